@@ -517,12 +517,11 @@ void CRender::OnFrame()
     Models->DeleteQueue();
     if (ps_r2_ls_flags.test(R2FLAG_EXP_MT_CALC))
     {
-        // MT-details (@front)
-        Device.seqParallel.insert(
-            Device.seqParallel.begin(), fastdelegate::FastDelegate0<>(Details, &CDetailManager::MT_CALC));
+        // MT-HOM, overlaps with the game jobs of the frame
+        Device.seqFrameJobs.Push("render_mt", fastdelegate::FastDelegate0<>(&HOM, &CHOM::MT_RENDER));
 
-        // MT-HOM (@front)
-        Device.seqParallel.insert(Device.seqParallel.begin(), fastdelegate::FastDelegate0<>(&HOM, &CHOM::MT_RENDER));
+        // MT-details
+        Device.seqFrameJobs.Push("render_mt", fastdelegate::FastDelegate0<>(Details, &CDetailManager::MT_CALC));
     }
 }
 
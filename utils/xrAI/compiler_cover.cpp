@@ -1,8 +1,8 @@
 #include "stdafx.h"
 #include "compiler.h"
 #include "xrCDB/Intersect.hpp"
-#include "utils/xrLCUtil/xrThread.hpp"
-#include <mmsystem.h>
+#include "xrCore/Threading/TaskManager.hpp"
+#include <atomic>
 
 #include "xrGame/quadtree.h"
 #include "xrGame/cover_point.h"
@@ -231,23 +231,47 @@ public:
 };
 struct RC
 {
+    u32 ID;
     RayCache C;
 };
 
-class CoverThread : public CThread
+// Ray caches are kept for the most recent targets only, the targets of the nearby base nodes
+// (the ones of a chunk) fit. An evicted cache means a real query, the result is the same
+const u32 cover_cache_size = 1 << 16;
+
+// State of the cover computation reused from chunk to chunk by the workers
+class CCoverContext
 {
-    u32 Nstart, Nend;
     xr_vector<RC> cache;
     CDB::COLLIDER DB;
     Query Q;
 
     typedef float Cover[4];
 
+    RayCache& ray_cache(u32 ID)
+    {
+        RC& rc = cache[ID & (cover_cache_size - 1)];
+        if (rc.ID != ID)
+        {
+            rc.ID = ID;
+            rc.C[0].set(0, 0, 0);
+            rc.C[1].set(0, 0, 0);
+            rc.C[2].set(0, 0, 0);
+        }
+        return (rc.C);
+    }
+
 public:
-    CoverThread(u32 ID, u32 _start, u32 _end) : CThread(ID, ProxyMsg)
+    CCoverContext()
     {
-        Nstart = _start;
-        Nend = _end;
+        DB.ray_options(CDB::OPT_CULL);
+        RC rc;
+        rc.ID = InvalidNode;
+        rc.C[0].set(0, 0, 0);
+        rc.C[1].set(0, 0, 0);
+        rc.C[2].set(0, 0, 0);
+        cache.assign(cover_cache_size, rc);
+        Q.Begin(g_nodes.size());
     }
 
     void compute_cover_value(u32 const& N, vertex& BaseNode, float const& cover_height, Cover& cover)
@@ -281,7 +305,7 @@ public:
             // raytrace
             int sector = calcSphereSector(Dir);
             c_total[sector] += 1.f;
-            c_passed[sector] += rayTrace(&DB, TestPos, Dir, range, cache[ID].C); //
+            c_passed[sector] += rayTrace(&DB, TestPos, Dir, range, ray_cache(ID)); //
         }
         Q.Clear();
 
@@ -312,25 +336,12 @@ public:
         clamp(cover[3], 0.f, 1.f); // back
     }
 
-    virtual void Execute()
+    void Execute(u32 Nstart, u32 Nend)
     {
-        DB.ray_options(CDB::OPT_CULL);
-        {
-            RC rc;
-            rc.C[0].set(0, 0, 0);
-            rc.C[1].set(0, 0, 0);
-            rc.C[2].set(0, 0, 0);
-
-            cache.assign(g_nodes.size() * 2, rc);
-        }
-
         FPU::m24r();
 
-        Q.Begin(g_nodes.size());
         for (u32 N = Nstart; N < Nend; N++)
         {
-            // initialize process
-            thProgress = float(N - Nstart) / float(Nend - Nstart);
             vertex& BaseNode = g_nodes[N];
 
             if (!g_cover_nodes[N])
@@ -352,6 +363,44 @@ public:
     }
 };
 
+// Contexts are taken by the chunks being computed, there are no more of them than workers
+class CCoverContextPool
+{
+    Lock lock;
+    xr_vector<CCoverContext*> contexts;
+    xr_vector<CCoverContext*> free;
+
+public:
+    ~CCoverContextPool() { delete_data(contexts); }
+    CCoverContext* acquire()
+    {
+        lock.Enter();
+        if (!free.empty())
+        {
+            CCoverContext* context = free.back();
+            free.pop_back();
+            lock.Leave();
+            return (context);
+        }
+        lock.Leave();
+
+        CCoverContext* context = new CCoverContext();
+        lock.Enter();
+        contexts.push_back(context);
+        lock.Leave();
+        return (context);
+    }
+
+    void release(CCoverContext* context)
+    {
+        lock.Enter();
+        free.push_back(context);
+        lock.Leave();
+    }
+
+    u32 size() const { return (contexts.size()); }
+};
+
 bool valid_vertex_id(const u32& vertex_id) { return (vertex_id != InvalidNode); }
 bool cover(const vertex& v, u32 index0, u32 index1)
 {
@@ -572,7 +621,9 @@ void compute_non_covers()
     }
 }
 
-#define NUM_THREADS 3
+// base nodes computed by a single task, the workers steal the chunks of each other
+const u32 cover_grain = 32;
+
 extern void mem_Optimize();
 void xrCover(bool pure_covers)
 {
@@ -583,20 +634,28 @@ void xrCover(bool pure_covers)
     else
         g_cover_nodes.assign(g_nodes.size(), true);
 
-    // Start threads, wait, continue --- perform all the work
-    u32 start_time = timeGetTime();
-    CThreadManager Threads(ProxyStatus, ProxyProgress);
-    u32 stride = g_nodes.size() / NUM_THREADS;
-    u32 last = g_nodes.size() - stride * (NUM_THREADS - 1);
-    for (u32 thID = 0; thID < NUM_THREADS; thID++)
-        Threads.start(
-            new CoverThread(thID, thID * stride, thID * stride + ((thID == (NUM_THREADS - 1)) ? last : stride)));
-    Threads.wait();
-    Msg("%d seconds elapsed.", (timeGetTime() - start_time) / 1000);
+    // Perform all the work in chunks on the task scheduler
+    CTimer timer;
+    timer.Start();
+    {
+        CCoverContextPool pool;
+        std::atomic<u32> done(0);
+        const u32 count = g_nodes.size();
+        Logger.Progress(0.f);
+        TaskScheduler.ParallelFor(0, count, cover_grain, [&](u32 from, u32 to) {
+            CCoverContext* context = pool.acquire();
+            context->Execute(from, to);
+            pool.release(context);
+            Logger.Progress(float(done += to - from) / float(count));
+        });
+        Msg("covers : %f seconds elapsed, %d nodes, %d workers", timer.GetElapsed_sec(), count, pool.size());
+    }
 
     if (!pure_covers)
     {
+        timer.Start();
         compute_non_covers();
+        Msg("non-covers : %f seconds elapsed", timer.GetElapsed_sec());
 
         COVERS nearest;
         VERIFY(g_covers);
@@ -608,6 +667,7 @@ void xrCover(bool pure_covers)
 
     // Smooth
     Logger.Status("Smoothing coverage mask...");
+    timer.Start();
     mem_Optimize();
     Nodes Old = g_nodes;
     for (u32 N = 0; N < g_nodes.size(); N++)
@@ -634,4 +694,5 @@ void xrCover(bool pure_covers)
             Dest.low_cover[dir] = val2 / cnt;
         }
     }
+    Msg("smoothing : %f seconds elapsed", timer.GetElapsed_sec());
 }
@@ -17,6 +17,9 @@
 #include "xrCrossTable.h"
 #include "guid_generator.h"
 #include "xrAICore/Navigation/graph_engine.h"
+#include "xrCore/Threading/TaskManager.hpp"
+#include "Common/object_broker.h"
+#include <atomic>
 
 CGameGraphBuilder::CGameGraphBuilder()
 {
@@ -219,90 +222,66 @@ void CGameGraphBuilder::fill_marks(const float& start, const float& amount)
     Logger.Progress(start + amount);
 }
 
-void CGameGraphBuilder::fill_distances(const float& start, const float& amount)
+void CGameGraphBuilder::iterate_distances(const float& start, const float& amount)
 {
     Logger.Progress(start);
 
-    m_distances.resize(graph().vertices().size());
+    // A single breadth first search from all the graph points at once: every node gets the
+    // nearest graph point, the one with the smallest id among the equally near ones
+    u32 level_vertex_count = level_graph().header().vertex_count();
+    m_results.assign(level_vertex_count, 0);
+    m_distances.assign(level_vertex_count, u32(-1));
+    m_current_fringe.reserve(level_vertex_count);
+    m_next_fringe.reserve(level_vertex_count);
+
+    graph_type::const_vertex_iterator I = graph().vertices().begin();
+    graph_type::const_vertex_iterator E = graph().vertices().end();
+    for (; I != E; ++I)
     {
-        DISTANCES::iterator I = m_distances.begin();
-        DISTANCES::iterator E = m_distances.end();
-        for (; I != E; I++)
-        {
-            (*I).resize(level_graph().header().vertex_count());
-            xr_vector<u32>::iterator i = (*I).begin();
-            xr_vector<u32>::iterator e = (*I).end();
-            for (; i != e; i++)
-                *i = u32(-1);
-        }
+        u32 level_vertex_id = (*I).second->data().level_vertex_id();
+        m_results[level_vertex_id] = (*I).second->vertex_id();
+        m_distances[level_vertex_id] = 0;
+        m_current_fringe.push_back(level_vertex_id);
     }
 
-    Logger.Progress(start + amount);
-}
-
-void CGameGraphBuilder::recursive_update(const u32& game_vertex_id, const float& start, const float& amount)
-{
-    Logger.Progress(start);
-
-    u32 level_vertex_id = graph().vertex(game_vertex_id)->data().level_vertex_id();
-    xr_vector<u32>& distances = m_distances[game_vertex_id];
-    m_distances[m_results[level_vertex_id]][level_vertex_id] = u32(-1);
-
-    m_current_fringe.reserve(distances.size());
-    m_next_fringe.reserve(distances.size());
-    distances.assign(distances.size(), u32(-1));
-    m_current_fringe.push_back(level_vertex_id);
-    u32 curr_dist = 0;
+    float amount_i = amount / float(level_vertex_count);
     u32 total_count = 0;
-
-    u32 vertex_count = graph().header().vertex_count();
-
-    float amount_i = amount / (float(vertex_count) * float(level_graph().header().vertex_count()));
-
-    Logger.Progress(start);
-    for (; !m_current_fringe.empty();)
+    for (u32 curr_dist = 0; !m_current_fringe.empty(); ++curr_dist)
     {
-        xr_vector<u32>::iterator I = m_current_fringe.begin();
-        xr_vector<u32>::iterator E = m_current_fringe.end();
-        for (; I != E; ++I)
+        xr_vector<u32>::const_iterator i = m_current_fringe.begin();
+        xr_vector<u32>::const_iterator e = m_current_fringe.end();
+        for (; i != e; ++i)
         {
-            u32* result = &m_results[*I];
-            VERIFY(curr_dist < m_distances[*result][*I]);
-            *result = game_vertex_id;
-
-            distances[*I] = curr_dist;
-            CLevelGraph::const_iterator i, e;
-            CLevelGraph::CVertex* node = level_graph().vertex(*I);
-            level_graph().begin(*I, i, e);
-            for (; i != e; ++i)
+            u32 result = m_results[*i];
+            CLevelGraph::const_iterator J, K;
+            CLevelGraph::CVertex* node = level_graph().vertex(*i);
+            level_graph().begin(*i, J, K);
+            for (; J != K; ++J)
             {
-                u32 dwNexNodeID = node->link(i);
-                if (!level_graph().valid_vertex_id(dwNexNodeID))
-                    continue;
-
-                if (m_marks[dwNexNodeID])
+                u32 next_level_vertex_id = node->link(J);
+                if (!level_graph().valid_vertex_id(next_level_vertex_id))
                     continue;
 
-                if (distances[dwNexNodeID] <= curr_dist)
+                if (m_marks[next_level_vertex_id])
                     continue;
 
-                if (m_distances[m_results[dwNexNodeID]][dwNexNodeID] <= (curr_dist + 1))
+                u32& distance = m_distances[next_level_vertex_id];
+                if (distance == u32(-1))
+                {
+                    distance = curr_dist + 1;
+                    m_results[next_level_vertex_id] = result;
+                    m_next_fringe.push_back(next_level_vertex_id);
                     continue;
+                }
 
-                m_next_fringe.push_back(dwNexNodeID);
-                m_marks[dwNexNodeID] = true;
+                if ((distance == curr_dist + 1) && (result < m_results[next_level_vertex_id]))
+                    m_results[next_level_vertex_id] = result;
             }
         }
 
-        I = m_current_fringe.begin();
-        E = m_current_fringe.end();
-        for (; I != E; ++I)
-            m_marks[*I] = false;
-
         total_count += m_current_fringe.size();
-        m_current_fringe = m_next_fringe;
+        m_current_fringe.swap(m_next_fringe);
         m_next_fringe.clear();
-        ++curr_dist;
 
         Logger.Progress(start + amount_i * float(total_count));
     }
@@ -310,27 +289,6 @@ void CGameGraphBuilder::recursive_update(const u32& game_vertex_id, const float&
     Logger.Progress(start + amount);
 }
 
-void CGameGraphBuilder::iterate_distances(const float& start, const float& amount)
-{
-    Logger.Progress(start);
-
-    m_results.assign(level_graph().header().vertex_count(), 0);
-
-    float amount_i = amount / float(graph().vertices().size());
-    for (int i = 0, n = (int)graph().vertices().size(); i < n; ++i)
-    {
-        if (i)
-        {
-            for (int k = 0, kn = (int)level_graph().header().vertex_count(); k < kn; ++k)
-                m_distances[i][k] = m_distances[i - 1][k];
-        }
-
-        recursive_update(i, start + amount_i * float(i), amount_i);
-    }
-
-    Logger.Progress(start + amount);
-}
-
 void CGameGraphBuilder::save_cross_table(const float& start, const float& amount)
 {
     Logger.Progress(start);
@@ -360,8 +318,7 @@ void CGameGraphBuilder::save_cross_table(const float& start, const float& amount
         CGameLevelCrossTable::CCell tCrossTableCell;
         tCrossTableCell.tGraphIndex = (GameGraph::_GRAPH_ID)m_results[i];
         VERIFY(graph().header().vertex_count() > tCrossTableCell.tGraphIndex);
-        tCrossTableCell.fDistance =
-            float(m_distances[tCrossTableCell.tGraphIndex][i]) * level_graph().header().cell_size();
+        tCrossTableCell.fDistance = float(m_distances[i]) * level_graph().header().cell_size();
         tMemoryStream.w(&tCrossTableCell, sizeof(tCrossTableCell));
     }
 
@@ -391,19 +348,17 @@ void CGameGraphBuilder::build_cross_table(const float& start, const float& amoun
 
     Msg("Building cross table");
 
-    //	CTimer					timer;
-    //	timer.Start				();
+    CTimer timer;
+    timer.Start();
 
     fill_marks(start + 0.000000f * amount, 0.018725f * amount);
-    //	Msg						("CT : %f",timer.GetElapsed_sec());
-    fill_distances(start + 0.018725f * amount, 0.183732f * amount);
-    //	Msg						("CT : %f",timer.GetElapsed_sec());
-    iterate_distances(start + 0.202457f * amount, 0.757202f * amount);
-    //	Msg						("CT : %f",timer.GetElapsed_sec());
+    Msg("CT : marks : %f", timer.GetElapsed_sec());
+    iterate_distances(start + 0.018725f * amount, 0.940934f * amount);
+    Msg("CT : distances : %f", timer.GetElapsed_sec());
     save_cross_table(start + 0.959659f * amount, 0.040327f * amount);
-    //	Msg						("CT : %f",timer.GetElapsed_sec());
+    Msg("CT : save : %f", timer.GetElapsed_sec());
     load_cross_table(start + 0.999986f * amount, 0.000014f * amount);
-    //	Msg						("CT : %f",timer.GetElapsed_sec());
+    Msg("CT : load : %f", timer.GetElapsed_sec());
 
     Logger.Progress(start + amount);
 }
@@ -420,55 +375,54 @@ void CGameGraphBuilder::load_cross_table(const float& start, const float& amount
     Logger.Progress(start + amount);
 }
 
-void CGameGraphBuilder::fill_neighbours(const u32& game_vertex_id)
+void CGameGraphBuilder::fill_neighbours(
+    const u32& game_vertex_id, xr_vector<bool>& marks, xr_vector<u32>& mark_stack, xr_vector<u32>& neighbours) const
 {
-    m_marks.assign(level_graph().header().vertex_count(), false);
-    m_current_fringe.clear();
+    marks.assign(level_graph().header().vertex_count(), false);
+    neighbours.clear();
 
     u32 level_vertex_id = graph().vertex(game_vertex_id)->data().level_vertex_id();
 
     CLevelGraph::const_iterator I, E;
-    m_mark_stack.reserve(8192);
-    m_mark_stack.push_back(level_vertex_id);
+    mark_stack.reserve(8192);
+    mark_stack.push_back(level_vertex_id);
 
-    for (; !m_mark_stack.empty();)
+    for (; !mark_stack.empty();)
     {
-        level_vertex_id = m_mark_stack.back();
-        m_mark_stack.resize(m_mark_stack.size() - 1);
+        level_vertex_id = mark_stack.back();
+        mark_stack.resize(mark_stack.size() - 1);
         CLevelGraph::CVertex* node = level_graph().vertex(level_vertex_id);
         level_graph().begin(level_vertex_id, I, E);
-        m_marks[level_vertex_id] = true;
+        marks[level_vertex_id] = true;
         for (; I != E; ++I)
         {
             u32 next_level_vertex_id = node->link(I);
             if (!level_graph().valid_vertex_id(next_level_vertex_id))
                 continue;
 
-            if (m_marks[next_level_vertex_id])
+            if (marks[next_level_vertex_id])
                 continue;
 
             GameGraph::_GRAPH_ID next_game_vertex_id = cross().vertex(next_level_vertex_id).game_vertex_id();
             VERIFY(next_game_vertex_id < graph().vertices().size());
             if (next_game_vertex_id != (GameGraph::_GRAPH_ID)game_vertex_id)
             {
-                if (std::find(m_current_fringe.begin(), m_current_fringe.end(), next_game_vertex_id) ==
-                    m_current_fringe.end())
-                    m_current_fringe.push_back(next_game_vertex_id);
+                if (std::find(neighbours.begin(), neighbours.end(), next_game_vertex_id) == neighbours.end())
+                    neighbours.push_back(next_game_vertex_id);
                 continue;
             }
 
-            m_mark_stack.push_back(next_level_vertex_id);
+            mark_stack.push_back(next_level_vertex_id);
         }
     }
 }
 
-float CGameGraphBuilder::path_distance(const u32& game_vertex_id0, const u32& game_vertex_id1)
+float CGameGraphBuilder::path_distance(
+    const u32& game_vertex_id0, const u32& game_vertex_id1, SEdgeContext& context) const
 {
     //	return
     //(graph().vertex(game_vertex_id0)->data().level_point().distance_to(graph().vertex(game_vertex_id1)->data().level_point()));
 
-    VERIFY(m_graph_engine);
-
     graph_type::CVertex& vertex0 = *graph().vertex(game_vertex_id0);
     graph_type::CVertex& vertex1 = *graph().vertex(game_vertex_id1);
 
@@ -484,8 +438,8 @@ float CGameGraphBuilder::path_distance(const u32& game_vertex_id0, const u32& ga
     if (level_graph().valid_vertex_id(level_vertex_id))
         return (pure_distance);
 
-    bool successfull = m_graph_engine->search(
-        level_graph(), vertex0.data().level_vertex_id(), vertex1.data().level_vertex_id(), &m_path, parameters);
+    bool successfull = context.graph_engine->search(
+        level_graph(), vertex0.data().level_vertex_id(), vertex1.data().level_vertex_id(), &context.path, parameters);
 
     if (successfull)
         return (parameters.m_distance);
@@ -497,18 +451,46 @@ float CGameGraphBuilder::path_distance(const u32& game_vertex_id0, const u32& ga
     return (flt_max);
 }
 
-void CGameGraphBuilder::generate_edges(const u32& game_vertex_id)
+CGameGraphBuilder::SEdgeContext::SEdgeContext(u32 vertex_count) : graph_engine(new CGraphEngine(vertex_count)) {}
+CGameGraphBuilder::SEdgeContext::~SEdgeContext() { xr_delete(graph_engine); }
+CGameGraphBuilder::SEdgeContext* CGameGraphBuilder::acquire_edge_context()
 {
-    graph_type::CVertex* vertex = graph().vertex(game_vertex_id);
-
-    xr_vector<u32>::const_iterator I = m_current_fringe.begin();
-    xr_vector<u32>::const_iterator E = m_current_fringe.end();
-    for (; I != E; ++I)
+    m_edge_contexts_lock.Enter();
+    if (!m_free_edge_contexts.empty())
     {
-        VERIFY(!vertex->edge(*I));
-        float distance = path_distance(game_vertex_id, *I);
-        graph().add_edge(game_vertex_id, *I, distance);
+        SEdgeContext* context = m_free_edge_contexts.back();
+        m_free_edge_contexts.pop_back();
+        m_edge_contexts_lock.Leave();
+        return (context);
     }
+    m_edge_contexts_lock.Leave();
+
+    // engines reserve their storage up front, so they are made outside of the lock
+    SEdgeContext* context = new SEdgeContext(level_graph().header().vertex_count());
+    m_edge_contexts_lock.Enter();
+    m_edge_contexts.push_back(context);
+    m_edge_contexts_lock.Leave();
+    return (context);
+}
+
+void CGameGraphBuilder::release_edge_context(SEdgeContext* context)
+{
+    m_edge_contexts_lock.Enter();
+    m_free_edge_contexts.push_back(context);
+    m_edge_contexts_lock.Leave();
+}
+
+void CGameGraphBuilder::generate_edges(const u32& game_vertex_id, SEdgeContext& context, EDGES& edges) const
+{
+    fill_neighbours(game_vertex_id, context.marks, context.mark_stack, context.neighbours);
+
+    edges.clear();
+    edges.reserve(context.neighbours.size());
+
+    xr_vector<u32>::const_iterator I = context.neighbours.begin();
+    xr_vector<u32>::const_iterator E = context.neighbours.end();
+    for (; I != E; ++I)
+        edges.push_back(std::make_pair(*I, path_distance(game_vertex_id, *I, context)));
 }
 
 void CGameGraphBuilder::generate_edges(const float& start, const float& amount)
@@ -517,12 +499,32 @@ void CGameGraphBuilder::generate_edges(const float& start, const float& amount)
 
     Msg("Generating edges");
 
-    graph_type::const_vertex_iterator I = graph().vertices().begin();
-    graph_type::const_vertex_iterator E = graph().vertices().end();
-    for (; I != E; ++I)
+    // Every vertex looks for its neighbours and paths to them on its own, the vertices are
+    // spread over the workers one by one since their areas differ a lot. The graph itself
+    // is modified afterwards, in the vertex order
+    u32 vertex_count = graph().vertices().size();
+    xr_vector<EDGES> edges(vertex_count);
+    std::atomic<u32> done(0);
+
+    TaskScheduler.ParallelFor(0, vertex_count, 1, [&](u32 from, u32 to) {
+        SEdgeContext* context = acquire_edge_context();
+        for (u32 i = from; i < to; ++i)
+            generate_edges(i, *context, edges[i]);
+        release_edge_context(context);
+        Logger.Progress(start + amount * float(done += to - from) / float(vertex_count));
+    });
+
+    for (u32 i = 0; i < vertex_count; ++i)
     {
-        fill_neighbours((*I).second->vertex_id());
-        generate_edges((*I).second->vertex_id());
+        graph_type::CVertex* vertex = graph().vertex(i);
+
+        EDGES::const_iterator I = edges[i].begin();
+        EDGES::const_iterator E = edges[i].end();
+        for (; I != E; ++I)
+        {
+            VERIFY(!vertex->edge((*I).first));
+            graph().add_edge(i, (*I).first, (*I).second);
+        }
     }
 
     Msg("%d edges built", graph().edge_count());
@@ -711,23 +713,21 @@ void CGameGraphBuilder::build_graph(const float& start, const float& amount)
     CTimer timer;
     timer.Start();
 
-    m_graph_engine = new CGraphEngine(level_graph().header().vertex_count());
     Logger.Progress(start + 0.000000f * amount + amount * 0.067204f);
-    //	Msg						("BG : %f",timer.GetElapsed_sec());
 
     generate_edges(start + 0.067204f * amount, amount * 0.922647f);
-    //	Msg						("BG : %f",timer.GetElapsed_sec());
+    Msg("BG : edges : %f, %d workers", timer.GetElapsed_sec(), u32(m_edge_contexts.size()));
 
-    xr_delete(m_graph_engine);
+    VERIFY(m_free_edge_contexts.size() == m_edge_contexts.size());
+    delete_data(m_edge_contexts);
+    m_free_edge_contexts.clear();
     Logger.Progress(start + 0.989851f * amount + amount * 0.002150f);
-    //	Msg						("BG : %f",timer.GetElapsed_sec());
 
     connectivity_check(start + 0.992001f * amount, amount * 0.000030f);
-    //	Msg						("BG : %f",timer.GetElapsed_sec());
     optimize_graph(start + 0.992031f * amount, amount * 0.000454f);
-    //	Msg						("BG : %f",timer.GetElapsed_sec());
+    Msg("BG : optimization : %f", timer.GetElapsed_sec());
     save_graph(start + 0.992485f * amount, amount * 0.007515f);
-    //	Msg						("BG : %f",timer.GetElapsed_sec());
+    Msg("BG : save : %f", timer.GetElapsed_sec());
 
     Logger.Progress(start + amount);
 }
@@ -741,19 +741,17 @@ void CGameGraphBuilder::build_graph(LPCSTR graph_name, LPCSTR cross_table_name,
     m_cross_table_name = cross_table_name;
     m_level_name = level_name;
 
-    //	CTimer					timer;
-    //	timer.Start				();
+    CTimer timer;
+    timer.Start();
 
     create_graph(0.000000f, 0.000047f);
-    //	Msg						("%f",timer.GetElapsed_sec());
     load_level_graph(0.000047f, 0.002470f);
-    //	Msg						("%f",timer.GetElapsed_sec());
     load_graph_points(0.002517f, 0.111812f);
-    //	Msg						("%f",timer.GetElapsed_sec());
+    Msg("graph points : %f", timer.GetElapsed_sec());
     build_cross_table(0.114329f, 0.773423f);
-    //	Msg						("%f",timer.GetElapsed_sec());
+    Msg("cross table : %f", timer.GetElapsed_sec());
     build_graph(0.887752f, 0.112248f);
-    //	Msg						("%f",timer.GetElapsed_sec());
+    Msg("graph : %f", timer.GetElapsed_sec());
 
     Msg("Level graph is generated successfully");
 }
@@ -33,7 +33,8 @@ class CGameGraphBuilder
 private:
     typedef GameGraph::CVertex vertex_type;
     typedef CGraphAbstract<vertex_type, float, u32> graph_type;
-    typedef xr_vector<xr_vector<u32>> DISTANCES;
+    typedef std::pair<u32, float> EDGE;
+    typedef xr_vector<EDGE> EDGES;
     typedef std::pair<u32, u32> PAIR;
     typedef std::pair<float, PAIR> TRIPPLE;
     typedef xr_vector<TRIPPLE> TRIPPLES;
@@ -52,15 +53,33 @@ private:
     // cross table generation stuff
     xr_vector<bool> m_marks;
     xr_vector<u32> m_mark_stack;
-    DISTANCES m_distances;
+    xr_vector<u32> m_distances;
     xr_vector<u32> m_current_fringe;
     xr_vector<u32> m_next_fringe;
     xr_vector<u32> m_results;
     // cross table itself
     CGameLevelCrossTable* m_cross_table;
     TRIPPLES m_tripples;
-    xr_vector<u32> m_path;
-    CGraphEngine* m_graph_engine;
+
+private:
+    // edge generation storage of a worker. The engine is made here and not taken from CGraphEnginePool: xrAI
+    // compiles CGraphEngine with AI_COMPILER and xrAICore without it, so their engines differ
+    struct SEdgeContext
+    {
+        CGraphEngine* graph_engine;
+        xr_vector<bool> marks;
+        xr_vector<u32> mark_stack;
+        xr_vector<u32> neighbours;
+        xr_vector<u32> path;
+
+        SEdgeContext(u32 vertex_count);
+        ~SEdgeContext();
+    };
+
+    // contexts are taken by the vertices being processed, there are no more of them than workers
+    Lock m_edge_contexts_lock;
+    xr_vector<SEdgeContext*> m_edge_contexts;
+    xr_vector<SEdgeContext*> m_free_edge_contexts;
 
 private:
     void create_graph(const float& start, const float& amount);
@@ -71,17 +90,18 @@ private:
 private:
     void mark_vertices(u32 level_vertex_id);
     void fill_marks(const float& start, const float& amount);
-    void fill_distances(const float& start, const float& amount);
-    void recursive_update(const u32& index, const float& start, const float& amount);
     void iterate_distances(const float& start, const float& amount);
     void save_cross_table(const float& start, const float& amount);
     void build_cross_table(const float& start, const float& amount);
     void load_cross_table(const float& start, const float& amount);
 
 private:
-    void fill_neighbours(const u32& game_vertex_id);
-    float path_distance(const u32& game_vertex_id0, const u32& game_vertex_id1);
-    void generate_edges(const u32& vertex_id);
+    void fill_neighbours(const u32& game_vertex_id, xr_vector<bool>& marks, xr_vector<u32>& mark_stack,
+        xr_vector<u32>& neighbours) const;
+    float path_distance(const u32& game_vertex_id0, const u32& game_vertex_id1, SEdgeContext& context) const;
+    SEdgeContext* acquire_edge_context();
+    void release_edge_context(SEdgeContext* context);
+    void generate_edges(const u32& vertex_id, SEdgeContext& context, EDGES& edges) const;
     void generate_edges(const float& start, const float& amount);
     void connectivity_check(const float& start, const float& amount);
     void create_tripples(const float& start, const float& amount);
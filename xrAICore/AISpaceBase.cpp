@@ -2,7 +2,9 @@
 #include "AISpaceBase.hpp"
 #include "Navigation/game_graph.h"
 #include "Navigation/level_graph.h"
+#include "Navigation/level_graph_hierarchy.h"
 #include "Navigation/graph_engine.h"
+#include "Navigation/graph_engine_pool.h"
 #include "Navigation/PatrolPath/patrol_path_storage.h"
 #include "Include/xrAPI/xrAPI.h"
 
@@ -10,6 +12,7 @@ AISpaceBase::AISpaceBase() { GlobalEnv.AISpace = this; }
 AISpaceBase::~AISpaceBase()
 {
     xr_delete(m_patrol_path_storage);
+    xr_delete(m_graph_engine_pool);
     xr_delete(m_graph_engine);
     VERIFY(!m_game_graph);
     GlobalEnv.AISpace = nullptr;
@@ -27,17 +30,25 @@ void AISpaceBase::Load(const char* levelName)
     R_ASSERT2(crossHeader.game_guid() == gameHeader.guid(), "graph doesn't correspond to the cross table");
     u32 vertexCount = _max(gameHeader.vertex_count(), levelHeader.vertex_count());
     m_graph_engine = new CGraphEngine(vertexCount);
+    m_graph_engine_pool = new CGraphEnginePool(vertexCount);
     R_ASSERT2(currentLevel.guid() == levelHeader.guid(), "graph doesn't correspond to the AI-map");
     if (!xr_strcmp(currentLevel.name(), levelName))
         Validate(currentLevel.id());
     level_graph().level_id(currentLevel.id());
+    CTimer timer;
+    timer.Start();
+    m_level_graph_hierarchy = new CLevelGraphHierarchy(level_graph());
+    Msg("* Level graph hierarchy: %u clusters, %u KB, built in %.0f ms", m_level_graph_hierarchy->cluster_count(),
+        m_level_graph_hierarchy->memory() / 1024, timer.GetElapsed_sec() * 1000.f);
 }
 
 void AISpaceBase::Unload(bool reload)
 {
     if (g_dedicated_server)
         return;
+    xr_delete(m_graph_engine_pool);
     xr_delete(m_graph_engine);
+    xr_delete(m_level_graph_hierarchy);
     xr_delete(m_level_graph);
     if (!reload && m_game_graph)
         m_graph_engine = new CGraphEngine(game_graph().header().vertex_count());
@@ -120,5 +131,14 @@ void AISpaceBase::SetGameGraph(CGameGraph* gameGraph)
     }
 }
 
+CGraphEngine& AISpaceBase::graph_engine() const
+{
+    CGraphEngine* engine = CGraphEnginePool::bound_engine();
+    if (engine)
+        return *engine;
+    VERIFY(m_graph_engine);
+    return *m_graph_engine;
+}
+
 const CGameLevelCrossTable& AISpaceBase::cross_table() const { return game_graph().cross_table(); }
 const CGameLevelCrossTable* AISpaceBase::get_cross_table() const { return &game_graph().cross_table(); }
@@ -5,7 +5,9 @@
 class CGameGraph;
 class CGameLevelCrossTable;
 class CLevelGraph;
+class CLevelGraphHierarchy;
 class CGraphEngine;
+class CGraphEnginePool;
 class CPatrolPathStorage;
 
 class XRAICORE_API AISpaceBase
@@ -13,7 +15,9 @@ class XRAICORE_API AISpaceBase
 protected:
     CGameGraph* m_game_graph = nullptr; // not owned by AISpaceBase
     CLevelGraph* m_level_graph = nullptr;
+    CLevelGraphHierarchy* m_level_graph_hierarchy = nullptr;
     CGraphEngine* m_graph_engine = nullptr;
+    CGraphEnginePool* m_graph_engine_pool = nullptr; // level searches on worker threads
     CPatrolPathStorage* m_patrol_path_storage = nullptr;
 
 protected:
@@ -37,10 +41,13 @@ public:
     inline CGameGraph* get_game_graph() const;
     inline CLevelGraph& level_graph() const;
     inline const CLevelGraph* get_level_graph() const;
+    inline const CLevelGraphHierarchy* level_graph_hierarchy() const;
     const CGameLevelCrossTable& cross_table() const;
     const CGameLevelCrossTable* get_cross_table() const;
     inline const CPatrolPathStorage& patrol_paths() const;
-    inline CGraphEngine& graph_engine() const;
+    // Engine bound to the calling thread (CGraphEngineScope) or the primary one
+    CGraphEngine& graph_engine() const;
+    inline CGraphEnginePool* graph_engine_pool() const;
 };
 
 inline CGameGraph& AISpaceBase::game_graph() const
@@ -57,11 +64,8 @@ inline CLevelGraph& AISpaceBase::level_graph() const
 }
 
 inline const CLevelGraph* AISpaceBase::get_level_graph() const { return m_level_graph; }
-inline CGraphEngine& AISpaceBase::graph_engine() const
-{
-    VERIFY(m_graph_engine);
-    return *m_graph_engine;
-}
+inline const CLevelGraphHierarchy* AISpaceBase::level_graph_hierarchy() const { return m_level_graph_hierarchy; }
+inline CGraphEnginePool* AISpaceBase::graph_engine_pool() const { return m_graph_engine_pool; }
 
 inline const CPatrolPathStorage& AISpaceBase::patrol_paths() const
 {
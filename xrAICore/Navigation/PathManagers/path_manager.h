@@ -40,5 +40,6 @@ class CPathManager
 #include "xrAICore/Navigation/PathManagers/path_manager_level_straight_line.h"
 #else
 #include "xrAICore/Navigation/PathManagers/path_manager_level_nearest_vertex.h"
+#include "xrAICore/Navigation/PathManagers/path_manager_level_corridor.h"
 #include "xrAICore/Navigation/PathManagers/path_manager_solver.h"
 #endif
@@ -37,6 +37,7 @@ protected:
     float m_sqr_distance_xz;
     float m_distance_xz;
     _Graph::CVertex* best_node;
+    const xr_vector<bool>* m_access_mask; // of the searching thread, see CLevelGraph::access_mask
 
 public:
     virtual ~CPathManager();
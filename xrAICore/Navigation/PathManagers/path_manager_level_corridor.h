@@ -0,0 +1,37 @@
+////////////////////////////////////////////////////////////////////////////
+//	Module 		: path_manager_level_corridor.h
+//	Description : Level path manager limited to a corridor of clusters
+////////////////////////////////////////////////////////////////////////////
+
+#pragma once
+
+#include "xrAICore/Navigation/PathManagers/path_manager_level.h"
+#include "xrAICore/Navigation/level_graph_hierarchy.h"
+
+// Refinement step of CGraphEngine::search_hierarchical: the level search
+// doesn't leave the clusters marked by CLevelGraphHierarchy::build_corridor
+template <typename _DataStorage, typename _dist_type, typename _index_type, typename _iteration_type>
+class CLevelCorridorPathManager
+    : public CPathManager<CLevelGraph, _DataStorage, SBaseParameters<_dist_type, _index_type, _iteration_type>,
+          _dist_type, _index_type, _iteration_type>
+{
+protected:
+    typedef CPathManager<CLevelGraph, _DataStorage, SBaseParameters<_dist_type, _index_type, _iteration_type>,
+        _dist_type, _index_type, _iteration_type>
+        inherited;
+
+protected:
+    const CLevelGraphHierarchy* m_hierarchy;
+    const CLevelGraphHierarchy::SCorridor* m_corridor;
+
+public:
+    IC CLevelCorridorPathManager(const CLevelGraphHierarchy& hierarchy, const CLevelGraphHierarchy::SCorridor& corridor)
+        : m_hierarchy(&hierarchy), m_corridor(&corridor)
+    {
+    }
+
+    IC bool is_accessible(const _index_type& vertex_id) const
+    {
+        return (inherited::is_accessible(vertex_id) && m_hierarchy->in_corridor(*m_corridor, vertex_id));
+    }
+};
@@ -25,6 +25,7 @@ IC void CLevelPathManager::setup(const _Graph* _graph, _DataStorage* _data_stora
     inherited::setup(_graph, _data_storage, _path, _start_node_index, _goal_node_index, parameters);
     m_distance_xz = graph->header().cell_size();
     m_sqr_distance_xz = _sqr(graph->header().cell_size());
+    m_access_mask = &graph->access_mask();
     //		square_size_y			= _sqr((float)(graph->header().factor_y()/32767.0));
     //		size_y					= (float)(graph->header().factor_y()/32767.0);
 }
@@ -95,7 +96,7 @@ IC bool CLevelPathManager::is_accessible(const _index_type& vertex_id) const
 {
     VERIFY(graph);
     //	return					(graph->valid_vertex_id(vertex_id));
-    return (graph->is_accessible(vertex_id));
+    return (graph->valid_vertex_id(vertex_id) && (*m_access_mask)[vertex_id]);
 }
 
 TEMPLATE_SPECIALIZATION
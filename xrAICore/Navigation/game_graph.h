@@ -38,6 +38,8 @@ private:
     IReader* m_reader;
     CVertex* m_nodes;
     mutable ENABLED m_enabled;
+    // changes every time a vertex becomes accessible or inaccessible
+    mutable u32 m_accessibility_stamp;
     _GRAPH_ID m_current_level_some_vertex_id;
 
 private:
@@ -62,6 +64,7 @@ public:
     IC float distance(const _GRAPH_ID tGraphID0, const _GRAPH_ID tGraphID1) const;
     IC bool accessible(u32 vertex_id) const;
     IC void accessible(u32 vertex_id, bool value) const;
+    IC u32 accessibility_stamp() const;
     IC bool valid_vertex_id(u32 vertex_id) const;
     IC void begin(u32 vertex_id, const_iterator& start, const_iterator& end) const;
     IC void begin_spawn(u32 vertex_id, const_spawn_iterator& start, const_spawn_iterator& end) const;
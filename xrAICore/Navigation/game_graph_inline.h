@@ -17,6 +17,7 @@ inline void CGameGraph::Initialize(IReader& stream, bool own)
     m_nodes = (CVertex*)m_reader->pointer();
     m_current_level_some_vertex_id = _GRAPH_ID(-1);
     m_enabled.assign(header().vertex_count(), true);
+    m_accessibility_stamp = 0;
     u8* temp = (u8*)(m_nodes + header().vertex_count());
     temp += header().edge_count() * sizeof(CGameGraph::CEdge);
     m_cross_tables = (u32*)(((CLevelPoint*)temp) + header().death_point_count());
@@ -79,9 +80,14 @@ IC bool CGameGraph::accessible(u32 const vertex_id) const
 IC void CGameGraph::accessible(u32 const vertex_id, bool value) const
 {
     VERIFY(valid_vertex_id(vertex_id));
+    if (m_enabled[vertex_id] == value)
+        return;
     m_enabled[vertex_id] = value;
+    ++m_accessibility_stamp;
 }
 
+IC u32 CGameGraph::accessibility_stamp() const { return (m_accessibility_stamp); }
+
 IC bool CGameGraph::valid_vertex_id(u32 const vertex_id) const { return (vertex_id < header().vertex_count()); }
 IC void CGameGraph::begin(u32 const vertex_id, const_iterator& start, const_iterator& end) const
 {
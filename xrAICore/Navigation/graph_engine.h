@@ -72,6 +72,7 @@ public:
 #ifndef AI_COMPILER
     CSolverAlgorithm* m_solver_algorithm;
     CStringAlgorithm* m_string_algorithm;
+    CLevelGraphHierarchy::SCorridor m_corridor;
 #endif
     CStatTimer PathTimer;
 
@@ -99,6 +100,12 @@ public:
         xr_vector<_index_type>* node_path, const _Parameters& parameters, _PathManager& path_manager);
 
 #ifndef AI_COMPILER
+    // Cluster path first, then the level path within its corridor;
+    // falls back to the full search if restrictions close the corridor
+    inline bool search_hierarchical(const CLevelGraphHierarchy& hierarchy, const CLevelGraph& graph,
+        const _index_type& start_node, const _index_type& dest_node, xr_vector<_index_type>* node_path,
+        const SBaseParameters<_dist_type, _index_type, _iteration_type>& parameters);
+
     template <typename T1, typename T2, typename T3, typename T4, typename T5, bool T6, typename T7, typename T8,
         typename _Parameters>
     inline bool search(const CProblemSolver<T1, T2, T3, T4, T5, T6, T7, T8>& graph,
@@ -84,6 +84,29 @@ inline bool CGraphEngine::search(const _Graph& graph, const _index_type& start_n
 }
 
 #ifndef AI_COMPILER
+inline bool CGraphEngine::search_hierarchical(const CLevelGraphHierarchy& hierarchy, const CLevelGraph& graph,
+    const _index_type& start_node, const _index_type& dest_node, xr_vector<_index_type>* node_path,
+    const SBaseParameters<_dist_type, _index_type, _iteration_type>& parameters)
+{
+    START_PROFILE("graph_engine")
+    START_PROFILE("graph_engine/hierarchical")
+    if (!hierarchy.build_corridor(m_corridor, start_node, dest_node))
+        return false;
+
+    PathTimer.Begin();
+    using CCorridorPathManager =
+        CLevelCorridorPathManager<CAlgorithm::CDataStorage, _dist_type, _index_type, _iteration_type>;
+    CCorridorPathManager path_manager(hierarchy, m_corridor);
+    path_manager.setup(&graph, &m_algorithm->data_storage(), node_path, start_node, dest_node, parameters);
+    bool successfull = m_algorithm->find(path_manager);
+    PathTimer.End();
+    if (successfull)
+        return true;
+    return search(graph, start_node, dest_node, node_path, parameters);
+    STOP_PROFILE
+    STOP_PROFILE
+}
+
 template <typename T1, typename T2, typename T3, typename T4, typename T5, bool T6, typename T7, typename T8,
     typename _Parameters>
 inline bool CGraphEngine::search(const CProblemSolver<T1, T2, T3, T4, T5, T6, T7, T8>& graph,
@@ -0,0 +1,71 @@
+////////////////////////////////////////////////////////////////////////////
+//  Module      : graph_engine_pool.cpp
+//  Description : Graph engines for path searches on worker threads
+////////////////////////////////////////////////////////////////////////////
+
+#include "PCH.hpp"
+#include "graph_engine_pool.h"
+#include "graph_engine.h"
+#include "level_graph.h"
+
+static thread_local CGraphEngine* t_graph_engine = nullptr;
+
+CGraphEnginePool::CGraphEnginePool(u32 vertex_count) : m_vertex_count(vertex_count) {}
+
+CGraphEnginePool::~CGraphEnginePool()
+{
+    VERIFY2(m_free.size() == m_entries.size(), "graph engine pool is destroyed while searches are running");
+    for (SEntry* entry : m_entries)
+    {
+        xr_delete(entry->engine);
+        xr_delete(entry);
+    }
+}
+
+CGraphEnginePool::SEntry* CGraphEnginePool::acquire()
+{
+    m_lock.Enter();
+    if (!m_free.empty())
+    {
+        SEntry* entry = m_free.back();
+        m_free.pop_back();
+        m_lock.Leave();
+        return entry;
+    }
+    m_lock.Leave();
+
+    // Engines reserve their storage up front, so they are created outside of the lock
+    SEntry* entry = new SEntry();
+    entry->engine = new CGraphEngine(m_vertex_count);
+    m_lock.Enter();
+    m_entries.push_back(entry);
+    m_lock.Leave();
+    return entry;
+}
+
+void CGraphEnginePool::release(SEntry* entry)
+{
+    m_lock.Enter();
+    m_free.push_back(entry);
+    m_lock.Leave();
+}
+
+CGraphEngine* CGraphEnginePool::bound_engine() { return t_graph_engine; }
+
+CGraphEngineScope::CGraphEngineScope(CGraphEnginePool& pool, const CLevelGraph* level_graph)
+    : m_pool(pool), m_entry(pool.acquire()), m_previous_engine(t_graph_engine), m_previous_mask(nullptr)
+{
+    // Borders are cleared after every search, so an all-accessible copy stays in sync with the level mask
+    if (level_graph && m_entry->access_mask.size() != level_graph->header().vertex_count())
+        m_entry->access_mask.assign(level_graph->header().vertex_count(), true);
+
+    t_graph_engine = m_entry->engine;
+    m_previous_mask = CLevelGraph::bind_access_mask(level_graph ? &m_entry->access_mask : nullptr);
+}
+
+CGraphEngineScope::~CGraphEngineScope()
+{
+    CLevelGraph::bind_access_mask(m_previous_mask);
+    t_graph_engine = m_previous_engine;
+    m_pool.release(m_entry);
+}
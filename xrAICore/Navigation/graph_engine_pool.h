@@ -0,0 +1,59 @@
+////////////////////////////////////////////////////////////////////////////
+//  Module      : graph_engine_pool.h
+//  Description : Graph engines for path searches on worker threads
+////////////////////////////////////////////////////////////////////////////
+
+#pragma once
+
+#include "xrAICore/xrAICore.hpp"
+#include "xrCore/xrCore.h"
+
+class CGraphEngine;
+class CLevelGraph;
+
+// Every engine comes with a level graph access mask of its own: searches running on
+// different threads must not share the search storage nor the restriction borders,
+// which are applied to the mask for the duration of a search
+class XRAICORE_API CGraphEnginePool
+{
+public:
+    struct SEntry
+    {
+        CGraphEngine* engine;
+        xr_vector<bool> access_mask;
+    };
+
+private:
+    Lock m_lock;
+    xr_vector<SEntry*> m_entries;
+    xr_vector<SEntry*> m_free;
+    u32 m_vertex_count;
+
+public:
+    CGraphEnginePool(u32 vertex_count);
+    ~CGraphEnginePool();
+
+    SEntry* acquire();
+    void release(SEntry* entry);
+    u32 size() const { return m_entries.size(); }
+
+    // Engine bound to the calling thread by CGraphEngineScope, nullptr if none
+    static CGraphEngine* bound_engine();
+};
+
+// Binds a pooled engine and its access mask to the calling thread for the lifetime
+// of the scope, ai().graph_engine() and the level graph mask accessors return them
+class XRAICORE_API CGraphEngineScope
+{
+    CGraphEnginePool& m_pool;
+    CGraphEnginePool::SEntry* m_entry;
+    CGraphEngine* m_previous_engine;
+    xr_vector<bool>* m_previous_mask;
+
+public:
+    CGraphEngineScope(CGraphEnginePool& pool, const CLevelGraph* level_graph);
+    ~CGraphEngineScope();
+
+    CGraphEngineScope(const CGraphEngineScope&) = delete;
+    CGraphEngineScope& operator=(const CGraphEngineScope&) = delete;
+};
@@ -36,23 +36,139 @@ void CLevelGraph::Initialize(const char* filePath)
     m_column_length = iFloor((header().box().max.x - header().box().min.x) / header().cell_size() + EPS_L + 1.5f);
     m_access_mask.assign(header().vertex_count(), true);
     unpack_xz(vertex_position(header().box().max), m_max_x, m_max_z);
+    m_vertex_grid = nullptr;
+}
+
+CLevelGraph::~CLevelGraph()
+{
+    SVertexGrid* grid = m_vertex_grid;
+    xr_delete(grid);
+    FS.r_close(m_reader);
+}
+
+// Set for the threads running pooled searches, see CGraphEnginePool
+static thread_local xr_vector<bool>* t_access_mask = nullptr;
+
+const xr_vector<bool>& CLevelGraph::access_mask() const { return t_access_mask ? *t_access_mask : m_access_mask; }
+xr_vector<bool>& CLevelGraph::access_mask() { return t_access_mask ? *t_access_mask : m_access_mask; }
+xr_vector<bool>* CLevelGraph::bind_access_mask(xr_vector<bool>* mask)
+{
+    xr_vector<bool>* previous = t_access_mask;
+    t_access_mask = mask;
+    return previous;
+}
+
+const CLevelGraph::SVertexGrid& CLevelGraph::vertex_grid() const
+{
+    SVertexGrid* grid = m_vertex_grid.load(std::memory_order_acquire);
+    if (grid)
+        return (*grid);
+
+    m_vertex_grid_lock.Enter();
+    grid = m_vertex_grid.load(std::memory_order_relaxed);
+    if (!grid)
+    {
+        grid = new SVertexGrid();
+        grid->size_x = m_max_x / vertex_grid_cells + 1;
+        grid->size_z = m_max_z / vertex_grid_cells + 1;
+        grid->offsets.assign(grid->size_x * grid->size_z + 1, 0);
+
+        // counting sort of the vertex ids, so every bucket keeps them in ascending order
+        const u32 vertex_count = header().vertex_count();
+        xr_vector<u32> buckets(vertex_count);
+        for (u32 i = 0; i < vertex_count; ++i)
+        {
+            u32 x, z;
+            unpack_xz(m_nodes[i].position(), x, z);
+            x = _min(x / vertex_grid_cells, grid->size_x - 1);
+            z = _min(z / vertex_grid_cells, grid->size_z - 1);
+            buckets[i] = x * grid->size_z + z;
+            ++grid->offsets[buckets[i] + 1];
+        }
+
+        for (u32 i = 1, n = grid->offsets.size(); i < n; ++i)
+            grid->offsets[i] += grid->offsets[i - 1];
+
+        xr_vector<u32> fill(grid->offsets.begin(), grid->offsets.end() - 1);
+        grid->vertices.resize(vertex_count);
+        for (u32 i = 0; i < vertex_count; ++i)
+            grid->vertices[fill[buckets[i]]++] = i;
+
+        m_vertex_grid.store(grid, std::memory_order_release);
+    }
+    m_vertex_grid_lock.Leave();
+    return (*grid);
 }
 
-CLevelGraph::~CLevelGraph() { FS.r_close(m_reader); }
 u32 CLevelGraph::vertex(const Fvector& position) const
 {
-    CLevelGraph::CPosition _node_position;
-    vertex_position(_node_position, position);
+    // Buckets are visited in rings around the position until the ring is farther than the best
+    // vertex: a vertex contour never leaves its cell, so the horizontal distance to the bucket
+    // bounds the distance to its vertices from below
+    const SVertexGrid& grid = vertex_grid();
+    const float bucket_size = float(vertex_grid_cells) * header().cell_size();
+    const float origin_x = header().box().min.x - header().cell_size() / 2;
+    const float origin_z = header().box().min.z - header().cell_size() / 2;
+    const int size_x = int(grid.size_x);
+    const int size_z = int(grid.size_z);
+    const int center_x = clampr(iFloor((position.x - origin_x) / bucket_size), 0, size_x - 1);
+    const int center_z = clampr(iFloor((position.z - origin_z) / bucket_size), 0, size_z - 1);
+    const int max_ring =
+        _max(_max(center_x, size_x - 1 - center_x), _max(center_z, size_z - 1 - center_z));
+
     float min_dist = flt_max;
     u32 selected;
     set_invalid_vertex(selected);
-    for (u32 i = 0; i < header().vertex_count(); ++i)
+
+    auto process_bucket = [&](int x, int z) {
+        if ((x < 0) || (x >= size_x) || (z < 0) || (z >= size_z))
+            return;
+
+        const float min_x = origin_x + float(x) * bucket_size;
+        const float min_z = origin_z + float(z) * bucket_size;
+        const float dx = _max(0.f, _max(min_x - position.x, position.x - (min_x + bucket_size)));
+        const float dz = _max(0.f, _max(min_z - position.z, position.z - (min_z + bucket_size)));
+        if (_sqr(dx) + _sqr(dz) > min_dist)
+            return;
+
+        const u32 bucket = u32(x) * grid.size_z + u32(z);
+        for (u32 i = grid.offsets[bucket], n = grid.offsets[bucket + 1]; i < n; ++i)
+        {
+            // ties go to the lower id, as with the full scan over the vertices
+            const u32 vertex_id = grid.vertices[i];
+            const float dist = distance(vertex_id, position);
+            if ((dist < min_dist) || ((dist == min_dist) && (vertex_id < selected)))
+            {
+                min_dist = dist;
+                selected = vertex_id;
+            }
+        }
+    };
+
+    for (int ring = 0; ring <= max_ring; ++ring)
     {
-        float dist = distance(i, position);
-        if (dist < min_dist)
+        if (ring)
+        {
+            // distance from the position to the buckets outside of the rings visited
+            const float inner = _min(_min(position.x - (origin_x + float(center_x - ring + 1) * bucket_size),
+                                         origin_x + float(center_x + ring) * bucket_size - position.x),
+                _min(position.z - (origin_z + float(center_z - ring + 1) * bucket_size),
+                    origin_z + float(center_z + ring) * bucket_size - position.z));
+            if ((inner > 0.f) && (_sqr(inner) > min_dist))
+                break;
+        }
+
+        for (int x = center_x - ring; x <= center_x + ring; ++x)
+        {
+            process_bucket(x, center_z - ring);
+            if (ring)
+                process_bucket(x, center_z + ring);
+        }
+
+        for (int z = center_z - ring + 1; z < center_z + ring; ++z)
         {
-            min_dist = dist;
-            selected = i;
+            process_bucket(center_x - ring, z);
+            process_bucket(center_x + ring, z);
         }
     }
 
@@ -11,6 +11,8 @@
 #include "Common/LevelStructure.hpp"
 #include "xrAICore/Navigation/level_graph_space.h"
 #include "xrAICore/Navigation/game_graph_space.h"
+#include "xrCore/Threading/Lock.hpp"
+#include <atomic>
 
 namespace LevelGraph
 {
@@ -54,10 +56,26 @@ private:
     u32 m_max_x;
     u32 m_max_z;
 
+    // Vertex ids bucketed by squares of vertex_grid_cells cells, for the nearest vertex lookup
+    struct SVertexGrid
+    {
+        u32 size_x;
+        u32 size_z;
+        xr_vector<u32> offsets; // bucket (x * size_z + z) spans [offsets[i], offsets[i + 1])
+        xr_vector<u32> vertices;
+    };
+
+    static const u32 vertex_grid_cells = 8;
+    mutable std::atomic<SVertexGrid*> m_vertex_grid;
+    mutable Lock m_vertex_grid_lock;
+
 public:
     mutable CStatTimer NodeTime;
 
 private:
+    friend class CCC_LevelGraphBench;
+
+    const SVertexGrid& vertex_grid() const;
     u32 vertex(const Fvector& position) const;
     u32 guess_vertex_id(u32 const& current_vertex_id, Fvector const& position) const;
 
@@ -97,6 +115,12 @@ public:
     IC void clear_mask_no_check(u32 vertex_id);
 
     IC bool is_accessible(const u32 vertex_id) const;
+    // Mask used by the calling thread: threads running pooled searches (CGraphEnginePool)
+    // apply restriction borders to a copy of their own instead of m_access_mask
+    const xr_vector<bool>& access_mask() const;
+    xr_vector<bool>& access_mask();
+    // Returns the previously bound mask
+    static xr_vector<bool>* bind_access_mask(xr_vector<bool>* mask);
     IC void level_id(const GameGraph::_LEVEL_ID& level_id);
     IC u32 max_x() const;
     IC u32 max_z() const;
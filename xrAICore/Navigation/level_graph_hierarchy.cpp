@@ -0,0 +1,187 @@
+////////////////////////////////////////////////////////////////////////////
+//  Module      : level_graph_hierarchy.cpp
+//  Description : Cluster hierarchy over the level graph for long searches
+////////////////////////////////////////////////////////////////////////////
+
+#include "PCH.hpp"
+#include "level_graph_hierarchy.h"
+#include "level_graph.h"
+
+CLevelGraphHierarchy::CLevelGraphHierarchy(const CLevelGraph& graph) : m_graph(graph)
+{
+    const u32 vertex_count = graph.header().vertex_count();
+    m_vertex_clusters.assign(vertex_count, u32(-1));
+
+    // flood fill within the squares
+    xr_vector<u32> front;
+    for (u32 i = 0; i < vertex_count; ++i)
+    {
+        if (m_vertex_clusters[i] != u32(-1))
+            continue;
+
+        const u32 cluster_id = m_clusters.size();
+        const u32 cluster_region = region(i);
+        front.clear();
+        front.push_back(i);
+        m_vertex_clusters[i] = cluster_id;
+
+        Fvector centroid = {0.f, 0.f, 0.f};
+        for (u32 j = 0; j < front.size(); ++j)
+        {
+            const u32 vertex_id = front[j];
+            centroid.add(graph.vertex_position(vertex_id));
+
+            CLevelGraph::const_iterator I, E;
+            graph.begin(vertex_id, I, E);
+            for (; I != E; ++I)
+            {
+                const u32 neighbour_id = graph.value(vertex_id, I);
+                if (!graph.valid_vertex_id(neighbour_id) || (m_vertex_clusters[neighbour_id] != u32(-1)) ||
+                    (region(neighbour_id) != cluster_region))
+                    continue;
+
+                m_vertex_clusters[neighbour_id] = cluster_id;
+                front.push_back(neighbour_id);
+            }
+        }
+
+        centroid.div(float(front.size()));
+        SCluster cluster;
+        cluster.center = graph.vertex_position(front.front());
+        for (u32 vertex_id : front)
+        {
+            const Fvector position = graph.vertex_position(vertex_id);
+            if (position.distance_to_sqr(centroid) < cluster.center.distance_to_sqr(centroid))
+                cluster.center = position;
+        }
+        cluster.edge_offset = 0;
+        cluster.edge_count = 0;
+        m_clusters.push_back(cluster);
+    }
+
+    // cluster links
+    xr_vector<std::pair<u32, u32>> links;
+    for (u32 i = 0; i < vertex_count; ++i)
+    {
+        CLevelGraph::const_iterator I, E;
+        graph.begin(i, I, E);
+        for (; I != E; ++I)
+        {
+            const u32 neighbour_id = graph.value(i, I);
+            if (graph.valid_vertex_id(neighbour_id) && (m_vertex_clusters[neighbour_id] != m_vertex_clusters[i]))
+                links.push_back(std::make_pair(m_vertex_clusters[i], m_vertex_clusters[neighbour_id]));
+        }
+    }
+    std::sort(links.begin(), links.end());
+    links.erase(std::unique(links.begin(), links.end()), links.end());
+
+    m_edges.resize(links.size());
+    for (u32 i = 0, n = links.size(); i < n; ++i)
+    {
+        SCluster& cluster = m_clusters[links[i].first];
+        if (!cluster.edge_count)
+            cluster.edge_offset = i;
+        ++cluster.edge_count;
+        m_edges[i].cluster = links[i].second;
+        m_edges[i].cost = cluster.center.distance_to(m_clusters[links[i].second].center);
+    }
+}
+
+u32 CLevelGraphHierarchy::region(u32 vertex_id) const
+{
+    u32 x, z;
+    m_graph.unpack_xz(m_graph.vertex(vertex_id), x, z);
+    return ((x / cluster_cells) << 16) | (z / cluster_cells);
+}
+
+u32 CLevelGraphHierarchy::memory() const
+{
+    return m_vertex_clusters.size() * sizeof(u32) + m_clusters.size() * sizeof(SCluster) +
+        m_edges.size() * sizeof(SEdge) + sizeof(*this);
+}
+
+bool CLevelGraphHierarchy::distant(u32 start_vertex_id, u32 dest_vertex_id) const
+{
+    int x0, z0, x1, z1;
+    m_graph.unpack_xz(m_graph.vertex(start_vertex_id), x0, z0);
+    m_graph.unpack_xz(m_graph.vertex(dest_vertex_id), x1, z1);
+    return u32(_abs(x1 - x0) + _abs(z1 - z0)) > 2 * cluster_cells;
+}
+
+bool CLevelGraphHierarchy::build_corridor(SCorridor& corridor, u32 start_vertex_id, u32 dest_vertex_id) const
+{
+    const u32 count = m_clusters.size();
+    if (corridor.marks.size() != count)
+    {
+        corridor.marks.assign(count, 0);
+        corridor.visited.assign(count, 0);
+        corridor.cost.resize(count);
+        corridor.parent.resize(count);
+        corridor.stamp = 0;
+    }
+
+    if (!++corridor.stamp)
+    {
+        std::fill(corridor.marks.begin(), corridor.marks.end(), 0);
+        std::fill(corridor.visited.begin(), corridor.visited.end(), 0);
+        corridor.stamp = 1;
+    }
+
+    // A* over the clusters, the straight line between the centers is a consistent estimate
+    const u32 stamp = corridor.stamp;
+    const u32 start = m_vertex_clusters[start_vertex_id];
+    const u32 dest = m_vertex_clusters[dest_vertex_id];
+    const Fvector& target = m_clusters[dest].center;
+
+    SCorridor::SQueueItem item = {m_clusters[start].center.distance_to(target), 0.f, start};
+    corridor.queue.clear();
+    corridor.queue.push_back(item);
+    corridor.visited[start] = stamp;
+    corridor.cost[start] = 0.f;
+    corridor.parent[start] = u32(-1);
+
+    bool found = false;
+    while (!corridor.queue.empty())
+    {
+        std::pop_heap(corridor.queue.begin(), corridor.queue.end());
+        item = corridor.queue.back();
+        corridor.queue.pop_back();
+        if (item.cluster == dest)
+        {
+            found = true;
+            break;
+        }
+
+        if (item.g > corridor.cost[item.cluster])
+            continue;
+
+        const SCluster& cluster = m_clusters[item.cluster];
+        for (u32 i = cluster.edge_offset, n = cluster.edge_offset + cluster.edge_count; i < n; ++i)
+        {
+            const SEdge& edge = m_edges[i];
+            const float g = item.g + edge.cost;
+            if ((corridor.visited[edge.cluster] == stamp) && (g >= corridor.cost[edge.cluster]))
+                continue;
+
+            corridor.visited[edge.cluster] = stamp;
+            corridor.cost[edge.cluster] = g;
+            corridor.parent[edge.cluster] = item.cluster;
+            SCorridor::SQueueItem next = {g + m_clusters[edge.cluster].center.distance_to(target), g, edge.cluster};
+            corridor.queue.push_back(next);
+            std::push_heap(corridor.queue.begin(), corridor.queue.end());
+        }
+    }
+
+    if (!found)
+        return false;
+
+    // the neighbours leave the refinement room to cut the corners of the cluster path
+    for (u32 cluster_id = dest; cluster_id != u32(-1); cluster_id = corridor.parent[cluster_id])
+    {
+        corridor.marks[cluster_id] = stamp;
+        const SCluster& cluster = m_clusters[cluster_id];
+        for (u32 i = cluster.edge_offset, n = cluster.edge_offset + cluster.edge_count; i < n; ++i)
+            corridor.marks[m_edges[i].cluster] = stamp;
+    }
+    return true;
+}
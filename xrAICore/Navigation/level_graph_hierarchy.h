@@ -0,0 +1,82 @@
+////////////////////////////////////////////////////////////////////////////
+//  Module      : level_graph_hierarchy.h
+//  Description : Cluster hierarchy over the level graph for long searches
+////////////////////////////////////////////////////////////////////////////
+
+#pragma once
+
+#include "xrAICore/xrAICore.hpp"
+#include "xrCore/xrCore.h"
+
+class CLevelGraph;
+
+// A cluster is a connected set of vertices within a square of cluster_cells x cluster_cells
+// cells, so stacked floors get clusters of their own. Long searches go over the cluster graph
+// first, then over the level graph only within the corridor of the clusters found
+class XRAICORE_API CLevelGraphHierarchy
+{
+public:
+    static const u32 cluster_cells = 16;
+
+    struct SCluster
+    {
+        Fvector center; // position of the vertex closest to the centroid
+        u32 edge_offset;
+        u32 edge_count;
+    };
+
+    struct SEdge
+    {
+        u32 cluster;
+        float cost;
+    };
+
+    // Search state, every graph engine keeps its own
+    struct SCorridor
+    {
+        struct SQueueItem
+        {
+            float f;
+            float g;
+            u32 cluster;
+
+            bool operator<(const SQueueItem& other) const { return f > other.f; }
+        };
+
+        u32 stamp;
+        xr_vector<u32> marks; // the cluster is in the corridor when its mark equals the stamp
+        xr_vector<u32> visited;
+        xr_vector<float> cost;
+        xr_vector<u32> parent;
+        xr_vector<SQueueItem> queue;
+
+        SCorridor() : stamp(0) {}
+    };
+
+private:
+    const CLevelGraph& m_graph;
+    xr_vector<u32> m_vertex_clusters;
+    xr_vector<SCluster> m_clusters;
+    xr_vector<SEdge> m_edges;
+
+private:
+    u32 region(u32 vertex_id) const;
+
+public:
+    CLevelGraphHierarchy(const CLevelGraph& graph);
+
+    IC u32 cluster(u32 vertex_id) const { return m_vertex_clusters[vertex_id]; }
+    IC u32 cluster_count() const { return m_clusters.size(); }
+    IC const SCluster& cluster_data(u32 cluster_id) const { return m_clusters[cluster_id]; }
+    IC bool in_corridor(const SCorridor& corridor, u32 vertex_id) const
+    {
+        return corridor.marks[m_vertex_clusters[vertex_id]] == corridor.stamp;
+    }
+    u32 memory() const;
+
+    // Vertices are far enough apart for the cluster search to pay off
+    bool distant(u32 start_vertex_id, u32 dest_vertex_id) const;
+    // Marks the clusters on the cheapest cluster path and their neighbours,
+    // false if the clusters of the vertices aren't connected at all
+    bool build_corridor(SCorridor& corridor, u32 start_vertex_id, u32 dest_vertex_id) const;
+};
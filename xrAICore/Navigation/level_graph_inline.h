@@ -277,7 +277,7 @@ IC u32 CLevelGraph::value(const CVertex* vertex, const_iterator& i) const { retu
 IC u32 CLevelGraph::value(const u32 vertex_id, const_iterator& i) const { return (value(vertex(vertex_id), i)); }
 IC bool CLevelGraph::is_accessible(const u32 vertex_id) const
 {
-    return (valid_vertex_id(vertex_id) && m_access_mask[vertex_id]);
+    return (valid_vertex_id(vertex_id) && access_mask()[vertex_id]);
 }
 
 IC void CLevelGraph::set_invalid_vertex(u32& vertex_id, CVertex** vertex) const
@@ -502,50 +502,60 @@ IC bool CLevelGraph::valid_vertex_position(const Fvector& position) const
 
 IC void CLevelGraph::set_mask(const xr_vector<u32>& mask)
 {
+    xr_vector<bool>& access = access_mask();
     xr_vector<u32>::const_iterator I = mask.begin();
     xr_vector<u32>::const_iterator E = mask.end();
     for (; I != E; ++I)
-        set_mask(*I);
+    {
+        VERIFY(access[*I]);
+        access[*I] = false;
+    }
 }
 
 IC void CLevelGraph::set_mask_no_check(const xr_vector<u32>& mask)
 {
+    xr_vector<bool>& access = access_mask();
     xr_vector<u32>::const_iterator I = mask.begin();
     xr_vector<u32>::const_iterator E = mask.end();
     for (; I != E; ++I)
-        set_mask_no_check(*I);
+        access[*I] = false;
 }
 
 IC void CLevelGraph::clear_mask(const xr_vector<u32>& mask)
 {
+    xr_vector<bool>& access = access_mask();
     xr_vector<u32>::const_iterator I = mask.begin();
     xr_vector<u32>::const_iterator E = mask.end();
     for (; I != E; ++I)
-        clear_mask(*I);
+    {
+        VERIFY(!access[*I]);
+        access[*I] = true;
+    }
 }
 
 IC void CLevelGraph::clear_mask_no_check(const xr_vector<u32>& mask)
 {
+    xr_vector<bool>& access = access_mask();
     xr_vector<u32>::const_iterator I = mask.begin();
     xr_vector<u32>::const_iterator E = mask.end();
     for (; I != E; ++I)
-        clear_mask_no_check(*I);
+        access[*I] = true;
 }
 
 IC void CLevelGraph::set_mask(u32 vertex_id)
 {
-    VERIFY(m_access_mask[vertex_id]);
+    VERIFY(access_mask()[vertex_id]);
     set_mask_no_check(vertex_id);
 }
 
-IC void CLevelGraph::set_mask_no_check(u32 vertex_id) { m_access_mask[vertex_id] = false; }
+IC void CLevelGraph::set_mask_no_check(u32 vertex_id) { access_mask()[vertex_id] = false; }
 IC void CLevelGraph::clear_mask(u32 vertex_id)
 {
-    VERIFY(!m_access_mask[vertex_id]);
+    VERIFY(!access_mask()[vertex_id]);
     clear_mask_no_check(vertex_id);
 }
 
-IC void CLevelGraph::clear_mask_no_check(u32 vertex_id) { m_access_mask[vertex_id] = true; }
+IC void CLevelGraph::clear_mask_no_check(u32 vertex_id) { access_mask()[vertex_id] = true; }
 template <typename P>
 IC void CLevelGraph::iterate_vertices(
     const Fvector& min_position, const Fvector& max_position, const P& predicate) const
@@ -265,7 +265,7 @@ void ISpatial_DB::_insert(ISpatial_NODE* N, Fvector& n_C, float n_R)
 
 void ISpatial_DB::insert(ISpatial* S)
 {
-    cs.Enter();
+    cs.EnterWrite();
 #ifdef DEBUG
     Stats.Insert.Begin();
 
@@ -306,7 +306,7 @@ void ISpatial_DB::insert(ISpatial* S)
 #ifdef DEBUG
     Stats.Insert.End();
 #endif
-    cs.Leave();
+    cs.LeaveWrite();
 }
 
 void ISpatial_DB::_remove(ISpatial_NODE* N, ISpatial_NODE* N_sub)
@@ -343,7 +343,7 @@ void ISpatial_DB::_remove(ISpatial_NODE* N, ISpatial_NODE* N_sub)
 
 void ISpatial_DB::remove(ISpatial* S)
 {
-    cs.Enter();
+    cs.EnterWrite();
 #ifdef DEBUG
     Stats.Remove.Begin();
 #endif
@@ -357,7 +357,7 @@ void ISpatial_DB::remove(ISpatial* S)
 #ifdef DEBUG
     Stats.Remove.End();
 #endif
-    cs.Leave();
+    cs.LeaveWrite();
 }
 
 void ISpatial_DB::update(u32 nodes /* =8 */)
@@ -365,8 +365,8 @@ void ISpatial_DB::update(u32 nodes /* =8 */)
 #ifdef DEBUG
     if (0 == m_root)
         return;
-    cs.Enter();
+    cs.EnterRead();
     VERIFY(verify());
-    cs.Leave();
+    cs.LeaveRead();
 #endif
 }
@@ -4,6 +4,7 @@
 //#pragma once
 #include "Common/Platform.hpp"
 #include "xrCore/xrPool.h"
+#include "xrCore/Threading/RWLock.hpp"
 #include "xr_collide_defs.h"
 
 #pragma pack(push, 4)
@@ -179,11 +180,17 @@ public:
         CStatTimer Insert; // debug only
         CStatTimer Remove; // debug only
 #endif
+        // Queries run concurrently, so they don't time Query directly but add to the
+        // atomic counters below, which FrameEnd moves into Query
         CStatTimer Query;
+        std::atomic<u64> QueryTicks;
+        std::atomic<u32> QueryCount;
 
         SpatialDBStatistics()
         {
             NodeCount = ObjectCount = 0;
+            QueryTicks = 0;
+            QueryCount = 0;
             FrameStart();
         }
 
@@ -202,12 +209,15 @@ public:
             Insert.FrameEnd();
             Remove.FrameEnd();
 #endif
+            Query.accum += QueryTicks.exchange(0);
+            Query.count += QueryCount.exchange(0);
             Query.FrameEnd();
         }
     };
 
 private:
-    Lock cs;
+    // Queries only read the tree and take it shared, insert/remove take it exclusively
+    RWLock cs;
 
     poolSS<ISpatial_NODE, 128> allocator;
 
@@ -219,7 +229,6 @@ public:
     ISpatial_NODE* m_root;
     Fvector m_center;
     float m_bounds;
-    xr_vector<ISpatial*>* q_result;
     SpatialDBStatistics Stats;
 
 private:
@@ -238,6 +247,16 @@ private:
         return o;
     }
 
+    // Query timing for Stats, see SpatialDBStatistics
+    IC u64 _query_begin() const { return g_bEnableStatGather ? CPU::QPC() : 0; }
+    IC void _query_end(u64 start)
+    {
+        if (!start)
+            return;
+        Stats.QueryTicks += CPU::QPC() - start;
+        ++Stats.QueryCount;
+    }
+
     ISpatial_NODE* _node_create();
     void _node_destroy(ISpatial_NODE*& P);
 
@@ -266,6 +285,9 @@ public:
     };
 
     // query
+    // Queries are reentrant and may run on any number of threads at once, every caller
+    // passes its own result buffer R (cleared first). They must not be issued from inside
+    // insert/remove, i.e. from spatial callbacks
     void q_ray(
         xr_vector<ISpatial*>& R, u32 _o, u32 _mask_and, const Fvector& _start, const Fvector& _dir, float _range);
     void q_box(xr_vector<ISpatial*>& R, u32 _o, u32 _mask_or, const Fvector& _center, const Fvector& _size);
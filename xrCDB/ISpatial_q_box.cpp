@@ -11,16 +11,16 @@ public:
     Fvector center;
     Fvector size;
     Fbox box;
-    ISpatial_DB* space;
+    xr_vector<ISpatial*>* result;
 
 public:
-    walker(ISpatial_DB* _space, u32 _mask, const Fvector& _center, const Fvector& _size)
+    walker(xr_vector<ISpatial*>* _result, u32 _mask, const Fvector& _center, const Fvector& _size)
     {
         mask = _mask;
         center = _center;
         size = _size;
         box.setb(center, size);
-        space = _space;
+        result = _result;
     }
     void walk(ISpatial_NODE* N, Fvector& n_C, float n_R)
     {
@@ -47,7 +47,7 @@ public:
             if (!sB.intersect(box))
                 continue;
 
-            space->q_result->push_back(S);
+            result->push_back(S);
             if (b_first)
                 return;
         }
@@ -61,7 +61,7 @@ public:
             Fvector c_C;
             c_C.mad(n_C, c_spatial_offset[octant], c_R);
             walk(N->children[octant], c_C, c_R);
-            if (b_first && !space->q_result->empty())
+            if (b_first && !result->empty())
                 return;
         }
     }
@@ -69,22 +69,21 @@ public:
 
 void ISpatial_DB::q_box(xr_vector<ISpatial*>& R, u32 _o, u32 _mask, const Fvector& _center, const Fvector& _size)
 {
-    cs.Enter();
-    Stats.Query.Begin();
-    q_result = &R;
-    q_result->clear_not_free();
+    const u64 start = _query_begin();
+    cs.EnterRead();
+    R.clear_not_free();
     if (_o & O_ONLYFIRST)
     {
-        walker<true> W(this, _mask, _center, _size);
+        walker<true> W(&R, _mask, _center, _size);
         W.walk(m_root, m_center, m_bounds);
     }
     else
     {
-        walker<false> W(this, _mask, _center, _size);
+        walker<false> W(&R, _mask, _center, _size);
         W.walk(m_root, m_center, m_bounds);
     }
-    Stats.Query.End();
-    cs.Leave();
+    cs.LeaveRead();
+    _query_end(start);
 }
 
 void ISpatial_DB::q_sphere(xr_vector<ISpatial*>& R, u32 _o, u32 _mask, const Fvector& _center, const float _radius)
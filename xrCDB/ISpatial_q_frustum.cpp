@@ -9,14 +9,14 @@ class walker
 public:
     u32 mask;
     CFrustum* F;
-    ISpatial_DB* space;
+    xr_vector<ISpatial*>* result;
 
 public:
-    walker(ISpatial_DB* _space, u32 _mask, const CFrustum* _F)
+    walker(xr_vector<ISpatial*>* _result, u32 _mask, const CFrustum* _F)
     {
         mask = _mask;
         F = (CFrustum*)_F;
-        space = _space;
+        result = _result;
     }
     void walk(ISpatial_NODE* N, Fvector& n_C, float n_R, u32 fmask)
     {
@@ -42,7 +42,7 @@ public:
             if (fcvNone == F->testSphere(sC, sR, tmask))
                 continue;
 
-            space->q_result->push_back(S);
+            result->push_back(S);
         }
 
         // recurse
@@ -60,12 +60,11 @@ public:
 
 void ISpatial_DB::q_frustum(xr_vector<ISpatial*>& R, u32 _o, u32 _mask, const CFrustum& _frustum)
 {
-    cs.Enter();
-    Stats.Query.Begin();
-    q_result = &R;
-    q_result->clear_not_free();
-    walker W(this, _mask, &_frustum);
+    const u64 start = _query_begin();
+    cs.EnterRead();
+    R.clear_not_free();
+    walker W(&R, _mask, &_frustum);
     W.walk(m_root, m_center, m_bounds, _frustum.getMask());
-    Stats.Query.End();
-    cs.Leave();
+    cs.LeaveRead();
+    _query_end(start);
 }
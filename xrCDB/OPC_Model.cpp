@@ -276,3 +276,13 @@ bool OPCODE_Model::Build(const OPCODECREATE& create)
 #endif // __MESHMERIZER_H__
     return true;
 }
+
+void OPCODE_Model::Build(AABBNoLeafNode* nodes, udword nb_nodes)
+{
+    ASSERT(!mTree);
+    mNoLeaf = true;
+    mQuantized = false;
+    AABBNoLeafTree* tree = CNEW(AABBNoLeafTree)();
+    tree->Attach(nodes, nb_nodes);
+    mTree = tree;
+}
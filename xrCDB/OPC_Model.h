@@ -55,6 +55,15 @@ public:
     ///////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
     bool Build(const OPCODECREATE& create);
 
+    ///////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+    /**
+     *	Builds a non quantized no-leaf model from an already built node array (CDB tree cache).
+     *	\param		nodes		[in] CALLOC'ed nodes, the model takes ownership
+     *	\param		nb_nodes	[in] number of nodes
+     */
+    ///////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+    void Build(AABBNoLeafNode* nodes, udword nb_nodes);
+
     ///////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
     /**
      *	A method to access the tree.
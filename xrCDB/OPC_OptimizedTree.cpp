@@ -261,6 +261,12 @@ AABBNoLeafTree::AABBNoLeafTree() : mNodes(null) {}
  */
 ///////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
 AABBNoLeafTree::~AABBNoLeafTree() { CFREE(mNodes); }
+void AABBNoLeafTree::Attach(AABBNoLeafNode* nodes, udword nb_nodes)
+{
+    CFREE(mNodes);
+    mNodes = nodes;
+    mNbNodes = nb_nodes;
+}
 ///////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
 /**
  *	Builds the collision tree from a generic AABB tree.
@@ -150,6 +150,10 @@ class OPCODE_API AABBCollisionTree : public AABBOptimizedTree
 class OPCODE_API AABBNoLeafTree : public AABBOptimizedTree
 {
     IMPLEMENT_COLLISION_TREE(AABBNoLeafTree, AABBNoLeafNode)
+
+public:
+    // Takes over a CALLOC'ed node array with valid child pointers (restored from the CDB tree cache)
+    void Attach(AABBNoLeafNode* nodes, udword nb_nodes);
 };
 
 class OPCODE_API AABBQuantizedTree : public AABBOptimizedTree
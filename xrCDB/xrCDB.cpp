@@ -5,6 +5,7 @@
 #pragma hdrstop
 
 #include "xrCDB.h"
+#include "xrCDB_flat.h"
 
 #ifdef USE_ARENA_ALLOCATOR
 static const u32 s_arena_size = (128 + 16) * 1024 * 1024;
@@ -20,6 +21,8 @@ namespace Opcode
 using namespace CDB;
 using namespace Opcode;
 
+u32 CDB::g_tree_engine = ENGINE_OPCODE;
+
 BOOL APIENTRY DllMain(HANDLE hModule, u32 ul_reason_for_call, LPVOID lpReserved)
 {
     switch (ul_reason_for_call)
@@ -39,6 +42,8 @@ MODEL::MODEL()
 #endif // CONFIG_PROFILE_LOCKS
 {
     tree = 0;
+    flat = 0;
+    engine = g_tree_engine;
     tris = 0;
     tris_count = 0;
     verts = 0;
@@ -50,6 +55,7 @@ MODEL::~MODEL()
     syncronize(); // maybe model still in building
     status = S_INIT;
     CDELETE(tree);
+    CDELETE(flat);
     CFREE(tris);
     tris_count = 0;
     CFREE(verts);
@@ -103,7 +109,7 @@ void MODEL::build(Fvector* V, int Vcnt, TRI* T, int Tcnt, build_callback* bc, vo
 #endif
 }
 
-void MODEL::build_internal(Fvector* V, int Vcnt, TRI* T, int Tcnt, build_callback* bc, void* bcp)
+void MODEL::build_geometry(Fvector* V, int Vcnt, TRI* T, int Tcnt, build_callback* bc, void* bcp)
 {
     // verts
     verts_count = Vcnt;
@@ -118,6 +124,11 @@ void MODEL::build_internal(Fvector* V, int Vcnt, TRI* T, int Tcnt, build_callbac
     // callback
     if (bc)
         bc(verts, Vcnt, tris, Tcnt, bcp);
+}
+
+void MODEL::build_internal(Fvector* V, int Vcnt, TRI* T, int Tcnt, build_callback* bc, void* bcp)
+{
+    build_geometry(V, Vcnt, T, Tcnt, bc, bcp);
 
     // Release data pointers
     status = S_BUILD;
@@ -160,6 +171,14 @@ void MODEL::build_internal(Fvector* V, int Vcnt, TRI* T, int Tcnt, build_callbac
 
     // Free temporary tris
     CFREE(temp_tris);
+
+    if (ENGINE_FLAT == engine)
+    {
+        // Convert to the flat layout, the OPCODE tree isn't needed anymore
+        flat = CNEW(FLAT_TREE)();
+        flat->build(((const AABBNoLeafTree*)tree->GetTree())->GetNodes(), verts, tris);
+        CDELETE(tree);
+    }
     return;
 }
 
@@ -172,6 +191,8 @@ u32 MODEL::memory()
     }
     u32 V = verts_count * sizeof(Fvector);
     u32 T = tris_count * sizeof(TRI);
+    if (flat)
+        return flat->memory() + V + T + sizeof(*this);
     return tree->GetUsedBytes() + V + T + sizeof(*this) + sizeof(*tree);
 }
 
@@ -191,4 +212,10 @@ RESULT& COLLIDER::r_add()
     return rd.back();
 }
 
-void COLLIDER::r_free() { rd.clear_and_free(); }
+void COLLIDER::r_free()
+{
+    rd.clear_and_free();
+    rp.clear_and_free();
+    for (u32 i = 0; i < RAY_PACKET_SIZE; ++i)
+        rp_lanes[i].clear_and_free();
+}
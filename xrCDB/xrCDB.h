@@ -24,6 +24,10 @@ namespace Opcode
 class OPCODE_Model;
 class AABBNoLeafNode;
 };
+namespace CDB
+{
+class FLAT_TREE;
+};
 
 #pragma pack(push, 8)
 namespace CDB
@@ -52,6 +56,16 @@ public:
 // Build callback
 typedef void __stdcall build_callback(Fvector* V, int Vcnt, TRI* T, int Tcnt, void* params);
 
+// Query tree engines
+enum
+{
+    ENGINE_OPCODE = 0, // OPCODE no-leaf tree, pointer based nodes
+    ENGINE_FLAT = 1, // quantized 4-wide tree in depth-first order, triangles inline (xrCDB_flat.h)
+};
+
+// Engine used by models constructed from now on ("cdb_engine" console command)
+extern XRCDB_API u32 g_tree_engine;
+
 // Model definition
 class XRCDB_API MODEL
 {
@@ -67,6 +81,8 @@ class XRCDB_API MODEL
 private:
     Lock cs;
     Opcode::OPCODE_Model* tree;
+    FLAT_TREE* flat; // replaces tree when built with ENGINE_FLAT
+    u32 engine;
     u32 status; // 0=ready, 1=init, 2=building
 
     // tris
@@ -96,10 +112,23 @@ public:
         }
     }
 
+    // Must be called before build, defaults to g_tree_engine
+    void set_engine(u32 E) { engine = E; }
+    u32 get_engine() const { return engine; }
+
     static void build_thread(void*);
+    void build_geometry(Fvector* V, int Vcnt, TRI* T, int Tcnt, build_callback* bc, void* bcp);
     void build_internal(Fvector* V, int Vcnt, TRI* T, int Tcnt, build_callback* bc = NULL, void* bcp = NULL);
     void build(Fvector* V, int Vcnt, TRI* T, int Tcnt, build_callback* bc = NULL, void* bcp = NULL);
     u32 memory();
+
+    // Tree cache (xrCDB_cache.cpp): the tree of a built model is saved along with the CRC
+    // of its source geometry and loaded back by the next build instead of being rebuilt
+    static u32 geometry_crc(const Fvector* V, int Vcnt, const TRI* T, int Tcnt);
+    void serialize(IWriter& W, u32 crc);
+    // Takes ownership of F; returns false and leaves the model unbuilt if the cache doesn't match
+    bool deserialize(
+        IReader* F, u32 crc, Fvector* V, int Vcnt, TRI* T, int Tcnt, build_callback* bc = NULL, void* bcp = NULL);
 };
 
 // Collider result
@@ -122,6 +151,18 @@ struct XRCDB_API RESULT
     float u, v;
 };
 
+// Ray of a packet query
+struct XRCDB_API RAY
+{
+    Fvector start;
+    Fvector dir;
+    float range;
+};
+
+// Rays traced together by ray_packet_query, coherent rays (same origin or
+// direction) share most of the tree traversal
+const u32 RAY_PACKET_SIZE = 4;
+
 // Collider Options
 enum
 {
@@ -141,6 +182,9 @@ class XRCDB_API COLLIDER
 
     // Result management
     xr_vector<RESULT> rd;
+    // Packet query results: hits of ray i are [rp[i], rp[i+1]) in rd
+    xr_vector<u32> rp;
+    xr_vector<RESULT> rp_lanes[RAY_PACKET_SIZE];
 
 public:
     COLLIDER();
@@ -149,6 +193,13 @@ public:
     ICF void ray_options(u32 f) { ray_mode = f; }
     void ray_query(const MODEL* m_def, const Fvector& r_start, const Fvector& r_dir, float r_range = 10000.f);
 
+    // Traces rays in packets of RAY_PACKET_SIZE with SSE, ray_options apply to every ray
+    void ray_packet_query(const MODEL* m_def, const RAY* rays, u32 count);
+    ICF u32 r_ray_count() const { return rp.empty() ? 0 : rp.size() - 1; }
+    ICF RESULT* r_ray_begin(u32 ray) { return r_begin() + rp[ray]; }
+    ICF RESULT* r_ray_end(u32 ray) { return r_begin() + rp[ray + 1]; }
+    ICF int r_ray_count(u32 ray) const { return int(rp[ray + 1] - rp[ray]); }
+
     ICF void box_options(u32 f) { box_mode = f; }
     void box_query(const MODEL* m_def, const Fvector& b_center, const Fvector& b_dim);
 
@@ -160,7 +211,11 @@ public:
     RESULT& r_add();
     void r_free();
     ICF int r_count() { return rd.size(); };
-    ICF void r_clear() { rd.clear_not_free(); };
+    ICF void r_clear()
+    {
+        rd.clear_not_free();
+        rp.clear_not_free();
+    };
     ICF void r_clear_compact() { rd.clear_and_free(); };
 };
 
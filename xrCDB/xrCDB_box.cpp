@@ -2,6 +2,7 @@
 #pragma hdrstop
 
 #include "xrCDB.h"
+#include "xrCDB_flat.h"
 
 using namespace CDB;
 using namespace Opcode;
@@ -247,15 +248,16 @@ public:
     void _prim(DWORD prim)
     {
         TRI& T = tris[prim];
-        Fvector& v0 = verts[T.verts[0]];
+        _prim(prim, verts[T.verts[0]], verts[T.verts[1]], verts[T.verts[2]]);
+    }
+    void _prim(DWORD prim, const Fvector& v0, const Fvector& v1, const Fvector& v2)
+    {
         mLeafVerts[0].x = v0.x;
         mLeafVerts[0].y = v0.y;
         mLeafVerts[0].z = v0.z;
-        Fvector& v1 = verts[T.verts[1]];
         mLeafVerts[1].x = v1.x;
         mLeafVerts[1].y = v1.y;
         mLeafVerts[1].z = v1.z;
-        Fvector& v2 = verts[T.verts[2]];
         mLeafVerts[2].x = v2.x;
         mLeafVerts[2].y = v2.y;
         mLeafVerts[2].z = v2.z;
@@ -266,7 +268,7 @@ public:
         R.verts[0] = v0;
         R.verts[1] = v1;
         R.verts[2] = v2;
-        R.dummy = T.dummy;
+        R.dummy = tris[prim].dummy;
     }
     void _stab(const AABBNoLeafNode* node)
     {
@@ -290,6 +292,18 @@ public:
         else
             _stab(node->GetNeg());
     }
+
+    // Flat tree walk, see flat_stab
+    ICF bool _flat_box(const Fvector& C, const Fvector& E, u32&) { return _box(C, E); }
+    ICF void _flat_prim(const FLAT_TRI& T) { _prim(T.id, T.verts[0], T.verts[1], T.verts[2]); }
+    ICF bool _flat_done() { return bFirst && dest->r_count(); }
+    void _query(const AABBNoLeafNode* N, const FLAT_TREE* flat)
+    {
+        if (flat)
+            flat_query(*flat, *this, 0);
+        else
+            _stab(N);
+    }
 };
 
 void COLLIDER::box_query(const MODEL* m_def, const Fvector& b_center, const Fvector& b_dim)
@@ -297,8 +311,8 @@ void COLLIDER::box_query(const MODEL* m_def, const Fvector& b_center, const Fvec
     m_def->syncronize();
 
     // Get nodes
-    const AABBNoLeafTree* T = (const AABBNoLeafTree*)m_def->tree->GetTree();
-    const AABBNoLeafNode* N = T->GetNodes();
+    const FLAT_TREE* flat = m_def->flat;
+    const AABBNoLeafNode* N = flat ? nullptr : ((const AABBNoLeafTree*)m_def->tree->GetTree())->GetNodes();
     r_clear();
 
     // Binary dispatcher
@@ -308,13 +322,13 @@ void COLLIDER::box_query(const MODEL* m_def, const Fvector& b_center, const Fvec
         {
             box_collider<true, true> BC;
             BC._init(this, m_def->verts, m_def->tris, b_center, b_dim);
-            BC._stab(N);
+            BC._query(N, flat);
         }
         else
         {
             box_collider<true, false> BC;
             BC._init(this, m_def->verts, m_def->tris, b_center, b_dim);
-            BC._stab(N);
+            BC._query(N, flat);
         }
     }
     else
@@ -323,13 +337,13 @@ void COLLIDER::box_query(const MODEL* m_def, const Fvector& b_center, const Fvec
         {
             box_collider<false, true> BC;
             BC._init(this, m_def->verts, m_def->tris, b_center, b_dim);
-            BC._stab(N);
+            BC._query(N, flat);
         }
         else
         {
             box_collider<false, false> BC;
             BC._init(this, m_def->verts, m_def->tris, b_center, b_dim);
-            BC._stab(N);
+            BC._query(N, flat);
         }
     }
 }
@@ -0,0 +1,198 @@
+#include "stdafx.h"
+#pragma hdrstop
+
+#include "xrCDB.h"
+#include "xrCDB_flat.h"
+
+using namespace CDB;
+using namespace Opcode;
+
+namespace
+{
+const u32 CACHE_VERSION = 1;
+
+// Padded to 64 bytes, so the tree that follows is cache line aligned in a memory mapped file
+struct hdrCACHE
+{
+    u32 version;
+    u32 crc; // MODEL::geometry_crc of the source geometry
+    u32 engine;
+    u32 verts_count;
+    u32 tris_count;
+    u32 tree_size; // bytes
+    Fbox bounds; // ENGINE_FLAT only
+    u32 reserved[4];
+};
+static_assert(sizeof(hdrCACHE) == 64, "CDB cache header must stay 64 bytes");
+
+// OPCODE no-leaf node, child pointers are stored as node indices (leaf flag in bit 0 is kept)
+struct CACHE_NODE
+{
+    Fvector center;
+    Fvector extents;
+    u32 data;
+    u32 data2;
+};
+
+u32 node_data(const AABBNoLeafNode* nodes, const AABBNoLeafNode* child, uintptr_t data)
+{
+    return (data & 1) ? u32(data) : u32(child - nodes) << 1;
+}
+
+// OPCODE places the children after their parent, so a forward reference also rules out the cycles
+bool valid_data(u32 data, u32 parent, u32 nodes_count, u32 tris_count)
+{
+    return (data & 1) ? (data >> 1) < tris_count : (data >> 1) < nodes_count && (data >> 1) > parent;
+}
+
+// The stream is walked the way flat_stab walks it. Every reference must point forward inside the stream, and the
+// walk stops after as many nodes as the stream can hold, so a damaged stream neither loops nor reads outside
+bool valid_flat(const u8* data, u32 size, u32 tris_count)
+{
+    if (size < sizeof(FLAT_NODE))
+        return false;
+
+    u32 nodes_left = size / sizeof(FLAT_NODE);
+    xr_vector<u32> stack;
+    stack.push_back(0);
+    while (!stack.empty())
+    {
+        const u32 ref = stack.back();
+        stack.pop_back();
+        if (!nodes_left--)
+            return false;
+
+        const FLAT_NODE& N = *(const FLAT_NODE*)(data + ref);
+        for (u32 i = 0; i < 4 && FLAT_EMPTY != N.child[i]; ++i)
+        {
+            const u32 child = N.child[i] & ~FLAT_LEAF;
+            if (child <= ref)
+                return false;
+
+            if (N.child[i] & FLAT_LEAF)
+            {
+                if ((child & 3) || child > size - sizeof(FLAT_TRI) ||
+                    ((const FLAT_TRI*)(data + child))->id >= tris_count)
+                    return false;
+            }
+            else
+            {
+                if ((child & 63) || child > size - sizeof(FLAT_NODE))
+                    return false;
+                stack.push_back(child);
+            }
+        }
+    }
+    return true;
+}
+}
+
+u32 MODEL::geometry_crc(const Fvector* V, int Vcnt, const TRI* T, int Tcnt)
+{
+    const u32 crc = crc32(V, Vcnt * sizeof(Fvector));
+    return crc32(T, Tcnt * sizeof(TRI), crc);
+}
+
+void MODEL::serialize(IWriter& W, u32 crc)
+{
+    syncronize();
+    R_ASSERT(S_READY == status && (tree || flat));
+
+    hdrCACHE H;
+    ZeroMemory(&H, sizeof(H));
+    H.version = CACHE_VERSION;
+    H.crc = crc;
+    H.engine = engine;
+    H.verts_count = verts_count;
+    H.tris_count = tris_count;
+    H.bounds.invalidate();
+
+    if (flat)
+    {
+        H.tree_size = flat->get_size();
+        H.bounds = flat->get_bounds();
+        W.w(&H, sizeof(H));
+        W.w(flat->get_data(), H.tree_size);
+        return;
+    }
+
+    const AABBNoLeafTree* T = (const AABBNoLeafTree*)tree->GetTree();
+    const AABBNoLeafNode* nodes = T->GetNodes();
+    const u32 count = T->GetNbNodes();
+    H.tree_size = count * sizeof(CACHE_NODE);
+    W.w(&H, sizeof(H));
+
+    xr_vector<CACHE_NODE> stream(count);
+    for (u32 i = 0; i < count; ++i)
+    {
+        const AABBNoLeafNode& N = nodes[i];
+        CACHE_NODE& C = stream[i];
+        C.center = (const Fvector&)N.mAABB.mCenter;
+        C.extents = (const Fvector&)N.mAABB.mExtents;
+        C.data = node_data(nodes, N.GetPos(), N.mData);
+        C.data2 = node_data(nodes, N.GetNeg(), N.mData2);
+    }
+    W.w(&*stream.begin(), H.tree_size);
+}
+
+bool MODEL::deserialize(IReader* F, u32 crc, Fvector* V, int Vcnt, TRI* T, int Tcnt, build_callback* bc, void* bcp)
+{
+    R_ASSERT(S_INIT == status);
+    R_ASSERT((Vcnt >= 4) && (Tcnt >= 2));
+
+    hdrCACHE H;
+    bool valid = u32(F->length()) >= sizeof(H);
+    if (valid)
+    {
+        F->r(&H, sizeof(H));
+        valid = CACHE_VERSION == H.version && crc == H.crc && engine == H.engine && u32(Vcnt) == H.verts_count &&
+            u32(Tcnt) == H.tris_count && u32(F->elapsed()) >= H.tree_size;
+    }
+
+    // Every child reference is checked, a damaged file must not crash the queries
+    const CACHE_NODE* stream = (const CACHE_NODE*)F->pointer();
+    const u32 nodes_count = u32(Tcnt - 1);
+    if (valid && ENGINE_OPCODE == engine)
+    {
+        valid = H.tree_size == nodes_count * sizeof(CACHE_NODE);
+        for (u32 i = 0; valid && i < nodes_count; ++i)
+        {
+            valid = valid_data(stream[i].data, i, nodes_count, H.tris_count) &&
+                valid_data(stream[i].data2, i, nodes_count, H.tris_count);
+        }
+    }
+    if (valid && ENGINE_FLAT == engine)
+        valid = valid_flat((const u8*)F->pointer(), H.tree_size, H.tris_count);
+    if (!valid)
+    {
+        FS.r_close(F);
+        return false;
+    }
+
+    build_geometry(V, Vcnt, T, Tcnt, bc, bcp);
+
+    if (ENGINE_FLAT == engine)
+    {
+        flat = CNEW(FLAT_TREE)();
+        flat->load(F, H.tree_size, H.bounds);
+    }
+    else
+    {
+        AABBNoLeafNode* nodes = CALLOC(AABBNoLeafNode, nodes_count);
+        for (u32 i = 0; i < nodes_count; ++i)
+        {
+            const CACHE_NODE& C = stream[i];
+            AABBNoLeafNode& N = nodes[i];
+            (Fvector&)N.mAABB.mCenter = C.center;
+            (Fvector&)N.mAABB.mExtents = C.extents;
+            N.mData = (C.data & 1) ? uintptr_t(C.data) : uintptr_t(nodes + (C.data >> 1));
+            N.mData2 = (C.data2 & 1) ? uintptr_t(C.data2) : uintptr_t(nodes + (C.data2 >> 1));
+        }
+        tree = CNEW(OPCODE_Model)();
+        tree->Build(nodes, nodes_count);
+        FS.r_close(F);
+    }
+
+    status = S_READY;
+    return true;
+}
@@ -0,0 +1,219 @@
+#include "stdafx.h"
+#pragma hdrstop
+
+#include "xrCDB_flat.h"
+
+using namespace CDB;
+using namespace Opcode;
+
+namespace
+{
+// Child of the node being emitted: either an OPCODE node or a single triangle
+struct flat_item
+{
+    const AABBNoLeafNode* node;
+    u32 prim;
+    Fbox box;
+};
+
+float box_area(const Fbox& box)
+{
+    Fvector size;
+    box.getsize(size);
+    return size.x * size.y + size.y * size.z + size.z * size.x;
+}
+
+class flat_builder
+{
+    const Fvector* verts;
+    const TRI* tris;
+
+public:
+    xr_vector<u8> stream;
+
+    flat_builder(const Fvector* V, const TRI* T) : verts(V), tris(T) {}
+
+    void make_node(const AABBNoLeafNode* node, flat_item& item)
+    {
+        const Fvector& center = (const Fvector&)node->mAABB.mCenter;
+        const Fvector& extents = (const Fvector&)node->mAABB.mExtents;
+        item.node = node;
+        item.prim = 0;
+        item.box.min.sub(center, extents);
+        item.box.max.add(center, extents);
+    }
+
+    void make_prim(u32 prim, flat_item& item)
+    {
+        item.node = nullptr;
+        item.prim = prim;
+        item.box.invalidate();
+        for (u32 i = 0; i < 3; ++i)
+            item.box.modify(verts[tris[prim].verts[i]]);
+    }
+
+    void split(const AABBNoLeafNode* node, flat_item& pos, flat_item& neg)
+    {
+        if (node->HasLeaf())
+            make_prim(node->GetPrimitive(), pos);
+        else
+            make_node(node->GetPos(), pos);
+        if (node->HasLeaf2())
+            make_prim(node->GetPrimitive2(), neg);
+        else
+            make_node(node->GetNeg(), neg);
+    }
+
+    // Pulls grandchildren up until the node has 4 children: the largest inner child is opened first
+    u32 collapse(const AABBNoLeafNode* node, flat_item* items)
+    {
+        split(node, items[0], items[1]);
+        u32 count = 2;
+        while (count < 4)
+        {
+            u32 best = count;
+            float best_area = -1.f;
+            for (u32 i = 0; i < count; ++i)
+            {
+                if (items[i].node && box_area(items[i].box) > best_area)
+                {
+                    best = i;
+                    best_area = box_area(items[i].box);
+                }
+            }
+            if (best == count)
+                break;
+            for (u32 i = count; i > best + 1; --i)
+                items[i] = items[i - 1];
+            const AABBNoLeafNode* opened = items[best].node;
+            split(opened, items[best], items[best + 1]);
+            ++count;
+        }
+        return count;
+    }
+
+    u32 alloc(u32 bytes, u32 alignment)
+    {
+        const u32 offset = (stream.size() + alignment - 1) & ~(alignment - 1);
+        stream.resize(offset + bytes, 0);
+        return offset;
+    }
+
+    // Conservative quantization: the dequantized box always contains the exact one
+    static void quantize(FLAT_NODE& N, u32 i, const Fvector& origin, const Fvector& scale, const Fbox& box)
+    {
+        for (u32 k = 0; k < 3; ++k)
+        {
+            s32 q0 = 0, q1 = 0;
+            if (scale[k] > 0.f)
+            {
+                q0 = clampr(iFloor((box.min[k] - origin[k]) / scale[k]), 0, 65535);
+                q1 = clampr(iCeil((box.max[k] - origin[k]) / scale[k]), 0, 65535);
+                while (q0 > 0 && origin[k] + float(q0) * scale[k] > box.min[k])
+                    --q0;
+                while (q1 < 65535 && origin[k] + float(q1) * scale[k] < box.max[k])
+                    ++q1;
+            }
+            N.bmin[k][i] = u16(q0);
+            N.bmax[k][i] = u16(q1);
+        }
+    }
+
+    u32 emit(const flat_item* items, u32 count, const Fvector& origin, const Fvector& scale)
+    {
+        FLAT_NODE N;
+        ZeroMemory(&N, sizeof(N));
+        const u32 ref = alloc(sizeof(FLAT_NODE), 64);
+        for (u32 i = 0; i < 4; ++i)
+            N.child[i] = FLAT_EMPTY;
+
+        // Leaf triangles go right after the node, they are usually tested together with it
+        for (u32 i = 0; i < count; ++i)
+        {
+            quantize(N, i, origin, scale, items[i].box);
+            if (items[i].node)
+                continue;
+            const u32 offset = alloc(sizeof(FLAT_TRI), 4);
+            FLAT_TRI& T = *(FLAT_TRI*)&stream[offset];
+            for (u32 v = 0; v < 3; ++v)
+                T.verts[v] = verts[tris[items[i].prim].verts[v]];
+            T.id = items[i].prim;
+            N.child[i] = offset | FLAT_LEAF;
+        }
+
+        // Then the subtrees in depth-first order
+        for (u32 i = 0; i < count; ++i)
+        {
+            if (!items[i].node)
+                continue;
+            Fvector bmin, bmax, child_scale;
+            flat_child_box(N, i, origin, scale, bmin, bmax);
+            flat_scale(bmin, bmax, child_scale);
+            flat_item children[4];
+            const u32 child_count = collapse(items[i].node, children);
+            N.child[i] = emit(children, child_count, bmin, child_scale);
+        }
+
+        CopyMemory(&stream[ref], &N, sizeof(N));
+        return ref;
+    }
+};
+}
+
+FLAT_TREE::FLAT_TREE()
+{
+    data = nullptr;
+    memory_block = nullptr;
+    source = nullptr;
+    size = 0;
+    bounds.invalidate();
+}
+
+FLAT_TREE::~FLAT_TREE()
+{
+    if (memory_block)
+        CFREE(memory_block);
+    if (source)
+        FS.r_close(source);
+}
+
+void FLAT_TREE::build(const AABBNoLeafNode* root, const Fvector* verts, const TRI* tris)
+{
+    VERIFY(!memory_block && !source);
+
+    flat_builder builder(verts, tris);
+    flat_item items[4];
+    const u32 count = builder.collapse(root, items);
+    bounds.invalidate();
+    for (u32 i = 0; i < count; ++i)
+        bounds.merge(items[i].box);
+
+    Fvector scale;
+    flat_scale(bounds.min, bounds.max, scale);
+    const u32 root_ref = builder.emit(items, count, bounds.min, scale);
+    VERIFY(0 == root_ref);
+
+    // Nodes are aligned to cache lines relative to the stream start
+    size = builder.stream.size();
+    memory_block = (u8*)CMALLOC(size + 64);
+    data = (u8*)((uintptr_t(memory_block) + 63) & ~uintptr_t(63));
+    CopyMemory(data, &*builder.stream.begin(), size);
+}
+
+void FLAT_TREE::load(IReader* F, u32 stream_size, const Fbox& stream_bounds)
+{
+    VERIFY(!memory_block && !source);
+    size = stream_size;
+    bounds = stream_bounds;
+    if (0 == (uintptr_t(F->pointer()) & 63))
+    {
+        data = (u8*)F->pointer();
+        source = F;
+        return;
+    }
+
+    memory_block = (u8*)CMALLOC(size + 64);
+    data = (u8*)((uintptr_t(memory_block) + 63) & ~uintptr_t(63));
+    CopyMemory(data, F->pointer(), size);
+    FS.r_close(F);
+}
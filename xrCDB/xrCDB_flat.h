@@ -0,0 +1,123 @@
+#pragma once
+
+#include "xrCDB.h"
+#include <xmmintrin.h>
+
+namespace Opcode
+{
+class AABBNoLeafNode;
+}
+
+namespace CDB
+{
+// Node of the flat tree, exactly one cache line. Boxes of the four children are
+// quantized to 16 bits relative to the (dequantized) box of the node itself and
+// stored per axis, so all children can be decoded with the same origin/scale
+struct FLAT_NODE
+{
+    u16 bmin[3][4];
+    u16 bmax[3][4];
+    u32 child[4];
+};
+
+// Triangle stored inline right after the node that references it
+struct FLAT_TRI
+{
+    Fvector verts[3];
+    u32 id;
+};
+
+const u32 FLAT_EMPTY = u32(-1);
+const u32 FLAT_LEAF = 0x80000000;
+const float FLAT_QUANT = 65535.f;
+
+// Depth-first stream of nodes and triangles built from the OPCODE no-leaf tree:
+// every node is followed by its leaf triangles, then by its child nodes
+class FLAT_TREE
+{
+    u8* data;
+    u8* memory_block;
+    IReader* source; // cache file the stream is mapped from
+    u32 size;
+    Fbox bounds;
+
+public:
+    FLAT_TREE();
+    ~FLAT_TREE();
+
+    void build(const Opcode::AABBNoLeafNode* root, const Fvector* verts, const TRI* tris);
+    // The stream is position independent: if F points to it at a 64-byte aligned address
+    // (memory mapped cache file) it is used in place and F is kept open, otherwise copied
+    void load(IReader* F, u32 stream_size, const Fbox& stream_bounds);
+    u32 memory() const { return size + (memory_block ? 64 : 0) + sizeof(*this); }
+
+    ICF const u8* get_data() const { return data; }
+    ICF u32 get_size() const { return size; }
+
+    ICF const Fbox& get_bounds() const { return bounds; }
+    ICF const FLAT_NODE& node(u32 ref) const { return *(const FLAT_NODE*)(data + ref); }
+    ICF const FLAT_TRI& tri(u32 ref) const { return *(const FLAT_TRI*)(data + (ref & ~FLAT_LEAF)); }
+};
+
+ICF void flat_scale(const Fvector& bmin, const Fvector& bmax, Fvector& scale)
+{
+    scale.sub(bmax, bmin).div(FLAT_QUANT);
+}
+
+ICF void flat_child_box(
+    const FLAT_NODE& N, u32 i, const Fvector& origin, const Fvector& scale, Fvector& bmin, Fvector& bmax)
+{
+    bmin.x = origin.x + float(N.bmin[0][i]) * scale.x;
+    bmin.y = origin.y + float(N.bmin[1][i]) * scale.y;
+    bmin.z = origin.z + float(N.bmin[2][i]) * scale.z;
+    bmax.x = origin.x + float(N.bmax[0][i]) * scale.x;
+    bmax.y = origin.y + float(N.bmax[1][i]) * scale.y;
+    bmax.z = origin.z + float(N.bmax[2][i]) * scale.z;
+}
+
+// Walks the flat tree with one of the query colliders, which provide:
+//   bool _flat_box(const Fvector& center, const Fvector& extents, u32& state) - descend into the box?
+//   void _flat_prim(const FLAT_TRI& tri) - leaf test
+//   bool _flat_done() - early exit ("only first")
+// state is passed down the hierarchy, the frustum collider keeps its plane mask there
+template <typename Collider>
+void flat_stab(const FLAT_TREE& T, Collider& C, u32 ref, const Fvector& origin, const Fvector& scale, u32 state)
+{
+    const FLAT_NODE& N = T.node(ref);
+    for (u32 i = 0; i < 4; ++i)
+    {
+        const u32 child = N.child[i];
+        if (FLAT_EMPTY == child)
+            return;
+
+        Fvector bmin, bmax, center, extents;
+        flat_child_box(N, i, origin, scale, bmin, bmax);
+        center.add(bmin, bmax).mul(0.5f);
+        extents.sub(bmax, bmin).mul(0.5f);
+        u32 child_state = state;
+        if (!C._flat_box(center, extents, child_state))
+            continue;
+
+        if (child & FLAT_LEAF)
+            C._flat_prim(T.tri(child));
+        else
+        {
+            _mm_prefetch((const char*)&T.node(child), _MM_HINT_T0);
+            Fvector child_scale;
+            flat_scale(bmin, bmax, child_scale);
+            flat_stab(T, C, child, bmin, child_scale, child_state);
+        }
+
+        if (C._flat_done())
+            return;
+    }
+}
+
+template <typename Collider>
+void flat_query(const FLAT_TREE& T, Collider& C, u32 state)
+{
+    Fvector scale;
+    flat_scale(T.get_bounds().min, T.get_bounds().max, scale);
+    flat_stab(T, C, 0, T.get_bounds().min, scale, state);
+}
+}
@@ -3,6 +3,7 @@
 
 #include "xrCDB.h"
 #include "Frustum.h"
+#include "xrCDB_flat.h"
 
 using namespace CDB;
 using namespace Opcode;
@@ -32,33 +33,28 @@ public:
         return F->testAABB(&mM[0].x, mask);
     }
     void _prim(DWORD prim)
+    {
+        const u32* p = tris[prim].verts;
+        _prim(prim, verts[p[0]], verts[p[1]], verts[p[2]]);
+    }
+    void _prim(DWORD prim, const Fvector& v0, const Fvector& v1, const Fvector& v2)
     {
         if (bClass3)
         {
             sPoly src, dst;
             src.resize(3);
-            src[0] = verts[tris[prim].verts[0]];
-            src[1] = verts[tris[prim].verts[1]];
-            src[2] = verts[tris[prim].verts[2]];
-            if (F->ClipPoly(src, dst))
-            {
-                RESULT& R = dest->r_add();
-                R.id = prim;
-                R.verts[0] = verts[tris[prim].verts[0]];
-                R.verts[1] = verts[tris[prim].verts[1]];
-                R.verts[2] = verts[tris[prim].verts[2]];
-                R.dummy = tris[prim].dummy;
-            }
-        }
-        else
-        {
-            RESULT& R = dest->r_add();
-            R.id = prim;
-            R.verts[0] = verts[tris[prim].verts[0]];
-            R.verts[1] = verts[tris[prim].verts[1]];
-            R.verts[2] = verts[tris[prim].verts[2]];
-            R.dummy = tris[prim].dummy;
+            src[0] = v0;
+            src[1] = v1;
+            src[2] = v2;
+            if (!F->ClipPoly(src, dst))
+                return;
         }
+        RESULT& R = dest->r_add();
+        R.id = prim;
+        R.verts[0] = v0;
+        R.verts[1] = v1;
+        R.verts[2] = v2;
+        R.dummy = tris[prim].dummy;
     }
 
     void _stab(const AABBNoLeafNode* node, u32 mask)
@@ -84,6 +80,22 @@ public:
         else
             _stab(node->GetNeg(), mask);
     }
+
+    // Flat tree walk, see flat_stab; the plane mask is passed down as the walk state
+    ICF bool _flat_box(const Fvector& C, const Fvector& E, u32& mask)
+    {
+        Fvector center = C, extents = E;
+        return fcvNone != _box(center, extents, mask);
+    }
+    ICF void _flat_prim(const FLAT_TRI& T) { _prim(T.id, T.verts[0], T.verts[1], T.verts[2]); }
+    ICF bool _flat_done() { return bFirst && dest->r_count(); }
+    void _query(const AABBNoLeafNode* N, const FLAT_TREE* flat, u32 mask)
+    {
+        if (flat)
+            flat_query(*flat, *this, mask);
+        else
+            _stab(N, mask);
+    }
 };
 
 void COLLIDER::frustum_query(const MODEL* m_def, const CFrustum& F)
@@ -91,8 +103,8 @@ void COLLIDER::frustum_query(const MODEL* m_def, const CFrustum& F)
     m_def->syncronize();
 
     // Get nodes
-    const AABBNoLeafTree* T = (const AABBNoLeafTree*)m_def->tree->GetTree();
-    const AABBNoLeafNode* N = T->GetNodes();
+    const FLAT_TREE* flat = m_def->flat;
+    const AABBNoLeafNode* N = flat ? nullptr : ((const AABBNoLeafTree*)m_def->tree->GetTree())->GetNodes();
     const DWORD mask = F.getMask();
     r_clear();
 
@@ -103,13 +115,13 @@ void COLLIDER::frustum_query(const MODEL* m_def, const CFrustum& F)
         {
             frustum_collider<true, true> BC;
             BC._init(this, m_def->verts, m_def->tris, &F);
-            BC._stab(N, mask);
+            BC._query(N, flat, mask);
         }
         else
         {
             frustum_collider<true, false> BC;
             BC._init(this, m_def->verts, m_def->tris, &F);
-            BC._stab(N, mask);
+            BC._query(N, flat, mask);
         }
     }
     else
@@ -118,13 +130,13 @@ void COLLIDER::frustum_query(const MODEL* m_def, const CFrustum& F)
         {
             frustum_collider<false, true> BC;
             BC._init(this, m_def->verts, m_def->tris, &F);
-            BC._stab(N, mask);
+            BC._query(N, flat, mask);
         }
         else
         {
             frustum_collider<false, false> BC;
             BC._init(this, m_def->verts, m_def->tris, &F);
-            BC._stab(N, mask);
+            BC._query(N, flat, mask);
         }
     }
 }
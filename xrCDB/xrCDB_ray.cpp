@@ -6,6 +6,7 @@
 #pragma warning(pop)
 
 #include "xrCDB.h"
+#include "xrCDB_flat.h"
 
 using namespace CDB;
 using namespace Opcode;
@@ -270,15 +271,12 @@ public:
         return isect_sse(box, ray, dist);
     }
 
-    IC bool _tri(u32* p, float& u, float& v, float& range)
+    IC bool _tri(const Fvector& p0, const Fvector& p1, const Fvector& p2, float& u, float& v, float& range)
     {
         Fvector edge1, edge2, tvec, pvec, qvec;
         float det, inv_det;
 
         // find vectors for two edges sharing vert0
-        Fvector& p0 = verts[p[0]];
-        Fvector& p1 = verts[p[1]];
-        Fvector& p2 = verts[p[2]];
         edge1.sub(p1, p0);
         edge2.sub(p2, p0);
         // begin calculating determinant - also used to calculate U parameter
@@ -322,9 +320,14 @@ public:
     }
 
     void _prim(DWORD prim)
+    {
+        const u32* p = tris[prim].verts;
+        _prim(prim, verts[p[0]], verts[p[1]], verts[p[2]]);
+    }
+    void _prim(DWORD prim, const Fvector& v0, const Fvector& v1, const Fvector& v2)
     {
         float u, v, r;
-        if (!_tri(tris[prim].verts, u, v, r))
+        if (!_tri(v0, v1, v2, u, v, r))
             return;
         if (r <= 0 || r > rRange)
             return;
@@ -340,9 +343,9 @@ public:
                     R.range = r;
                     R.u = u;
                     R.v = v;
-                    R.verts[0] = verts[tris[prim].verts[0]];
-                    R.verts[1] = verts[tris[prim].verts[1]];
-                    R.verts[2] = verts[tris[prim].verts[2]];
+                    R.verts[0] = v0;
+                    R.verts[1] = v1;
+                    R.verts[2] = v2;
                     R.dummy = tris[prim].dummy;
                     rRange = r;
                     rRange2 = r * r;
@@ -355,9 +358,9 @@ public:
                 R.range = r;
                 R.u = u;
                 R.v = v;
-                R.verts[0] = verts[tris[prim].verts[0]];
-                R.verts[1] = verts[tris[prim].verts[1]];
-                R.verts[2] = verts[tris[prim].verts[2]];
+                R.verts[0] = v0;
+                R.verts[1] = v1;
+                R.verts[2] = v2;
                 R.dummy = tris[prim].dummy;
                 rRange = r;
                 rRange2 = r * r;
@@ -370,36 +373,42 @@ public:
             R.range = r;
             R.u = u;
             R.v = v;
-            R.verts[0] = verts[tris[prim].verts[0]];
-            R.verts[1] = verts[tris[prim].verts[1]];
-            R.verts[2] = verts[tris[prim].verts[2]];
+            R.verts[0] = v0;
+            R.verts[1] = v1;
+            R.verts[2] = v2;
             R.dummy = tris[prim].dummy;
         }
     }
-    void _stab(const AABBNoLeafNode* node)
+    ICF bool _box(const Fvector& bCenter, const Fvector& bExtents)
     {
-        // Should help
-        _mm_prefetch((char*)node->GetNeg(), _MM_HINT_NTA);
-
-        // Actual ray/aabb test
         if (bUseSSE)
         {
             // use SSE
             float d;
-            if (!_box_sse((Fvector&)node->mAABB.mCenter, (Fvector&)node->mAABB.mExtents, d))
-                return;
+            if (!_box_sse(bCenter, bExtents, d))
+                return false;
             if (d > rRange)
-                return;
+                return false;
         }
         else
         {
             // use FPU
             Fvector P;
-            if (!_box_fpu((Fvector&)node->mAABB.mCenter, (Fvector&)node->mAABB.mExtents, P))
-                return;
+            if (!_box_fpu(bCenter, bExtents, P))
+                return false;
             if (P.distance_to_sqr(ray.pos) > rRange2)
-                return;
+                return false;
         }
+        return true;
+    }
+    void _stab(const AABBNoLeafNode* node)
+    {
+        // Should help
+        _mm_prefetch((char*)node->GetNeg(), _MM_HINT_NTA);
+
+        // Actual ray/aabb test
+        if (!_box((Fvector&)node->mAABB.mCenter, (Fvector&)node->mAABB.mExtents))
+            return;
 
         // 1st chield
         if (node->HasLeaf())
@@ -417,6 +426,18 @@ public:
         else
             _stab(node->GetNeg());
     }
+
+    // Flat tree walk, see flat_stab
+    ICF bool _flat_box(const Fvector& bCenter, const Fvector& bExtents, u32&) { return _box(bCenter, bExtents); }
+    ICF void _flat_prim(const FLAT_TRI& T) { _prim(T.id, T.verts[0], T.verts[1], T.verts[2]); }
+    ICF bool _flat_done() { return bFirst && dest->r_count(); }
+    void _query(const AABBNoLeafNode* N, const FLAT_TREE* flat)
+    {
+        if (flat)
+            flat_query(*flat, *this, 0);
+        else
+            _stab(N);
+    }
 };
 
 void COLLIDER::ray_query(const MODEL* m_def, const Fvector& r_start, const Fvector& r_dir, float r_range)
@@ -424,8 +445,8 @@ void COLLIDER::ray_query(const MODEL* m_def, const Fvector& r_start, const Fvect
     m_def->syncronize();
 
     // Get nodes
-    const AABBNoLeafTree* T = (const AABBNoLeafTree*)m_def->tree->GetTree();
-    const AABBNoLeafNode* N = T->GetNodes();
+    const FLAT_TREE* flat = m_def->flat;
+    const AABBNoLeafNode* N = flat ? nullptr : ((const AABBNoLeafTree*)m_def->tree->GetTree())->GetNodes();
     r_clear();
 
     if (CPU::ID.feature & _CPU_FEATURE_SSE)
@@ -440,13 +461,13 @@ void COLLIDER::ray_query(const MODEL* m_def, const Fvector& r_start, const Fvect
                 {
                     ray_collider<true, true, true, true> RC;
                     RC._init(this, m_def->verts, m_def->tris, r_start, r_dir, r_range);
-                    RC._stab(N);
+                    RC._query(N, flat);
                 }
                 else
                 {
                     ray_collider<true, true, true, false> RC;
                     RC._init(this, m_def->verts, m_def->tris, r_start, r_dir, r_range);
-                    RC._stab(N);
+                    RC._query(N, flat);
                 }
             }
             else
@@ -455,13 +476,13 @@ void COLLIDER::ray_query(const MODEL* m_def, const Fvector& r_start, const Fvect
                 {
                     ray_collider<true, true, false, true> RC;
                     RC._init(this, m_def->verts, m_def->tris, r_start, r_dir, r_range);
-                    RC._stab(N);
+                    RC._query(N, flat);
                 }
                 else
                 {
                     ray_collider<true, true, false, false> RC;
                     RC._init(this, m_def->verts, m_def->tris, r_start, r_dir, r_range);
-                    RC._stab(N);
+                    RC._query(N, flat);
                 }
             }
         }
@@ -473,13 +494,13 @@ void COLLIDER::ray_query(const MODEL* m_def, const Fvector& r_start, const Fvect
                 {
                     ray_collider<true, false, true, true> RC;
                     RC._init(this, m_def->verts, m_def->tris, r_start, r_dir, r_range);
-                    RC._stab(N);
+                    RC._query(N, flat);
                 }
                 else
                 {
                     ray_collider<true, false, true, false> RC;
                     RC._init(this, m_def->verts, m_def->tris, r_start, r_dir, r_range);
-                    RC._stab(N);
+                    RC._query(N, flat);
                 }
             }
             else
@@ -488,13 +509,13 @@ void COLLIDER::ray_query(const MODEL* m_def, const Fvector& r_start, const Fvect
                 {
                     ray_collider<true, false, false, true> RC;
                     RC._init(this, m_def->verts, m_def->tris, r_start, r_dir, r_range);
-                    RC._stab(N);
+                    RC._query(N, flat);
                 }
                 else
                 {
                     ray_collider<true, false, false, false> RC;
                     RC._init(this, m_def->verts, m_def->tris, r_start, r_dir, r_range);
-                    RC._stab(N);
+                    RC._query(N, flat);
                 }
             }
         }
@@ -511,13 +532,13 @@ void COLLIDER::ray_query(const MODEL* m_def, const Fvector& r_start, const Fvect
                 {
                     ray_collider<false, true, true, true> RC;
                     RC._init(this, m_def->verts, m_def->tris, r_start, r_dir, r_range);
-                    RC._stab(N);
+                    RC._query(N, flat);
                 }
                 else
                 {
                     ray_collider<false, true, true, false> RC;
                     RC._init(this, m_def->verts, m_def->tris, r_start, r_dir, r_range);
-                    RC._stab(N);
+                    RC._query(N, flat);
                 }
             }
             else
@@ -526,13 +547,13 @@ void COLLIDER::ray_query(const MODEL* m_def, const Fvector& r_start, const Fvect
                 {
                     ray_collider<false, true, false, true> RC;
                     RC._init(this, m_def->verts, m_def->tris, r_start, r_dir, r_range);
-                    RC._stab(N);
+                    RC._query(N, flat);
                 }
                 else
                 {
                     ray_collider<false, true, false, false> RC;
                     RC._init(this, m_def->verts, m_def->tris, r_start, r_dir, r_range);
-                    RC._stab(N);
+                    RC._query(N, flat);
                 }
             }
         }
@@ -544,13 +565,13 @@ void COLLIDER::ray_query(const MODEL* m_def, const Fvector& r_start, const Fvect
                 {
                     ray_collider<false, false, true, true> RC;
                     RC._init(this, m_def->verts, m_def->tris, r_start, r_dir, r_range);
-                    RC._stab(N);
+                    RC._query(N, flat);
                 }
                 else
                 {
                     ray_collider<false, false, true, false> RC;
                     RC._init(this, m_def->verts, m_def->tris, r_start, r_dir, r_range);
-                    RC._stab(N);
+                    RC._query(N, flat);
                 }
             }
             else
@@ -559,13 +580,13 @@ void COLLIDER::ray_query(const MODEL* m_def, const Fvector& r_start, const Fvect
                 {
                     ray_collider<false, false, false, true> RC;
                     RC._init(this, m_def->verts, m_def->tris, r_start, r_dir, r_range);
-                    RC._stab(N);
+                    RC._query(N, flat);
                 }
                 else
                 {
                     ray_collider<false, false, false, false> RC;
                     RC._init(this, m_def->verts, m_def->tris, r_start, r_dir, r_range);
-                    RC._stab(N);
+                    RC._query(N, flat);
                 }
             }
         }
@@ -0,0 +1,299 @@
+#include "stdafx.h"
+#pragma hdrstop
+#pragma warning(push)
+#pragma warning(disable : 4995)
+#include <xmmintrin.h>
+#pragma warning(pop)
+
+#include "xrCDB.h"
+
+using namespace CDB;
+using namespace Opcode;
+
+#ifndef _MM_ALIGN16
+#define _MM_ALIGN16 __declspec(align(16))
+#endif // _MM_ALIGN16
+
+// Ray packet in SoA layout, lane i holds ray i of the packet
+struct _MM_ALIGN16 ray_packet_t
+{
+    __m128 pos[3];
+    __m128 dir[3];
+    __m128 inv_dir[3];
+    __m128 range;
+};
+
+static const float flt_plus_inf = -logf(0);
+
+ICF __m128 cross_x(const __m128* a, const __m128* b) { return _mm_sub_ps(_mm_mul_ps(a[1], b[2]), _mm_mul_ps(a[2], b[1])); }
+ICF __m128 cross_y(const __m128* a, const __m128* b) { return _mm_sub_ps(_mm_mul_ps(a[2], b[0]), _mm_mul_ps(a[0], b[2])); }
+ICF __m128 cross_z(const __m128* a, const __m128* b) { return _mm_sub_ps(_mm_mul_ps(a[0], b[1]), _mm_mul_ps(a[1], b[0])); }
+ICF __m128 dot(const __m128* a, const __m128* b)
+{
+    return _mm_add_ps(_mm_add_ps(_mm_mul_ps(a[0], b[0]), _mm_mul_ps(a[1], b[1])), _mm_mul_ps(a[2], b[2]));
+}
+
+// Same traversal as ray_collider (xrCDB_ray.cpp), but every node and triangle is
+// tested against the whole packet at once. Lanes that miss a node don't descend
+// into it, lanes that are done (bFirst) are masked out for the rest of the walk
+template <bool bCull, bool bFirst, bool bNearest>
+class _MM_ALIGN16 ray_packet_collider
+{
+public:
+    ray_packet_t ray;
+    xr_vector<RESULT>* lanes;
+    TRI* tris;
+    Fvector* verts;
+    int done; // lanes that found their first hit
+
+    void _init(xr_vector<RESULT>* L, Fvector* V, TRI* T, const RAY* rays, u32 count)
+    {
+        lanes = L;
+        tris = T;
+        verts = V;
+        done = 0;
+        _MM_ALIGN16 float data[10][RAY_PACKET_SIZE];
+        for (u32 i = 0; i < RAY_PACKET_SIZE; ++i)
+        {
+            // Unused lanes repeat the last ray, they are masked out by the caller
+            const RAY& R = rays[_min(i, count - 1)];
+            data[0][i] = R.start.x;
+            data[1][i] = R.start.y;
+            data[2][i] = R.start.z;
+            data[3][i] = R.dir.x;
+            data[4][i] = R.dir.y;
+            data[5][i] = R.dir.z;
+            data[6][i] = 1.f / R.dir.x;
+            data[7][i] = 1.f / R.dir.y;
+            data[8][i] = 1.f / R.dir.z;
+            data[9][i] = R.range;
+        }
+        for (u32 k = 0; k < 3; ++k)
+        {
+            ray.pos[k] = _mm_load_ps(data[k]);
+            ray.dir[k] = _mm_load_ps(data[3 + k]);
+            ray.inv_dir[k] = _mm_load_ps(data[6 + k]);
+        }
+        ray.range = _mm_load_ps(data[9]);
+    }
+
+    // Slab test of all lanes against the node box, returns mask of lanes entering it within their range
+    ICF int _box(const Fvector& bCenter, const Fvector& bExtents)
+    {
+        const __m128 plus_inf = _mm_set1_ps(flt_plus_inf), minus_inf = _mm_set1_ps(-flt_plus_inf);
+        __m128 t_near = _mm_setzero_ps();
+        __m128 t_far = ray.range;
+        for (u32 k = 0; k < 3; ++k)
+        {
+            const __m128 center = _mm_set1_ps(bCenter[k]), extents = _mm_set1_ps(bExtents[k]);
+            const __m128 l1 = _mm_mul_ps(_mm_sub_ps(_mm_sub_ps(center, extents), ray.pos[k]), ray.inv_dir[k]);
+            const __m128 l2 = _mm_mul_ps(_mm_sub_ps(_mm_add_ps(center, extents), ray.pos[k]), ray.inv_dir[k]);
+            // Filter out NaNs of inf * 0 the same way isect_sse does
+            const __m128 lmax = _mm_max_ps(_mm_min_ps(l1, plus_inf), _mm_min_ps(l2, plus_inf));
+            const __m128 lmin = _mm_min_ps(_mm_max_ps(l1, minus_inf), _mm_max_ps(l2, minus_inf));
+            t_far = _mm_min_ps(t_far, lmax);
+            t_near = _mm_max_ps(t_near, lmin);
+        }
+        return _mm_movemask_ps(_mm_cmpge_ps(t_far, t_near));
+    }
+
+    void _prim(DWORD prim, int mask)
+    {
+        const TRI& T = tris[prim];
+        const Fvector& p0 = verts[T.verts[0]];
+        const Fvector& p1 = verts[T.verts[1]];
+        const Fvector& p2 = verts[T.verts[2]];
+        __m128 edge1[3], edge2[3], pvec[3], tvec[3], qvec[3];
+        for (u32 k = 0; k < 3; ++k)
+        {
+            edge1[k] = _mm_set1_ps(p1[k] - p0[k]);
+            edge2[k] = _mm_set1_ps(p2[k] - p0[k]);
+            tvec[k] = _mm_sub_ps(ray.pos[k], _mm_set1_ps(p0[k]));
+        }
+        pvec[0] = cross_x(ray.dir, edge2);
+        pvec[1] = cross_y(ray.dir, edge2);
+        pvec[2] = cross_z(ray.dir, edge2);
+        const __m128 det = dot(edge1, pvec);
+        __m128 valid;
+        if (bCull)
+            valid = _mm_cmpge_ps(det, _mm_set1_ps(EPS));
+        else
+        {
+            const __m128 abs_det = _mm_andnot_ps(_mm_set1_ps(-0.f), det);
+            valid = _mm_cmpge_ps(abs_det, _mm_set1_ps(EPS));
+        }
+        mask &= _mm_movemask_ps(valid);
+        if (!mask)
+            return;
+
+        const __m128 inv_det = _mm_div_ps(_mm_set1_ps(1.f), det);
+        qvec[0] = cross_x(tvec, edge1);
+        qvec[1] = cross_y(tvec, edge1);
+        qvec[2] = cross_z(tvec, edge1);
+        const __m128 u = _mm_mul_ps(dot(tvec, pvec), inv_det);
+        const __m128 v = _mm_mul_ps(dot(ray.dir, qvec), inv_det);
+        const __m128 range = _mm_mul_ps(dot(edge2, qvec), inv_det);
+        const __m128 zero = _mm_setzero_ps();
+        valid = _mm_and_ps(_mm_cmpge_ps(u, zero), _mm_cmpge_ps(v, zero));
+        valid = _mm_and_ps(valid, _mm_cmple_ps(_mm_add_ps(u, v), _mm_set1_ps(1.f)));
+        valid = _mm_and_ps(valid, _mm_cmpgt_ps(range, zero));
+        valid = _mm_and_ps(valid, _mm_cmple_ps(range, ray.range));
+        mask &= _mm_movemask_ps(valid);
+        if (!mask)
+            return;
+
+        _MM_ALIGN16 float U[RAY_PACKET_SIZE], V[RAY_PACKET_SIZE], R[RAY_PACKET_SIZE], Range[RAY_PACKET_SIZE];
+        _mm_store_ps(U, u);
+        _mm_store_ps(V, v);
+        _mm_store_ps(R, range);
+        _mm_store_ps(Range, ray.range);
+        for (u32 i = 0; i < RAY_PACKET_SIZE; ++i)
+        {
+            if (!(mask & (1 << i)))
+                continue;
+            xr_vector<RESULT>& dest = lanes[i];
+            if (bNearest && !dest.empty())
+            {
+                if (R[i] >= dest.front().range)
+                    continue;
+            }
+            else
+                dest.push_back(RESULT());
+            RESULT& result = bNearest ? dest.front() : dest.back();
+            result.id = prim;
+            result.range = R[i];
+            result.u = U[i];
+            result.v = V[i];
+            result.verts[0] = p0;
+            result.verts[1] = p1;
+            result.verts[2] = p2;
+            result.dummy = T.dummy;
+            if (bNearest)
+                Range[i] = R[i];
+            if (bFirst)
+                done |= 1 << i;
+        }
+        if (bNearest)
+            ray.range = _mm_load_ps(Range);
+    }
+
+    void _stab(const AABBNoLeafNode* node, int mask)
+    {
+        _mm_prefetch((char*)node->GetNeg(), _MM_HINT_NTA);
+
+        mask &= _box((Fvector&)node->mAABB.mCenter, (Fvector&)node->mAABB.mExtents);
+        if (!mask)
+            return;
+
+        // 1st chield
+        if (node->HasLeaf())
+            _prim(node->GetPrimitive(), mask);
+        else
+            _stab(node->GetPos(), mask);
+
+        // Early exit for "only first"
+        if (bFirst)
+        {
+            mask &= ~done;
+            if (!mask)
+                return;
+        }
+
+        // 2nd chield
+        if (node->HasLeaf2())
+            _prim(node->GetPrimitive2(), mask);
+        else
+            _stab(node->GetNeg(), mask);
+    }
+};
+
+template <bool bCull, bool bFirst, bool bNearest>
+static void ray_packets(xr_vector<RESULT>* lanes, xr_vector<RESULT>& rd, xr_vector<u32>& rp, const MODEL* m_def,
+    const AABBNoLeafNode* N, const RAY* rays, u32 count)
+{
+    ray_packet_collider<bCull, bFirst, bNearest> RC;
+    for (u32 first = 0; first < count; first += RAY_PACKET_SIZE)
+    {
+        const u32 size = _min(count - first, RAY_PACKET_SIZE);
+        for (u32 i = 0; i < size; ++i)
+            lanes[i].clear_not_free();
+        RC._init(lanes, const_cast<Fvector*>(m_def->get_verts()), const_cast<TRI*>(m_def->get_tris()), rays + first,
+            size);
+        RC._stab(N, (1 << size) - 1);
+        // Collect per lane results in ray order
+        for (u32 i = 0; i < size; ++i)
+        {
+            rp.push_back(rd.size());
+            rd.insert(rd.end(), lanes[i].begin(), lanes[i].end());
+        }
+    }
+}
+
+void COLLIDER::ray_packet_query(const MODEL* m_def, const RAY* rays, u32 count)
+{
+    r_clear();
+    if (!count)
+        return;
+
+    m_def->syncronize();
+    if (!(CPU::ID.feature & _CPU_FEATURE_SSE) || !m_def->tree)
+    {
+        // No SSE or no OPCODE tree (ENGINE_FLAT): fall back to the scalar path ray by ray
+        xr_vector<RESULT> hits;
+        xr_vector<u32> offsets;
+        for (u32 i = 0; i < count; ++i)
+        {
+            ray_query(m_def, rays[i].start, rays[i].dir, rays[i].range);
+            offsets.push_back(hits.size());
+            hits.insert(hits.end(), rd.begin(), rd.end());
+        }
+        offsets.push_back(hits.size());
+        rd.swap(hits);
+        rp.swap(offsets);
+        return;
+    }
+
+    const AABBNoLeafTree* T = (const AABBNoLeafTree*)m_def->tree->GetTree();
+    const AABBNoLeafNode* N = T->GetNodes();
+    rp.reserve(count + 1);
+
+    // Binary dispatcher
+    const bool bCull = !!(ray_mode & OPT_CULL);
+    const bool bFirst = !!(ray_mode & OPT_ONLYFIRST);
+    const bool bNearest = !!(ray_mode & OPT_ONLYNEAREST);
+    if (bCull)
+    {
+        if (bFirst)
+        {
+            if (bNearest)
+                ray_packets<true, true, true>(rp_lanes, rd, rp, m_def, N, rays, count);
+            else
+                ray_packets<true, true, false>(rp_lanes, rd, rp, m_def, N, rays, count);
+        }
+        else
+        {
+            if (bNearest)
+                ray_packets<true, false, true>(rp_lanes, rd, rp, m_def, N, rays, count);
+            else
+                ray_packets<true, false, false>(rp_lanes, rd, rp, m_def, N, rays, count);
+        }
+    }
+    else
+    {
+        if (bFirst)
+        {
+            if (bNearest)
+                ray_packets<false, true, true>(rp_lanes, rd, rp, m_def, N, rays, count);
+            else
+                ray_packets<false, true, false>(rp_lanes, rd, rp, m_def, N, rays, count);
+        }
+        else
+        {
+            if (bNearest)
+                ray_packets<false, false, true>(rp_lanes, rd, rp, m_def, N, rays, count);
+            else
+                ray_packets<false, false, false>(rp_lanes, rd, rp, m_def, N, rays, count);
+        }
+    }
+    rp.push_back(rd.size());
+}
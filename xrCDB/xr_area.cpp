@@ -100,23 +100,52 @@ void CObjectSpace::Load(LPCSTR path, LPCSTR fname, CDB::build_callback build_cal
 #endif // #ifdef USE_ARENA_ALLOCATOR
     IReader* F = FS.r_open(path, fname);
     R_ASSERT(F);
-    Load(F, build_callback);
+    string_path cache_name;
+    strconcat(sizeof(cache_name), cache_name, fname, ".cache");
+    Load(F, build_callback, path, cache_name);
 }
-void CObjectSpace::Load(IReader* F, CDB::build_callback build_callback)
+void CObjectSpace::Load(IReader* F, CDB::build_callback build_callback, LPCSTR cache_path, LPCSTR cache_name)
 
 {
     hdrCFORM H;
     F->r(&H, sizeof(hdrCFORM));
     Fvector* verts = (Fvector*)F->pointer();
     CDB::TRI* tris = (CDB::TRI*)(verts + H.vertcount);
-    Create(verts, tris, H, build_callback);
+    Create(verts, tris, H, build_callback, cache_path, cache_name);
     FS.r_close(F);
 }
 
-void CObjectSpace::Create(Fvector* verts, CDB::TRI* tris, const hdrCFORM& H, CDB::build_callback build_callback)
+void CObjectSpace::Create(Fvector* verts, CDB::TRI* tris, const hdrCFORM& H, CDB::build_callback build_callback,
+    LPCSTR cache_path, LPCSTR cache_name)
 {
     R_ASSERT(CFORM_CURRENT_VERSION == H.version);
-    Static.build(verts, H.vertcount, tris, H.facecount, build_callback);
+    if (!cache_name || strstr(Core.Params, "-no_cdb_cache"))
+        Static.build(verts, H.vertcount, tris, H.facecount, build_callback);
+    else
+    {
+        // The cache is keyed by the CRC of the geometry as stored in the CFORM, before build_callback
+        CTimer timer;
+        timer.Start();
+        const u32 crc = CDB::MODEL::geometry_crc(verts, H.vertcount, tris, H.facecount);
+        IReader* F = FS.exist(cache_path, cache_name) ? FS.r_open(cache_path, cache_name) : NULL;
+        if (F && Static.deserialize(F, crc, verts, H.vertcount, tris, H.facecount, build_callback))
+            Msg("* CDB: tree loaded from '%s' in %2.3fs", cache_name, timer.GetElapsed_sec());
+        else
+        {
+            if (F)
+                Msg("* CDB: '%s' is out of date, rebuilding", cache_name);
+            Static.build(verts, H.vertcount, tris, H.facecount, build_callback);
+            IWriter* W = FS.w_open(cache_path, cache_name);
+            if (W)
+            {
+                Static.serialize(*W, crc);
+                FS.w_close(W);
+                Msg("* CDB: tree built and cached to '%s' in %2.3fs", cache_name, timer.GetElapsed_sec());
+            }
+            else
+                Msg("! CDB: tree built in %2.3fs, can't write '%s'", timer.GetElapsed_sec(), cache_name);
+        }
+    }
     m_BoundingVolume.set(H.aabb);
     g_SpatialSpace->initialize(m_BoundingVolume);
     g_SpatialSpacePhysic->initialize(m_BoundingVolume);
@@ -54,8 +54,10 @@ public:
 
     void Load(CDB::build_callback build_callback);
     void Load(LPCSTR path, LPCSTR fname, CDB::build_callback build_callback);
-    void Load(IReader* R, CDB::build_callback build_callback);
-    void Create(Fvector* verts, CDB::TRI* tris, const hdrCFORM& H, CDB::build_callback build_callback);
+    void Load(IReader* R, CDB::build_callback build_callback, LPCSTR cache_path = NULL, LPCSTR cache_name = NULL);
+    // Static tree is loaded from the cache file if given and up to date, otherwise built and saved there
+    void Create(Fvector* verts, CDB::TRI* tris, const hdrCFORM& H, CDB::build_callback build_callback,
+        LPCSTR cache_path = NULL, LPCSTR cache_name = NULL);
     // Occluded/No
     BOOL RayTest(const Fvector& start, const Fvector& dir, float range, collide::rq_target tgt,
         collide::ray_cache* cache, IGameObject* ignore_object);
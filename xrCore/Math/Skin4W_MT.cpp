@@ -1,6 +1,6 @@
 #include "stdafx.h"
 #include "Skin4W_MT.hpp"
-#include "Threading/ttapi.h"
+#include "Threading/TaskManager.hpp"
 #ifdef _EDITOR
 #include "SkeletonX.h"
 #include "SkeletonCustom.h"
@@ -40,26 +40,20 @@ void Skin4W_MT(vertRender* dst, vertBoned4W* src, u32 vCount, CBoneInstance* bon
 #ifdef _GPA_ENABLED
     TAL_SCOPED_TASK_NAMED("Skin4W_MT()");
 #endif
-    u32 workerCount = ttapi_GetWorkerCount();
-    if (vCount < workerCount * 64)
+    if (vCount < TaskScheduler.GetWorkerCount() * 64)
     {
         Skin4W_MTs(dst, src, vCount, bones);
         return;
     }
-    auto params = (SkinParams*)_alloca(sizeof(SkinParams) * workerCount);
-    // Give ~1% more for the last worker to minimize wait in final spin
-    u32 nSlice = vCount / 128;
-    u32 nStep = (vCount - nSlice) / workerCount;
-    u32 nLast = vCount - nStep * (workerCount - 1);
-    for (u32 i = 0; i < workerCount; i++)
+    TaskScheduler.ParallelFor(0, vCount, TaskScheduler.CalcGrainSize(vCount, 64), [=](u32 from, u32 to)
     {
-        params[i].Dest = dst + i * nStep;
-        params[i].Src = src + i * nStep;
-        params[i].Count = i == (workerCount - 1) ? nLast : nStep;
-        params[i].Data = bones;
-        ttapi_AddWorker(Skin4W_Stream, &params[i]);
-    }
-    ttapi_Run();
+        SkinParams params;
+        params.Dest = dst + from;
+        params.Src = src + from;
+        params.Count = to - from;
+        params.Data = bones;
+        Skin4W_Stream(&params);
+    });
 }
 
 } // namespace Util3D
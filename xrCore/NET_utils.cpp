@@ -366,3 +366,156 @@ void NET_Packet::r_stringZ_s(LPSTR string, u32 const size)
     R_ASSERT2((length + 1) <= size, "buffer overrun");
     r(string, length + 1);
 }
+
+// ---NET_PooledPacket
+// size classes are the powers of two from 64 bytes to NET_PooledPacketSizeLimit
+static const u32 pool_min_size_log = 6;
+static const u32 pool_size_class_count = 10;
+// free buffers above the limit are returned to the memory manager, a burst of packets is not kept for good
+static const u32 pool_max_free_count = 256;
+
+class NET_PacketPool
+{
+    Lock cs;
+    xr_vector<u8*> free[pool_size_class_count];
+    u32 buffer_count;
+    u32 memory;
+
+public:
+    NET_PacketPool() : buffer_count(0), memory(0) {}
+    ~NET_PacketPool()
+    {
+        for (u32 i = 0; i < pool_size_class_count; ++i)
+            for (u8* buffer : free[i])
+                xr_free(buffer);
+    }
+
+    static u32 size_class(u32 size)
+    {
+        VERIFY(size <= NET_PooledPacketSizeLimit);
+        u32 result = 0;
+        while ((u32(1) << (pool_min_size_log + result)) < size)
+            ++result;
+        VERIFY(result < pool_size_class_count);
+        return result;
+    }
+
+    static u32 class_size(u32 size_class) { return u32(1) << (pool_min_size_log + size_class); }
+    u8* acquire(u32 size_class)
+    {
+        cs.Enter();
+        if (!free[size_class].empty())
+        {
+            u8* result = free[size_class].back();
+            free[size_class].pop_back();
+            cs.Leave();
+            return result;
+        }
+        ++buffer_count;
+        memory += class_size(size_class);
+        cs.Leave();
+        return (u8*)xr_malloc(class_size(size_class));
+    }
+
+    void release(u8* buffer, u32 size_class)
+    {
+        cs.Enter();
+        if (free[size_class].size() < pool_max_free_count)
+        {
+            free[size_class].push_back(buffer);
+            cs.Leave();
+            return;
+        }
+        --buffer_count;
+        memory -= class_size(size_class);
+        cs.Leave();
+        xr_free(buffer);
+    }
+
+    void stats(u32& _buffer_count, u32& free_count, u32& _memory)
+    {
+        cs.Enter();
+        _buffer_count = buffer_count;
+        _memory = memory;
+        free_count = 0;
+        for (u32 i = 0; i < pool_size_class_count; ++i)
+            free_count += free[i].size();
+        cs.Leave();
+    }
+};
+
+static NET_PacketPool packet_pool;
+
+NET_PooledPacket::NET_PooledPacket() : m_data(NULL), m_size(0), m_size_class(0), m_r_pos(0), m_time_receive(0) {}
+NET_PooledPacket::NET_PooledPacket(NET_PooledPacket&& other)
+    : m_data(other.m_data), m_size(other.m_size), m_size_class(other.m_size_class), m_r_pos(other.m_r_pos),
+      m_time_receive(other.m_time_receive)
+{
+    other.m_data = NULL;
+    other.m_size = 0;
+}
+
+NET_PooledPacket::~NET_PooledPacket() { clear(); }
+NET_PooledPacket& NET_PooledPacket::operator=(NET_PooledPacket&& other)
+{
+    if (this == &other)
+        return *this;
+
+    clear();
+    m_data = other.m_data;
+    m_size = other.m_size;
+    m_size_class = other.m_size_class;
+    m_r_pos = other.m_r_pos;
+    m_time_receive = other.m_time_receive;
+    other.m_data = NULL;
+    other.m_size = 0;
+    return *this;
+}
+
+void NET_PooledPacket::clear()
+{
+    if (m_data)
+        packet_pool.release(m_data, m_size_class);
+    m_data = NULL;
+    m_size = 0;
+    m_r_pos = 0;
+}
+
+void NET_PooledPacket::assign(const void* data, u32 size, u32 time_receive)
+{
+    u32 size_class = NET_PacketPool::size_class(size);
+    if (!m_data || (m_size_class != size_class))
+    {
+        clear();
+        m_data = packet_pool.acquire(size_class);
+        m_size_class = size_class;
+    }
+
+    if (size)
+        CopyMemory(m_data, data, size);
+    m_size = size;
+    m_r_pos = 0;
+    m_time_receive = time_receive;
+}
+
+void NET_PooledPacket::assign(const NET_Packet& P)
+{
+    VERIFY(!P.inistream);
+    assign(P.B.data, P.B.count, P.timeReceive);
+    m_r_pos = P.r_pos;
+}
+
+void NET_PooledPacket::unpack(NET_Packet& P) const
+{
+    VERIFY(m_size <= sizeof(P.B.data));
+    if (m_size)
+        CopyMemory(P.B.data, m_data, m_size);
+    P.B.count = m_size;
+    P.r_pos = m_r_pos;
+    P.timeReceive = m_time_receive;
+}
+
+void NET_PooledPacket::pool_stats(u32& buffer_count, u32& free_count, u32& memory)
+{
+    packet_pool.stats(buffer_count, free_count, memory);
+}
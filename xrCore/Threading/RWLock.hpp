@@ -0,0 +1,22 @@
+#pragma once
+#include "xrCore/xrCore.h"
+
+#include <shared_mutex>
+
+// Any number of readers or a single writer. Unlike Lock it is not recursive:
+// a thread must not enter it again while holding it, in either mode
+class RWLock
+{
+public:
+    RWLock() = default;
+    RWLock(const RWLock&) = delete;
+    RWLock& operator=(const RWLock&) = delete;
+
+    void EnterRead() { mutex.lock_shared(); }
+    void LeaveRead() { mutex.unlock_shared(); }
+    void EnterWrite() { mutex.lock(); }
+    void LeaveWrite() { mutex.unlock(); }
+
+private:
+    std::shared_timed_mutex mutex;
+};
@@ -0,0 +1,308 @@
+#include "stdafx.h"
+#include "TaskManager.hpp"
+
+#include <mutex>
+#include <condition_variable>
+#include <thread>
+
+TaskManager TaskScheduler;
+
+struct TaskManager::WorkerQueue
+{
+    // Owner works at the bottom, thieves take from the top
+    std::mutex mutex;
+    Task* tasks[MaxTasksPerThread];
+    u32 top = 0;
+    u32 bottom = 0;
+    // Ring of task storage owned by the thread
+    Task* storage = nullptr;
+    u32 allocated = 0;
+    u32 index = 0;
+
+    void Push(Task* task)
+    {
+        std::lock_guard<std::mutex> guard(mutex);
+        R_ASSERT2(bottom - top < MaxTasksPerThread, "Task queue overflow");
+        tasks[bottom % MaxTasksPerThread] = task;
+        ++bottom;
+    }
+
+    Task* Pop()
+    {
+        std::lock_guard<std::mutex> guard(mutex);
+        if (bottom == top)
+            return nullptr;
+        --bottom;
+        return tasks[bottom % MaxTasksPerThread];
+    }
+
+    Task* Steal()
+    {
+        if (!mutex.try_lock())
+            return nullptr;
+        Task* task = nullptr;
+        if (bottom != top)
+        {
+            task = tasks[top % MaxTasksPerThread];
+            ++top;
+        }
+        mutex.unlock();
+        return task;
+    }
+};
+
+// Queue slots of exited threads are recycled, so MaxThreads limits only
+// the number of threads using the scheduler at the same time
+static std::mutex s_queue_mutex;
+static u32 s_free_queues[TaskManager::MaxThreads];
+static u32 s_free_queue_count = 0;
+// Bumped by Destroy, so that slots taken before it are neither reused nor released
+static std::atomic<u32> s_queue_generation{0};
+
+static void ReleaseQueueSlot(u32 index, u32 generation)
+{
+    std::lock_guard<std::mutex> guard(s_queue_mutex);
+    if (generation != s_queue_generation.load())
+        return;
+    s_free_queues[s_free_queue_count++] = index;
+}
+
+struct ThreadQueueSlot
+{
+    TaskManager::WorkerQueue* queue = nullptr;
+    u32 generation = 0;
+
+    void Release()
+    {
+        if (queue)
+            ReleaseQueueSlot(queue->index, generation);
+        queue = nullptr;
+    }
+
+    ~ThreadQueueSlot() { Release(); }
+};
+
+static thread_local ThreadQueueSlot s_thread_queue;
+static std::mutex s_sleep_mutex;
+static std::condition_variable s_sleep_condition;
+static string64 s_thread_names[TaskManager::MaxThreads];
+
+struct WorkerStartup
+{
+    TaskManager* manager;
+    u32 index;
+};
+
+void TaskManager::Initialize(u32 threadCount)
+{
+    if (initialized)
+        return;
+    if (threadCount < 1)
+        threadCount = 1;
+    if (threadCount > MaxThreads / 2)
+        threadCount = MaxThreads / 2;
+    workerCount = threadCount;
+    shouldStop = false;
+    queues = xr_alloc<WorkerQueue>(MaxThreads);
+    for (u32 i = 0; i < MaxThreads; ++i)
+        new (queues + i) WorkerQueue();
+    queueCount = 0;
+    s_free_queue_count = 0;
+    // Calling thread is the first worker
+    GetThreadQueue();
+    initialized = true;
+    for (u32 i = 1; i < workerCount; ++i)
+    {
+        ++aliveThreads;
+        auto startup = xr_new<WorkerStartup>();
+        startup->manager = this;
+        startup->index = i;
+        xr_sprintf(s_thread_names[i], "Task worker #%u", i);
+        thread_spawn(WorkerThread, s_thread_names[i], 0, startup);
+    }
+}
+
+void TaskManager::Destroy()
+{
+    if (!initialized)
+        return;
+    shouldStop = true;
+    while (aliveThreads.load())
+    {
+        s_sleep_condition.notify_all();
+        std::this_thread::yield();
+    }
+    std::lock_guard<std::mutex> guard(s_queue_mutex);
+    ++s_queue_generation;
+    s_free_queue_count = 0;
+    for (u32 i = 0; i < MaxThreads; ++i)
+    {
+        xr_free(queues[i].storage);
+        queues[i].~WorkerQueue();
+    }
+    xr_free(queues);
+    queueCount = 0;
+    workerCount = 0;
+    s_thread_queue.queue = nullptr;
+    initialized = false;
+}
+
+TaskManager::WorkerQueue& TaskManager::GetThreadQueue()
+{
+    ThreadQueueSlot& slot = s_thread_queue;
+    if (!slot.queue || slot.generation != s_queue_generation.load(std::memory_order_relaxed))
+    {
+        std::lock_guard<std::mutex> guard(s_queue_mutex);
+        u32 index;
+        if (s_free_queue_count)
+            index = s_free_queues[--s_free_queue_count];
+        else
+        {
+            index = queueCount.load();
+            R_ASSERT2(index < MaxThreads, "Too many threads use the task scheduler");
+            queueCount.store(index + 1);
+        }
+        // A recycled slot keeps its storage, tasks still in flight in it stay valid
+        WorkerQueue& queue = queues[index];
+        queue.index = index;
+        if (!queue.storage)
+        {
+            queue.storage = xr_alloc<Task>(MaxTasksPerThread);
+            ZeroMemory(queue.storage, sizeof(Task) * MaxTasksPerThread);
+        }
+        slot.queue = &queue;
+        slot.generation = s_queue_generation.load();
+    }
+    return *slot.queue;
+}
+
+Task* TaskManager::AllocateTask(Task* parent)
+{
+    WorkerQueue& queue = GetThreadQueue();
+    Task* task = &queue.storage[queue.allocated++ % MaxTasksPerThread];
+    R_ASSERT2(task->IsFinished(), "Task ring overflow: too many tasks in flight");
+    task->invoker = nullptr;
+    task->destructor = nullptr;
+    task->parent = parent;
+    task->unfinishedJobs.store(1, std::memory_order_relaxed);
+    task->continuationCount.store(0, std::memory_order_relaxed);
+    if (parent)
+        parent->unfinishedJobs.fetch_add(1, std::memory_order_relaxed);
+    return task;
+}
+
+Task* TaskManager::CreateTask(Task* parent) { return AllocateTask(parent); }
+void TaskManager::AddContinuation(Task& ancestor, Task& continuation)
+{
+    const int index = ancestor.continuationCount.fetch_add(1);
+    R_ASSERT2(index < int(Task::MaxContinuations), "Too many task continuations");
+    ancestor.continuations[index] = &continuation;
+}
+
+void TaskManager::Run(Task& task)
+{
+    GetThreadQueue().Push(&task);
+    WakeUpWorkers();
+}
+
+void TaskManager::WakeUpWorkers()
+{
+    if (sleepingThreads.load(std::memory_order_relaxed) > 0)
+        s_sleep_condition.notify_one();
+}
+
+Task* TaskManager::GetTask(WorkerQueue& queue)
+{
+    Task* task = queue.Pop();
+    if (task)
+        return task;
+    // Steal from the others, starting next to us so thieves spread over victims
+    const u32 count = queueCount.load();
+    for (u32 i = 1; i < count; ++i)
+    {
+        WorkerQueue& victim = queues[(queue.index + i) % count];
+        task = victim.Steal();
+        if (task)
+            return task;
+    }
+    return nullptr;
+}
+
+void TaskManager::Execute(Task& task)
+{
+    if (task.invoker)
+        task.invoker(task, task.data);
+    if (task.destructor)
+        task.destructor(task.data);
+    Finish(task);
+}
+
+void TaskManager::Finish(Task& task)
+{
+    // Once the task is finished it may be waited for and its ring slot reused,
+    // so everything needed afterwards is read before the decrement
+    Task* parent = task.parent;
+    Task* continuations[Task::MaxContinuations];
+    const int continuationCount = task.continuationCount.load(std::memory_order_acquire);
+    for (int i = 0; i < continuationCount; ++i)
+        continuations[i] = task.continuations[i];
+
+    const int unfinished = task.unfinishedJobs.fetch_sub(1, std::memory_order_acq_rel) - 1;
+    if (unfinished > 0)
+        return;
+    for (int i = 0; i < continuationCount; ++i)
+        Run(*continuations[i]);
+    if (parent)
+        Finish(*parent);
+}
+
+void TaskManager::Wait(const Task& task)
+{
+    WorkerQueue& queue = GetThreadQueue();
+    while (!task.IsFinished())
+    {
+        if (Task* other = GetTask(queue))
+            Execute(*other);
+        else
+            std::this_thread::yield();
+    }
+}
+
+void TaskManager::WorkerThread(void* params)
+{
+    auto startup = static_cast<WorkerStartup*>(params);
+    TaskManager& manager = *startup->manager;
+    xr_delete(startup);
+    WorkerQueue& queue = manager.GetThreadQueue();
+    u32 idleSpins = 0;
+    while (!manager.shouldStop.load(std::memory_order_relaxed))
+    {
+        if (Task* task = manager.GetTask(queue))
+        {
+            manager.Execute(*task);
+            idleSpins = 0;
+            continue;
+        }
+        // Spin briefly before going to sleep, frame work usually comes in bursts
+        if (++idleSpins < 256)
+        {
+            _mm_pause();
+            continue;
+        }
+        if (idleSpins < 512)
+        {
+            std::this_thread::yield();
+            continue;
+        }
+        ++manager.sleepingThreads;
+        {
+            std::unique_lock<std::mutex> lock(s_sleep_mutex);
+            s_sleep_condition.wait_for(lock, std::chrono::milliseconds(1));
+        }
+        --manager.sleepingThreads;
+        idleSpins = 256;
+    }
+    // Give the slot back before Destroy may free the queues
+    s_thread_queue.Release();
+    --manager.aliveThreads;
+}
@@ -0,0 +1,164 @@
+#pragma once
+#include "xrCore/xrCore.h"
+
+#include <atomic>
+#include <new>
+#include <type_traits>
+#include <utility>
+
+// Work-stealing task scheduler.
+// Every thread that touches the scheduler owns a deque: the owner pushes and pops
+// at the back (LIFO, keeps the cache warm), idle threads steal from the front.
+// Tasks may spawn children; a task is finished when its own body and all of its
+// children are done, after which its continuations are scheduled.
+
+class TaskManager;
+
+class alignas(64) Task
+{
+    friend class TaskManager;
+
+public:
+    static constexpr u32 MaxContinuations = 4;
+    static constexpr u32 DataSize = 64;
+
+    using Invoker = void (*)(Task& task, void* data);
+    using Destructor = void (*)(void* data);
+
+    bool IsFinished() const { return unfinishedJobs.load(std::memory_order_acquire) <= 0; }
+    Task* GetParent() const { return parent; }
+    void* GetData() { return data; }
+
+private:
+    Invoker invoker;
+    Destructor destructor;
+    Task* parent;
+    std::atomic_int unfinishedJobs;
+    std::atomic_int continuationCount;
+    Task* continuations[MaxContinuations];
+    alignas(16) u8 data[DataSize];
+};
+
+class XRCORE_API TaskManager
+{
+public:
+    // Tasks are recycled from per-thread rings of this size, so no more than
+    // MaxTasksPerThread tasks created by one thread may be in flight at once
+    static constexpr u32 MaxTasksPerThread = 4096;
+    static constexpr u32 MaxThreads = 64;
+
+    struct WorkerQueue;
+
+    TaskManager() = default;
+    TaskManager(const TaskManager&) = delete;
+    TaskManager& operator=(const TaskManager&) = delete;
+
+    // Starts (threadCount - 1) helper threads; the calling thread is the first worker
+    void Initialize(u32 threadCount);
+    void Destroy();
+
+    bool IsInitialized() const { return initialized; }
+    // Number of threads executing tasks, including the calling one
+    u32 GetWorkerCount() const { return workerCount; }
+
+    // Creates an empty task, useful as a root for a group of children
+    Task* CreateTask(Task* parent = nullptr);
+
+    // Creates a task that runs functor(Task&) when executed
+    template <typename Functor>
+    Task* CreateTask(Functor&& functor, Task* parent = nullptr)
+    {
+        using FunctorType = typename std::decay<Functor>::type;
+        static_assert(sizeof(FunctorType) <= Task::DataSize, "Task functor is too large");
+        Task* task = AllocateTask(parent);
+        new (task->data) FunctorType(std::forward<Functor>(functor));
+        task->invoker = [](Task& t, void* data) { (*static_cast<FunctorType*>(data))(t); };
+        task->destructor = nullptr;
+        if (!std::is_trivially_destructible<FunctorType>::value)
+            task->destructor = [](void* data) { static_cast<FunctorType*>(data)->~FunctorType(); };
+        return task;
+    }
+
+    // Schedules the task continuation to run once the ancestor is finished.
+    // Must be called before the ancestor is run.
+    void AddContinuation(Task& ancestor, Task& continuation);
+
+    // Pushes the task onto the calling thread's deque
+    void Run(Task& task);
+    // Executes other tasks until the given one is finished
+    void Wait(const Task& task);
+    void RunAndWait(Task& task)
+    {
+        Run(task);
+        Wait(task);
+    }
+
+    // Splits [begin, end) into chunks of at most grainSize elements and runs
+    // functor(from, to) for each of them in parallel; returns when all are done
+    template <typename Functor>
+    void ParallelFor(u32 begin, u32 end, u32 grainSize, const Functor& functor)
+    {
+        if (begin >= end)
+            return;
+        if (!grainSize)
+            grainSize = 1;
+        if (end - begin <= grainSize || workerCount < 2)
+        {
+            functor(begin, end);
+            return;
+        }
+        ParallelForRange<Functor> range = {begin, end, grainSize, &functor, this};
+        Task* root = CreateTask(range);
+        RunAndWait(*root);
+    }
+
+    // Default grain size that gives every worker a few chunks to balance with
+    u32 CalcGrainSize(u32 count, u32 minGrainSize = 1) const
+    {
+        const u32 grain = count / ((workerCount ? workerCount : 1) * 4);
+        return grain < minGrainSize ? minGrainSize : grain;
+    }
+
+private:
+    template <typename Functor>
+    struct ParallelForRange
+    {
+        u32 begin;
+        u32 end;
+        u32 grainSize;
+        const Functor* functor;
+        TaskManager* manager;
+
+        void operator()(Task& self)
+        {
+            // Split off the right half as a child until the rest fits a single chunk
+            while (end - begin > grainSize)
+            {
+                const u32 middle = begin + (end - begin) / 2;
+                ParallelForRange right = {middle, end, grainSize, functor, manager};
+                manager->Run(*manager->CreateTask(right, &self));
+                end = middle;
+            }
+            (*functor)(begin, end);
+        }
+    };
+
+    Task* AllocateTask(Task* parent);
+    WorkerQueue& GetThreadQueue();
+    Task* GetTask(WorkerQueue& queue);
+    void Execute(Task& task);
+    void Finish(Task& task);
+    void WakeUpWorkers();
+
+    static void WorkerThread(void* params);
+
+    WorkerQueue* queues = nullptr;
+    std::atomic<u32> queueCount{0};
+    u32 workerCount = 0;
+    std::atomic_int aliveThreads{0};
+    std::atomic_int sleepingThreads{0};
+    std::atomic_bool shouldStop{false};
+    bool initialized = false;
+};
+
+extern XRCORE_API TaskManager TaskScheduler;
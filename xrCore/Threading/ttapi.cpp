@@ -1,208 +1,46 @@
 #include "stdafx.h"
 #include "ttapi.h"
-#include <windows.h>
+#include "TaskManager.hpp"
 #ifdef _GPA_ENABLED
 #include <tal.h>
 #endif
 
-typedef struct TTAPI_WORKER_PARAMS
+#define TTAPI_HARDCODED_THREADS 64
+
+struct TTAPI_WORKER_PARAMS
 {
-    volatile LONG vlFlag;
     TTAPIWorkerFunc lpWorkerFunc;
     LPVOID lpvWorkerFuncParams;
-    DWORD dwPadding[13];
-} * PTTAPI_WORKER_PARAMS;
-
-typedef PTTAPI_WORKER_PARAMS LPTTAPI_WORKER_PARAMS;
+};
 
-static LPHANDLE ttapi_threads_handles = NULL;
-static bool ttapi_initialized = false;
-static DWORD ttapi_worker_count = 0;
-static DWORD ttapi_thread_count = 0;
+static TTAPI_WORKER_PARAMS ttapi_worker_params[TTAPI_HARDCODED_THREADS];
 static DWORD ttapi_assigned_workers = 0;
-static LPTTAPI_WORKER_PARAMS ttapi_worker_params = NULL;
-static DWORD ttapi_dwFastIter = 0;
-static DWORD ttapi_dwSlowIter = 0;
-
-struct
-{
-    volatile LONG size;
-    DWORD dwPadding[15];
-} ttapi_queue_size;
-
-static DWORD WINAPI ttapiThreadProc(void* lpParameter)
-{
-    LPTTAPI_WORKER_PARAMS pParams = (LPTTAPI_WORKER_PARAMS)lpParameter;
-    DWORD i, dwFastIter = ttapi_dwFastIter, dwSlowIter = ttapi_dwSlowIter;
-
-    while (TRUE)
-    {
-        // Wait
-
-        // Fast
-        for (i = 0; i < dwFastIter; ++i)
-        {
-            if (pParams->vlFlag == 0)
-            {
-                // Msg( "0x%8.8X Fast %u" , dwId , i );
-                goto process;
-            }
-			_mm_pause(); //__asm pause;
-        }
-
-        // Moderate
-        for (i = 0; i < dwSlowIter; ++i)
-        {
-            if (pParams->vlFlag == 0)
-            {
-                // Msg( "0x%8.8X Moderate %u" , dwId , i );
-                goto process;
-            }
-            SwitchToThread();
-        }
-
-        // Slow
-        while (pParams->vlFlag)
-            Sleep(100);
-    process:
-        pParams->vlFlag = 1;
-
-        if (pParams->lpWorkerFunc)
-            pParams->lpWorkerFunc(pParams->lpvWorkerFuncParams);
-        else
-            break;
-
-        _InterlockedDecrement(&ttapi_queue_size.size);
-
-    } // while
-
-    return 0;
-}
-
-typedef struct tagTHREADNAME_INFO
-{
-    DWORD dwType;
-    LPCSTR szName;
-    DWORD dwThreadID;
-    DWORD dwFlags;
-} THREADNAME_INFO;
-
-void SetThreadName(DWORD dwThreadID, LPCSTR szThreadName)
-{
-    THREADNAME_INFO info;
-    {
-        info.dwType = 0x1000;
-        info.szName = szThreadName;
-        info.dwThreadID = dwThreadID;
-        info.dwFlags = 0;
-    }
-    __try
-    {
-#ifdef _M_X64
-		RaiseException(0x406D1388, 0, sizeof(info) / sizeof(DWORD), (ULONG_PTR*)&info);
-#else
-		RaiseException(0x406D1388, 0, sizeof(info) / sizeof(DWORD), (DWORD*)&info);
-#endif
-    }
-    __except (EXCEPTION_CONTINUE_EXECUTION)
-    {
-    }
-}
 
 int ttapi_Init(const _processor_info& pi)
 {
-    if (ttapi_initialized)
-        return ttapi_worker_count;
+    if (TaskScheduler.IsInitialized())
+        return TaskScheduler.GetWorkerCount();
 
-    // System Info
-    ttapi_worker_count = pi.n_cores;
-    SetPriorityClass(GetCurrentProcess(), REALTIME_PRIORITY_CLASS);
-    DWORD dwNumIter;
-    volatile DWORD dwDummy = 1;
-    LARGE_INTEGER liFrequency, liStart, liEnd;
-    QueryPerformanceFrequency(&liFrequency);
-    // Get fast spin-loop timings
-    dwNumIter = 100000000;
-    QueryPerformanceCounter(&liStart);
-    for (DWORD i = 0; i < dwNumIter; ++i)
-    {
-        if (!dwDummy)
-            goto process1;
-		_mm_pause(); // __asm pause;
-    }
-process1:
-    QueryPerformanceCounter(&liEnd);
-    // We want 1/25 (40ms) fast spin-loop
-    ttapi_dwFastIter = DWORD((dwNumIter * liFrequency.QuadPart) / ((liEnd.QuadPart - liStart.QuadPart) * 25));
-    // Get slow spin-loop timings
-    dwNumIter = 10000000;
-    QueryPerformanceCounter(&liStart);
-    for (DWORD i = 0; i < dwNumIter; ++i)
-    {
-        if (!dwDummy)
-            goto process2;
-        SwitchToThread();
-    }
-process2:
-    QueryPerformanceCounter(&liEnd);
-    // We want 1/2 (500ms) slow spin-loop
-    ttapi_dwSlowIter = DWORD((dwNumIter * liFrequency.QuadPart) / ((liEnd.QuadPart - liStart.QuadPart) * 2));
-    SetPriorityClass(GetCurrentProcess(), NORMAL_PRIORITY_CLASS);
+    DWORD workerCount = pi.n_cores;
     // Check for override from command line
     char szSearchFor[] = "-max-threads";
     char* pszTemp = strstr(GetCommandLine(), szSearchFor);
     DWORD dwOverride = 0;
     if (pszTemp && sscanf_s(pszTemp + strlen(szSearchFor), "%u", &dwOverride))
     {
-        if (dwOverride >= 1 && dwOverride < ttapi_worker_count)
-            ttapi_worker_count = dwOverride;
-    }
-    // Number of helper threads
-    ttapi_thread_count = ttapi_worker_count - 1;
-
-    // Creating control structures
-    if ((ttapi_threads_handles = (LPHANDLE)malloc(sizeof(HANDLE) * ttapi_thread_count)) == NULL)
-        return 0;
-    if ((ttapi_worker_params = (PTTAPI_WORKER_PARAMS)malloc(sizeof(TTAPI_WORKER_PARAMS) * ttapi_worker_count)) == NULL)
-        return 0;
-    // Clearing params
-    for (DWORD i = 0; i < ttapi_worker_count; i++)
-        ttapi_worker_params[i] = {};
-    char szThreadName[64];
-    DWORD dwThreadId = 0;
-    DWORD dwAffinitiMask = pi.affinity_mask;
-    DWORD dwCurrentMask = 0x01;
-    // Setting affinity
-    while (!(dwAffinitiMask & dwCurrentMask))
-        dwCurrentMask <<= 1;
-    SetThreadAffinityMask(GetCurrentThread(), dwCurrentMask);
-    // Creating threads
-    for (DWORD i = 0; i < ttapi_thread_count; i++)
-    {
-        // Initializing "enter" "critical section"
-        ttapi_worker_params[i].vlFlag = 1;
-        ttapi_threads_handles[i] = CreateThread(NULL, 0, &ttapiThreadProc, &ttapi_worker_params[i], 0, &dwThreadId);
-        if (!ttapi_threads_handles[i])
-            return 0;
-        // Setting affinity
-        do
-        {
-            dwCurrentMask <<= 1;
-        } while (!(dwAffinitiMask & dwCurrentMask));
-        SetThreadAffinityMask(ttapi_threads_handles[i], dwCurrentMask);
-        // Setting thread name
-        sprintf_s(szThreadName, "Helper Thread #%u", i);
-        SetThreadName(dwThreadId, szThreadName);
+        if (dwOverride >= 1 && dwOverride < workerCount)
+            workerCount = dwOverride;
     }
-    ttapi_initialized = true;
-    return ttapi_worker_count;
+    TaskScheduler.Initialize(workerCount);
+    return TaskScheduler.GetWorkerCount();
 }
 
-int ttapi_GetWorkerCount() { return ttapi_worker_count; }
+int ttapi_GetWorkerCount() { return TaskScheduler.GetWorkerCount(); }
 // We do not check for overflow here to be faster
 // Assume that caller is smart enough to use ttapi_GetWorkersCount() to get number of available slots
 void ttapi_AddWorker(TTAPIWorkerFunc lpWorkerFunc, void* lpvWorkerFuncParams)
 {
+    VERIFY(ttapi_assigned_workers < TTAPI_HARDCODED_THREADS);
     // Assigning parameters
     ttapi_worker_params[ttapi_assigned_workers].lpWorkerFunc = lpWorkerFunc;
     ttapi_worker_params[ttapi_assigned_workers].lpvWorkerFuncParams = lpvWorkerFuncParams;
@@ -211,50 +49,30 @@ void ttapi_AddWorker(TTAPIWorkerFunc lpWorkerFunc, void* lpvWorkerFuncParams)
 
 void ttapi_Run()
 {
-    DWORD workerCount = (ttapi_assigned_workers - 1);
-    if (workerCount)
+    const DWORD workerCount = ttapi_assigned_workers;
+    // Cleaning active workers count before running, workers may use ttapi themselves
+    ttapi_assigned_workers = 0;
+    if (!workerCount)
+        return;
+    if (workerCount == 1)
     {
-        // Setting queue size
-        ttapi_queue_size.size = workerCount;
-        // Starting all workers except the last
-        for (DWORD i = 0; i < workerCount; ++i)
-            _InterlockedExchange(&ttapi_worker_params[i].vlFlag, 0);
-        // Running last worker in current thread
-        ttapi_worker_params[workerCount].lpWorkerFunc(ttapi_worker_params[workerCount].lpvWorkerFuncParams);
-        // Waiting task queue to become empty
-        // Start = __rdtsc();
-		while (ttapi_queue_size.size) 
-			_mm_pause();
-          //  __asm pause;
-        // Stop = __rdtsc();
-        // Msg( "Wait: %u ticks" , Stop - Start );
-    }
-    else
         // Running the only worker in current thread
-        ttapi_worker_params[workerCount].lpWorkerFunc(ttapi_worker_params[workerCount].lpvWorkerFuncParams);
-    // Cleaning active workers count
-    ttapi_assigned_workers = 0;
-}
-
-void ttapi_Done()
-{
-    if (!ttapi_initialized)
+        ttapi_worker_params[0].lpWorkerFunc(ttapi_worker_params[0].lpvWorkerFuncParams);
         return;
-    // Asking helper threads to terminate
-    for (DWORD i = 0; i < ttapi_thread_count; i++)
+    }
+    TTAPI_WORKER_PARAMS* params = (TTAPI_WORKER_PARAMS*)_alloca(sizeof(TTAPI_WORKER_PARAMS) * workerCount);
+    CopyMemory(params, ttapi_worker_params, sizeof(TTAPI_WORKER_PARAMS) * workerCount);
+    // Every added worker becomes a child task, idle threads steal them
+    Task* root = TaskScheduler.CreateTask();
+    for (DWORD i = 0; i < workerCount; ++i)
     {
-        ttapi_worker_params[i].lpWorkerFunc = NULL;
-        _InterlockedExchange(&ttapi_worker_params[i].vlFlag, 0);
+        TTAPI_WORKER_PARAMS& worker = params[i];
+        TaskScheduler.Run(*TaskScheduler.CreateTask([&worker](Task&)
+        {
+            worker.lpWorkerFunc(worker.lpvWorkerFuncParams);
+        }, root));
     }
-    // Waiting threads for completion
-    WaitForMultipleObjects(ttapi_thread_count, ttapi_threads_handles, TRUE, INFINITE);
-    // Freeing resources
-    free(ttapi_threads_handles);
-    ttapi_threads_handles = nullptr;
-    free(ttapi_worker_params);
-    ttapi_worker_params = nullptr;
-    ttapi_worker_count = 0;
-    ttapi_thread_count = 0;
-    ttapi_assigned_workers = 0;
-    ttapi_initialized = false;
+    TaskScheduler.RunAndWait(*root);
 }
+
+void ttapi_Done() { TaskScheduler.Destroy(); }
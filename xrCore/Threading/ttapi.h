@@ -1,6 +1,8 @@
 #pragma once
 #include "xrCore/xrCore.h"
 // Trivial (and dumb) Threads API
+// Kept for compatibility, it is a thin fork/join shim over TaskScheduler (see TaskManager.hpp).
+// New code should spawn tasks or use TaskScheduler.ParallelFor directly.
 
 using TTAPIWorkerFunc = void (*)(void* lpWorkerParameters);
 
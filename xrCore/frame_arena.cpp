@@ -0,0 +1,114 @@
+#include "stdafx.h"
+#pragma hdrstop
+
+#include "frame_arena.h"
+
+XRCORE_API frame_arena g_frame_arena;
+
+namespace
+{
+struct arena_chunk
+{
+    arena_chunk* next;
+    size_t size;
+    // data follows
+};
+
+// Chunks of one frame parity, reused from the start when the parity comes around again
+struct arena_buffer
+{
+    arena_chunk* first;
+    arena_chunk* current;
+    size_t offset;
+
+    void rewind()
+    {
+        current = first;
+        offset = sizeof(arena_chunk);
+    }
+
+    void release()
+    {
+        while (first)
+        {
+            arena_chunk* next = first->next;
+            xr_free(first);
+            first = next;
+        }
+        current = 0;
+        offset = 0;
+    }
+
+    static arena_chunk* create_chunk(size_t size)
+    {
+        arena_chunk* chunk = (arena_chunk*)xr_malloc(size);
+        chunk->next = 0;
+        chunk->size = size;
+        return chunk;
+    }
+
+    void* alloc(size_t size, size_t align)
+    {
+        while (current)
+        {
+            size_t start = (size_t(current) + offset + align - 1) & ~(align - 1);
+            if (start + size <= size_t(current) + current->size)
+            {
+                offset = start + size - size_t(current);
+                return (void*)start;
+            }
+            // reuse the next chunk kept from earlier frames, if any
+            if (!current->next)
+                break;
+            current = current->next;
+            offset = sizeof(arena_chunk);
+        }
+        // oversized requests get a chunk of their own
+        size_t need = sizeof(arena_chunk) + size + align;
+        arena_chunk* chunk = create_chunk(need > frame_arena::chunk_size ? need : frame_arena::chunk_size);
+        if (current)
+        {
+            chunk->next = current->next;
+            current->next = chunk;
+        }
+        else
+            first = chunk;
+        current = chunk;
+        offset = sizeof(arena_chunk);
+        return alloc(size, align);
+    }
+};
+
+struct arena_thread_state
+{
+    arena_buffer buffers[2];
+    u32 frame;
+    bool used;
+
+    ~arena_thread_state()
+    {
+        buffers[0].release();
+        buffers[1].release();
+    }
+};
+
+thread_local arena_thread_state thread_state;
+}
+
+void* frame_arena::alloc(size_t size, size_t align)
+{
+    VERIFY(align && !(align & (align - 1)));
+    arena_thread_state& state = thread_state;
+    const u32 current = frame();
+    if (!state.used || state.frame != current)
+    {
+        // buffer of this parity was last used two (or more) frames ago, its data is dead now
+        const bool skipped = !state.used || current - state.frame >= 2;
+        state.buffers[current & 1].rewind();
+        if (skipped)
+            state.buffers[(current + 1) & 1].rewind();
+        state.frame = current;
+        state.used = true;
+    }
+    return state.buffers[current & 1].alloc(size ? size : 1, align);
+}
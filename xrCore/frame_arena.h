@@ -0,0 +1,108 @@
+#ifndef FRAME_ARENA_H_INCLUDED
+#define FRAME_ARENA_H_INCLUDED
+#pragma once
+
+#include <atomic>
+
+// Per-thread bump allocator for transient per-frame data.
+// Every thread allocates from its own chunks without locking, memory is never freed
+// individually. CRenderDevice calls next_frame() at the end of each frame; memory
+// allocated during frame N stays valid until the end of frame N+1, so results can be
+// handed over to the next frame (e.g. bullet events), but nothing may live longer.
+class XRCORE_API frame_arena
+{
+public:
+    static const u32 chunk_size = 256 * 1024;
+
+    frame_arena() : m_frame(0) {}
+    void* alloc(size_t size, size_t align = 16);
+    void next_frame() { ++m_frame; }
+    u32 frame() const { return m_frame.load(std::memory_order_relaxed); }
+private:
+    std::atomic<u32> m_frame;
+};
+
+extern XRCORE_API frame_arena g_frame_arena;
+
+template <class T>
+class frame_alloc
+{
+public:
+    typedef size_t size_type;
+    typedef ptrdiff_t difference_type;
+    typedef T* pointer;
+    typedef const T* const_pointer;
+    typedef T& reference;
+    typedef const T& const_reference;
+    typedef T value_type;
+
+public:
+    template <class _Other>
+    struct rebind
+    {
+        typedef frame_alloc<_Other> other;
+    };
+
+public:
+    pointer address(reference _Val) const { return (&_Val); }
+    const_pointer address(const_reference _Val) const { return (&_Val); }
+    frame_alloc() {}
+    frame_alloc(const frame_alloc<T>&) {}
+    template <class _Other>
+    frame_alloc(const frame_alloc<_Other>&)
+    {
+    }
+    template <class _Other>
+    frame_alloc<T>& operator=(const frame_alloc<_Other>&)
+    {
+        return (*this);
+    }
+    pointer allocate(size_type n, const void* p = 0) const
+    {
+        return (T*)g_frame_arena.alloc(sizeof(T) * n, __alignof(T) > 16 ? __alignof(T) : 16);
+    }
+    // memory goes back at frame end
+    void deallocate(pointer p, size_type n) const {}
+    void deallocate(void* p, size_type n) const {}
+    char* __charalloc(size_type n) { return (char*)allocate(n); }
+    void construct(pointer p, const T& _Val) { new ((void*)p) T(_Val); }
+    void destroy(pointer p) { p->~T(); }
+    size_type max_size() const
+    {
+        size_type _Count = (size_type)(-1) / sizeof(T);
+        return (0 < _Count ? _Count : 1);
+    }
+};
+
+template <class _Ty, class _Other>
+inline bool operator==(const frame_alloc<_Ty>&, const frame_alloc<_Other>&)
+{
+    return (true);
+}
+template <class _Ty, class _Other>
+inline bool operator!=(const frame_alloc<_Ty>&, const frame_alloc<_Other>&)
+{
+    return (false);
+}
+
+// for FixedMap/FixedSet
+struct frame_allocator
+{
+    template <typename T>
+    struct helper
+    {
+        typedef frame_alloc<T> result;
+    };
+
+    static void* alloc(const u32& n) { return g_frame_arena.alloc(n); }
+    template <typename T>
+    static void dealloc(T*& p)
+    {
+        p = 0;
+    }
+};
+
+template <typename T>
+using frame_vector = xr_vector<T, frame_alloc<T>>;
+
+#endif // FRAME_ARENA_H_INCLUDED
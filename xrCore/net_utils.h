@@ -347,4 +347,39 @@ public:
 
 #pragma pack(pop)
 
+// Packet kept for a while (queues, delayed messages) in a pooled buffer of the smallest size class which fits
+// it, rather than in the whole NET_PacketSizeLimit of a NET_Packet. It is moved, never copied, and unpacked
+// to a NET_Packet to be read. The pool takes larger buffers too, the net transport datagrams carry a packet
+// of NET_PacketSizeLimit with the headers
+const u32 NET_PooledPacketSizeLimit = 2 * NET_PacketSizeLimit;
+
+class XRCORE_API NET_PooledPacket
+{
+    u8* m_data;
+    u32 m_size;
+    u32 m_size_class;
+    u32 m_r_pos;
+    u32 m_time_receive;
+
+public:
+    NET_PooledPacket();
+    NET_PooledPacket(NET_PooledPacket&& other);
+    ~NET_PooledPacket();
+    NET_PooledPacket& operator=(NET_PooledPacket&& other);
+
+    NET_PooledPacket(const NET_PooledPacket&) = delete;
+    NET_PooledPacket& operator=(const NET_PooledPacket&) = delete;
+
+    void assign(const void* data, u32 size, u32 time_receive);
+    void assign(const NET_Packet& P);
+    // restores the data, the read position and the receive time
+    void unpack(NET_Packet& P) const;
+    void clear();
+
+    IC u32 size() const { return m_size; }
+    IC const u8* data() const { return m_data; }
+    // buffers of the pool, both taken by the packets and kept for reuse
+    static void pool_stats(u32& buffer_count, u32& free_count, u32& memory);
+};
+
 #endif /*_INCDEF_NETUTILS_H_*/
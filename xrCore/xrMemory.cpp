@@ -135,6 +135,36 @@ void xrMemory::mem_compact()
         SetProcessWorkingSetSize(GetCurrentProcess(), size_t(-1), size_t(-1));
 }
 
+u32 xrMemory::mem_pool_stats(MEMPOOL_STATS* stats)
+{
+    for (u32 k = 0; k < mem_pools_count; ++k)
+        mem_pools[k].get_stats(stats[k]);
+    return mem_pools_count;
+}
+
+void xrMemory::mem_pool_statistic()
+{
+    MEMPOOL_STATS stats[mem_pools_count];
+    mem_pool_stats(stats);
+    u64 hits = 0, misses = 0, flushes = 0;
+    Msg("* memory pools: element, sectors, hits, refills, flushes, hit ratio");
+    for (u32 k = 0; k < mem_pools_count; ++k)
+    {
+        const MEMPOOL_STATS& S = stats[k];
+        const u64 total = S.hits + S.misses;
+        if (!total)
+            continue;
+        Msg("- %4db: %4d %12I64u %10I64u %10I64u %6.2f%%", S.element, S.blocks, S.hits, S.misses, S.flushes,
+            100.0 * double(S.hits) / double(total));
+        hits += S.hits;
+        misses += S.misses;
+        flushes += S.flushes;
+    }
+    const u64 total = hits + misses;
+    Msg("* total: hits %I64u, pool locks %I64u, hit ratio %2.2f%%", hits, misses + flushes,
+        total ? 100.0 * double(hits) / double(total) : 0.0);
+}
+
 #ifdef DEBUG_MEMORY_MANAGER
 ICF u8* acc_header(void* P)
 {
@@ -70,6 +70,10 @@ public:
 
     size_t mem_usage();
     void mem_compact();
+    // Small-block pool counters, stats must have room for mem_pools_count entries;
+    // returns the number of pools filled in
+    u32 mem_pool_stats(MEMPOOL_STATS* stats);
+    void mem_pool_statistic();
     void mem_counter_set(u32 _val) { stat_counter = _val; }
     u32 mem_counter_get() { return stat_counter; }
 #ifdef DEBUG_MEMORY_NAME
@@ -29,4 +29,126 @@ void MEMPOOL::_initialize(u32 _element, u32 _sector, u32 _header)
     s_offset = _header;
     list = NULL;
     block_count = 0;
+    stat_hits = 0;
+    stat_misses = 0;
+    stat_flushes = 0;
+}
+
+void MEMPOOL::create_batch(void** dest, u32 count, u32 hits)
+{
+    cs.Enter();
+    for (u32 it = 0; it < count; it++)
+    {
+        if (0 == list)
+            block_create();
+        dest[it] = list;
+        list = (u8*)*access(list);
+    }
+    stat_hits += hits;
+    stat_misses++;
+    cs.Leave();
+}
+
+void MEMPOOL::destroy_batch(void** src, u32 count, u32 hits)
+{
+    cs.Enter();
+    for (u32 it = 0; it < count; it++)
+    {
+        *access(src[it]) = list;
+        list = (u8*)src[it];
+    }
+    stat_hits += hits;
+    stat_flushes++;
+    cs.Leave();
+}
+
+void MEMPOOL::get_stats(MEMPOOL_STATS& stats)
+{
+    cs.Enter();
+    stats.element = s_element;
+    stats.blocks = block_count;
+    stats.hits = stat_hits;
+    stats.misses = stat_misses;
+    stats.flushes = stat_flushes;
+    cs.Leave();
+}
+
+// Thread-local magazines.
+// Refill takes half a magazine from the pool, overflow returns the older half,
+// so a thread alternating alloc/free at the boundary doesn't bounce on the lock.
+namespace
+{
+const u32 mem_magazine_size = 32;
+const u32 mem_magazine_batch = mem_magazine_size / 2;
+
+struct mem_magazine
+{
+    u32 count;
+    u32 hits;
+    void* items[mem_magazine_size];
+};
+
+struct mem_thread_cache
+{
+    mem_magazine magazines[mem_pools_count];
+    bool destroyed;
+
+    ~mem_thread_cache()
+    {
+        // Return everything, other threads can't reach our magazines
+        for (u32 pid = 0; pid < mem_pools_count; pid++)
+        {
+            mem_magazine& M = magazines[pid];
+            if (M.count || M.hits)
+                mem_pools[pid].destroy_batch(M.items, M.count, M.hits);
+            M.count = 0;
+            M.hits = 0;
+        }
+        destroyed = true;
+    }
+};
+
+thread_local mem_thread_cache thread_cache;
+}
+
+void* MEMPOOL::create()
+{
+    mem_thread_cache& cache = thread_cache;
+    if (cache.destroyed)
+    {
+        void* E;
+        create_batch(&E, 1, 0);
+        return E;
+    }
+    mem_magazine& M = cache.magazines[this - mem_pools];
+    if (0 == M.count)
+    {
+        create_batch(M.items, mem_magazine_batch, M.hits);
+        M.count = mem_magazine_batch;
+        M.hits = 0;
+    }
+    else
+        M.hits++;
+    return M.items[--M.count];
+}
+
+void MEMPOOL::destroy(void*& P)
+{
+    mem_thread_cache& cache = thread_cache;
+    if (cache.destroyed)
+    {
+        destroy_batch(&P, 1, 0);
+        return;
+    }
+    mem_magazine& M = cache.magazines[this - mem_pools];
+    if (mem_magazine_size == M.count)
+    {
+        destroy_batch(M.items, mem_magazine_batch, M.hits);
+        M.count -= mem_magazine_batch;
+        CopyMemory(M.items, M.items + mem_magazine_batch, M.count * sizeof(void*));
+        M.hits = 0;
+    }
+    else
+        M.hits++;
+    M.items[M.count++] = P;
 }
@@ -4,6 +4,18 @@
 
 class xrMemory;
 
+struct MEMPOOL_STATS
+{
+    u32 element; // element size
+    u32 blocks; // allocated sectors
+    u64 hits; // requests served by thread caches without touching the pool
+    u64 misses; // thread cache refills from the pool
+    u64 flushes; // thread cache returns to the pool
+};
+
+// Small-block pool. Every thread keeps a magazine of free elements per pool
+// (see xrMemory_POOL.cpp), the shared free list is only locked to refill or
+// flush a magazine in batches.
 class MEMPOOL
 {
 #ifdef DEBUG_MEMORY_MANAGER
@@ -17,6 +29,9 @@ private:
     u32 s_offset; // header size
     u32 block_count; // block count
     u8* list;
+    u64 stat_hits;
+    u64 stat_misses;
+    u64 stat_flushes;
 
 private:
     ICF void** access(void* P) { return (void**)((void*)(P)); }
@@ -31,23 +46,14 @@ public:
 
     ICF u32 get_block_count() { return block_count; }
     ICF u32 get_element() { return s_element; }
-    ICF void* create()
-    {
-        cs.Enter();
-        if (0 == list)
-            block_create();
-
-        void* E = list;
-        list = (u8*)*access(list);
-        cs.Leave();
-        return E;
-    }
-    ICF void destroy(void*& P)
-    {
-        cs.Enter();
-        *access(P) = list;
-        list = (u8*)P;
-        cs.Leave();
-    }
+    void get_stats(MEMPOOL_STATS& stats);
+
+    // Served by the calling thread's magazine
+    void* create();
+    void destroy(void*& P);
+
+    // Shared free list access, one lock per batch
+    void create_batch(void** dest, u32 count, u32 hits);
+    void destroy_batch(void** src, u32 count, u32 hits);
 };
 #endif
@@ -3,6 +3,7 @@
 #pragma once
 
 #include "_std_extensions.h"
+#include <atomic>
 
 #pragma pack(push, 4)
 //////////////////////////////////////////////////////////////////////////
@@ -13,7 +14,7 @@ typedef const char* str_c;
 #pragma warning(disable : 4200)
 struct XRCORE_API str_value
 {
-    u32 dwReference;
+    std::atomic<u32> dwReference;
     u32 dwLength;
     u32 dwCRC;
     str_value* next;
@@ -36,25 +37,25 @@ struct XRCORE_API str_hash_function
 struct str_container_impl;
 class IWriter;
 //////////////////////////////////////////////////////////////////////////
+// Strings are spread over independently locked shards by CRC, so threads docking
+// different strings rarely contend
 class XRCORE_API str_container
 {
 private:
-    Lock cs;
     str_container_impl* impl;
 
 public:
     str_container();
     ~str_container();
 
+    // Returns value with reference already taken (docked under the shard lock,
+    // so clean() can't free it before the caller gets it)
     str_value* dock(str_c value);
     void clean();
     void dump();
     void dump(IWriter* W);
     void verify();
     u32 stat_economy();
-#ifdef CONFIG_PROFILE_LOCKS
-    str_container() : cs(MUTEX_PROFILE_ID(str_container)) {}
-#endif // CONFIG_PROFILE_LOCKS
 };
 XRCORE_API extern str_container* g_pStringContainer;
 
@@ -70,17 +71,14 @@ protected:
     {
         if (0 == p_)
             return;
-        p_->dwReference--;
-        if (0 == p_->dwReference)
-            p_ = 0;
+        p_->dwReference.fetch_sub(1, std::memory_order_acq_rel);
+        p_ = 0;
     }
 
 public:
     void _set(str_c rhs)
     {
         str_value* v = g_pStringContainer->dock(rhs);
-        if (0 != v)
-            v->dwReference++;
         _dec();
         p_ = v;
     }
@@ -88,7 +86,7 @@ public:
     {
         str_value* v = rhs.p_;
         if (0 != v)
-            v->dwReference++;
+            v->dwReference.fetch_add(1, std::memory_order_relaxed);
         _dec();
         p_ = v;
     }
@@ -73,4 +73,5 @@ void CRenderDevice::DumpStatistics(IGameFont& font, IPerformanceAlert* alert)
     font.OutNext("TPS:          %2.2f M", stats.fTPS);
     if (alert && stats.fFPS < 30)
         alert->Print(font, "FPS       < 30:   %3.1f", stats.fFPS);
+    seqFrameJobs.DumpStatistics(font, alert);
 }
@@ -27,6 +27,7 @@ void CRenderDevice::Destroy(void)
     seqFrameMT.R.clear();
     seqDeviceReset.R.clear();
     seqParallel.clear();
+    seqFrameJobs.Clear();
     xr_delete(Statistic);
 }
 
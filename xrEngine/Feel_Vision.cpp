@@ -5,11 +5,38 @@
 #include "xr_collide_form.h"
 #include "IGame_Level.h"
 #include "xrCDB/Intersect.hpp"
+#include "xrCore/Threading/TaskManager.hpp"
 
 namespace Feel
 {
+// rays traced by a single task of the vision batch
+const u32 batch_grain = 64;
+
+struct SBatchResult
+{
+    float vis; // transparency of the static geometry along the ray
+    int occluder; // nearest opaque triangle or -1
+    BOOL hit;
+};
+
+static bool s_batch = false;
+static xr_vector<Vision*> s_batch_visions;
+static xr_vector<Vision*> s_batch_owners;
+static xr_vector<CDB::RAY> s_batch_rays;
+static xr_vector<SBatchResult> s_batch_results;
+
 Vision::Vision(IGameObject const* owner) : pure_relcase(&Vision::feel_vision_relcase), m_owner(owner) {}
-Vision::~Vision() {}
+Vision::~Vision()
+{
+    s_batch_visions.erase(std::remove(s_batch_visions.begin(), s_batch_visions.end(), this), s_batch_visions.end());
+    for (u32 i = 0; i < s_batch_owners.size(); ++i)
+        if (s_batch_owners[i] == this)
+        {
+            s_batch_owners[i] = 0;
+            s_batch_rays[i].range = 0.f;
+        }
+}
+
 struct SFeelParam
 {
     Vision* parent;
@@ -66,6 +93,7 @@ void Vision::feel_vision_clear()
     query.clear();
     diff.clear();
     feel_visible.clear();
+    m_traces.clear();
 }
 
 void Vision::feel_vision_relcase(IGameObject* object)
@@ -87,6 +115,12 @@ void Vision::feel_vision_relcase(IGameObject* object)
             feel_visible.erase(Ii);
             break;
         }
+    xr_vector<STrace>::iterator It = m_traces.begin();
+    while (It != m_traces.end())
+        if (It->O == object)
+            It = m_traces.erase(It);
+        else
+            ++It;
 }
 
 void Vision::feel_vision_query(Fmatrix& mFull, Fvector& P)
@@ -202,6 +236,31 @@ void Vision::o_trace(Fvector& P, float dt, float vis_threshold)
                     feel_params.vis = 0.f;
                     // Log("cache 1");
                 }
+                else if (s_batch)
+                {
+                    // cache outdated, the query waits for the batch
+                    VERIFY(!fis_zero(D.magnitude()));
+                    if (m_traces.empty())
+                        s_batch_visions.push_back(this);
+
+                    STrace trace;
+                    trace.O = I->O;
+                    trace.P = P;
+                    trace.D = D;
+                    trace.range = f;
+                    trace.dt = dt;
+                    trace.vis_threshold = vis_threshold;
+                    trace.ray = s_batch_rays.size();
+                    m_traces.push_back(trace);
+
+                    CDB::RAY ray;
+                    ray.start = P;
+                    ray.dir = D;
+                    ray.range = f;
+                    s_batch_rays.push_back(ray);
+                    s_batch_owners.push_back(this);
+                    continue;
+                }
                 else
                 {
                     // cache outdated. real query.
@@ -222,54 +281,158 @@ void Vision::o_trace(Fvector& P, float dt, float vis_threshold)
                 }
             }
             // Log("Vis",feel_params.vis);
-            r_spatial.clear_not_free();
-            g_SpatialSpace->q_ray(r_spatial, 0, STYPE_VISIBLEFORAI, P, D, f);
+            o_update(*I, P, D, f, feel_params.vis, dt, vis_threshold);
+        }
+        else
+        {
+            // VISIBLE, 'cause near
+            I->fuzzy += fuzzy_update_vis * dt;
+            clamp(I->fuzzy, -.5f, 1.f);
+        }
+    }
+}
 
-            RD.flags = CDB::OPT_ONLYFIRST;
+void Vision::o_update(
+    feel_visible_Item& item, const Fvector& P, const Fvector& D, float f, float vis, float dt, float vis_threshold)
+{
+    r_spatial.clear_not_free();
+    g_SpatialSpace->q_ray(r_spatial, 0, STYPE_VISIBLEFORAI, P, D, f);
 
-            bool collision_found = false;
-            xr_vector<ISpatial*>::const_iterator i = r_spatial.begin();
-            xr_vector<ISpatial*>::const_iterator e = r_spatial.end();
-            for (; i != e; ++i)
-            {
-                if (*i == m_owner)
-                    continue;
+    collide::ray_defs RD(P, D, f, CDB::OPT_ONLYFIRST,
+        collide::rq_target(collide::rqtStatic | /**/ collide::rqtObject | /**/ collide::rqtObstacle));
 
-                if (*i == I->O)
-                    continue;
+    bool collision_found = false;
+    xr_vector<ISpatial*>::const_iterator i = r_spatial.begin();
+    xr_vector<ISpatial*>::const_iterator e = r_spatial.end();
+    for (; i != e; ++i)
+    {
+        if (*i == m_owner)
+            continue;
 
-                IGameObject const* object = (*i)->dcast_GameObject();
-                RQR.r_clear();
-                if (object && object->GetCForm() && !object->GetCForm()->_RayQuery(RD, RQR))
-                    continue;
+        if (*i == item.O)
+            continue;
 
-                collision_found = true;
-                break;
-            }
+        IGameObject const* object = (*i)->dcast_GameObject();
+        RQR.r_clear();
+        if (object && object->GetCForm() && !object->GetCForm()->_RayQuery(RD, RQR))
+            continue;
 
-            if (collision_found)
-                feel_params.vis = 0.f;
+        collision_found = true;
+        break;
+    }
 
-            if (feel_params.vis < feel_params.vis_threshold)
-            {
-                // INVISIBLE, choose next point
-                I->fuzzy -= fuzzy_update_novis * dt;
-                clamp(I->fuzzy, -.5f, 1.f);
-                I->cp_LP = I->O->get_new_local_point_on_mesh(I->bone_id);
-            }
-            else
-            {
-                // VISIBLE
-                I->fuzzy += fuzzy_update_vis * dt;
-                clamp(I->fuzzy, -.5f, 1.f);
-            }
+    if (collision_found)
+        vis = 0.f;
+
+    if (vis < vis_threshold)
+    {
+        // INVISIBLE, choose next point
+        item.fuzzy -= fuzzy_update_novis * dt;
+        clamp(item.fuzzy, -.5f, 1.f);
+        item.cp_LP = item.O->get_new_local_point_on_mesh(item.bone_id);
+    }
+    else
+    {
+        // VISIBLE
+        item.fuzzy += fuzzy_update_vis * dt;
+        clamp(item.fuzzy, -.5f, 1.f);
+    }
+}
+
+void Vision::o_resolve()
+{
+    xr_vector<STrace>::const_iterator I = m_traces.begin();
+    xr_vector<STrace>::const_iterator E = m_traces.end();
+    for (; I != E; ++I)
+    {
+        xr_vector<feel_visible_Item>::iterator J = feel_visible.begin(), JE = feel_visible.end();
+        for (; (J != JE) && (J->O != I->O); ++J)
+            ;
+        if ((J == JE) || (0 == J->O->GetCForm()))
+            continue;
+
+        const SBatchResult& result = s_batch_results[I->ray];
+        if (result.occluder >= 0)
+        {
+            CDB::TRI* T = g_pGameLevel->ObjectSpace.GetStaticTris() + result.occluder;
+            Fvector* V = g_pGameLevel->ObjectSpace.GetStaticVerts();
+            J->Cache.verts[0].set(V[T->verts[0]]);
+            J->Cache.verts[1].set(V[T->verts[1]]);
+            J->Cache.verts[2].set(V[T->verts[2]]);
         }
-        else
+
+        // the static part is done, the objects are queried only if it left the target visible
+        SFeelParam feel_params(this, &*J, I->vis_threshold);
+        feel_params.vis = result.vis;
+        BOOL hit = result.hit;
+        if (feel_params.vis > feel_params.vis_threshold)
         {
-            // VISIBLE, 'cause near
-            I->fuzzy += fuzzy_update_vis * dt;
-            clamp(I->fuzzy, -.5f, 1.f);
+            collide::ray_defs RD(I->P, I->D, I->range, CDB::OPT_CULL,
+                collide::rq_target(collide::rqtObject | /**/ collide::rqtObstacle));
+            if (g_pGameLevel->ObjectSpace.RayQuery(RQR, RD, feel_vision_callback, &feel_params, NULL, NULL))
+                hit = TRUE;
         }
+
+        if (hit)
+        {
+            J->Cache_vis = feel_params.vis;
+            J->Cache.set(I->P, I->D, I->range, TRUE);
+        }
+        else
+            J->Cache.set(I->P, I->D, I->range, FALSE);
+
+        o_update(*J, I->P, I->D, I->range, feel_params.vis, I->dt, I->vis_threshold);
     }
+    m_traces.clear();
+}
+
+void Vision::feel_vision_batch(bool value) { s_batch = value; }
+void Vision::feel_vision_flush()
+{
+    if (s_batch_visions.empty())
+        return;
+
+    VERIFY(g_pGameLevel);
+    const CDB::MODEL* model = g_pGameLevel->ObjectSpace.GetStaticModel();
+    s_batch_results.resize(s_batch_rays.size());
+
+    TaskScheduler.ParallelFor(0, s_batch_rays.size(), batch_grain, [&](u32 from, u32 to) {
+        CDB::COLLIDER collider;
+        collider.ray_options(CDB::OPT_CULL);
+        collider.ray_packet_query(model, &s_batch_rays[from], to - from);
+        for (u32 i = from; i < to; ++i)
+        {
+            SBatchResult& result = s_batch_results[i];
+            result.vis = 1.f;
+            result.occluder = -1;
+            result.hit = collider.r_ray_count(i - from) > 0;
+            if (!result.hit || !s_batch_owners[i])
+                continue;
+
+            float occluder_range = flt_max;
+            CDB::RESULT* I = collider.r_ray_begin(i - from);
+            CDB::RESULT* E = collider.r_ray_end(i - from);
+            for (; I != E; ++I)
+            {
+                // the static materials are shared, it is safe to ask for them in parallel
+                float vis = s_batch_owners[i]->feel_vision_mtl_transp(NULL, I->id);
+                result.vis *= vis;
+                if (fis_zero(vis) && (I->range < occluder_range))
+                {
+                    occluder_range = I->range;
+                    result.occluder = I->id;
+                }
+            }
+        }
+    });
+
+    xr_vector<Vision*>::const_iterator I = s_batch_visions.begin();
+    xr_vector<Vision*>::const_iterator E = s_batch_visions.end();
+    for (; I != E; ++I)
+        (*I)->o_resolve();
+
+    s_batch_visions.clear();
+    s_batch_owners.clear();
+    s_batch_rays.clear();
 }
 };
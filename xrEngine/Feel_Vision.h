@@ -27,9 +27,23 @@ private:
     xr_vector<ISpatial*> r_spatial;
     IGameObject const* m_owner;
 
+    // trace of a visible item waiting for the vision batch
+    struct STrace
+    {
+        IGameObject* O;
+        Fvector P;
+        Fvector D;
+        float range;
+        float dt;
+        float vis_threshold;
+        u32 ray;
+    };
+    xr_vector<STrace> m_traces;
+
     void o_new(IGameObject* E);
     void o_delete(IGameObject* E);
     void o_trace(Fvector& P, float dt, float vis_threshold);
+    void o_resolve();
 
 public:
     Vision(IGameObject const* owner);
@@ -48,11 +62,25 @@ public:
     };
     xr_vector<feel_visible_Item> feel_visible;
 
+private:
+    void o_update(feel_visible_Item& item, const Fvector& P, const Fvector& D, float f, float vis, float dt,
+        float vis_threshold);
+
 public:
     void feel_vision_clear();
     void feel_vision_query(Fmatrix& mFull, Fvector& P);
     void feel_vision_update(IGameObject* parent, Fvector& P, float dt, float vis_threshold);
     void __stdcall feel_vision_relcase(IGameObject* object);
+
+    // While batching is on, the rays which miss their caches are gathered from all the visions and
+    // traced against the static geometry at once on flush: in SSE packets on the task scheduler.
+    // The dynamic objects are tested and the results are written back on the calling thread.
+    // The flush goes after the scheduler update, so the memory and the visual managers, which read
+    // feel_visible right after feel_vision_update, see the results of the rays queued on the previous
+    // update of the object: the visibility lags by one scheduled update with batching on
+    static void feel_vision_batch(bool value);
+    static void feel_vision_flush();
+
     void feel_vision_get(xr_vector<IGameObject*>& R)
     {
         R.clear();
@@ -0,0 +1,155 @@
+#include "stdafx.h"
+#include "FrameJobGraph.h"
+#include "IGameFont.hpp"
+#include "IPerformanceAlert.hpp"
+#include "xrCore/Threading/TaskManager.hpp"
+
+CFrameJobGraph::CFrameJobGraph() : executing(false) {}
+CFrameJobGraph::~CFrameJobGraph()
+{
+    for (Stage* stage : stages)
+        xr_delete(stage);
+    stages.clear();
+}
+
+CFrameJobGraph::StageId CFrameJobGraph::FindStage(LPCSTR name) const
+{
+    for (u32 i = 0; i < stages.size(); ++i)
+    {
+        if (!xr_strcmp(stages[i]->name, name))
+            return i;
+    }
+    return InvalidStage;
+}
+
+CFrameJobGraph::StageId CFrameJobGraph::RegisterStage(LPCSTR name, std::initializer_list<StageId> dependencies)
+{
+    lock.Enter();
+    StageId id = FindStage(name);
+    if (id != InvalidStage)
+    {
+        lock.Leave();
+        return id;
+    }
+    R_ASSERT2(!executing, "Frame stages can't be registered while the frame graph is executing");
+    R_ASSERT2(dependencies.size() <= MaxDependencies, name);
+    id = StageId(stages.size());
+    Stage* stage = xr_new<Stage>();
+    stage->name = name;
+    stage->dependencyCount = 0;
+    stage->jobCount = 0;
+    stage->pending = 0;
+    for (StageId dependency : dependencies)
+    {
+        // Dependencies must be registered first, this also rules out cycles
+        R_ASSERT2(dependency < id, name);
+        stage->dependencies[stage->dependencyCount++] = dependency;
+        stages[dependency]->dependents.push_back(id);
+    }
+    stages.push_back(stage);
+    lock.Leave();
+    return id;
+}
+
+void CFrameJobGraph::Push(StageId stage, const Job& job)
+{
+    lock.Enter();
+    VERIFY(stage < stages.size());
+    stages[stage]->jobs.push_back(job);
+    lock.Leave();
+}
+
+void CFrameJobGraph::Remove(const Job& job)
+{
+    lock.Enter();
+    for (Stage* stage : stages)
+    {
+        auto it = std::remove(stage->jobs.begin(), stage->jobs.end(), job);
+        stage->jobs.erase(it, stage->jobs.end());
+    }
+    lock.Leave();
+}
+
+bool CFrameJobGraph::Contains(const Job& job)
+{
+    bool result = false;
+    lock.Enter();
+    for (Stage* stage : stages)
+    {
+        if (std::find(stage->jobs.begin(), stage->jobs.end(), job) != stage->jobs.end())
+        {
+            result = true;
+            break;
+        }
+    }
+    lock.Leave();
+    return result;
+}
+
+void CFrameJobGraph::Clear()
+{
+    lock.Enter();
+    for (Stage* stage : stages)
+        stage->jobs.clear();
+    lock.Leave();
+}
+
+void CFrameJobGraph::Spawn(StageId id, Task* root)
+{
+    TaskScheduler.Run(*TaskScheduler.CreateTask([this, id, root](Task&) { RunStage(id, root); }, root));
+}
+
+void CFrameJobGraph::RunStage(StageId id, Task* root)
+{
+    Stage& stage = *stages[id];
+    stage.timer.Begin();
+    for (Job& job : stage.running)
+        job();
+    stage.running.clear_not_free();
+    stage.timer.End();
+    // Release the stages waiting for us, the last finished dependency starts them
+    for (StageId dependent : stage.dependents)
+    {
+        if (--stages[dependent]->pending == 0)
+            Spawn(dependent, root);
+    }
+}
+
+void CFrameJobGraph::Execute()
+{
+    lock.Enter();
+    executing = true;
+    for (Stage* stage : stages)
+    {
+        stage->running.swap(stage->jobs);
+        stage->jobCount = stage->running.size();
+        stage->pending = int(stage->dependencyCount);
+        stage->timer.FrameStart();
+    }
+    lock.Leave();
+
+    Task* root = TaskScheduler.CreateTask();
+    for (StageId id = 0; id < stages.size(); ++id)
+    {
+        if (!stages[id]->dependencyCount)
+            Spawn(id, root);
+    }
+    TaskScheduler.RunAndWait(*root);
+
+    lock.Enter();
+    for (Stage* stage : stages)
+        stage->timer.FrameEnd();
+    executing = false;
+    lock.Leave();
+}
+
+void CFrameJobGraph::DumpStatistics(IGameFont& font, IPerformanceAlert* alert)
+{
+    font.OutNext("Frame jobs:");
+    for (Stage* stage : stages)
+    {
+        font.OutNext("- %-12s %2.2fms, %u jobs", stage->name.c_str(), stage->timer.result, stage->jobCount);
+        if (alert && stage->timer.result > 5.0f)
+            alert->Print(font, "%-9s > 5ms:  %3.1f", stage->name.c_str(), stage->timer.result);
+    }
+}
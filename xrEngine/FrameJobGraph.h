@@ -0,0 +1,64 @@
+#pragma once
+
+#include "xrCore/Threading/Lock.hpp"
+#include <initializer_list>
+
+class IGameFont;
+class IPerformanceAlert;
+class Task;
+
+// Per-frame job graph executed by the secondary thread on the task scheduler.
+// Stages are named and registered once; every frame jobs are pushed into them.
+// Jobs of one stage run in push order on a single worker, stages whose
+// dependencies are done run in parallel with each other.
+class ENGINE_API CFrameJobGraph
+{
+public:
+    using Job = fastdelegate::FastDelegate0<>;
+    using StageId = u32;
+    static const StageId InvalidStage = u32(-1);
+    static const u32 MaxDependencies = 4;
+
+private:
+    struct Stage
+    {
+        shared_str name;
+        StageId dependencies[MaxDependencies];
+        u32 dependencyCount;
+        xr_vector<StageId> dependents;
+        xr_vector<Job> jobs;
+        xr_vector<Job> running;
+        CStatTimer timer;
+        u32 jobCount;
+        // Runtime state, valid during Execute only
+        std::atomic_int pending;
+    };
+
+    xr_vector<Stage*> stages;
+    Lock lock;
+    bool executing;
+
+    void Spawn(StageId id, Task* root);
+    void RunStage(StageId id, Task* root);
+
+public:
+    CFrameJobGraph();
+    ~CFrameJobGraph();
+
+    // Returns existing stage with the same name or registers a new one.
+    // Dependencies are only taken into account on the first registration.
+    StageId RegisterStage(LPCSTR name, std::initializer_list<StageId> dependencies = {});
+    StageId FindStage(LPCSTR name) const;
+
+    // Thread safe. Jobs pushed while the graph is executing run on the next frame.
+    void Push(StageId stage, const Job& job);
+    void Push(LPCSTR stage, const Job& job) { Push(RegisterStage(stage), job); }
+    void Remove(const Job& job);
+    bool Contains(const Job& job);
+    void Clear();
+
+    // Runs all stages and waits for completion
+    void Execute();
+
+    void DumpStatistics(IGameFont& font, IPerformanceAlert* alert);
+};
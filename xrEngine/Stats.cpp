@@ -76,6 +76,8 @@ CStats::CStats()
 {
     statsFont = nullptr;
     fMem_calls = 0;
+    memPoolHits = 0;
+    memPoolLocks = 0;
     Device.seqRender.Add(this, REG_PRIORITY_LOW - 1000);
 }
 
@@ -134,6 +136,18 @@ void CStats::Show()
 #endif
         Device.DumpStatistics(font, alertPtr);
         font.OutNext("Memory:       %2.2f", fMem_calls);
+        {
+            MEMPOOL_STATS poolStats[mem_pools_count];
+            u64 hits = 0, locks = 0;
+            for (u32 i = 0, count = Memory.mem_pool_stats(poolStats); i < count; ++i)
+            {
+                hits += poolStats[i].hits;
+                locks += poolStats[i].misses + poolStats[i].flushes;
+            }
+            font.OutNext("- pools:      %u hits, %u locks", u32(hits - memPoolHits), u32(locks - memPoolLocks));
+            memPoolHits = hits;
+            memPoolLocks = locks;
+        }
         if (g_pGameLevel)
             g_pGameLevel->DumpStatistics(font, alertPtr);
         Engine.Sheduler.DumpStatistics(font, alertPtr);
@@ -15,6 +15,8 @@ class ENGINE_API CStats : public pureRender
 private:
     CGameFont* statsFont;
     float fMem_calls;
+    u64 memPoolHits; // totals at the previous frame
+    u64 memPoolLocks;
     xr_vector<shared_str> errors;
 
 public:
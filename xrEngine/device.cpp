@@ -24,6 +24,8 @@
 #endif // #ifdef INGAME_EDITOR
 
 #include "xrSASH.h"
+#include "xrCore/frame_arena.h"
+#include "profiler.h"
 #include "IGame_Persistent.h"
 #include "xrScriptEngine/ScriptExporter.hpp"
 
@@ -126,14 +128,23 @@ void CRenderDevice::SecondaryThreadProc(void* context)
             device.syncThreadExit.Set();
             return;
         }
-        for (u32 pit = 0; pit < device.seqParallel.size(); pit++)
-            device.seqParallel[pit]();
-        device.seqParallel.clear_not_free();
-        device.seqFrameMT.Process(rp_Frame);
+        device.seqFrameJobs.Push("parallel", CFrameJobGraph::Job(&device, &CRenderDevice::ProcessParallelSequence));
+        device.seqFrameJobs.Push("frame_mt", CFrameJobGraph::Job(&device, &CRenderDevice::ProcessFrameMT));
+        device.seqFrameJobs.Execute();
         device.syncFrameDone.Set();
     }
 }
 
+void CRenderDevice::ProcessParallelSequence()
+{
+    // Legacy jobs rely on running one after another, so they share a single stage
+    for (u32 pit = 0; pit < seqParallel.size(); pit++)
+        seqParallel[pit]();
+    seqParallel.clear_not_free();
+}
+
+void CRenderDevice::ProcessFrameMT() { seqFrameMT.Process(rp_Frame); }
+
 #include "IGame_Level.h"
 void CRenderDevice::PreCache(u32 amount, bool b_draw_loadscreen, bool b_wait_user_input)
 {
@@ -249,6 +260,9 @@ void CRenderDevice::on_idle()
     stats.RenderTotal.accum = renderTotalReal.accum;
 #endif // #ifndef DEDICATED_SERVER
     syncFrameDone.Wait(); // wait until secondary thread finish its job
+    g_frame_arena.next_frame();
+    if (g_profiler)
+        g_profiler->on_frame();
 #ifdef DEDICATED_SERVER
     u32 FrameEndTime = TimerGlobal.GetElapsed_ms();
     u32 FrameTime = (FrameEndTime - FrameStartTime);
@@ -308,6 +322,11 @@ void CRenderDevice::Run()
         u32 time_local = TimerAsync();
         Timer_MM_Delta = time_system - time_local;
     }
+    // Independent stages of the frame, they overlap on the worker threads
+    seqFrameJobs.RegisterStage("render_mt");
+    seqFrameJobs.RegisterStage("bullets");
+    seqFrameJobs.RegisterStage("frame_mt");
+    seqFrameJobs.RegisterStage("parallel");
     // Start all threads
     mt_bMustExit = FALSE;
     thread_spawn(SecondaryThreadProc, "X-RAY Secondary thread", 0, this);
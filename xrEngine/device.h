@@ -14,6 +14,7 @@
 #include "xrCore/ftimer.h"
 #include "stats.h"
 #include "xrCore/Threading/Event.hpp"
+#include "FrameJobGraph.h"
 
 #define VIEWPORT_NEAR 0.2f
 
@@ -174,6 +175,8 @@ public:
     CRegistrator<pureFrame> seqFrameMT;
     CRegistrator<pureDeviceReset> seqDeviceReset;
     xr_vector<fastdelegate::FastDelegate0<>> seqParallel;
+    // Executed by the secondary thread every frame, seqParallel and seqFrameMT are stages of it
+    CFrameJobGraph seqFrameJobs;
 
     Fmatrix mInvFullTransform;
 
@@ -196,6 +199,8 @@ public:
 
 private:
     static void SecondaryThreadProc(void* context);
+    void xr_stdcall ProcessParallelSequence();
+    void xr_stdcall ProcessFrameMT();
 
 public:
     // Scene control
@@ -249,6 +254,7 @@ public:
             std::find(seqParallel.begin(), seqParallel.end(), delegate);
         if (I != seqParallel.end())
             seqParallel.erase(I);
+        seqFrameJobs.Remove(delegate);
     }
 
 private:
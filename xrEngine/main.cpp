@@ -13,6 +13,7 @@
 #include <locale.h>
 #include "xrSASH.h"
 #include "xr_ioc_cmd.h"
+#include "profiler.h"
 
 #ifdef MASTER_GOLD
 #define NO_MULTI_INSTANCES
@@ -40,6 +41,7 @@ void InitEngine()
 {
     Engine.Initialize();
     Device.Initialize();
+    g_profiler = xr_new<CProfiler>();
 }
 
 static void InitEngineExt() { Engine.External.Initialize(); }
@@ -127,6 +129,7 @@ void destroyConsole()
 
 void destroyEngine()
 {
+    xr_delete(g_profiler);
     Device.Destroy();
     Engine.Destroy();
 }
@@ -7,265 +7,510 @@
 ////////////////////////////////////////////////////////////////////////////
 
 #include "stdafx.h"
-// XXX nitrocaster PROFILER: temporarily disabled due to linkage issues
-#if 0
 #include "profiler.h"
+
+#ifdef USE_PROFILER
 #include "xrEngine/GameFont.h"
 
 #ifdef CONFIG_PROFILE_LOCKS
-static volatile LONG					critical_section_counter = 0;
-
-void add_profile_portion				(LPCSTR id, const u64 &time)
+void add_profile_portion(LPCSTR id, const u64& time)
 {
-	if (!*id)
-		return;	
-	if (!psDeviceFlags.test(rsStatistic))
-		return;
-
-	CProfileResultPortion			temp;
-	temp.m_timer_id					= id;
-	temp.m_time						= time;
-	
-	profiler().add_profile_portion	(temp);
+    if (!*id)
+        return;
+
+    CProfileResultPortion temp;
+    temp.m_timer_id = id;
+    temp.m_time = time;
+
+    profiler().add_profile_portion(temp);
 }
 #endif // CONFIG_PROFILE_LOCKS
 
-CProfiler	*g_profiler			= 0;
-LPCSTR		indent				= "  ";
-char		white_character		= '.';
+CProfiler* g_profiler = 0;
+LPCSTR indent = "  ";
+char white_character = '.';
 
-struct CProfilePortionPredicate {
-	IC		bool operator()			(const CProfileResultPortion &_1, const CProfileResultPortion &_2) const
-	{
-		return					(xr_strcmp(_1.m_timer_id,_2.m_timer_id) < 0);
-	}
+// Limits the memory taken by a trace capture, 32 bytes per event
+static const u32 max_trace_events = 4 * 1024 * 1024;
+static u32 s_generation = 0;
+
+struct CProfilerThreadCache
+{
+    u32 generation;
+    CProfiler::CThreadBuffer* buffer;
+
+    ~CProfilerThreadCache()
+    {
+        if (buffer && g_profiler)
+            g_profiler->on_thread_exit(generation, buffer);
+    }
 };
 
-CProfiler::CProfiler				()
-#ifdef CONFIG_PROFILE_LOCKS
-	:m_section("")
-#endif // CONFIG_PROFILE_LOCKS
+static thread_local CProfilerThreadCache s_thread_cache = {0, nullptr};
+
+struct CProfilePortionPredicate
+{
+    IC bool operator()(const CProfileResultPortion& _1, const CProfileResultPortion& _2) const
+    {
+        return (xr_strcmp(_1.m_timer_id, _2.m_timer_id) < 0);
+    }
+};
+
+struct CProfileTracePredicate
+{
+    IC bool operator()(const CProfileTraceEvent& _1, const CProfileTraceEvent& _2) const
+    {
+        if (_1.m_start != _2.m_start)
+            return (_1.m_start < _2.m_start);
+        return (_1.m_depth < _2.m_depth);
+    }
+};
+
+CProfiler::CProfiler()
 {
-	m_actual							= true;
+    for (u32 i = 0; i < max_threads; ++i)
+        m_threads[i] = nullptr;
+    m_thread_count = 0;
+    m_threads_overflow = false;
+    m_generation = ++s_generation;
+    m_stats_enabled = false;
+    m_trace_enabled = false;
+    m_actual = true;
+    m_call_count = 0;
+    m_dropped = 0;
+    m_trace_frames = 0;
+    m_primary_thread_id = GetCurrentThreadId();
+    m_trace_start = 0;
+    m_frame_start = 0;
+    m_trace_file[0] = 0;
 }
 
-CProfiler::~CProfiler				()
+CProfiler::~CProfiler()
 {
 #ifdef CONFIG_PROFILE_LOCKS
-	set_add_profile_portion		(0);
+    set_add_profile_portion(0);
 #endif // CONFIG_PROFILE_LOCKS
+    m_stats_enabled = false;
+    m_trace_enabled = false;
+    const u32 count = _min(m_thread_count.load(), max_threads);
+    for (u32 i = 0; i < count; ++i)
+    {
+        CThreadBuffer* buffer = m_threads[i].load();
+        xr_delete(buffer);
+    }
 }
 
-IC	u32 compute_string_length		(LPCSTR str)
+CProfiler::CThreadBuffer* CProfiler::thread_buffer()
 {
-	LPCSTR						i, j = str;
-	u32							count = 0;
-	while ((i = strchr(j,'/')) != 0) {
-		j = i					= i + 1;
-		++count;
-	}
-	return						(count*xr_strlen(indent) + xr_strlen(j));
+    CProfilerThreadCache& cache = s_thread_cache;
+    if (cache.generation == m_generation)
+        return cache.buffer;
+
+    cache.generation = m_generation;
+    cache.buffer = nullptr;
+
+    CThreadBuffer* buffer = xr_new<CThreadBuffer>();
+    buffer->m_write = 0;
+    buffer->m_read = 0;
+    buffer->m_dropped = 0;
+    buffer->m_exited = false;
+    buffer->m_depth = 0;
+    buffer->m_thread_id = GetCurrentThreadId();
+    for (u32 index = 0; index < max_threads; ++index)
+    {
+        CThreadBuffer* empty = nullptr;
+        if (!m_threads[index].compare_exchange_strong(empty, buffer, std::memory_order_acq_rel))
+            continue;
+        u32 count = m_thread_count.load();
+        while ((count <= index) && !m_thread_count.compare_exchange_weak(count, index + 1))
+            ;
+        cache.buffer = buffer;
+        return buffer;
+    }
+
+    xr_delete(buffer);
+    if (!m_threads_overflow.exchange(true))
+        Msg("! profiler: more than %u threads, the events of the rest are ignored", max_threads);
+    return nullptr;
 }
 
-IC	void CProfiler::convert_string	(LPCSTR str, shared_str &out, u32 max_string_size)
+void CProfiler::on_thread_exit(u32 generation, CThreadBuffer* buffer)
 {
-	string256					m_temp;
-	LPCSTR						i, j = str;
-	u32							count = 0;
-	while ((i = strchr(j,'/')) != 0) {
-		j = i					= i + 1;
-		++count;
-	}
-	xr_strcpy						(m_temp,"");
-	for (u32 k = 0; k<count; ++k)
-		xr_strcat					(m_temp,indent);
-	xr_strcat						(m_temp,j);
-	count						= xr_strlen(m_temp);
-	for ( ; count < max_string_size; ++count)
-		m_temp[count]			= white_character;
-	m_temp[max_string_size]		= 0;
-	out							= m_temp;
+    if (generation == m_generation)
+        buffer->m_exited.store(true, std::memory_order_release);
 }
 
-void CProfiler::setup_timer			(LPCSTR timer_id, const u64 &timer_time, const u32 &call_count)
+void CProfiler::release_exited()
 {
-	string256					m_temp;
-	float						_time = float(timer_time)*1000.f/CPU::qpc_freq;
-	TIMERS::iterator			i = m_timers.find(timer_id);
-	if (i == m_timers.end()) {
-		xr_strcpy					(m_temp,timer_id);
-		LPSTR					j,k = m_temp;
-		while ((j = strchr(k,'/')) != 0) {
-			*j					= 0;
-			TIMERS::iterator	m = m_timers.find(m_temp);
-			if (m == m_timers.end())
-				m_timers.insert	(std::make_pair(shared_str(m_temp),CProfileStats()));
-			*j					= '/';
-			k					= j + 1;
-		}
-		i						= m_timers.insert(std::make_pair(shared_str(timer_id),CProfileStats())).first;
-
-		CProfileStats			&current = (*i).second;
-		current.m_min_time		= _time;
-		current.m_max_time		= _time;
-		current.m_total_time	= _time;
-		current.m_count			= 1;
-		current.m_call_count	= call_count;
-		m_actual				= false;
-	}
-	else {
-		CProfileStats			&current = (*i).second;
-		current.m_min_time		= _min(current.m_min_time,_time);
-		current.m_max_time		= _max(current.m_max_time,_time);
-		current.m_total_time	+= _time;
-		++current.m_count;
-		current.m_call_count	+= call_count;
-	}
-
-	if (_time > (*i).second.m_time)
-		(*i).second.m_time		= _time;
-	else
-		(*i).second.m_time		= .01f*_time + .99f*(*i).second.m_time;
-
-	(*i).second.m_update_time	= Device.dwTimeGlobal;
+    const u32 count = _min(m_thread_count.load(), max_threads);
+    for (u32 i = 0; i < count; ++i)
+    {
+        CThreadBuffer* buffer = m_threads[i].load(std::memory_order_acquire);
+        if (!buffer || !buffer->m_exited.load(std::memory_order_acquire))
+            continue;
+        if (enabled())
+            drain(*buffer);
+        m_threads[i].store(nullptr, std::memory_order_release);
+        xr_delete(buffer);
+    }
 }
 
-void CProfiler::clear				()
+u32 CProfiler::enter_scope()
 {
-#ifdef CONFIG_PROFILE_LOCKS
-	while (InterlockedExchange(&critical_section_counter,1))
-		Sleep					(0);
-#endif // CONFIG_PROFILE_LOCKS
+    CThreadBuffer* buffer = thread_buffer();
+    if (!buffer)
+        return 0;
+    return buffer->m_depth++;
+}
 
-	m_section.Enter				();
-	m_portions.clear			();
-	m_timers.clear				();
-	m_section.Leave				();
+void CProfiler::leave_scope(LPCSTR timer_id, const u64& start, const u32& depth)
+{
+    const u64 finish = CPU::QPC();
+    CThreadBuffer* buffer = thread_buffer();
+    if (!buffer)
+        return;
+    buffer->m_depth = depth;
+
+    const u32 write = buffer->m_write.load(std::memory_order_relaxed);
+    if (write - buffer->m_read.load(std::memory_order_acquire) >= thread_buffer_size)
+    {
+        // The primary thread hasn't drained the buffer yet, e.g. during a long loading
+        buffer->m_dropped.fetch_add(1, std::memory_order_relaxed);
+        return;
+    }
+    CProfileEvent& event = buffer->m_events[write % thread_buffer_size];
+    event.m_timer_id = timer_id;
+    event.m_start = start;
+    event.m_finish = finish;
+    event.m_depth = depth;
+    buffer->m_write.store(write + 1, std::memory_order_release);
+}
 
-	m_call_count				= 0;
+void CProfiler::add_profile_portion(const CProfileResultPortion& profile_portion)
+{
+    if (!enabled())
+        return;
+    const u32 depth = enter_scope();
+    leave_scope(profile_portion.m_timer_id, CPU::QPC() - profile_portion.m_time, depth);
+}
 
-#ifdef CONFIG_PROFILE_LOCKS
-	InterlockedExchange			(&critical_section_counter,0);
-#endif // CONFIG_PROFILE_LOCKS
+void CProfiler::discard_pending()
+{
+    const u32 count = _min(m_thread_count.load(), max_threads);
+    for (u32 i = 0; i < count; ++i)
+    {
+        CThreadBuffer* buffer = m_threads[i].load(std::memory_order_acquire);
+        if (buffer)
+            buffer->m_read.store(buffer->m_write.load(std::memory_order_acquire), std::memory_order_release);
+    }
 }
 
-void CProfiler::show_stats			(IGameFont &font, bool show)
+void CProfiler::drain(CThreadBuffer& buffer)
 {
-	if (!show) {
-#ifdef CONFIG_PROFILE_LOCKS
-		set_add_profile_portion	(0);
-#endif // CONFIG_PROFILE_LOCKS
-		clear					();
-		return;
-	}
+    const u32 read = buffer.m_read.load(std::memory_order_relaxed);
+    const u32 write = buffer.m_write.load(std::memory_order_acquire);
+    for (u32 i = read; i != write; ++i)
+    {
+        const CProfileEvent& event = buffer.m_events[i % thread_buffer_size];
+        push_event(event);
+        if (m_trace_enabled.load(std::memory_order_relaxed) && m_trace.size() < max_trace_events)
+        {
+            CProfileTraceEvent trace_event;
+            static_cast<CProfileEvent&>(trace_event) = event;
+            trace_event.m_thread_id = buffer.m_thread_id;
+            m_trace.push_back(trace_event);
+        }
+    }
+    buffer.m_read.store(write, std::memory_order_release);
+    m_dropped += buffer.m_dropped.exchange(0, std::memory_order_relaxed);
+}
 
-#ifdef CONFIG_PROFILE_LOCKS
-	set_add_profile_portion		(&::add_profile_portion);
-#endif // CONFIG_PROFILE_LOCKS
+void CProfiler::push_event(const CProfileEvent& event)
+{
+    if (!m_stats_enabled.load(std::memory_order_relaxed))
+        return;
+    CProfileResultPortion portion;
+    portion.m_timer_id = event.m_timer_id;
+    portion.m_time = event.m_finish - event.m_start;
+    m_portions.push_back(portion);
+}
 
-	++m_call_count;
+IC u32 compute_string_length(LPCSTR str)
+{
+    LPCSTR i, j = str;
+    u32 count = 0;
+    while ((i = strchr(j, '/')) != 0)
+    {
+        j = i = i + 1;
+        ++count;
+    }
+    return (count * xr_strlen(indent) + xr_strlen(j));
+}
 
-#ifdef CONFIG_PROFILE_LOCKS
-	while (InterlockedExchange(&critical_section_counter,1))
-		Sleep					(0);
-#endif // CONFIG_PROFILE_LOCKS
+IC void CProfiler::convert_string(LPCSTR str, shared_str& out, u32 max_string_size)
+{
+    string256 m_temp;
+    LPCSTR i, j = str;
+    u32 count = 0;
+    while ((i = strchr(j, '/')) != 0)
+    {
+        j = i = i + 1;
+        ++count;
+    }
+    xr_strcpy(m_temp, "");
+    for (u32 k = 0; k < count; ++k)
+        xr_strcat(m_temp, indent);
+    xr_strcat(m_temp, j);
+    count = xr_strlen(m_temp);
+    for (; count < max_string_size; ++count)
+        m_temp[count] = white_character;
+    m_temp[max_string_size] = 0;
+    out = m_temp;
+}
 
-	m_section.Enter				();
-
-	if (!m_portions.empty()) {
-		std::sort				(m_portions.begin(),m_portions.end(),CProfilePortionPredicate());
-		u64						timer_time = 0;
-		u32						call_count = 0;
-
-		PORTIONS::const_iterator	I = m_portions.begin(), J = I;
-		PORTIONS::const_iterator	E = m_portions.end();
-		for ( ; I != E; ++I) {
-			if (xr_strcmp((*I).m_timer_id,(*J).m_timer_id)) {
-				setup_timer		((*J).m_timer_id,timer_time,call_count);
-				timer_time		= 0;
-				call_count		= 0;
-				J				= I;
-			}
-
-			++call_count;
-			timer_time			+= (*I).m_time;
-		}
-		setup_timer				((*J).m_timer_id,timer_time,call_count);
-
-		m_portions.clear		();
-
-		m_section.Leave			();
-
-		if (!m_actual) {
-			u32					max_string_size = 0;
-			TIMERS::iterator	I = m_timers.begin();
-			TIMERS::iterator	E = m_timers.end();
-			for ( ; I != E; ++I)
-				max_string_size	= _max(max_string_size,compute_string_length(*(*I).first));
-
-			I					= m_timers.begin();
-			for ( ; I != E; ++I)
-				convert_string	(*(*I).first,(*I).second.m_name,max_string_size);
-
-			m_actual			= true;
-		}
-	}
-	else
-		m_section.Leave			();
+void CProfiler::setup_timer(LPCSTR timer_id, const u64& timer_time, const u32& call_count)
+{
+    string256 m_temp;
+    float _time = float(timer_time) * 1000.f / CPU::qpc_freq;
+    TIMERS::iterator i = m_timers.find(timer_id);
+    if (i == m_timers.end())
+    {
+        xr_strcpy(m_temp, timer_id);
+        LPSTR j, k = m_temp;
+        while ((j = strchr(k, '/')) != 0)
+        {
+            *j = 0;
+            TIMERS::iterator m = m_timers.find(m_temp);
+            if (m == m_timers.end())
+                m_timers.insert(std::make_pair(shared_str(m_temp), CProfileStats()));
+            *j = '/';
+            k = j + 1;
+        }
+        i = m_timers.insert(std::make_pair(shared_str(timer_id), CProfileStats())).first;
+
+        CProfileStats& current = (*i).second;
+        current.m_min_time = _time;
+        current.m_max_time = _time;
+        current.m_total_time = _time;
+        current.m_count = 1;
+        current.m_call_count = call_count;
+        m_actual = false;
+    }
+    else
+    {
+        CProfileStats& current = (*i).second;
+        current.m_min_time = _min(current.m_min_time, _time);
+        current.m_max_time = _max(current.m_max_time, _time);
+        current.m_total_time += _time;
+        ++current.m_count;
+        current.m_call_count += call_count;
+    }
+
+    if (_time > (*i).second.m_time)
+        (*i).second.m_time = _time;
+    else
+        (*i).second.m_time = .01f * _time + .99f * (*i).second.m_time;
+
+    (*i).second.m_update_time = Device.dwTimeGlobal;
+}
 
+void CProfiler::on_frame()
+{
+    release_exited();
+    if (!enabled())
+        return;
+
+    const u64 frame_finish = CPU::QPC();
+    const u32 count = _min(m_thread_count.load(), max_threads);
+    for (u32 i = 0; i < count; ++i)
+    {
+        // Slot may still be empty if its thread is in the middle of registration
+        CThreadBuffer* buffer = m_threads[i].load(std::memory_order_acquire);
+        if (buffer)
+            drain(*buffer);
+    }
+
+    if (m_trace_enabled.load(std::memory_order_relaxed))
+    {
+        CProfileTraceEvent frame;
+        frame.m_timer_id = "frame";
+        frame.m_start = m_frame_start;
+        frame.m_finish = frame_finish;
+        frame.m_depth = 0;
+        frame.m_thread_id = m_primary_thread_id;
+        m_trace.push_back(frame);
+        m_frame_start = frame_finish;
+        if (!--m_trace_frames)
+        {
+            m_trace_enabled = false;
+            save_trace();
+        }
+    }
+
+    if (!m_stats_enabled.load(std::memory_order_relaxed) || m_portions.empty())
+        return;
+
+    ++m_call_count;
+    std::sort(m_portions.begin(), m_portions.end(), CProfilePortionPredicate());
+    u64 timer_time = 0;
+    u32 call_count = 0;
+
+    PORTIONS::const_iterator I = m_portions.begin(), J = I;
+    PORTIONS::const_iterator E = m_portions.end();
+    for (; I != E; ++I)
+    {
+        if (xr_strcmp((*I).m_timer_id, (*J).m_timer_id))
+        {
+            setup_timer((*J).m_timer_id, timer_time, call_count);
+            timer_time = 0;
+            call_count = 0;
+            J = I;
+        }
+
+        ++call_count;
+        timer_time += (*I).m_time;
+    }
+    setup_timer((*J).m_timer_id, timer_time, call_count);
+
+    m_portions.clear();
+
+    if (!m_actual)
+    {
+        u32 max_string_size = 0;
+        TIMERS::iterator I = m_timers.begin();
+        TIMERS::iterator E = m_timers.end();
+        for (; I != E; ++I)
+            max_string_size = _max(max_string_size, compute_string_length(*(*I).first));
+
+        I = m_timers.begin();
+        for (; I != E; ++I)
+            convert_string(*(*I).first, (*I).second.m_name, max_string_size);
+
+        m_actual = true;
+    }
+}
+
+void CProfiler::clear()
+{
+    if (!m_stats_enabled.load(std::memory_order_relaxed))
+        return;
 #ifdef CONFIG_PROFILE_LOCKS
-	InterlockedExchange			(&critical_section_counter,0);
+    set_add_profile_portion(0);
 #endif // CONFIG_PROFILE_LOCKS
-
-	TIMERS::iterator			I = m_timers.begin();
-	TIMERS::iterator			E = m_timers.end();
-	for ( ; I != E; ++I) {
-		if ((*I).second.m_update_time != Device.dwTimeGlobal)
-			(*I).second.m_time	*= .99f;
-
-		float					average = (*I).second.m_count ? (*I).second.m_total_time/float((*I).second.m_count) : 0.f;
-		if (average >= (*I).second.m_time)
-			font.SetColor	(color_xrgb(127,127,127));
-		else
-			font.SetColor	(color_xrgb(255,255,255));
-
-		font.OutNext		(
-//			"%s.. %8.3f %8.3f %8.3f %8.3f %8.3f %8d %12.3f",
-			"%s%c%c %8.3f %8.3f %8.3f %6.1f %8d %12.3f",
-			*(*I).second.m_name,
-			white_character,
-			white_character,
-			(*I).second.m_time,
-			average,
-			(*I).second.m_max_time,
-			float((*I).second.m_call_count)/m_call_count,//float((*I).second.m_count),
-//			(*I).second.m_min_time,
-			(*I).second.m_call_count,
-			(*I).second.m_total_time
-		);
-	}
-
-	font.SetColor			(color_xrgb(255,255,255));
+    m_stats_enabled = false;
+    m_portions.clear();
+    m_timers.clear();
+    m_call_count = 0;
+    m_dropped = 0;
 }
 
-void CProfiler::add_profile_portion	(const CProfileResultPortion &profile_portion)
+void CProfiler::show_stats(IGameFont& font, bool show)
 {
+    if (!show)
+    {
+        clear();
+        return;
+    }
+
+    if (!m_stats_enabled.load(std::memory_order_relaxed))
+    {
+        // Events pushed before the stats were requested belong to some trace capture
+        if (!tracing())
+            discard_pending();
+        m_stats_enabled = true;
 #ifdef CONFIG_PROFILE_LOCKS
-	if (InterlockedExchange(&critical_section_counter,1))
-		return;
-
-	do {
-		Sleep					(0);
-	}
-	while (!InterlockedExchange(&critical_section_counter,1));
+        set_add_profile_portion(&::add_profile_portion);
 #endif // CONFIG_PROFILE_LOCKS
+    }
+
+    if (m_dropped)
+        font.OutNext("profiler: %u events dropped", m_dropped);
+
+    TIMERS::iterator I = m_timers.begin();
+    TIMERS::iterator E = m_timers.end();
+    for (; I != E; ++I)
+    {
+        if ((*I).second.m_update_time != Device.dwTimeGlobal)
+            (*I).second.m_time *= .99f;
+
+        float average = (*I).second.m_count ? (*I).second.m_total_time / float((*I).second.m_count) : 0.f;
+        if (average >= (*I).second.m_time)
+            font.SetColor(color_xrgb(127, 127, 127));
+        else
+            font.SetColor(color_xrgb(255, 255, 255));
+
+        font.OutNext("%s%c%c %8.3f %8.3f %8.3f %8.3f %6.1f %8d %12.3f", *(*I).second.m_name, white_character,
+            white_character, (*I).second.m_time, average, (*I).second.m_min_time, (*I).second.m_max_time,
+            m_call_count ? float((*I).second.m_call_count) / m_call_count : 0.f, (*I).second.m_call_count,
+            (*I).second.m_total_time);
+    }
+
+    font.SetColor(color_xrgb(255, 255, 255));
+}
 
-	m_section.Enter				();
-	m_portions.push_back		(profile_portion);
-	m_section.Leave				();
+void CProfiler::start_trace(u32 frames, LPCSTR file_name)
+{
+    if (tracing())
+    {
+        Msg("! profiler: trace to [%s] is already being recorded", m_trace_file);
+        return;
+    }
+    FS.update_path(m_trace_file, "$logs$", file_name);
+    if (!m_stats_enabled.load(std::memory_order_relaxed))
+        discard_pending();
+    m_trace.clear();
+    m_trace_frames = _max(frames, 1u);
+    m_trace_start = CPU::QPC();
+    m_frame_start = m_trace_start;
+    m_trace_enabled = true;
+    Msg("* profiler: recording %u frames to [%s]", m_trace_frames, m_trace_file);
+}
 
-#ifdef CONFIG_PROFILE_LOCKS
-	InterlockedExchange			(&critical_section_counter,0);
-#endif // CONFIG_PROFILE_LOCKS
+static void write_trace_name(IWriter& writer, LPCSTR name)
+{
+    // Timer ids are plain literals, but keep the JSON valid whatever they contain
+    string256 escaped;
+    u32 length = 0;
+    for (LPCSTR i = name; *i && length < sizeof(escaped) - 2; ++i)
+    {
+        if (*i == '"' || *i == '\\')
+            escaped[length++] = '\\';
+        escaped[length++] = *i;
+    }
+    escaped[length] = 0;
+    writer.w_printf("{\"name\":\"%s\",\"cat\":\"xray\",", escaped);
+}
+
+void CProfiler::save_trace()
+{
+    IWriter* writer = FS.w_open(m_trace_file);
+    if (!writer)
+    {
+        Msg("! profiler: can't write trace to [%s]", m_trace_file);
+        TRACE().swap(m_trace);
+        return;
+    }
+
+    std::sort(m_trace.begin(), m_trace.end(), CProfileTracePredicate());
+
+    // Chrome trace event format, timestamps and durations in microseconds
+    const double to_us = 1000000.0 / double(CPU::qpc_freq);
+    writer->w_printf("{\"displayTimeUnit\":\"ms\",\"traceEvents\":[\n");
+    writer->w_printf("{\"name\":\"thread_name\",\"ph\":\"M\",\"pid\":0,\"tid\":%u,\"args\":{\"name\":\"primary\"}}",
+        m_primary_thread_id);
+    for (const CProfileTraceEvent& event : m_trace)
+    {
+        writer->w_printf(",\n");
+        write_trace_name(*writer, event.m_timer_id);
+        const u64 start = event.m_start > m_trace_start ? event.m_start - m_trace_start : 0;
+        const u64 duration = event.m_finish > event.m_start ? event.m_finish - event.m_start : 0;
+        writer->w_printf("\"ph\":\"X\",\"pid\":0,\"tid\":%u,\"ts\":%.3f,\"dur\":%.3f,\"args\":{\"depth\":%u}}",
+            event.m_thread_id, double(start) * to_us, double(duration) * to_us, event.m_depth);
+    }
+    writer->w_printf("\n]}\n");
+    FS.w_close(writer);
+
+    Msg("* profiler: %u events written to [%s]", m_trace.size(), m_trace_file);
+    TRACE().swap(m_trace);
 }
-#endif
+#endif // USE_PROFILER
@@ -8,24 +8,23 @@
 
 #pragma once
 
-// XXX nitrocaster PROFILER: temporarily disabled due to linkage issues
-#define START_PROFILE(a) {
-#define STOP_PROFILE }
-#if 0
 #include "xrCore/xrCore.h"
 #include "xrEngine/Engine.h"
-#include "xrEngine/defines.h"
+
+#include <atomic>
 
 class IGameFont;
 
-#if defined(DEBUG) && !defined(USE_PROFILER)
+// Profile points cost a single flag check while the profiler is idle, so they are
+// compiled in all configurations: dedicated servers are profiled with profile_trace
+#if !defined(USE_PROFILER) && !defined(NO_PROFILER)
 #define USE_PROFILER
 #endif
 
 #ifdef USE_PROFILER
 
 #ifdef CONFIG_PROFILE_LOCKS
-extern void add_profile_portion(LPCSTR id, const u64 &time);
+extern void add_profile_portion(LPCSTR id, const u64& time);
 #endif
 
 #pragma pack(push, 4)
@@ -36,12 +35,30 @@ struct ENGINE_API CProfileResultPortion
 };
 #pragma pack(pop)
 
-struct ENGINE_API CProfilePortion : public CProfileResultPortion
+// Single scope measured on some thread, timestamps are CPU::QPC() ticks
+struct CProfileEvent
+{
+    LPCSTR m_timer_id;
+    u64 m_start;
+    u64 m_finish;
+    u32 m_depth;
+};
+
+struct CProfileTraceEvent : public CProfileEvent
+{
+    u32 m_thread_id;
+};
+
+struct ENGINE_API CProfilePortion
 {
 private:
+    LPCSTR m_timer_id;
+    u64 m_start;
+    u32 m_depth;
     bool enabled = false;
+
 public:
-    inline CProfilePortion(const char *id, bool enableIf = true);
+    inline CProfilePortion(const char* id, bool enableIf = true);
     inline ~CProfilePortion();
 };
 
@@ -59,70 +76,122 @@ struct ENGINE_API CProfileStats
     inline CProfileStats();
 };
 
+// Events are written by the measured threads into their own ring buffers without
+// any locking; the primary thread drains the rings once a frame in on_frame(),
+// aggregates them per timer id and optionally keeps them for a Chrome trace dump.
+// The buffers of exited threads are freed there as well and their slots reused
 class ENGINE_API CProfiler
 {
+public:
+    static const u32 max_threads = 64;
+    static const u32 thread_buffer_size = 16 * 1024;
+
+    struct CThreadBuffer
+    {
+        CProfileEvent m_events[thread_buffer_size];
+        // m_write is advanced by the owner thread only, m_read by the primary thread only
+        std::atomic<u32> m_write;
+        std::atomic<u32> m_read;
+        std::atomic<u32> m_dropped;
+        // set by the owner thread on exit, the primary thread frees the buffer and reuses its slot
+        std::atomic<bool> m_exited;
+        u32 m_depth;
+        u32 m_thread_id;
+    };
+
 private:
     struct pred_rstr
     {
-        bool operator()(const shared_str &lhs, const shared_str &rhs) const
-        { return xr_strcmp(*lhs, *rhs)<0; }
+        bool operator()(const shared_str& lhs, const shared_str& rhs) const { return xr_strcmp(*lhs, *rhs) < 0; }
     };
 
 protected:
     typedef xr_vector<CProfileResultPortion> PORTIONS;
     typedef xr_map<shared_str, CProfileStats, pred_rstr> TIMERS;
+    typedef xr_vector<CProfileTraceEvent> TRACE;
 
 protected:
+    std::atomic<CThreadBuffer*> m_threads[max_threads];
+    std::atomic<u32> m_thread_count; // slots ever used
+    std::atomic<bool> m_threads_overflow; // logged once
+    u32 m_generation;
+    std::atomic<bool> m_stats_enabled;
+    std::atomic<bool> m_trace_enabled;
     PORTIONS m_portions;
     TIMERS m_timers;
     bool m_actual;
-    Lock m_section;
     u32 m_call_count;
+    u32 m_dropped;
+    // Chrome trace capture
+    TRACE m_trace;
+    u32 m_trace_frames;
+    u32 m_primary_thread_id;
+    u64 m_trace_start;
+    u64 m_frame_start;
+    string_path m_trace_file;
 
 protected:
-    void setup_timer(LPCSTR timer_id, const u64 &timer_time, const u32 &call_count);
-    inline void convert_string(LPCSTR str, shared_str &out, u32 max_string_size);
+    CThreadBuffer* thread_buffer();
+    void discard_pending();
+    void release_exited();
+    void drain(CThreadBuffer& buffer);
+    void push_event(const CProfileEvent& event);
+    void setup_timer(LPCSTR timer_id, const u64& timer_time, const u32& call_count);
+    inline void convert_string(LPCSTR str, shared_str& out, u32 max_string_size);
+    void save_trace();
 
 public:
     CProfiler();
     ~CProfiler();
-    void show_stats(IGameFont &font, bool show);
+
+    bool enabled() const
+    {
+        return m_stats_enabled.load(std::memory_order_relaxed) || m_trace_enabled.load(std::memory_order_relaxed);
+    }
+
+    // Called by the measured threads
+    u32 enter_scope();
+    void leave_scope(LPCSTR timer_id, const u64& start, const u32& depth);
+    void add_profile_portion(const CProfileResultPortion& profile_portion);
+    void on_thread_exit(u32 generation, CThreadBuffer* buffer);
+
+    // Called by the primary thread
+    void on_frame();
+    void show_stats(IGameFont& font, bool show);
+    // Drops the aggregated stats and stops collecting them until show_stats() is called again
     void clear();
-    void add_profile_portion(const CProfileResultPortion &profile_portion);
+    // Records the next frames events and writes them to file_name in Chrome trace format
+    void start_trace(u32 frames, LPCSTR file_name);
+    bool tracing() const { return m_trace_enabled.load(std::memory_order_relaxed); }
 };
 
-extern ENGINE_API CProfiler *g_profiler;
+extern ENGINE_API CProfiler* g_profiler;
 
-inline CProfiler &profiler();
+inline CProfiler& profiler();
 
 #define START_PROFILE(...) \
     {                      \
         CProfilePortion __profile_portion__(__VA_ARGS__);
 #define STOP_PROFILE }
 
-inline CProfilePortion::CProfilePortion(const char *id, bool enableIf)
+inline CProfilePortion::CProfilePortion(const char* id, bool enableIf)
 {
-    // XXX: wrap into global xrGame function and pass as enableIf
-    //if (!psAI_Flags.test(aiStats))
-    //    return;
-    if (!enableIf || !psDeviceFlags.test(rsStatistic))
+    if (!enableIf || !g_profiler || !g_profiler->enabled())
         return;
     enabled = true;
     m_timer_id = id;
-    m_time = CPU::QPC();
+    m_depth = profiler().enter_scope();
+    m_start = CPU::QPC();
 }
 
 inline CProfilePortion::~CProfilePortion()
 {
     if (!enabled)
         return;
-    u64 temp = CPU::QPC();
-    m_time = temp - m_time;
-    profiler().add_profile_portion(*this);
+    profiler().leave_scope(m_timer_id, m_start, m_depth);
 }
 
-inline CProfiler &profiler() { return *g_profiler; }
-
+inline CProfiler& profiler() { return *g_profiler; }
 inline CProfileStats::CProfileStats()
 {
     m_update_time = 0;
@@ -136,7 +205,6 @@ inline CProfileStats::CProfileStats()
 }
 
 #else // !USE_PROFILER
-#define START_PROFILE(a) {
+#define START_PROFILE(...) {
 #define STOP_PROFILE }
 #endif
-#endif
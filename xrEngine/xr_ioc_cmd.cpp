@@ -12,10 +12,15 @@
 
 #include "xr_object.h"
 #include "xr_object_list.h"
+#include "profiler.h"
+#include "xrCDB/Frustum.h"
+
+#include <thread>
 
 xr_token* vid_quality_token = NULL;
 
 xr_token vid_bpp_token[] = {{"16", 16}, {"32", 32}, {0, 0}};
+xr_token cdb_engine_token[] = {{"opcode", CDB::ENGINE_OPCODE}, {"flat", CDB::ENGINE_FLAT}, {0, 0}};
 //-----------------------------------------------------------------------
 
 void IConsole_Command::add_to_LRU(shared_str const& arg)
@@ -99,6 +104,228 @@ public:
 };
 #endif // DEBUG_MEMORY_MANAGER
 
+class CCC_MemPoolStat : public IConsole_Command
+{
+public:
+    CCC_MemPoolStat(LPCSTR N) : IConsole_Command(N) { bEmptyArgsHandled = TRUE; };
+    virtual void Execute(LPCSTR args) { Memory.mem_pool_statistic(); }
+};
+
+#ifdef USE_PROFILER
+// Records profile points of the next frames into a Chrome trace (chrome://tracing) file in $logs$
+class CCC_ProfileTrace : public IConsole_Command
+{
+public:
+    CCC_ProfileTrace(LPCSTR N) : IConsole_Command(N) { bEmptyArgsHandled = TRUE; };
+    virtual void Execute(LPCSTR args)
+    {
+        if (!g_profiler)
+            return;
+        u32 frames = 100;
+        string_path file_name = "profile_trace.json";
+        if (args && args[0])
+        {
+            sscanf(args, "%u", &frames);
+            string_path param;
+            if (xr_strlen(_GetItem(args, 1, param, ' ')))
+                xr_strcpy(file_name, param);
+        }
+        g_profiler->start_trace(frames, file_name);
+    }
+    virtual void Info(TInfo& I) { xr_strcpy(I, "[frames] [file name], defaults are 100 profile_trace.json"); }
+};
+#endif // USE_PROFILER
+
+#ifndef MASTER_GOLD
+// Compares scalar CDB ray queries against ray packets on the level CFORM.
+// Rays go in coherent packets from random points, like vision and fire traces do
+class CCC_CDBRayBench : public IConsole_Command
+{
+    static void bench(CDB::MODEL* model, const xr_vector<CDB::RAY>& rays, u32 mode, LPCSTR name)
+    {
+        CDB::COLLIDER collider;
+        collider.ray_options(mode);
+        const u32 count = rays.size();
+
+        // Scalar path, remember the nearest hit of every ray to validate packets
+        xr_vector<float> ranges(count);
+        CTimer timer;
+        timer.Start();
+        for (u32 i = 0; i < count; ++i)
+        {
+            collider.ray_query(model, rays[i].start, rays[i].dir, rays[i].range);
+            ranges[i] = collider.r_count() ? collider.r_begin()->range : -1.f;
+        }
+        const float scalar = timer.GetElapsed_sec();
+
+        timer.Start();
+        for (u32 i = 0; i < count; i += 1024)
+            collider.ray_packet_query(model, &rays[i], _min(count - i, 1024u));
+        const float packets = timer.GetElapsed_sec();
+
+        // Validate the last batch only, the collider keeps results of one query
+        u32 mismatches = 0;
+        const u32 first = ((count - 1) / 1024) * 1024;
+        for (u32 i = 0; i < collider.r_ray_count(); ++i)
+        {
+            const float range = collider.r_ray_count(i) ? collider.r_ray_begin(i)->range : -1.f;
+            if ((range < 0.f) != (ranges[first + i] < 0.f))
+                ++mismatches;
+            else if (!(mode & CDB::OPT_ONLYFIRST) && !fsimilar(range, ranges[first + i], 0.01f))
+                ++mismatches;
+        }
+        Msg("- %-8s scalar %7.3f Mrays/s, packets %7.3f Mrays/s, speedup %2.2fx, %u mismatches", name,
+            float(count) / (scalar * 1000000.f), float(count) / (packets * 1000000.f),
+            packets > 0.f ? scalar / packets : 0.f, mismatches);
+    }
+
+public:
+    CCC_CDBRayBench(LPCSTR N) : IConsole_Command(N) { bEmptyArgsHandled = TRUE; };
+    virtual void Execute(LPCSTR args)
+    {
+        if (!g_pGameLevel)
+        {
+            Log("! level is not loaded");
+            return;
+        }
+        u32 count = 100000;
+        if (args && args[0])
+            sscanf(args, "%u", &count);
+        count = _max(count / CDB::RAY_PACKET_SIZE, 1u) * CDB::RAY_PACKET_SIZE;
+
+        CDB::MODEL* model = g_pGameLevel->ObjectSpace.GetStaticModel();
+        const Fbox& bounds = g_pGameLevel->ObjectSpace.GetBoundingVolume();
+        Fvector center, half;
+        bounds.getcenter(center);
+        bounds.getsize(half);
+        half.mul(0.5f);
+        CRandom random(0x2545f491);
+        xr_vector<CDB::RAY> rays(count);
+        for (u32 i = 0; i < count; i += CDB::RAY_PACKET_SIZE)
+        {
+            Fvector start, axis;
+            start.random_point(half, random).add(center);
+            axis.random_dir(random);
+            for (u32 j = 0; j < CDB::RAY_PACKET_SIZE; ++j)
+            {
+                CDB::RAY& ray = rays[i + j];
+                ray.start = start;
+                ray.dir.random_dir(axis, PI_DIV_8 / 4.f, random);
+                ray.range = 100.f;
+            }
+        }
+
+        Msg("* CDB ray benchmark, %u rays in packets of %u, %u tris", count, CDB::RAY_PACKET_SIZE,
+            model->get_tris_count());
+        bench(model, rays, CDB::OPT_ONLYNEAREST, "nearest");
+        bench(model, rays, CDB::OPT_ONLYFIRST, "first");
+        bench(model, rays, CDB::OPT_CULL | CDB::OPT_ONLYNEAREST, "cull");
+    }
+};
+
+// Builds the level CFORM with every CDB tree engine and compares build time,
+// memory and latency of ray, box and frustum queries
+class CCC_CDBTreeBench : public IConsole_Command
+{
+    struct queries
+    {
+        xr_vector<Fvector> points;
+        xr_vector<Fvector> dirs;
+        xr_vector<CFrustum> frustums;
+    };
+
+    static void bench(CDB::MODEL* level, u32 engine, LPCSTR name, const queries& Q)
+    {
+        CDB::MODEL model;
+        model.set_engine(engine);
+        CTimer timer;
+        timer.Start();
+        model.build(level->get_verts(), level->get_verts_count(), level->get_tris(), level->get_tris_count());
+        const float build = timer.GetElapsed_sec();
+
+        CDB::COLLIDER collider;
+        collider.ray_options(CDB::OPT_ONLYNEAREST);
+        collider.box_options(0);
+        collider.frustum_options(0);
+        const u32 count = Q.points.size();
+        u32 ray_hits = 0, box_hits = 0, frustum_hits = 0;
+
+        timer.Start();
+        for (u32 i = 0; i < count; ++i)
+        {
+            collider.ray_query(&model, Q.points[i], Q.dirs[i], 50.f);
+            ray_hits += collider.r_count();
+        }
+        const float ray = timer.GetElapsed_sec();
+
+        const Fvector box_size = {1.5f, 1.5f, 1.5f};
+        timer.Start();
+        for (u32 i = 0; i < count; ++i)
+        {
+            collider.box_query(&model, Q.points[i], box_size);
+            box_hits += collider.r_count();
+        }
+        const float box = timer.GetElapsed_sec();
+
+        timer.Start();
+        for (const CFrustum& F : Q.frustums)
+        {
+            collider.frustum_query(&model, F);
+            frustum_hits += collider.r_count();
+        }
+        const float frustum = timer.GetElapsed_sec();
+
+        Msg("- %-6s build %5.2fs, %6u K, ray %6.2f us (%u), box %6.2f us (%u), frustum %7.2f us (%u)", name, build,
+            model.memory() / 1024, ray * 1000000.f / count, ray_hits, box * 1000000.f / count, box_hits,
+            frustum * 1000000.f / Q.frustums.size(), frustum_hits);
+    }
+
+public:
+    CCC_CDBTreeBench(LPCSTR N) : IConsole_Command(N) { bEmptyArgsHandled = TRUE; };
+    virtual void Execute(LPCSTR args)
+    {
+        if (!g_pGameLevel)
+        {
+            Log("! level is not loaded");
+            return;
+        }
+        u32 count = 100000;
+        if (args && args[0])
+            sscanf(args, "%u", &count);
+        count = _max(count, 10u);
+
+        CDB::MODEL* level = g_pGameLevel->ObjectSpace.GetStaticModel();
+        const Fbox& bounds = g_pGameLevel->ObjectSpace.GetBoundingVolume();
+        Fvector center, half;
+        bounds.getcenter(center);
+        bounds.getsize(half);
+        half.mul(0.5f);
+        CRandom random(0x2545f491);
+        queries Q;
+        Q.points.resize(count);
+        Q.dirs.resize(count);
+        Q.frustums.resize(count / 10);
+        for (u32 i = 0; i < count; ++i)
+        {
+            Q.points[i].random_point(half, random).add(center);
+            Q.dirs[i].random_dir(random);
+        }
+        Fmatrix projection, view, full;
+        projection.build_projection(deg2rad(90.f), 1.f, 0.1f, 30.f);
+        for (u32 i = 0; i < Q.frustums.size(); ++i)
+        {
+            view.build_camera_dir(Q.points[i], Q.dirs[i], Fvector().set(0.f, 1.f, 0.f));
+            full.mul(projection, view);
+            Q.frustums[i].CreateFromMatrix(full, FRUSTUM_P_ALL);
+        }
+
+        Msg("* CDB tree benchmark, %u tris, %u queries", level->get_tris_count(), count);
+        bench(level, CDB::ENGINE_OPCODE, "opcode", Q);
+        bench(level, CDB::ENGINE_FLAT, "flat", Q);
+    }
+};
+#endif // #ifndef MASTER_GOLD
+
 class CCC_DbgStrCheck : public IConsole_Command
 {
 public:
@@ -113,6 +340,55 @@ public:
     virtual void Execute(LPCSTR args) { g_pStringContainer->dump(); }
 };
 
+// Measures shared_str docking throughput for 1..N threads
+class CCC_DbgStrBench : public IConsole_Command
+{
+    static const u32 string_count = 4096;
+
+    static void dock_strings(const xr_vector<xr_string>* strings, u32 offset, u32 iterations)
+    {
+        shared_str value;
+        const u32 count = strings->size();
+        for (u32 i = 0; i < iterations; ++i)
+            value = (*strings)[(offset + i * 7) % count].c_str();
+    }
+
+public:
+    CCC_DbgStrBench(LPCSTR N) : IConsole_Command(N) { bEmptyArgsHandled = TRUE; };
+    virtual void Execute(LPCSTR args)
+    {
+        u32 iterations = 1000000;
+        if (args && args[0])
+            sscanf(args, "%u", &iterations);
+        xr_vector<xr_string> strings(string_count);
+        string64 temp;
+        for (u32 i = 0; i < string_count; ++i)
+        {
+            xr_sprintf(temp, "str_bench_%u_%x", i, i * 2654435761u);
+            strings[i] = temp;
+        }
+        const u32 max_threads = _max(u32(std::thread::hardware_concurrency()), 1u);
+        Msg("* shared_str dock benchmark, %u docks per thread", iterations);
+        float single = 0.f;
+        for (u32 threads = 1; threads <= max_threads; threads *= 2)
+        {
+            xr_vector<std::thread> workers;
+            CTimer timer;
+            timer.Start();
+            for (u32 i = 0; i < threads; ++i)
+                workers.push_back(std::thread(dock_strings, &strings, i * 131, iterations));
+            for (std::thread& worker : workers)
+                worker.join();
+            const float seconds = timer.GetElapsed_sec();
+            const float rate = float(iterations) * float(threads) / (seconds * 1000000.f);
+            if (threads == 1)
+                single = rate;
+            Msg("- threads[%2u]: %7.3f Mdocks/s, scale %2.2fx", threads, rate, single > 0.f ? rate / single : 0.f);
+        }
+        g_pStringContainer->clean();
+    }
+};
+
 //-----------------------------------------------------------------------
 class CCC_MotionsStat : public IConsole_Command
 {
@@ -674,6 +950,16 @@ void CCC_Register()
     CMD1(CCC_Disconnect, "disconnect");
     CMD1(CCC_SaveCFG, "cfg_save");
     CMD1(CCC_LoadCFG, "cfg_load");
+    CMD1(CCC_MemPoolStat, "stat_mem_pools");
+#ifndef MASTER_GOLD
+    CMD1(CCC_CDBRayBench, "cdb_ray_bench");
+    CMD1(CCC_CDBTreeBench, "cdb_tree_bench");
+#endif // #ifndef MASTER_GOLD
+    // user setting: the tree the level CFORM is built with, takes effect on the next level load
+    CMD3(CCC_Token, "cdb_engine", &CDB::g_tree_engine, cdb_engine_token);
+#ifdef USE_PROFILER
+    CMD1(CCC_ProfileTrace, "profile_trace");
+#endif // USE_PROFILER
 
 #ifdef DEBUG
     CMD1(CCC_MotionsStat, "stat_motions");
@@ -690,6 +976,7 @@ void CCC_Register()
 
     CMD1(CCC_DbgStrCheck, "dbg_str_check");
     CMD1(CCC_DbgStrDump, "dbg_str_dump");
+    CMD1(CCC_DbgStrBench, "dbg_str_bench");
 
     CMD3(CCC_Mask, "mt_sound", &psDeviceFlags, mtSound);
     CMD3(CCC_Mask, "mt_physics", &psDeviceFlags, mtPhysics);
@@ -13,6 +13,8 @@
 #include "game_base_space.h"
 #include "stalker_animation_data_storage.h"
 #include "stalker_velocity_holder.h"
+#include "mt_config.h"
+#include "xrEngine/Feel_Vision.h"
 
 #include "ActorEffector.h"
 #include "actor.h"
@@ -641,7 +643,17 @@ void CGamePersistent::OnFrame()
     __super ::OnFrame();
 
     if (!Device.Paused())
+    {
+        Feel::Vision::feel_vision_batch(!!g_mt_config.test(mtAiVisionBatch));
         Engine.Sheduler.Update();
+        if (g_pGameLevel)
+        {
+            // eye_pp_s2 only queues the batched rays, they are cast here
+            Level().AIStats.VisRayTests.Begin();
+            Feel::Vision::feel_vision_flush();
+            Level().AIStats.VisRayTests.End();
+        }
+    }
 
     // update weathers ambient
     if (!Device.Paused())
@@ -671,9 +683,8 @@ void CGamePersistent::OnFrame()
     }
 
 #ifdef DEBUG
-// XXX nitrocaster PROFILER: temporarily disabled due to linkage issues
-// if ((m_last_stats_frame + 1) < m_frame_counter)
-//	profiler().clear		();
+    if ((m_last_stats_frame + 1) < m_frame_counter)
+        profiler().clear();
 #endif
     UpdateDof();
 }
@@ -730,8 +741,7 @@ void CGamePersistent::DumpStatistics(IGameFont& font, IPerformanceAlert* alert)
 #ifdef DEBUG
 #ifndef _EDITOR
     m_last_stats_frame = m_frame_counter;
-// XXX nitrocaster PROFILER: temporarily disabled due to linkage issues
-// profiler().show_stats(font,!!psAI_Flags.test(aiStats));
+    profiler().show_stats(font, !!psAI_Flags.test(aiStats));
 #endif
 #endif
 }
@@ -48,6 +48,8 @@
 #include "CustomDetector.h"
 #include "xrPhysics/IPHWorld.h"
 #include "xrPhysics/console_vars.h"
+#include "level_path_cache.h"
+#include "mp_bots_load_test.h"
 
 #ifdef DEBUG
 #include "level_debug.h"
@@ -113,6 +115,8 @@ extern CAI_Space* g_ai_space;
 
 CLevel::~CLevel()
 {
+    // the bots of a load test may be connected to the server of the level
+    xr_delete(g_bot_load_test);
     xr_delete(g_player_hud);
     delete_data(hud_zones_list);
     hud_zones_list = nullptr;
@@ -193,6 +197,7 @@ CLevel::~CLevel()
         StopSaveDemo();
     }
     deinit_compression();
+    xr_delete(m_updates_snapshots);
 }
 
 shared_str CLevel::name() const { return map_data.m_name; }
@@ -492,7 +497,7 @@ void CLevel::OnFrame()
                 F->OutNext("OUT: %4d/%4d (%2.1f%%)", S->bytes_out_real, S->bytes_out,
                     100.f * float(S->bytes_out_real) / float(S->bytes_out));
                 F->OutNext("client_2_sever ping: %d", net_Statistic.getPing());
-                F->OutNext("SPS/Sended : %4d/%4d", S->dwBytesPerSec, S->dwBytesSended);
+                F->OutNext("SPS/Sended : %4d/%4d", S->dwBytesPerSec.load(), S->dwBytesSended.load());
                 F->OutNext("sv_urate/cl_urate : %4d/%4d", psNET_ServerUpdate, psNET_ClientUpdate);
                 F->SetColor(color_xrgb(255, 255, 255));
                 struct net_stats_functor
@@ -771,6 +776,12 @@ void CLevel::DumpStatistics(IGameFont& font, IPerformanceAlert* alert)
     font.OutNext("AI think:     %2.2fms, %d", AIStats.Think.result, AIStats.Think.count);
     font.OutNext("- range:      %2.2fms, %d", AIStats.Range.result, AIStats.Range.count);
     font.OutNext("- path:       %2.2fms, %d", AIStats.Path.result, AIStats.Path.count);
+    if (const CLevelPathCache* cache = ai().get_level_path_cache())
+    {
+        const u32 lookups = cache->hit_count() + cache->miss_count();
+        font.OutNext("- path cache: %2.0f%%, %u/%u, %u paths", lookups ? 100.f * cache->hit_count() / lookups : 0.f,
+            cache->hit_count(), lookups, cache->size());
+    }
     font.OutNext("- node:       %2.2fms, %d", AIStats.Node.result, AIStats.Node.count);
     font.OutNext("AI vision:    %2.2fms, %d", AIStats.Vis.result, AIStats.Vis.count);
     font.OutNext("- query:      %2.2fms", AIStats.VisQuery.result);
@@ -198,6 +198,7 @@ private:
     u32 m_dwDeltaUpdate = 0;
     u32 m_dwLastNetUpdateTime = 0;
     void UpdateDeltaUpd(u32 LastTime);
+    void ProcessUpdateTime(NET_Packet const& P);
     void BlockCheatLoad();
     bool Connect2Server(const char* options);
     void SendClientDigestToServer();
@@ -288,6 +289,7 @@ public:
     void ProcessGameEvents();
     void ProcessGameSpawns();
     void ProcessCompressedUpdate(NET_Packet& P, u8 const compression_type);
+    void ProcessDeltaUpdate(NET_Packet& P);
     // Input
     virtual void IR_OnKeyboardPress(int btn);
     virtual void IR_OnKeyboardRelease(int btn);
@@ -387,6 +389,7 @@ public:
     // aligned to 16 bytes m_lzo_working_buffer
     u8* m_lzo_working_memory = nullptr;
     u8* m_lzo_working_buffer = nullptr;
+    client_updates_snapshots* m_updates_snapshots = nullptr;
     void init_compression();
     void deinit_compression();
 #ifdef DEBUG
@@ -105,7 +105,7 @@ CBulletManager::~CBulletManager()
 {
     m_Bullets.clear();
     m_WhineSounds.clear();
-    m_Events.clear();
+    frame_vector<_event>().swap(m_Events);
 }
 
 void CBulletManager::Load()
@@ -175,7 +175,7 @@ void CBulletManager::PlayWhineSound(SBullet* bullet, IGameObject* object, const
 void CBulletManager::Clear()
 {
     m_Bullets.clear();
-    m_Events.clear();
+    frame_vector<_event>().swap(m_Events);
 }
 
 void CBulletManager::AddBullet(const Fvector& position, const Fvector& direction, float starting_speed, float power,
@@ -903,7 +903,7 @@ void CBulletManager::CommitRenderSet() // @ the end of frame
     m_BulletsRendered = m_Bullets;
     if (g_mt_config.test(mtBullets))
     {
-        Device.seqParallel.push_back(fastdelegate::FastDelegate0<>(this, &CBulletManager::UpdateWorkload));
+        Device.seqFrameJobs.Push("bullets", fastdelegate::FastDelegate0<>(this, &CBulletManager::UpdateWorkload));
     }
     else
     {
@@ -938,7 +938,8 @@ void CBulletManager::CommitEvents() // @ the start of frame
         break;
         }
     }
-    m_Events.clear_and_reserve();
+    // drop the frame arena storage, it expires at the end of this frame
+    frame_vector<_event>().swap(m_Events);
 }
 
 void CBulletManager::RegisterEvent(
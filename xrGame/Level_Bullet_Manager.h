@@ -6,6 +6,7 @@
 
 #include "weaponammo.h"
 #include "tracer.h"
+#include "xrCore/frame_arena.h"
 
 //коэфициенты и параметры патрона
 struct SBullet_Hit
@@ -134,7 +135,9 @@ protected:
 
     BulletVec m_Bullets; // working set, locked
     BulletVec m_BulletsRendered; // copy for rendering
-    xr_vector<_event> m_Events;
+    // Produced by UpdateWorkload, consumed by CommitEvents on the next frame,
+    // so it fits the frame arena lifetime; never keep its capacity across frames
+    frame_vector<_event> m_Events;
 
 #ifdef DEBUG
     u32 m_thread_id;
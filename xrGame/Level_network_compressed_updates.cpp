@@ -3,6 +3,28 @@
 #include "xrCore/ppmd_compressor.h"
 #include "xrPhysics/iphworld.h"
 #include "xrServer_updates_compressor.h"
+#include "xrServer_updates_snapshots.h"
+
+// Updates the delta time and the number of the net correction steps by the ping
+// and the time the objects update was received at
+void CLevel::ProcessUpdateTime(NET_Packet const& P)
+{
+    if (OnClient())
+        UpdateDeltaUpd(timeServer());
+    IClientStatistic pStat = Level().GetStatistic();
+    u32 dTime = 0;
+
+    if ((Level().timeServer() + pStat.getPing()) < P.timeReceive)
+    {
+        dTime = pStat.getPing();
+    }
+    else
+    {
+        dTime = Level().timeServer() - P.timeReceive + pStat.getPing();
+    }
+    u32 NumSteps = physics_world()->CalcNumSteps(dTime);
+    SetNumCrSteps(NumSteps);
+}
 
 void CLevel::ProcessCompressedUpdate(NET_Packet& P, u8 const compress_type)
 {
@@ -40,21 +62,28 @@ void CLevel::ProcessCompressedUpdate(NET_Packet& P, u8 const compress_type)
     }
     stats.ClientCompressor.End();
 
-    if (OnClient())
-        UpdateDeltaUpd(timeServer());
-    IClientStatistic pStat = Level().GetStatistic();
-    u32 dTime = 0;
+    ProcessUpdateTime(P);
+}
 
-    if ((Level().timeServer() + pStat.getPing()) < P.timeReceive)
-    {
-        dTime = pStat.getPing();
-    }
-    else
+void CLevel::ProcessDeltaUpdate(NET_Packet& P)
+{
+    if (!m_updates_snapshots)
+        m_updates_snapshots = new client_updates_snapshots();
+
+    stats.ClientCompressor.Begin();
+    m_updates_snapshots->process_part(P, Objects);
+    stats.ClientCompressor.End();
+
+    u32 snapshot_id;
+    if (m_updates_snapshots->acknowledge(snapshot_id))
     {
-        dTime = Level().timeServer() - P.timeReceive + pStat.getPing();
+        NET_Packet ack;
+        ack.w_begin(M_DELTA_UPDATE_ACK);
+        ack.w_u32(snapshot_id);
+        Send(ack, net_flags(FALSE, TRUE));
     }
-    u32 NumSteps = physics_world()->CalcNumSteps(dTime);
-    SetNumCrSteps(NumSteps);
+
+    ProcessUpdateTime(P);
 }
 
 void CLevel::init_compression()
@@ -163,6 +163,9 @@ void CLevel::ClientReceive()
             ProcessCompressedUpdate(*P, compression_type);
         }
         break;
+        case M_DELTA_UPDATE_OBJECTS: { ProcessDeltaUpdate(*P);
+        }
+        break;
         case M_CL_UPDATE:
         {
             /*if (!game_configured)
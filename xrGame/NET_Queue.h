@@ -84,7 +84,7 @@ public:
         NET_Event E;
         E.import(P);
         //		queue.insert	(E);
-        queue.push_back(E);
+        queue.push_back(std::move(E));
         /*
         //-------------------------------------------
 #ifdef DEBUG
@@ -33,12 +33,22 @@ protected:
     _vertex_id_type m_failed_start_vertex_id;
     _vertex_id_type m_failed_dest_vertex_id;
 
+protected:
+    // search result computed ahead by prepare_path, consumed by the next build_path
+    PATH m_prepared_path;
+    _vertex_id_type m_prepared_start_vertex_id;
+    _vertex_id_type m_prepared_dest_vertex_id;
+    bool m_prepared;
+    bool m_prepared_failed;
+
 protected:
     IC _vertex_id_type intermediate_vertex_id() const;
 
     IC void build_path(const _vertex_id_type start_vertex_id, const _vertex_id_type dest_vertex_id);
+    IC bool consume_prepared_path(const _vertex_id_type start_vertex_id, const _vertex_id_type dest_vertex_id);
     IC virtual void before_search(const _vertex_id_type start_vertex_id, const _vertex_id_type dest_vertex_id);
     IC virtual void after_search();
+    IC virtual bool search(const _vertex_id_type start_vertex_id, const _vertex_id_type dest_vertex_id, PATH& path);
     IC virtual bool check_vertex(const _vertex_id_type vertex_id) const;
 
 public:
@@ -57,6 +67,9 @@ public:
     IC virtual void select_intermediate_vertex();
     IC CRestrictedObject& object() const;
     IC void invalidate_failed_info();
+    // Runs the search of the next build_path with the same vertices, may be called on a worker thread
+    IC void prepare_path(const _vertex_id_type start_vertex_id, const _vertex_id_type dest_vertex_id);
+    IC void discard_prepared_path();
 
 public:
     IC const PATH& path() const;
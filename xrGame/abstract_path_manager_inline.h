@@ -18,7 +18,12 @@
 #define CPathManagerTemplate CAbstractPathManager<_Graph, _VertexEvaluator, _vertex_id_type, _index_type>
 
 TEMPLATE_SPECIALIZATION
-IC CPathManagerTemplate::CAbstractPathManager(CRestrictedObject* object) { m_object = object; }
+IC CPathManagerTemplate::CAbstractPathManager(CRestrictedObject* object)
+{
+    m_object = object;
+    m_prepared = false;
+}
+
 TEMPLATE_SPECIALIZATION
 IC CPathManagerTemplate::~CAbstractPathManager() {}
 TEMPLATE_SPECIALIZATION
@@ -34,6 +39,7 @@ IC void CPathManagerTemplate::reinit(const _Graph* graph)
     m_path.clear();
     m_failed_start_vertex_id = _vertex_id_type(-1);
     m_failed_dest_vertex_id = _vertex_id_type(-1);
+    m_prepared = false;
 }
 
 TEMPLATE_SPECIALIZATION
@@ -53,9 +59,12 @@ IC void CPathManagerTemplate::build_path(const _vertex_id_type start_vertex_id,
         return;
     }
 
-    before_search(start_vertex_id, dest_vertex_id);
-    m_failed = !ai().graph_engine().search(*m_graph, start_vertex_id, dest_vertex_id, &m_path, *m_evaluator);
-    after_search();
+    if (!consume_prepared_path(start_vertex_id, dest_vertex_id))
+    {
+        before_search(start_vertex_id, dest_vertex_id);
+        m_failed = !search(start_vertex_id, dest_vertex_id, m_path);
+        after_search();
+    }
     m_current_index = _index_type(-1);
     m_intermediate_index = _index_type(-1);
     m_actuality = !failed();
@@ -67,6 +76,41 @@ IC void CPathManagerTemplate::build_path(const _vertex_id_type start_vertex_id,
     m_failed_dest_vertex_id = dest_vertex_id;
 }
 
+TEMPLATE_SPECIALIZATION
+IC bool CPathManagerTemplate::consume_prepared_path(
+    const _vertex_id_type start_vertex_id, const _vertex_id_type dest_vertex_id)
+{
+    if (!m_prepared)
+        return (false);
+
+    m_prepared = false;
+    if ((m_prepared_start_vertex_id != start_vertex_id) || (m_prepared_dest_vertex_id != dest_vertex_id))
+        return (false);
+
+    m_path.swap(m_prepared_path);
+    m_failed = m_prepared_failed;
+    return (true);
+}
+
+TEMPLATE_SPECIALIZATION
+IC void CPathManagerTemplate::prepare_path(const _vertex_id_type start_vertex_id, const _vertex_id_type dest_vertex_id)
+{
+    VERIFY(m_graph && m_evaluator && m_graph->valid_vertex_id(start_vertex_id) &&
+        m_graph->valid_vertex_id(dest_vertex_id));
+
+    m_prepared = false;
+    if ((m_failed_start_vertex_id == start_vertex_id) && (m_failed_dest_vertex_id == dest_vertex_id))
+        return;
+
+    before_search(start_vertex_id, dest_vertex_id);
+    m_prepared_failed = !search(start_vertex_id, dest_vertex_id, m_prepared_path);
+    after_search();
+
+    m_prepared_start_vertex_id = start_vertex_id;
+    m_prepared_dest_vertex_id = dest_vertex_id;
+    m_prepared = true;
+}
+
 TEMPLATE_SPECIALIZATION
 IC void CPathManagerTemplate::select_intermediate_vertex()
 {
@@ -125,6 +169,13 @@ IC void CPathManagerTemplate::before_search(const _vertex_id_type start_vertex_i
 
 TEMPLATE_SPECIALIZATION
 IC void CPathManagerTemplate::after_search() {}
+TEMPLATE_SPECIALIZATION
+IC bool CPathManagerTemplate::search(
+    const _vertex_id_type start_vertex_id, const _vertex_id_type dest_vertex_id, PATH& path)
+{
+    return (ai().graph_engine().search(*m_graph, start_vertex_id, dest_vertex_id, &path, *m_evaluator));
+}
+
 TEMPLATE_SPECIALIZATION
 IC bool CPathManagerTemplate::check_vertex(const _vertex_id_type vertex_id) const
 {
@@ -141,11 +192,14 @@ IC CRestrictedObject& CPathManagerTemplate::object() const
 TEMPLATE_SPECIALIZATION
 IC void CPathManagerTemplate::reset() { m_failed = false; }
 TEMPLATE_SPECIALIZATION
+IC void CPathManagerTemplate::discard_prepared_path() { m_prepared = false; }
+TEMPLATE_SPECIALIZATION
 IC void CPathManagerTemplate::invalidate_failed_info()
 {
     reset();
     m_failed_start_vertex_id = u32(-1);
     m_failed_dest_vertex_id = u32(-1);
+    m_prepared = false;
 }
 
 #undef CPathManagerTemplate
@@ -21,6 +21,8 @@
 #include "alife_simulator.h"
 #include "moving_objects.h"
 #include "doors_manager.h"
+#include "level_path_cache.h"
+#include "path_request_queue.h"
 
 ENGINE_API bool g_dedicated_server;
 
@@ -32,6 +34,8 @@ CAI_Space::CAI_Space()
     m_cover_manager = 0;
     m_alife_simulator = 0;
     m_moving_objects = 0;
+    m_path_requests = 0;
+    m_level_path_cache = 0;
     m_doors_manager = 0;
 }
 
@@ -48,6 +52,9 @@ void CAI_Space::init()
 
     VERIFY(!m_moving_objects);
     m_moving_objects = new ::moving_objects();
+
+    VERIFY(!m_path_requests);
+    m_path_requests = new CPathRequestQueue();
     VERIFY(!GlobalEnv.ScriptEngine);
     GlobalEnv.ScriptEngine = new CScriptEngine();
     SetupScriptEngine();
@@ -58,6 +65,7 @@ CAI_Space::~CAI_Space()
     unload();
     xr_delete(GlobalEnv.ScriptEngine); // XXX: wrapped into try..catch(...) in vanilla source
     xr_delete(m_doors_manager);
+    xr_delete(m_path_requests);
     xr_delete(m_moving_objects);
     xr_delete(m_cover_manager);
     xr_delete(m_ef_storage);
@@ -152,6 +160,9 @@ void CAI_Space::load(LPCSTR level_name)
     VERIFY(!m_doors_manager);
     m_doors_manager = new ::doors::manager(level_graph().header().box());
 
+    VERIFY(!m_level_path_cache);
+    m_level_path_cache = new CLevelPathCache();
+
 #ifdef DEBUG
     Msg("* Loading ai space is successfully completed (%.3fs, %7.3f Mb)", timer.GetElapsed_sec(),
         float(Memory.mem_usage() - mem_usage) / 1048576.0);
@@ -164,6 +175,7 @@ void CAI_Space::unload(bool reload)
         return;
     script_engine().unload();
     xr_delete(m_doors_manager);
+    xr_delete(m_level_path_cache);
     AISpaceBase::Unload(reload);
 }
 
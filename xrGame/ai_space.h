@@ -20,6 +20,8 @@ class CCoverManager;
 class CScriptEngine;
 class CPatrolPathStorage;
 class moving_objects;
+class CPathRequestQueue;
+class CLevelPathCache;
 
 namespace doors
 {
@@ -40,6 +42,8 @@ private:
     CALifeSimulator* m_alife_simulator;
     CCoverManager* m_cover_manager;
     moving_objects* m_moving_objects;
+    CPathRequestQueue* m_path_requests;
+    CLevelPathCache* m_level_path_cache;
     doors::manager* m_doors_manager;
 
 private:
@@ -62,6 +66,8 @@ public:
     // XXX: [ai] delete
     IC CScriptEngine& script_engine() const;
     IC moving_objects& moving_objects() const;
+    IC CPathRequestQueue& path_requests() const;
+    IC CLevelPathCache* get_level_path_cache() const;
     IC doors::manager& doors() const;
 };
 
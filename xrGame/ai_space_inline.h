@@ -39,6 +39,13 @@ IC moving_objects& CAI_Space::moving_objects() const
     return (*m_moving_objects);
 }
 
+IC CPathRequestQueue& CAI_Space::path_requests() const
+{
+    VERIFY(m_path_requests);
+    return (*m_path_requests);
+}
+
+IC CLevelPathCache* CAI_Space::get_level_path_cache() const { return (m_level_path_cache); }
 IC doors::manager& CAI_Space::doors() const
 {
     VERIFY(m_doors_manager);
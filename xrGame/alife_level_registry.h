@@ -9,6 +9,7 @@
 #pragma once
 
 #include "safe_map_iterator.h"
+#include "slot_map.h"
 #include "xrServer_Objects_ALife.h"
 #include "xrAICore/Navigation/game_graph.h"
 #include "ai_debug.h"
@@ -17,13 +18,37 @@
 
 class CSE_ALifeDynamicObject;
 
-class CALifeLevelRegistry : public CSafeMapIterator<ALife::_OBJECT_ID, CSE_ALifeDynamicObject>
+class CALifeLevelRegistry
+    : public CSafeMapIterator<ALife::_OBJECT_ID, CSE_ALifeDynamicObject, std::less<ALife::_OBJECT_ID>, true, u64, true,
+          CSlotMap<ALife::_OBJECT_ID, CSE_ALifeDynamicObject>>
 {
 protected:
-    typedef CSafeMapIterator<ALife::_OBJECT_ID, CSE_ALifeDynamicObject> inherited;
+    typedef CSafeMapIterator<ALife::_OBJECT_ID, CSE_ALifeDynamicObject, std::less<ALife::_OBJECT_ID>, true, u64, true,
+        CSlotMap<ALife::_OBJECT_ID, CSE_ALifeDynamicObject>>
+        inherited;
+
+public:
+    // an object is evaluated again when the actor and the object could have closed or widened
+    // the distance between them by the slack left to the switch band at the last evaluation
+    struct SSwitchEvent
+    {
+        double due;
+        ALife::_OBJECT_ID id;
+
+        IC bool operator<(const SSwitchEvent& other) const { return (due > other.due); }
+    };
+
+    typedef xr_vector<SSwitchEvent> SWITCH_QUEUE;
 
 protected:
     GameGraph::_LEVEL_ID m_level_id;
+    SWITCH_QUEUE m_switch_queue;
+    SWITCH_QUEUE m_switch_batch;
+    xr_vector<double> m_switch_due;
+    double m_switch_clock;
+
+protected:
+    IC void compact_switch_queue();
 
 public:
     IC CALifeLevelRegistry(const GameGraph::_LEVEL_ID& level_id);
@@ -31,6 +56,12 @@ public:
     IC void remove(CSE_ALifeDynamicObject* tpALifeDynamicObject, bool no_assert = false);
     template <typename _update_predicate>
     IC void update(const _update_predicate& predicate, bool const iterate_as_first_time_next_time);
+    template <typename _switch_predicate>
+    IC u32 update_switch(const _switch_predicate& predicate, double clock);
+    IC void schedule_switch(const ALife::_OBJECT_ID& id, double due);
+    IC void schedule_switch(const ALife::_OBJECT_ID& id);
+    IC void reset_switch(double clock);
+    IC u32 switch_queue_size() const;
     IC GameGraph::_LEVEL_ID level_id() const;
     IC CSE_ALifeDynamicObject* object(const ALife::_OBJECT_ID& id, bool no_assert = false) const;
 };
@@ -10,7 +10,12 @@
 
 #include "ai_space.h"
 
-IC CALifeLevelRegistry::CALifeLevelRegistry(const GameGraph::_LEVEL_ID& level_id) { m_level_id = level_id; }
+IC CALifeLevelRegistry::CALifeLevelRegistry(const GameGraph::_LEVEL_ID& level_id)
+{
+    m_level_id = level_id;
+    m_switch_clock = 0.0;
+}
+
 IC GameGraph::_LEVEL_ID CALifeLevelRegistry::level_id() const { return (m_level_id); }
 IC void CALifeLevelRegistry::add(CSE_ALifeDynamicObject* object)
 {
@@ -24,6 +29,7 @@ IC void CALifeLevelRegistry::add(CSE_ALifeDynamicObject* object)
     }
 #endif
     inherited::add(object->ID, object);
+    schedule_switch(object->ID);
 }
 
 IC void CALifeLevelRegistry::remove(CSE_ALifeDynamicObject* object, bool no_assert)
@@ -35,6 +41,8 @@ IC void CALifeLevelRegistry::remove(CSE_ALifeDynamicObject* object, bool no_asse
     }
 #endif
     inherited::remove(object->ID, no_assert);
+    if (object->ID < m_switch_due.size())
+        m_switch_due[object->ID] = -1.0;
 }
 
 template <typename _update_predicate>
@@ -63,3 +71,99 @@ IC CSE_ALifeDynamicObject* CALifeLevelRegistry::object(const ALife::_OBJECT_ID&
     }
     return ((*I).second);
 }
+
+IC void CALifeLevelRegistry::schedule_switch(const ALife::_OBJECT_ID& id, double due)
+{
+    if (id >= m_switch_due.size())
+        m_switch_due.resize(id + 1, -1.0);
+
+    m_switch_due[id] = due;
+    SSwitchEvent event;
+    event.due = due;
+    event.id = id;
+    m_switch_queue.push_back(event);
+    std::push_heap(m_switch_queue.begin(), m_switch_queue.end());
+}
+
+IC void CALifeLevelRegistry::schedule_switch(const ALife::_OBJECT_ID& id) { schedule_switch(id, m_switch_clock); }
+IC void CALifeLevelRegistry::reset_switch(double clock)
+{
+    m_switch_clock = clock;
+    m_switch_queue.clear();
+    m_switch_due.assign(m_switch_due.size(), -1.0);
+
+    _REGISTRY::const_iterator I = objects().begin();
+    _REGISTRY::const_iterator E = objects().end();
+    for (; I != E; ++I)
+        schedule_switch((*I).first);
+}
+
+IC void CALifeLevelRegistry::compact_switch_queue()
+{
+    // the events of the rescheduled or removed objects are left in the queue till they are due
+    if (m_switch_queue.size() <= 2 * objects().size() + 256)
+        return;
+
+    SWITCH_QUEUE::iterator I = m_switch_queue.begin();
+    SWITCH_QUEUE::iterator E = m_switch_queue.end();
+    SWITCH_QUEUE::iterator J = I;
+    for (; I != E; ++I)
+        if (m_switch_due[(*I).id] == (*I).due)
+            *J++ = *I;
+
+    m_switch_queue.erase(J, E);
+    std::make_heap(m_switch_queue.begin(), m_switch_queue.end());
+}
+
+template <typename _switch_predicate>
+IC u32 CALifeLevelRegistry::update_switch(const _switch_predicate& predicate, double clock)
+{
+    m_switch_clock = clock;
+    start_timer();
+
+    // the objects are taken out first, so the ones added back while switching wait for the next update
+    m_switch_batch.clear();
+    while (!m_switch_queue.empty() && (m_switch_queue.front().due <= clock))
+    {
+        const SSwitchEvent& event = m_switch_queue.front();
+        if (m_switch_due[event.id] == event.due)
+            m_switch_batch.push_back(event);
+        std::pop_heap(m_switch_queue.begin(), m_switch_queue.end());
+        m_switch_queue.pop_back();
+    }
+
+    u32 count = 0;
+    SWITCH_QUEUE::const_iterator I = m_switch_batch.begin();
+    SWITCH_QUEUE::const_iterator E = m_switch_batch.end();
+    for (; I != E; ++I)
+    {
+        if (m_switch_due[(*I).id] != (*I).due)
+            continue;
+
+        if (time_over())
+        {
+            m_switch_queue.push_back(*I);
+            std::push_heap(m_switch_queue.begin(), m_switch_queue.end());
+            continue;
+        }
+
+        m_switch_due[(*I).id] = -1.0;
+        CSE_ALifeDynamicObject* switched = object((*I).id, true);
+        if (!switched)
+            continue;
+
+        ++count;
+        predicate(switched);
+
+        // the object could be released, leave the level or be rescheduled while switching
+        switched = object((*I).id, true);
+        if (switched && (m_switch_due[(*I).id] < 0.0))
+            schedule_switch((*I).id, clock + predicate.slack(switched));
+    }
+
+    m_first_update = false;
+    compact_switch_queue();
+    return (count);
+}
+
+IC u32 CALifeLevelRegistry::switch_queue_size() const { return (m_switch_queue.size()); }
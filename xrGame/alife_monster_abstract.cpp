@@ -50,6 +50,14 @@ void CSE_ALifeMonsterAbstract::on_unregister()
         ai().alife().groups().object(m_group_id).unregister_member(ID);
 }
 
+void CSE_ALifeMonsterAbstract::prepare_update()
+{
+    if (!bfActive())
+        return;
+
+    brain().prepare_update();
+}
+
 void CSE_ALifeMonsterAbstract::update()
 {
     if (!bfActive())
@@ -29,6 +29,7 @@ CALifeMonsterDetailPathManager::CALifeMonsterDetailPathManager(object_type* obje
     m_destination.m_level_vertex_id = this->object().get_object().m_tNodeID;
     m_destination.m_position = this->object().get_object().o_Position;
     m_walked_distance = 0.f;
+    m_prepared = false;
 }
 
 void CALifeMonsterDetailPathManager::target(
@@ -96,26 +97,61 @@ void CALifeMonsterDetailPathManager::update()
 {
     ALife::_TIME_ID current_time = ai().alife().time_manager().game_time();
     if (current_time <= m_last_update_time)
+    {
+        m_prepared = false;
         return;
+    }
 
     //	if (ai().game_graph().vertex(object().m_tGraphID)->level_id() == ai().level_graph().level_id())
     //		Msg							("[detail::update][%6d][%s]",Device.dwTimeGlobal,object().name_replace());
 
     ALife::_TIME_ID time_delta = current_time - m_last_update_time;
     update(time_delta);
+    m_prepared = false;
     // we advisedly "lost" time we need to process a query to avoid some undesirable effects
     m_last_update_time = ai().alife().time_manager().game_time();
 }
 
+void CALifeMonsterDetailPathManager::prepare()
+{
+    m_prepared = false;
+    if (!m_last_update_time || (ai().alife().time_manager().game_time() <= m_last_update_time))
+        return;
+
+    if (completed() || actual())
+        return;
+
+    m_prepared_failed = !search(m_prepared_path);
+    m_prepared_start_vertex_id = object().get_object().m_tGraphID;
+    m_prepared_dest_vertex_id = m_destination.m_game_vertex_id;
+    m_prepared_accessibility_stamp = ai().game_graph().accessibility_stamp();
+    m_prepared = true;
+}
+
+bool CALifeMonsterDetailPathManager::search(PATH& path) const
+{
+    typedef GraphEngineSpace::CGameVertexParams CGameVertexParams;
+    CGameVertexParams temp = CGameVertexParams(object().m_tpaTerrain);
+    return (ai().graph_engine().search(
+        ai().game_graph(), object().get_object().m_tGraphID, m_destination.m_game_vertex_id, &path, temp));
+}
+
 void CALifeMonsterDetailPathManager::make_inactual() { m_path.clear(); }
 void CALifeMonsterDetailPathManager::actualize()
 {
     m_path.clear();
 
-    typedef GraphEngineSpace::CGameVertexParams CGameVertexParams;
-    CGameVertexParams temp = CGameVertexParams(object().m_tpaTerrain);
-    bool failed = !ai().graph_engine().search(
-        ai().game_graph(), object().get_object().m_tGraphID, m_destination.m_game_vertex_id, &m_path, temp);
+    bool failed;
+    if (m_prepared && (m_prepared_start_vertex_id == object().get_object().m_tGraphID) &&
+        (m_prepared_dest_vertex_id == m_destination.m_game_vertex_id) &&
+        (m_prepared_accessibility_stamp == ai().game_graph().accessibility_stamp()))
+    {
+        m_path.swap(m_prepared_path);
+        failed = m_prepared_failed;
+    }
+    else
+        failed = !search(m_path);
+    m_prepared = false;
 
 #ifdef DEBUG
     if (failed)
@@ -251,8 +287,17 @@ void CALifeMonsterDetailPathManager::follow_path(const ALife::_TIME_ID& time_del
     }
 }
 
-void CALifeMonsterDetailPathManager::on_switch_online() { m_path.clear(); }
-void CALifeMonsterDetailPathManager::on_switch_offline() { m_path.clear(); }
+void CALifeMonsterDetailPathManager::on_switch_online()
+{
+    m_path.clear();
+    m_prepared = false;
+}
+
+void CALifeMonsterDetailPathManager::on_switch_offline()
+{
+    m_path.clear();
+    m_prepared = false;
+}
 Fvector CALifeMonsterDetailPathManager::draw_level_position() const
 {
     if (path().empty())
@@ -47,6 +47,16 @@ private:
     // efficiently implemented in std::vector
 
 private:
+    // game path searched ahead by prepare, consumed by the actualize of the same update
+    PATH m_prepared_path;
+    GameGraph::_GRAPH_ID m_prepared_start_vertex_id;
+    GameGraph::_GRAPH_ID m_prepared_dest_vertex_id;
+    u32 m_prepared_accessibility_stamp;
+    bool m_prepared;
+    bool m_prepared_failed;
+
+private:
+    bool search(PATH& path) const;
     void actualize();
     void setup_current_speed();
     void follow_path(const ALife::_TIME_ID& time_delta);
@@ -64,6 +74,8 @@ public:
 
 public:
     void update();
+    // Searches the game path the next update is going to need, may be called on a worker thread
+    void prepare();
     void on_switch_online();
     void on_switch_offline();
     IC void speed(const float& speed);
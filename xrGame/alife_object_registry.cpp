@@ -9,6 +9,7 @@
 #include "stdafx.h"
 #include "alife_object_registry.h"
 #include "ai_debug.h"
+#include "alife_save_stream.h"
 
 CALifeObjectRegistry::CALifeObjectRegistry(LPCSTR section) {}
 CALifeObjectRegistry::~CALifeObjectRegistry()
@@ -55,37 +56,46 @@ void CALifeObjectRegistry::save(IWriter& memory_stream, CSE_ALifeDynamicObject*
     }
 }
 
-void CALifeObjectRegistry::save(IWriter& memory_stream)
+void CALifeObjectRegistry::save(CALifeSaveWriter& stream)
 {
     Msg("* Saving objects...");
-    memory_stream.open_chunk(OBJECT_CHUNK_DATA);
-
-    u32 position = memory_stream.tell();
-    memory_stream.w_u32(u32(-1));
 
     u32 object_count = 0;
     OBJECT_REGISTRY::iterator I = m_objects.begin();
     OBJECT_REGISTRY::iterator E = m_objects.end();
-    for (; I != E; ++I)
+    while (I != E)
     {
-        if (!(*I).second->can_save())
-            continue;
+        u32 block_id = u32((*I).first) >> block_id_shift;
+        IWriter& memory_stream = stream.open_block(OBJECT_CHUNK_DATA, block_id);
+        memory_stream.open_chunk(OBJECT_CHUNK_DATA);
 
-        if ((*I).second->redundant())
-            continue;
+        u32 position = memory_stream.tell();
+        memory_stream.w_u32(u32(-1));
 
-        if ((*I).second->ID_Parent != 0xffff)
-            continue;
+        u32 block_object_count = 0;
+        for (; (I != E) && ((u32((*I).first) >> block_id_shift) == block_id); ++I)
+        {
+            if (!(*I).second->can_save())
+                continue;
 
-        save(memory_stream, (*I).second, object_count);
-    }
+            if ((*I).second->redundant())
+                continue;
 
-    u32 last_position = memory_stream.tell();
-    memory_stream.seek(position);
-    memory_stream.w_u32(object_count);
-    memory_stream.seek(last_position);
+            if ((*I).second->ID_Parent != 0xffff)
+                continue;
 
-    memory_stream.close_chunk();
+            save(memory_stream, (*I).second, block_object_count);
+        }
+
+        u32 last_position = memory_stream.tell();
+        memory_stream.seek(position);
+        memory_stream.w_u32(block_object_count);
+        memory_stream.seek(last_position);
+
+        memory_stream.close_chunk();
+        stream.close_block();
+        object_count += block_object_count;
+    }
 
     Msg("* %d objects are successfully saved", object_count);
 }
@@ -125,23 +135,25 @@ CSE_ALifeDynamicObject* CALifeObjectRegistry::get_object(IReader& file_stream)
     return (tpALifeDynamicObject);
 }
 
-void CALifeObjectRegistry::load(IReader& file_stream)
+u32 CALifeObjectRegistry::load_block(IReader& file_stream)
 {
-    Msg("* Loading objects...");
     R_ASSERT2(file_stream.find_chunk(OBJECT_CHUNK_DATA), "Can't find chunk OBJECT_CHUNK_DATA!");
 
-    m_objects.clear();
-
     u32 count = file_stream.r_u32();
-    CSE_ALifeDynamicObject** objects = (CSE_ALifeDynamicObject**)_alloca(count * sizeof(CSE_ALifeDynamicObject*));
+    for (u32 i = 0; i < count; ++i)
+        add(get_object(file_stream));
 
-    CSE_ALifeDynamicObject** I = objects;
-    CSE_ALifeDynamicObject** E = objects + count;
-    for (; I != E; ++I)
-    {
-        *I = get_object(file_stream);
-        add(*I);
-    }
+    return (count);
+}
+
+void CALifeObjectRegistry::load(const CALifeSaveReader& stream)
+{
+    Msg("* Loading objects...");
+
+    m_objects.clear();
+
+    u32 count = 0;
+    stream.load(OBJECT_CHUNK_DATA, [this, &count](IReader& file_stream) { count += load_block(file_stream); });
 
     Msg("* %d objects are successfully loaded", count);
 }
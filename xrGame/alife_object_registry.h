@@ -9,6 +9,7 @@
 #pragma once
 
 #include "xrServer_Objects_ALife.h"
+#include "slot_map.h"
 #include "xrEngine/profiler.h"
 
 #pragma warning(push)
@@ -16,16 +17,27 @@
 #include <malloc.h>
 #pragma warning(pop)
 
+class CALifeSaveWriter;
+class CALifeSaveReader;
+
 class CALifeObjectRegistry
 {
 public:
-    typedef xr_map<ALife::_OBJECT_ID, CSE_ALifeDynamicObject*> OBJECT_REGISTRY;
+    typedef CSlotMap<ALife::_OBJECT_ID, CSE_ALifeDynamicObject> OBJECT_REGISTRY;
 
 protected:
     OBJECT_REGISTRY m_objects;
 
+private:
+    // top level objects are saved in blocks of 256 IDs, an object goes with its parent
+    enum
+    {
+        block_id_shift = 8,
+    };
+
 private:
     void save(IWriter& memory_stream, CSE_ALifeDynamicObject* object, u32& object_count);
+    u32 load_block(IReader& file_stream);
 
 public:
     static CSE_ALifeDynamicObject* get_object(IReader& file_stream);
@@ -33,8 +45,8 @@ public:
 public:
     CALifeObjectRegistry(LPCSTR section);
     virtual ~CALifeObjectRegistry();
-    virtual void save(IWriter& memory_stream);
-    void load(IReader& file_stream);
+    virtual void save(CALifeSaveWriter& stream);
+    void load(const CALifeSaveReader& stream);
     IC void add(CSE_ALifeDynamicObject* object);
     IC void remove(const ALife::_OBJECT_ID& id, bool no_assert = false);
     IC CSE_ALifeDynamicObject* object(const ALife::_OBJECT_ID& id, bool no_assert = false) const;
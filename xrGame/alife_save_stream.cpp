@@ -0,0 +1,175 @@
+////////////////////////////////////////////////////////////////////////////
+//	Module 		: alife_save_stream.cpp
+//	Description : ALife Simulator saved game sections
+////////////////////////////////////////////////////////////////////////////
+
+#include "stdafx.h"
+#include "alife_save_stream.h"
+#include "xrCore/Threading/TaskManager.hpp"
+#include "Common/object_broker.h"
+
+CALifeSaveWriter::SBlock::SBlock(u32 section_id, u32 id)
+    : section_id(section_id), id(id), crc(0), source_size(0), data(0), data_size(0)
+{
+}
+
+CALifeSaveWriter::SBlock::~SBlock() { xr_free(data); }
+void CALifeSaveWriter::SBlock::compress()
+{
+    data_size = rtc_csize(source_size);
+    data = (u8*)xr_malloc(data_size);
+    data_size = rtc_compress(data, data_size, source.pointer(), source_size);
+    source.free();
+}
+
+bool CALifeSaveWriter::SBlock::same_data(const SBlock& other) const
+{
+    // only the compressed data of the previous save is kept, decompressing is much cheaper
+    // than compressing again
+    if ((other.crc != crc) || (other.source_size != source_size))
+        return (false);
+    u8* buffer = (u8*)xr_malloc(source_size);
+    u32 size = rtc_decompress(buffer, source_size, other.data, other.data_size);
+    bool result = (size == source_size) && !memcmp(buffer, source.pointer(), source_size);
+    xr_free(buffer);
+    return (result);
+}
+
+bool CALifeSaveWriter::SBlock::operator<(const SBlock& other) const
+{
+    if (section_id != other.section_id)
+        return (section_id < other.section_id);
+    return (id < other.id);
+}
+
+struct CBlockPredicate
+{
+    template <typename T>
+    IC bool operator()(const T* first, const T* second) const
+    {
+        return (*first < *second);
+    }
+};
+
+CALifeSaveWriter::CALifeSaveWriter()
+    : m_current(0), m_root(0), m_reused_count(0), m_source_size(0), m_data_size(0)
+{
+}
+
+CALifeSaveWriter::~CALifeSaveWriter()
+{
+    VERIFY(!m_current && !m_root);
+    delete_data(m_blocks);
+    delete_data(m_previous);
+}
+
+CALifeSaveWriter::SBlock* CALifeSaveWriter::previous(const SBlock& block) const
+{
+    BLOCKS::const_iterator I = std::lower_bound(m_previous.begin(), m_previous.end(), &block, CBlockPredicate());
+    if ((I == m_previous.end()) || (block < **I))
+        return (0);
+    return (*I);
+}
+
+IWriter& CALifeSaveWriter::open_block(u32 section_id, u32 id)
+{
+    VERIFY(!m_current);
+    if (m_blocks.empty())
+    {
+        m_reused_count = 0;
+        if (TaskScheduler.GetWorkerCount() > 1)
+            m_root = TaskScheduler.CreateTask();
+    }
+
+    m_current = new SBlock(section_id, id);
+    return (m_current->source);
+}
+
+void CALifeSaveWriter::close_block()
+{
+    VERIFY(m_current);
+    SBlock* block = m_current;
+    m_current = 0;
+    m_blocks.push_back(block);
+
+    block->source_size = block->source.size();
+    block->crc = crc32(block->source.pointer(), block->source_size);
+
+    SBlock* last = previous(*block);
+    if (last && last->data && block->same_data(*last))
+    {
+        std::swap(block->data, last->data);
+        std::swap(block->data_size, last->data_size);
+        block->source.free();
+        ++m_reused_count;
+        return;
+    }
+
+    if (!m_root)
+    {
+        block->compress();
+        return;
+    }
+
+    TaskScheduler.Run(*TaskScheduler.CreateTask([block](Task&) { block->compress(); }, m_root));
+}
+
+void CALifeSaveWriter::save(IWriter& file)
+{
+    VERIFY(!m_current);
+    if (m_root)
+    {
+        TaskScheduler.RunAndWait(*m_root);
+        m_root = 0;
+    }
+
+    m_source_size = 0;
+    m_data_size = 0;
+    BLOCKS::const_iterator I = m_blocks.begin();
+    BLOCKS::const_iterator E = m_blocks.end();
+    while (I != E)
+    {
+        u32 section_id = (*I)->section_id;
+        file.open_chunk(section_id);
+        for (; (I != E) && ((*I)->section_id == section_id); ++I)
+        {
+            file.open_chunk((*I)->id);
+            file.w_u32((*I)->source_size);
+            file.w((*I)->data, (*I)->data_size);
+            file.close_chunk();
+            m_source_size += (*I)->source_size;
+            m_data_size += (*I)->data_size;
+        }
+        file.close_chunk();
+    }
+
+    // the compressed blocks are kept till the next save
+    delete_data(m_previous);
+    m_previous.swap(m_blocks);
+    std::sort(m_previous.begin(), m_previous.end(), CBlockPredicate());
+}
+
+CALifeSaveReader::CALifeSaveReader(IReader& file) : m_sections(0), m_source(0), m_buffer(0)
+{
+    file.seek(0);
+    u32 format = file.r_u32();
+    file.r_u32();
+
+    if (ALIFE_SAVE_SECTIONS == format)
+    {
+        m_sections = new IReader(file.pointer(), file.elapsed());
+        return;
+    }
+
+    u32 source_count = file.r_u32();
+    m_buffer = xr_malloc(source_count);
+    rtc_decompress(m_buffer, source_count, file.pointer(), file.elapsed());
+    m_source = new IReader(m_buffer, source_count);
+}
+
+CALifeSaveReader::~CALifeSaveReader()
+{
+    xr_delete(m_sections);
+    xr_delete(m_source);
+    xr_free(m_buffer);
+}
@@ -0,0 +1,87 @@
+////////////////////////////////////////////////////////////////////////////
+//	Module 		: alife_save_stream.h
+//	Description : ALife Simulator saved game sections
+////////////////////////////////////////////////////////////////////////////
+
+#pragma once
+
+class Task;
+
+// first dword of a saved game made of sections, the monolithic ones start with u32(-1)
+#define ALIFE_SAVE_SECTIONS u32(-2)
+
+// Every section of a saved game is a chunk of blocks compressed separately:
+//   chunk(section_id) { chunk(block_id) { u32 source size, compressed block }, ... }
+// A block is compressed on the task scheduler as soon as it is closed, while the next one is
+// serialized. A block which is the same as in the previous save reuses its compressed data
+class CALifeSaveWriter
+{
+private:
+    struct SBlock
+    {
+        u32 section_id;
+        u32 id;
+        u32 crc;
+        u32 source_size;
+        CMemoryWriter source;
+        u8* data;
+        u32 data_size;
+
+        SBlock(u32 section_id, u32 id);
+        ~SBlock();
+        void compress();
+        bool same_data(const SBlock& other) const;
+        bool operator<(const SBlock& other) const;
+    };
+
+    typedef xr_vector<SBlock*> BLOCKS;
+
+private:
+    BLOCKS m_blocks; // the save being made, in the order the blocks are written
+    BLOCKS m_previous; // the previous save, sorted
+    SBlock* m_current;
+    Task* m_root;
+    u32 m_reused_count;
+    u32 m_source_size;
+    u32 m_data_size;
+
+private:
+    SBlock* previous(const SBlock& block) const;
+
+public:
+    CALifeSaveWriter();
+    ~CALifeSaveWriter();
+    IWriter& open_block(u32 section_id, u32 id);
+    void close_block();
+    void save(IWriter& file);
+
+    IC u32 block_count() const { return (m_previous.size()); }
+    IC u32 reused_count() const { return (m_reused_count); }
+    IC u32 source_size() const { return (m_source_size); }
+    IC u32 data_size() const { return (m_data_size); }
+};
+
+// Gives the saved game to the loaders section by section, only one decompressed block is kept
+// in memory at a time. A monolithic saved game is decompressed as a whole and every section
+// is given the whole stream
+class CALifeSaveReader
+{
+private:
+    IReader* m_sections;
+    IReader* m_source;
+    void* m_buffer;
+
+private:
+    template <typename _loader>
+    IC void decompress(IReader& block, const _loader& loader) const;
+
+public:
+    CALifeSaveReader(IReader& file);
+    ~CALifeSaveReader();
+    template <typename _loader>
+    IC void load(u32 section_id, const _loader& loader) const;
+    template <typename _loader>
+    IC void load(u32 section_id, u32 block_id, const _loader& loader) const;
+};
+
+#include "alife_save_stream_inline.h"
@@ -0,0 +1,57 @@
+////////////////////////////////////////////////////////////////////////////
+//	Module 		: alife_save_stream_inline.h
+//	Description : ALife Simulator saved game sections inline functions
+////////////////////////////////////////////////////////////////////////////
+
+#pragma once
+
+template <typename _loader>
+IC void CALifeSaveReader::decompress(IReader& block, const _loader& loader) const
+{
+    u32 source_size = block.r_u32();
+    void* source = xr_malloc(source_size);
+    rtc_decompress(source, source_size, block.pointer(), block.elapsed());
+    IReader stream(source, source_size);
+    loader(stream);
+    xr_free(source);
+}
+
+template <typename _loader>
+IC void CALifeSaveReader::load(u32 section_id, const _loader& loader) const
+{
+    if (m_source)
+    {
+        loader(*m_source);
+        return;
+    }
+
+    IReader* section = m_sections->open_chunk(section_id);
+    R_ASSERT2(section, "Can't find the section of the saved game!");
+
+    u32 block_id;
+    for (IReader* block = section->open_chunk_iterator(block_id); block;
+         block = section->open_chunk_iterator(block_id, block))
+        decompress(*block, loader);
+
+    section->close();
+}
+
+template <typename _loader>
+IC void CALifeSaveReader::load(u32 section_id, u32 block_id, const _loader& loader) const
+{
+    if (m_source)
+    {
+        loader(*m_source);
+        return;
+    }
+
+    IReader* section = m_sections->open_chunk(section_id);
+    R_ASSERT2(section, "Can't find the section of the saved game!");
+
+    IReader* block = section->open_chunk(block_id);
+    R_ASSERT2(block, "Can't find the block of the saved game section!");
+    decompress(*block, loader);
+
+    block->close();
+    section->close();
+}
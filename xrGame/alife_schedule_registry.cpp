@@ -8,6 +8,10 @@
 
 #include "stdafx.h"
 #include "alife_schedule_registry.h"
+#include "ai_space.h"
+#include "mt_config.h"
+#include "xrAICore/Navigation/graph_engine_pool.h"
+#include "xrCore/Threading/TaskManager.hpp"
 
 CALifeScheduleRegistry::~CALifeScheduleRegistry() {}
 void CALifeScheduleRegistry::add(CSE_ALifeDynamicObject* object)
@@ -30,3 +34,38 @@ void CALifeScheduleRegistry::remove(CSE_ALifeDynamicObject* object, bool no_asse
 
     inherited::remove(object->ID, no_assert || !schedulable->need_update(object));
 }
+
+// The objects the following update is going to process are collected the same way
+// CUpdatePredicate selects them and their read-only part runs concurrently. The updates
+// themselves stay sequential and in the registry order, so every registry change happens
+// exactly as without the preparation. An object consumes the prepared result only if its
+// inputs are still the same, otherwise it computes it again
+void CALifeScheduleRegistry::prepare()
+{
+    CGraphEnginePool* pool = ai().graph_engine_pool();
+    if (!g_mt_config.test(mtALifeConcurrent) || !pool || (m_objects_per_update < 2))
+        return;
+
+    START_PROFILE("ALife/scheduled/prepare")
+    m_batch.clear();
+    _iterator I = next();
+    for (u32 i = 0, n = _min(m_objects_per_update, u32(objects().size())); i < n; ++i)
+    {
+        if ((*I).second->m_schedule_counter == m_cycle_count + 1)
+            break;
+
+        m_batch.push_back((*I).second);
+        if (++I == m_objects.end())
+            I = m_objects.begin();
+    }
+
+    if (m_batch.size() > 1)
+    {
+        TaskScheduler.ParallelFor(0, m_batch.size(), 1, [&](u32 from, u32 to) {
+            CGraphEngineScope scope(*pool, 0);
+            for (u32 i = from; i < to; ++i)
+                m_batch[i]->prepare_update();
+        });
+    }
+    STOP_PROFILE
+}
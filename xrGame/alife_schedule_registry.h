@@ -9,12 +9,14 @@
 #pragma once
 
 #include "safe_map_iterator.h"
+#include "slot_map.h"
 #include "xrServer_Objects_ALife.h"
 #include "ai_debug.h"
 #include "xrEngine/profiler.h"
 
-class CALifeScheduleRegistry
-    : public CSafeMapIterator<ALife::_OBJECT_ID, CSE_ALifeSchedulable, std::less<ALife::_OBJECT_ID>, false>
+class CALifeScheduleRegistry : public CSafeMapIterator<ALife::_OBJECT_ID, CSE_ALifeSchedulable,
+                                   std::less<ALife::_OBJECT_ID>, false, u64, true,
+                                   CSlotMap<ALife::_OBJECT_ID, CSE_ALifeSchedulable>>
 {
 private:
     struct CUpdatePredicate
@@ -51,10 +53,16 @@ private:
     };
 
 protected:
-    typedef CSafeMapIterator<ALife::_OBJECT_ID, CSE_ALifeSchedulable, std::less<ALife::_OBJECT_ID>, false> inherited;
+    typedef CSafeMapIterator<ALife::_OBJECT_ID, CSE_ALifeSchedulable, std::less<ALife::_OBJECT_ID>, false, u64, true,
+        CSlotMap<ALife::_OBJECT_ID, CSE_ALifeSchedulable>>
+        inherited;
 
 protected:
     u32 m_objects_per_update;
+    xr_vector<CSE_ALifeSchedulable*> m_batch;
+
+protected:
+    void prepare();
 
 public:
     IC CALifeScheduleRegistry();
@@ -17,6 +17,9 @@ IC void CALifeScheduleRegistry::objects_per_update(const u32& objects_per_update
 
 IC void CALifeScheduleRegistry::update()
 {
+    if (!objects().empty())
+        prepare();
+
     //	u32							count =
     objects().empty() ? 0 : inherited::update(CUpdatePredicate(m_objects_per_update), false);
 #ifdef DEBUG
@@ -22,6 +22,7 @@
 #include "string_table.h"
 #include "xrEngine/IGame_Persistent.h"
 #include "autosave_manager.h"
+#include "alife_save_stream.h"
 
 XRCORE_API string_path g_bug_report_file;
 
@@ -29,7 +30,12 @@ using namespace ALife;
 
 extern string_path g_last_saved_game;
 
-CALifeStorageManager::~CALifeStorageManager() { *g_last_saved_game = 0; }
+CALifeStorageManager::~CALifeStorageManager()
+{
+    *g_last_saved_game = 0;
+    xr_delete(m_save_writer);
+}
+
 void CALifeStorageManager::save(LPCSTR save_name_no_check, bool update_name)
 {
     LPCSTR game_saves_path = FS.get_path("$game_saves$")->m_Path;
@@ -55,37 +61,31 @@ void CALifeStorageManager::save(LPCSTR save_name_no_check, bool update_name)
         }
     }
 
-    u32 source_count;
-    u32 dest_count;
-    void* dest_data;
-    {
-        CMemoryWriter stream;
-        header().save(stream);
-        time_manager().save(stream);
-        spawns().save(stream);
-        objects().save(stream);
-        registry().save(stream);
-
-        source_count = stream.tell();
-        void* source_data = stream.pointer();
-        dest_count = rtc_csize(source_count);
-        dest_data = xr_malloc(dest_count);
-        dest_count = rtc_compress(dest_data, dest_count, source_data, source_count);
-    }
+    // every section is compressed on the task scheduler while the next one is serialized
+    if (!m_save_writer)
+        m_save_writer = new CALifeSaveWriter();
+
+    CALifeSaveWriter& stream = *m_save_writer;
+    header().save(stream.open_block(ALIFE_CHUNK_DATA, 0));
+    stream.close_block();
+    time_manager().save(stream.open_block(GAME_TIME_CHUNK_DATA, 0));
+    stream.close_block();
+    spawns().save(stream.open_block(SPAWN_CHUNK_DATA, 0));
+    stream.close_block();
+    objects().save(stream);
+    registry().save(stream.open_block(REGISTRY_CHUNK_DATA, 0));
+    stream.close_block();
 
     string_path temp;
     FS.update_path(temp, "$game_saves$", m_save_name);
     IWriter* writer = FS.w_open(temp);
-    writer->w_u32(u32(-1));
+    writer->w_u32(ALIFE_SAVE_SECTIONS);
     writer->w_u32(ALIFE_VERSION);
-
-    writer->w_u32(source_count);
-    writer->w(dest_data, dest_count);
-    xr_free(dest_data);
+    stream.save(*writer);
     FS.w_close(writer);
 #ifdef DEBUG
-    Msg("* Game %s is successfully saved to file '%s' (%d bytes compressed to %d)", m_save_name, temp, source_count,
-        dest_count + 4);
+    Msg("* Game %s is successfully saved to file '%s' (%d bytes compressed to %d, %d of %d blocks are reused)",
+        m_save_name, temp, stream.source_size(), stream.data_size(), stream.reused_count(), stream.block_count());
 #else // DEBUG
     Msg("* Game %s is successfully saved to file '%s'", m_save_name, temp);
 #endif // DEBUG
@@ -94,12 +94,11 @@ void CALifeStorageManager::save(LPCSTR save_name_no_check, bool update_name)
         xr_strcpy(m_save_name, save);
 }
 
-void CALifeStorageManager::load(void* buffer, const u32& buffer_size, LPCSTR file_name)
+void CALifeStorageManager::load(const CALifeSaveReader& source, LPCSTR file_name)
 {
-    IReader source(buffer, buffer_size);
-    header().load(source);
-    time_manager().load(source);
-    spawns().load(source, file_name);
+    source.load(ALIFE_CHUNK_DATA, [this](IReader& stream) { header().load(stream); });
+    source.load(GAME_TIME_CHUNK_DATA, [this](IReader& stream) { time_manager().load(stream); });
+    source.load(SPAWN_CHUNK_DATA, [this, file_name](IReader& stream) { spawns().load(stream, file_name); });
     graph().on_load();
     objects().load(source);
 
@@ -116,7 +115,7 @@ void CALifeStorageManager::load(void* buffer, const u32& buffer_size, LPCSTR fil
         register_object((*I).second, false);
     }
 
-    registry().load(source);
+    source.load(REGISTRY_CHUNK_DATA, [this](IReader& stream) { registry().load(stream); });
 
     can_register_objects(true);
 
@@ -179,12 +178,11 @@ bool CALifeStorageManager::load(LPCSTR save_name_no_check)
     unload();
     reload(m_section);
 
-    u32 source_count = stream->r_u32();
-    void* source_data = xr_malloc(source_count);
-    rtc_decompress(source_data, source_count, stream->pointer(), stream->length() - 3 * sizeof(u32));
+    {
+        CALifeSaveReader source(*stream);
+        load(source, file_name);
+    }
     FS.r_close(stream);
-    load(source_data, source_count, file_name);
-    xr_free(source_data);
 
     groups().on_after_game_load();
 
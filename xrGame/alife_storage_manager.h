@@ -11,6 +11,8 @@
 #include "alife_simulator_base.h"
 
 class NET_Packet;
+class CALifeSaveWriter;
+class CALifeSaveReader;
 
 class CALifeStorageManager : public virtual CALifeSimulatorBase
 {
@@ -22,10 +24,11 @@ protected:
 protected:
     string_path m_save_name;
     LPCSTR m_section;
+    CALifeSaveWriter* m_save_writer;
 
 private:
     void prepare_objects_for_save();
-    void load(void* buffer, const u32& buffer_size, LPCSTR file_name);
+    void load(const CALifeSaveReader& source, LPCSTR file_name);
 
 public:
     IC CALifeStorageManager(IPureServer* server, LPCSTR section);
@@ -11,5 +11,6 @@
 IC CALifeStorageManager::CALifeStorageManager(IPureServer* server, LPCSTR section) : inherited(server, section)
 {
     m_section = section;
+    m_save_writer = 0;
     xr_strcpy(m_save_name, "");
 }
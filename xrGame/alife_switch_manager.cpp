@@ -9,6 +9,7 @@
 #include "stdafx.h"
 #include "alife_switch_manager.h"
 #include "xrServer_Objects_ALife.h"
+#include "xrServer_Objects_ALife_Monsters.h"
 #include "alife_graph_registry.h"
 #include "alife_object_registry.h"
 #include "alife_schedule_registry.h"
@@ -23,6 +24,9 @@
 
 using namespace ALife;
 
+extern float g_alife_switch_band_speed;
+extern float g_alife_switch_band_delay;
+
 struct remove_non_savable_predicate
 {
     IPureServer* m_server;
@@ -252,3 +256,36 @@ void CALifeSwitchManager::switch_object(CSE_ALifeDynamicObject* I)
     if (I->redundant())
         release(I);
 }
+
+float CALifeSwitchManager::switch_slack(CSE_ALifeDynamicObject* object) const
+{
+    // every object is evaluated at least once per the band delay, since the switch conditions
+    // which don't depend on the distance (health, ammo, scripts) aren't tracked
+    float max_slack = g_alife_switch_band_speed * g_alife_switch_band_delay;
+    if (!object->can_switch_online() || !object->can_switch_offline())
+        return (max_slack);
+
+    if (object->cast_group_abstract())
+        return (0.f);
+
+    const Fvector& actor_position = graph().actor()->o_Position;
+    float distance = actor_position.distance_to(object->o_Position);
+
+    CSE_ALifeOnlineOfflineGroup* group = object->cast_online_offline_group();
+    if (group)
+    {
+        // the nearest member decides
+        if (group->squad_members().empty())
+            return (max_slack);
+
+        distance = flt_max;
+        CSE_ALifeOnlineOfflineGroup::MEMBERS::const_iterator I = group->squad_members().begin();
+        CSE_ALifeOnlineOfflineGroup::MEMBERS::const_iterator E = group->squad_members().end();
+        for (; I != E; ++I)
+            distance = _min(distance, actor_position.distance_to((*I).second->o_Position));
+    }
+
+    float slack = object->m_bOnline ? offline_distance() - distance : distance - online_distance();
+    clamp(slack, 0.f, max_slack);
+    return (slack);
+}
@@ -40,6 +40,7 @@ public:
     IC CALifeSwitchManager(IPureServer* server, LPCSTR section);
     virtual ~CALifeSwitchManager();
     void switch_object(CSE_ALifeDynamicObject* object);
+    float switch_slack(CSE_ALifeDynamicObject* object) const;
     IC float online_distance() const;
     IC float offline_distance() const;
     IC float switch_distance() const;
@@ -26,6 +26,8 @@
 using namespace ALife;
 
 extern string_path g_last_saved_game;
+extern BOOL g_alife_switch_band;
+extern float g_alife_switch_band_speed;
 
 class CSwitchPredicate
 {
@@ -49,6 +51,17 @@ public:
     }
 };
 
+class CSwitchBandPredicate
+{
+private:
+    CALifeSwitchManager* m_switch_manager;
+
+public:
+    IC CSwitchBandPredicate(CALifeSwitchManager* switch_manager) { m_switch_manager = switch_manager; }
+    IC void operator()(CSE_ALifeDynamicObject* object) const { m_switch_manager->switch_object(object); }
+    IC float slack(CSE_ALifeDynamicObject* object) const { return (m_switch_manager->switch_slack(object)); }
+};
+
 CALifeUpdateManager::CALifeUpdateManager(IPureServer* server, LPCSTR section)
     : CALifeSwitchManager(server, section), CALifeSurgeManager(server, section), CALifeStorageManager(server, section),
       CALifeSimulatorBase(server, section)
@@ -62,6 +75,12 @@ CALifeUpdateManager::CALifeUpdateManager(IPureServer* server, LPCSTR section)
     m_objects_per_update = pSettings->r_u32(section, "objects_per_update");
     m_changing_level = false;
     m_first_time = true;
+    m_switch_band = false;
+    m_switch_band_distance = 0.f;
+    m_switch_band_factor = 0.f;
+    m_switch_clock = 0.0;
+    m_switch_position.set(0.f, 0.f, 0.f);
+    m_switch_time = 0;
 }
 
 CALifeUpdateManager::~CALifeUpdateManager()
@@ -80,7 +99,33 @@ void CALifeUpdateManager::update_switch()
     init_ef_storage();
 
     START_PROFILE("ALife/switch");
-    graph().level().update(CSwitchPredicate(this), Device.dwPrecacheFrame > 0);
+    if (!g_alife_switch_band || (Device.dwPrecacheFrame > 0))
+    {
+        m_switch_band = false;
+        graph().level().update(CSwitchPredicate(this), Device.dwPrecacheFrame > 0);
+    }
+    else
+    {
+        // the switch clock is an upper bound of how much the distance between the actor and any
+        // object could have changed: the actor path plus the top object speed by the elapsed time
+        const Fvector& position = graph().actor()->o_Position;
+        const u32 time = Device.dwTimeGlobal;
+        if (!m_switch_band || (m_switch_band_distance != switch_distance()) ||
+            (m_switch_band_factor != m_switch_factor))
+        {
+            m_switch_band = true;
+            m_switch_band_distance = switch_distance();
+            m_switch_band_factor = m_switch_factor;
+            graph().level().reset_switch(m_switch_clock);
+        }
+        else
+            m_switch_clock += m_switch_position.distance_to(position) +
+                g_alife_switch_band_speed * float(time - m_switch_time) / 1000.f;
+
+        m_switch_position = position;
+        m_switch_time = time;
+        graph().level().update_switch(CSwitchBandPredicate(this), m_switch_clock);
+    }
     STOP_PROFILE
 }
 
@@ -304,6 +349,7 @@ void CALifeUpdateManager::set_switch_online(ALife::_OBJECT_ID id, bool value)
     CSE_ALifeDynamicObject* object = objects().object(id);
     VERIFY(object);
     object->can_switch_online(value);
+    graph().level().schedule_switch(id);
 }
 
 void CALifeUpdateManager::set_switch_offline(ALife::_OBJECT_ID id, bool value)
@@ -311,6 +357,7 @@ void CALifeUpdateManager::set_switch_offline(ALife::_OBJECT_ID id, bool value)
     CSE_ALifeDynamicObject* object = objects().object(id);
     VERIFY(object);
     object->can_switch_offline(value);
+    graph().level().schedule_switch(id);
 }
 
 void CALifeUpdateManager::set_interactive(ALife::_OBJECT_ID id, bool value)
@@ -397,6 +444,7 @@ void CALifeUpdateManager::teleport_object(
     CSE_ALifeMonsterAbstract* monster_abstract = smart_cast<CSE_ALifeMonsterAbstract*>(object);
     if (monster_abstract)
         monster_abstract->m_tNextGraphID = object->m_tGraphID;
+    graph().level().schedule_switch(id);
 }
 
 void CALifeUpdateManager::add_restriction(
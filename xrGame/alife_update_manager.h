@@ -24,6 +24,12 @@ class CALifeUpdateManager : public CALifeSwitchManager,
 {
 private:
     bool m_first_time;
+    bool m_switch_band;
+    float m_switch_band_distance;
+    float m_switch_band_factor;
+    double m_switch_clock;
+    Fvector m_switch_position;
+    u32 m_switch_time;
 
 protected:
     u64 m_max_process_time;
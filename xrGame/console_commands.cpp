@@ -38,6 +38,8 @@
 #include "MainMenu.h"
 #include "saved_game_wrapper.h"
 #include "xrAICore/Navigation/level_graph.h"
+#include "xrAICore/Navigation/level_graph_hierarchy.h"
+#include "xrAICore/Navigation/graph_engine.h"
 
 #include "cameralook.h"
 #include "character_hit_animations_params.h"
@@ -97,6 +99,11 @@ extern float g_smart_cover_animation_speed_factor;
 
 extern BOOL g_ai_use_old_vision;
 float g_aim_predict_time = 0.44f;
+BOOL g_ai_hierarchical_paths = TRUE;
+BOOL g_ai_level_path_cache = TRUE;
+BOOL g_alife_switch_band = TRUE;
+float g_alife_switch_band_speed = 40.f;
+float g_alife_switch_band_delay = 2.f;
 int g_keypress_on_start = 1;
 
 ENGINE_API extern float g_console_sensitive;
@@ -107,7 +114,7 @@ void register_mp_console_commands();
 BOOL g_bCheckTime = FALSE;
 int net_cl_inputupdaterate = 50;
 Flags32 g_mt_config = {mtLevelPath | mtDetailPath | mtObjectHandler | mtSoundPlayer | mtAiVision | mtBullets |
-    mtLUA_GC | mtLevelSounds | mtALife | mtMap};
+    mtLUA_GC | mtLevelSounds | mtALife | mtMap | mtLevelPathConcurrent | mtALifeConcurrent | mtAiVisionBatch};
 #ifdef DEBUG
 Flags32 dbg_net_Draw_Flags = {0};
 #endif
@@ -382,6 +389,73 @@ public:
     }
 };
 
+#include "alife_object_registry.h"
+#include "alife_schedule_registry.h"
+#include "alife_graph_registry.h"
+
+// al_update_bench [updates], every update processes all the scheduled objects
+class CCC_ALifeUpdateBench : public IConsole_Command
+{
+public:
+    CCC_ALifeUpdateBench(LPCSTR N) : IConsole_Command(N) { bEmptyArgsHandled = true; };
+    virtual void Execute(LPCSTR args)
+    {
+        if ((GameID() != eGameIDSingle) || !ai().get_alife())
+        {
+            Log("!Not a single player game!");
+            return;
+        }
+
+        game_sv_Single* tpGame = smart_cast<game_sv_Single*>(Level().Server->GetGameState());
+        VERIFY(tpGame);
+        CALifeSimulator& simulator = tpGame->alife();
+        const CALifeObjectRegistry& objects = ai().alife().objects();
+
+        u32 count = 16;
+        if (xr_strlen(args))
+            sscanf(args, "%u", &count);
+        count = _max(count, 1u);
+
+        const u32 objects_per_update = simulator.scheduled().objects_per_update();
+        simulator.objects_per_update(_max(u32(simulator.scheduled().objects().size()), 1u));
+
+        CTimer timer;
+        float total = 0.f, worst = 0.f;
+        for (u32 i = 0; i < count; ++i)
+        {
+            timer.Start();
+            simulator.update();
+            const float time = timer.GetElapsed_sec();
+            total += time;
+            worst = _max(worst, time);
+        }
+        simulator.objects_per_update(objects_per_update);
+
+        u32 found = 0;
+        timer.Start();
+        for (u32 id = 0; id < ALife::_OBJECT_ID(-1); ++id)
+            if (objects.object(ALife::_OBJECT_ID(id), true))
+                ++found;
+        const float lookup = timer.GetElapsed_sec();
+
+        u32 visited = 0;
+        timer.Start();
+        CALifeObjectRegistry::OBJECT_REGISTRY::const_iterator I = objects.objects().begin();
+        CALifeObjectRegistry::OBJECT_REGISTRY::const_iterator E = objects.objects().end();
+        for (; I != E; ++I)
+            visited += (*I).second->m_bOnline ? 1 : 0;
+        const float iteration = timer.GetElapsed_sec();
+
+        Msg("- %u objects, %u scheduled, %u on the current level, %u online", objects.objects().size(),
+            simulator.scheduled().objects().size(), simulator.graph().level().objects().size(), visited);
+        Msg("- %u full updates: %.3f ms average, %.3f ms worst", count, total * 1000.f / count, worst * 1000.f);
+        Msg("- %u lookups (%u found): %.3f ms, registry iteration: %.3f ms", u32(ALife::_OBJECT_ID(-1)), found,
+            lookup * 1000.f, iteration * 1000.f);
+        Msg("- switch band %s, %u switch events queued", g_alife_switch_band ? "on" : "off",
+            simulator.graph().level().switch_queue_size());
+    }
+};
+
 //-----------------------------------------------------------------------
 class CCC_DemoRecord : public IConsole_Command
 {
@@ -754,6 +828,200 @@ public:
     }
 };
 
+#ifndef MASTER_GOLD
+// Nearest level vertex lookup (CLevelGraph::vertex(position)) against the full scan over the vertices.
+// ai_level_graph_bench [queries] [level name], the current level graph by default
+class CCC_LevelGraphBench : public IConsole_Command
+{
+    static u32 full_scan(const CLevelGraph& graph, const Fvector& position)
+    {
+        float min_dist = flt_max;
+        u32 selected = u32(-1);
+        for (u32 i = 0, n = graph.header().vertex_count(); i < n; ++i)
+        {
+            const float dist = graph.distance(i, position);
+            if (dist < min_dist)
+            {
+                min_dist = dist;
+                selected = i;
+            }
+        }
+        return (selected);
+    }
+
+public:
+    CCC_LevelGraphBench(LPCSTR N) : IConsole_Command(N) { bEmptyArgsHandled = true; };
+    virtual void Execute(LPCSTR args)
+    {
+        string256 param;
+        u32 count = 256;
+        if (xr_strlen(_GetItem(args, 0, param, ' ')))
+            sscanf(param, "%u", &count);
+        count = _max(count, 10u);
+
+        CLevelGraph* loaded = 0;
+        const CLevelGraph* graph = ai().get_level_graph();
+        if (xr_strlen(_GetItem(args, 1, param, ' ')))
+        {
+            string_path path, file_name;
+            xr_strcat(param, "\\");
+            FS.update_path(path, "$game_levels$", param);
+            strconcat(sizeof(file_name), file_name, path, LEVEL_GRAPH_NAME);
+            if (!FS.exist(file_name))
+            {
+                Msg("! %s not found", file_name);
+                return;
+            }
+            graph = loaded = new CLevelGraph(path);
+        }
+        if (!graph)
+        {
+            Log("! level graph is not loaded");
+            return;
+        }
+
+        const u32 vertex_count = graph->header().vertex_count();
+        if (!vertex_count)
+        {
+            Log("! level graph has no vertices");
+            xr_delete(loaded);
+            return;
+        }
+
+        // half of the points are scattered over the bounding box, the rest just off the vertices
+        const Fbox& box = graph->header().box();
+        xr_vector<Fvector> points(count);
+        for (u32 i = 0; i < count; ++i)
+        {
+            Fvector& P = points[i];
+            if (i & 1)
+            {
+                P = graph->vertex_position(u32((::Random.randI() << 15) | ::Random.randI()) % vertex_count);
+                P.add(Fvector().set(::Random.randFs(3.f), ::Random.randFs(3.f), ::Random.randFs(3.f)));
+            }
+            else
+                P.set(::Random.randF(box.min.x - 10.f, box.max.x + 10.f), ::Random.randF(box.min.y, box.max.y),
+                    ::Random.randF(box.min.z - 10.f, box.max.z + 10.f));
+        }
+
+        CTimer timer;
+        timer.Start();
+        const CLevelGraph::SVertexGrid& grid = graph->vertex_grid();
+        const float build = timer.GetElapsed_sec();
+
+        xr_vector<u32> expected(count);
+        timer.Start();
+        for (u32 i = 0; i < count; ++i)
+            expected[i] = full_scan(*graph, points[i]);
+        const float scan = timer.GetElapsed_sec();
+
+        u32 mismatches = 0;
+        timer.Start();
+        for (u32 i = 0; i < count; ++i)
+        {
+            if (graph->vertex(points[i]) != expected[i])
+                ++mismatches;
+        }
+        const float lookup = timer.GetElapsed_sec();
+
+        Msg("- level graph: %u vertices, %ux%u buckets built in %.2f ms", vertex_count, grid.size_x, grid.size_z,
+            build * 1000.f);
+        Msg("- %u queries: full scan %.2f us, grid %.2f us (x%.1f), %u mismatches", count,
+            scan * 1000000.f / count, lookup * 1000000.f / count, lookup > 0.f ? scan / lookup : 0.f, mismatches);
+
+        xr_delete(loaded);
+    }
+};
+
+// Level path search over the whole graph against the search within the cluster corridor.
+// ai_level_path_bench [paths], random vertex pairs the hierarchical search is used for
+class CCC_LevelPathBench : public IConsole_Command
+{
+    struct SResult
+    {
+        float time;
+        u32 found;
+        u32 length;
+        u32 visited;
+
+        SResult() : time(0.f), found(0), length(0), visited(0) {}
+    };
+
+public:
+    CCC_LevelPathBench(LPCSTR N) : IConsole_Command(N) { bEmptyArgsHandled = true; };
+    virtual void Execute(LPCSTR args)
+    {
+        const CLevelGraphHierarchy* hierarchy = ai().level_graph_hierarchy();
+        if (!ai().get_level_graph() || !hierarchy)
+        {
+            Log("! level graph is not loaded");
+            return;
+        }
+
+        u32 count = 64;
+        if (xr_strlen(args))
+            sscanf(args, "%u", &count);
+        count = _max(count, 1u);
+
+        const CLevelGraph& graph = ai().level_graph();
+        const u32 vertex_count = graph.header().vertex_count();
+        if (!vertex_count)
+        {
+            Log("! level graph has no vertices");
+            return;
+        }
+
+        xr_vector<std::pair<u32, u32>> pairs;
+        for (u32 i = 0; pairs.size() < count && i < count * 64; ++i)
+        {
+            const u32 start = u32((::Random.randI() << 15) | ::Random.randI()) % vertex_count;
+            const u32 dest = u32((::Random.randI() << 15) | ::Random.randI()) % vertex_count;
+            if (hierarchy->distant(start, dest))
+                pairs.push_back(std::make_pair(start, dest));
+        }
+
+        CGraphEngine& engine = ai().graph_engine();
+        const SBaseParameters<float, u32, u32> parameters;
+        xr_vector<u32> path;
+        SResult flat, clustered;
+        CTimer timer;
+        for (auto& it : pairs)
+        {
+            timer.Start();
+            if (engine.search(graph, it.first, it.second, &path, parameters))
+            {
+                flat.time += timer.GetElapsed_sec();
+                flat.length += path.size();
+                ++flat.found;
+            }
+            else
+                flat.time += timer.GetElapsed_sec();
+            flat.visited += engine.m_algorithm->data_storage().get_visited_node_count();
+
+            timer.Start();
+            if (engine.search_hierarchical(*hierarchy, graph, it.first, it.second, &path, parameters))
+            {
+                clustered.time += timer.GetElapsed_sec();
+                clustered.length += path.size();
+                ++clustered.found;
+            }
+            else
+                clustered.time += timer.GetElapsed_sec();
+            clustered.visited += engine.m_algorithm->data_storage().get_visited_node_count();
+        }
+
+        const u32 n = _max(u32(pairs.size()), 1u);
+        Msg("- level graph: %u vertices, %u clusters (%u KB)", vertex_count, hierarchy->cluster_count(),
+            hierarchy->memory() / 1024);
+        Msg("- %u paths: full %.3f ms, %u found, %u nodes visited, %u vertices long", pairs.size(),
+            flat.time * 1000.f / n, flat.found, flat.visited / n, flat.length / _max(flat.found, 1u));
+        Msg("- %u paths: hierarchical %.3f ms, %u found, %u nodes visited, %u vertices long", pairs.size(),
+            clustered.time * 1000.f / n, clustered.found, clustered.visited / n,
+            clustered.length / _max(clustered.found, 1u));
+    }
+};
+#endif // MASTER_GOLD
+
 class CCC_FloatBlock : public CCC_Float
 {
 public:
@@ -947,7 +1215,7 @@ public:
     CCC_DumpCreatures(LPCSTR N) : IConsole_Command(N) { bEmptyArgsHandled = true; };
     virtual void Execute(LPCSTR args)
     {
-        typedef CSafeMapIterator<ALife::_OBJECT_ID, CSE_ALifeDynamicObject>::_REGISTRY::const_iterator const_iterator;
+        typedef CALifeLevelRegistry::_REGISTRY::const_iterator const_iterator;
 
         const_iterator I = ai().alife().graph().level().objects().begin();
         const_iterator E = ai().alife().graph().level().objects().end();
@@ -1775,6 +2043,10 @@ void CCC_RegisterCommands()
     CMD1(CCC_ALifeProcessTime, "al_process_time"); // set process time
     CMD1(CCC_ALifeObjectsPerUpdate, "al_objects_per_update"); // set process time
     CMD1(CCC_ALifeSwitchFactor, "al_switch_factor"); // set switch factor
+    CMD1(CCC_ALifeUpdateBench, "al_update_bench");
+    CMD4(CCC_Integer, "al_switch_band", &g_alife_switch_band, 0, 1);
+    CMD4(CCC_Float, "al_switch_band_speed", &g_alife_switch_band_speed, 0.f, 1000.f);
+    CMD4(CCC_Float, "al_switch_band_delay", &g_alife_switch_band_delay, 0.f, 60.f);
 #endif // #ifndef MASTER_GOLD
 
     CMD3(CCC_Mask, "hud_weapon", &psHUD_Flags, HUD_WEAPON);
@@ -1805,7 +2077,10 @@ void CCC_RegisterCommands()
 #ifndef MASTER_GOLD
     // ai
     CMD3(CCC_Mask, "mt_ai_vision", &g_mt_config, mtAiVision);
+    CMD3(CCC_Mask, "mt_ai_vision_batch", &g_mt_config, mtAiVisionBatch);
     CMD3(CCC_Mask, "mt_level_path", &g_mt_config, mtLevelPath);
+    CMD3(CCC_Mask, "mt_level_path_concurrent", &g_mt_config, mtLevelPathConcurrent);
+    CMD3(CCC_Mask, "mt_alife_concurrent", &g_mt_config, mtALifeConcurrent);
     CMD3(CCC_Mask, "mt_detail_path", &g_mt_config, mtDetailPath);
     CMD3(CCC_Mask, "mt_object_handler", &g_mt_config, mtObjectHandler);
     CMD3(CCC_Mask, "mt_sound_player", &g_mt_config, mtSoundPlayer);
@@ -1816,7 +2091,12 @@ void CCC_RegisterCommands()
     CMD3(CCC_Mask, "mt_map", &g_mt_config, mtMap);
 #endif // MASTER_GOLD
 
+    CMD4(CCC_Integer, "ai_hierarchical_paths", &g_ai_hierarchical_paths, 0, 1);
+    CMD4(CCC_Integer, "ai_level_path_cache", &g_ai_level_path_cache, 0, 1);
+
 #ifndef MASTER_GOLD
+    CMD1(CCC_LevelGraphBench, "ai_level_graph_bench");
+    CMD1(CCC_LevelPathBench, "ai_level_path_bench");
     CMD3(CCC_Mask, "ai_obstacles_avoiding", &psAI_Flags, aiObstaclesAvoiding);
     CMD3(CCC_Mask, "ai_obstacles_avoiding_static", &psAI_Flags, aiObstaclesAvoidingStatic);
     CMD3(CCC_Mask, "ai_use_smart_covers", &psAI_Flags, aiUseSmartCovers);
@@ -21,6 +21,9 @@
 #include "DemoPlay_Control.h"
 #include "account_manager_console.h"
 #include "xrGameSpy/GameSpy_GP.h"
+#include "xrNetServer/NET_Transport.h"
+#include "mp_bot_client.h"
+#include "mp_bots_load_test.h"
 
 EGameIDs ParseStringToGameType(LPCSTR str);
 LPCSTR GameTypeToString(EGameIDs gt, bool bShort);
@@ -2028,6 +2031,108 @@ public:
     virtual void Info(TInfo& I) { xr_strcpy(I, "valid arguments is [info info_full on off]"); }
 };
 
+#ifndef MASTER_GOLD
+class CCC_NetTransportBench : public IConsole_Command
+{
+public:
+    CCC_NetTransportBench(LPCSTR N) : IConsole_Command(N) { bEmptyArgsHandled = true; };
+    virtual void Execute(LPCSTR args)
+    {
+        string64 transport = "loopback";
+        string64 channel = "reliable";
+        SNetTransportBench bench;
+        bench.messages = 10000;
+        bench.size = 256;
+        if (xr_strlen(args))
+            sscanf(args, "%63s %u %u %63s", transport, &bench.messages, &bench.size, channel);
+
+        bench.udp = !xr_strcmp(transport, "udp");
+        if (!bench.udp && xr_strcmp(transport, "loopback"))
+        {
+            InvalidSyntax();
+            return;
+        }
+
+        if (!xr_strcmp(channel, "reliable"))
+            bench.flags = NET_TRANSPORT_RELIABLE;
+        else if (!xr_strcmp(channel, "sequenced"))
+            bench.flags = NET_TRANSPORT_SEQUENCED;
+        else if (xr_strcmp(channel, "unreliable"))
+        {
+            InvalidSyntax();
+            return;
+        }
+
+        bench.messages = _max(bench.messages, 1u);
+        bench.size = _min(_max(bench.size, u32(sizeof(float))), NET_TransportMessageSizeLimit);
+        if (!net_transport_bench(bench))
+        {
+            Msg("! Can't connect the %s transport", transport);
+            return;
+        }
+
+        Msg("- %s %s: %u of %u messages of %u bytes echoed in %.3f sec, %u resent", transport, channel,
+            bench.delivered, bench.messages, bench.size, bench.seconds, bench.resent);
+        Msg("- %.0f messages/sec, %.3f MB/sec, round trip %.3f ms average, %.3f ms worst",
+            bench.delivered / _max(bench.seconds, EPS_S), 2.f * bench.delivered * bench.size / (1024.f * 1024.f) /
+                _max(bench.seconds, EPS_S), bench.average_latency, bench.max_latency);
+    }
+    virtual void Info(TInfo& I)
+    {
+        xr_strcpy(I, "[loopback|udp] [messages] [message size] [reliable|sequenced|unreliable]");
+    }
+};
+
+class CCC_MpBotsStart : public IConsole_Command
+{
+public:
+    CCC_MpBotsStart(LPCSTR N) : IConsole_Command(N){};
+    virtual void Execute(LPCSTR args)
+    {
+        if (g_bot_load_test)
+        {
+            Msg("! Bots load test is running already");
+            return;
+        }
+
+        u32 count = 0;
+        string512 address = "127.0.0.1";
+        if (sscanf(args, "%u %511s", &count, address) < 1)
+        {
+            InvalidSyntax();
+            return;
+        }
+
+        g_bot_load_test = new CBotLoadTest(count, address, g_mp_bots_behaviour.get());
+        Msg("- %u bots are connecting to %s", count, address);
+    }
+    virtual void Info(TInfo& I)
+    {
+        xr_strcpy(I, "<bots count> [host[/port=...][/psw=...]], 0 bots only measure the server of this process");
+    }
+};
+
+class CCC_MpBotsStop : public IConsole_Command
+{
+    bool m_stop;
+
+public:
+    CCC_MpBotsStop(LPCSTR N, bool stop) : IConsole_Command(N), m_stop(stop) { bEmptyArgsHandled = true; };
+    virtual void Execute(LPCSTR args)
+    {
+        if (!g_bot_load_test)
+        {
+            Msg("! Bots load test is not running");
+            return;
+        }
+
+        g_bot_load_test->Report();
+        if (m_stop)
+            xr_delete(g_bot_load_test);
+    }
+};
+#endif // MASTER_GOLD
+
 void register_mp_console_commands()
 {
     CMD1(CCC_Restart, "g_restart");
@@ -2051,6 +2156,7 @@ void register_mp_console_commands()
     CMD4(CCC_Integer, "net_sv_update_rate", &psNET_ServerUpdate, 1, 100);
     CMD4(CCC_Integer, "net_sv_pending_lim", &psNET_ServerPending, 0, 10);
     CMD4(CCC_Integer, "net_sv_gpmode", &psNET_GuaranteedPacketMode, 0, 2);
+    CMD3(CCC_Mask, "net_sv_parallel_send", &psNET_Flags, NETFLAG_PARALLEL_SEND);
     CMD3(CCC_Mask, "net_sv_log_data", &psNET_Flags, NETFLAG_LOG_SV_PACKETS);
     CMD3(CCC_Mask, "net_cl_log_data", &psNET_Flags, NETFLAG_LOG_CL_PACKETS);
 #ifdef DEBUG
@@ -2209,6 +2315,15 @@ void register_mp_console_commands()
     CMD4(CCC_Integer, "sv_show_player_scores_time", (int*)&g_sv_cta_PlayerScoresDelayTime, 1, 20); // sec
     CMD4(CCC_Integer, "sv_cta_runkup_to_arts_div", (int*)&g_sv_cta_rankUpToArtsCountDiv, 0, 10);
     CMD1(CCC_CompressorStatus, "net_compressor_status");
+#ifndef MASTER_GOLD
+    CMD1(CCC_NetTransportBench, "net_transport_bench");
+    CMD1(CCC_MpBotsStart, "mp_bots_start");
+    CMD2(CCC_MpBotsStop, "mp_bots_stop", true);
+    CMD2(CCC_MpBotsStop, "mp_bots_report", false);
+    CMD3(CCC_Mask, "mp_bots_move", &g_mp_bots_behaviour, CBotClient::eBotMove);
+    CMD3(CCC_Mask, "mp_bots_fire", &g_mp_bots_behaviour, CBotClient::eBotFire);
+    CMD3(CCC_Mask, "mp_bots_inventory", &g_mp_bots_behaviour, CBotClient::eBotInventory);
+#endif // MASTER_GOLD
     CMD4(CCC_SV_Integer, "net_compressor_enabled", (int*)&g_net_compressor_enabled, 0, 1);
     CMD4(CCC_SV_Integer, "net_compressor_gather_stats", (int*)&g_net_compressor_gather_stats, 0, 1);
     CMD1(CCC_MpStatistics, "sv_dump_online_statistics");
@@ -2229,5 +2344,5 @@ void register_mp_console_commands()
     CMD1(CCC_GameSpyRegisterUniqueNick, "gs_register_unique_nick");
     CMD1(CCC_GameSpyProfile, "gs_profile");
     CMD4(CCC_Integer, "sv_write_update_bin", &g_sv_write_updates_bin, 0, 1);
-    CMD4(CCC_Integer, "sv_traffic_optimization_level", (int*)&g_sv_traffic_optimization_level, 0, 7);
+    CMD4(CCC_Integer, "sv_traffic_optimization_level", (int*)&g_sv_traffic_optimization_level, 0, 15);
 }
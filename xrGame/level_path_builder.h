@@ -11,6 +11,7 @@
 #include "movement_manager.h"
 #include "level_path_manager.h"
 #include "detail_path_builder.h"
+#include "path_request_queue.h"
 
 class CLevelPathBuilder : public CDetailPathBuilder
 {
@@ -65,7 +66,18 @@ public:
         if (Device.dwTimeGlobal < m_last_fail_time + time_to_wait_after_fail)
             return;
 
-        Device.seqParallel.push_back(fastdelegate::FastDelegate0<>(this, &CLevelPathBuilder::process));
+        ai().path_requests().add(this);
+    }
+
+    IC bool can_prepare() const { return (m_object->can_prepare_level_path()); }
+    IC ALife::_OBJECT_ID object_id() const { return (m_object->object().ID()); }
+    // Graph search only, called by CPathRequestQueue on a worker thread before process
+    void prepare()
+    {
+        if (Device.dwTimeGlobal < m_last_fail_time + time_to_wait_after_fail)
+            return;
+
+        m_object->level_path().prepare_path(m_start_vertex_id, m_dest_vertex_id);
     }
 
     void process_impl()
@@ -110,6 +122,6 @@ public:
         if (m_object->m_wait_for_distributed_computation)
             m_object->m_wait_for_distributed_computation = false;
 
-        Device.remove_from_seq_parallel(fastdelegate::FastDelegate0<>(this, &CLevelPathBuilder::process));
+        ai().path_requests().remove(this);
     }
 };
@@ -0,0 +1,78 @@
+////////////////////////////////////////////////////////////////////////////
+//	Module 		: level_path_cache.cpp
+//	Description : Recently built level paths
+////////////////////////////////////////////////////////////////////////////
+
+#include "stdafx.h"
+#include "level_path_cache.h"
+
+bool CLevelPathCache::SKey::operator<(const SKey& other) const
+{
+    if (start_vertex_id != other.start_vertex_id)
+        return (start_vertex_id < other.start_vertex_id);
+    if (dest_vertex_id != other.dest_vertex_id)
+        return (dest_vertex_id < other.dest_vertex_id);
+    if (restriction != other.restriction)
+        return (restriction < other.restriction);
+    if (max_range != other.max_range)
+        return (max_range < other.max_range);
+    if (max_iteration_count != other.max_iteration_count)
+        return (max_iteration_count < other.max_iteration_count);
+    return (max_visited_node_count < other.max_visited_node_count);
+}
+
+CLevelPathCache::CLevelPathCache() : m_hit_count(0), m_miss_count(0) {}
+
+bool CLevelPathCache::find(const SKey& key, PATH& path)
+{
+    m_lock.Enter();
+    INDEX::iterator I = m_index.find(key);
+    if (I == m_index.end())
+    {
+        ++m_miss_count;
+        m_lock.Leave();
+        return (false);
+    }
+
+    ++m_hit_count;
+    m_entries.splice(m_entries.begin(), m_entries, (*I).second);
+    path = (*I).second->path;
+    m_lock.Leave();
+    return (true);
+}
+
+void CLevelPathCache::add(const SKey& key, const PATH& path)
+{
+    m_lock.Enter();
+    INDEX::iterator I = m_index.find(key);
+    if (I != m_index.end())
+    {
+        m_entries.splice(m_entries.begin(), m_entries, (*I).second);
+        (*I).second->path = path;
+        m_lock.Leave();
+        return;
+    }
+
+    // the least recently used entry is reused for the new path
+    if (m_index.size() >= max_entry_count)
+    {
+        m_index.erase(m_entries.back().key);
+        m_entries.splice(m_entries.begin(), m_entries, --m_entries.end());
+    }
+    else
+        m_entries.push_front(SEntry());
+
+    SEntry& entry = m_entries.front();
+    entry.key = key;
+    entry.path = path;
+    m_index.insert(std::make_pair(key, m_entries.begin()));
+    m_lock.Leave();
+}
+
+void CLevelPathCache::clear()
+{
+    m_lock.Enter();
+    m_index.clear();
+    m_entries.clear();
+    m_lock.Leave();
+}
@@ -0,0 +1,63 @@
+////////////////////////////////////////////////////////////////////////////
+//	Module 		: level_path_cache.h
+//	Description : Recently built level paths
+////////////////////////////////////////////////////////////////////////////
+
+#pragma once
+
+#include "xrCore/Threading/Lock.hpp"
+
+// Bounded LRU cache of the successful level path searches. A path depends on the start and
+// the goal vertices, the restriction borders applied for the search and the search limits,
+// so these make the key. The restrictions are referenced by the address of their shared
+// CSpaceRestriction, the cache is cleared when one is deleted or a restrictor changes.
+// Searches may run on the task scheduler workers (CPathRequestQueue), so it is locked
+class CLevelPathCache
+{
+public:
+    typedef xr_vector<u32> PATH;
+
+    struct SKey
+    {
+        u32 start_vertex_id;
+        u32 dest_vertex_id;
+        const void* restriction;
+        float max_range;
+        u32 max_iteration_count;
+        u32 max_visited_node_count;
+
+        bool operator<(const SKey& other) const;
+    };
+
+private:
+    enum
+    {
+        max_entry_count = 512,
+    };
+
+    struct SEntry
+    {
+        SKey key;
+        PATH path;
+    };
+
+    typedef xr_list<SEntry> ENTRIES;
+    typedef xr_map<SKey, ENTRIES::iterator> INDEX;
+
+private:
+    ENTRIES m_entries; // the most recently used first
+    INDEX m_index;
+    u32 m_hit_count;
+    u32 m_miss_count;
+    mutable Lock m_lock;
+
+public:
+    CLevelPathCache();
+    bool find(const SKey& key, PATH& path);
+    void add(const SKey& key, const PATH& path);
+    void clear();
+
+    IC u32 hit_count() const { return (m_hit_count); }
+    IC u32 miss_count() const { return (m_miss_count); }
+    IC u32 size() const { return (m_index.size()); }
+};
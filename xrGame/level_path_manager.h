@@ -23,6 +23,8 @@ private:
 protected:
     IC virtual void before_search(const _vertex_id_type start_vertex_id, const _vertex_id_type dest_vertex_id);
     IC virtual void after_search();
+    IC virtual bool search(
+        const _vertex_id_type start_vertex_id, const _vertex_id_type dest_vertex_id, typename inherited::PATH& path);
     IC virtual bool check_vertex(const _vertex_id_type vertex_id) const;
 
 public:
@@ -9,6 +9,11 @@
 #pragma once
 
 #include "xrEngine/profiler.h"
+#include "xrAICore/Navigation/level_graph_hierarchy.h"
+#include "level_path_cache.h"
+
+extern BOOL g_ai_hierarchical_paths;
+extern BOOL g_ai_level_path_cache;
 
 #define TEMPLATE_SPECIALIZATION \
     template <typename _VertexEvaluator, typename _vertex_id_type, typename _index_type\
@@ -66,6 +71,34 @@ IC void CLevelManagerTemplate::after_search()
         m_object->remove_border();
 }
 
+TEMPLATE_SPECIALIZATION
+IC bool CLevelManagerTemplate::search(
+    const _vertex_id_type start_vertex_id, const _vertex_id_type dest_vertex_id, typename inherited::PATH& path)
+{
+    const CSpaceRestriction* restriction = 0;
+    CLevelPathCache* cache = g_ai_level_path_cache ? ai().get_level_path_cache() : 0;
+    if (cache && m_object && !m_object->static_border(restriction))
+        cache = 0;
+
+    CLevelPathCache::SKey key = {start_vertex_id, dest_vertex_id, restriction, evaluator()->max_range,
+        evaluator()->max_iteration_count, evaluator()->max_visited_node_count};
+    if (cache && cache->find(key, path))
+        return (true);
+
+    bool result;
+    const CLevelGraphHierarchy* hierarchy = ai().level_graph_hierarchy();
+    if (g_ai_hierarchical_paths && hierarchy && hierarchy->distant(start_vertex_id, dest_vertex_id))
+        result = ai().graph_engine().search_hierarchical(
+            *hierarchy, ai().level_graph(), start_vertex_id, dest_vertex_id, &path, *evaluator());
+    else
+        result = inherited::search(start_vertex_id, dest_vertex_id, path);
+
+    if (result && cache)
+        cache->add(key, path);
+
+    return (result);
+}
+
 TEMPLATE_SPECIALIZATION
 IC bool CLevelManagerTemplate::check_vertex(const _vertex_id_type vertex_id) const
 {
@@ -77,6 +110,7 @@ IC void CLevelManagerTemplate::on_restrictions_change()
 {
     m_failed_start_vertex_id = _vertex_id_type(-1);
     m_failed_dest_vertex_id = _vertex_id_type(-1);
+    m_prepared = false;
 }
 
 #undef TEMPLATE_SPECIALIZATION
@@ -231,6 +231,8 @@ protected:
 
 public:
     virtual void build_level_path();
+    // Whether the level path search may run ahead of build_level_path (see CPathRequestQueue)
+    virtual bool can_prepare_level_path() const { return (true); }
 
 private:
     void show_game_path_info();
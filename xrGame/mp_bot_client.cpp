@@ -0,0 +1,609 @@
+#include "pch_script.h"
+#include "mp_bot_client.h"
+#include "xrServer_Objects_ALife_Monsters.h"
+#include "xrMessages.h"
+#include "inventory_space.h"
+#include "actor_defs.h"
+
+// around the actor spawn point
+static float const bot_move_radius = 4.f;
+static float const bot_move_speed = 2.5f;
+static u32 const bot_ready_interval = 2000;
+static u32 const bot_fire_interval = 400;
+static u32 const bot_inventory_interval = 3000;
+static float const bot_hit_power = 0.005f;
+
+CBotClient::CBotClient(u32 index, CTimer* timer) : IPureClient(timer)
+{
+    xr_sprintf(m_name, "bot_%02u", index);
+    m_behaviour = 0;
+    m_state = eStateConnecting;
+    m_random.seed(s32(index + 1));
+    ZeroMemory(&m_secret_key, sizeof(m_secret_key));
+
+    m_control_id = u16(-1);
+    m_actor_id = u16(-1);
+    m_team = 0;
+    m_home.set(0.f, 0.f, 0.f);
+    m_position.set(0.f, 0.f, 0.f);
+    m_yaw = 0.f;
+    m_phase = m_random.randF(PI_MUL_2);
+    m_active_slot = NO_ACTIVE_SLOT;
+    m_ruck_item = u16(-1);
+
+    m_last_update_time = 0;
+    m_last_ready_time = 0;
+    m_last_fire_time = 0;
+    m_last_inventory_time = 0;
+    m_last_statistic_time = 0;
+
+    m_delta_snapshot = 0;
+    m_delta_parts_left = 0;
+}
+
+CBotClient::~CBotClient() { Stop(); }
+bool CBotClient::Start(LPCSTR address, u32 behaviour)
+{
+    m_behaviour = behaviour;
+    m_connect_timer.Start();
+
+    string512 options;
+    xr_sprintf(options, "%s/name=%s", address, m_name);
+    if (!Connect(options))
+    {
+        fail("can't connect");
+        return false;
+    }
+    return true;
+}
+
+void CBotClient::Stop() { Disconnect(); }
+void CBotClient::fail(LPCSTR reason)
+{
+    if (eStateFailed == m_state)
+        return;
+    Msg("! %s failed: %s", m_name, reason);
+    m_fail_reason = reason;
+    m_state = eStateFailed;
+}
+
+void CBotClient::OnSessionTerminate(LPCSTR reason) { fail(xr_strlen(reason) ? reason : "session terminated"); }
+void CBotClient::Send(NET_Packet& P, u32 dwFlags, u32 dwTimeout)
+{
+    ++m_stats.messages_sent;
+    m_stats.bytes_sent += P.B.count;
+    IPureClient::Send(P, dwFlags, dwTimeout);
+}
+
+void CBotClient::secure_send(NET_Packet& P, u32 flags)
+{
+    NET_Packet enc_packet;
+    enc_packet.w_begin(M_SECURE_MESSAGE);
+    u32 checksum = secure_messaging::encrypt(P.B.data, P.B.count, m_secret_key);
+    enc_packet.w(P.B.data, P.B.count);
+    enc_packet.w_u32(checksum);
+    Send(enc_packet, flags);
+}
+
+void CBotClient::event_begin(NET_Packet& P, u16 type, u16 dest)
+{
+    P.w_begin(M_EVENT);
+    P.w_u32(timeServer());
+    P.w_u16(type);
+    P.w_u16(dest);
+}
+
+// game_PlayerState::net_Export of a full state with an offline account, without loading the profile
+void CBotClient::write_player_state(NET_Packet& P)
+{
+    P.w_u8(1);
+    P.w_u8(m_team);
+    P.w_s16(0);
+    P.w_s16(0);
+    P.w_s16(0);
+    P.w_s16(0);
+    P.w_s32(0);
+    P.w_u8(0);
+    P.w_u8(0);
+    P.w_u16(0);
+    P.w_u16(0);
+    P.w_u16(0);
+    P.w_s8(0);
+    P.w_u8(2);
+    P.w_u32(0);
+
+    P.w_u32(0);
+    P.w_stringZ(m_name);
+    P.w_stringZ("");
+    P.w_u8(0);
+    P.w_u8(0);
+    P.w_u16(0);
+}
+
+void CBotClient::Update()
+{
+    if (eStateFailed == m_state)
+        return;
+
+    if (net_isDisconnected())
+    {
+        fail("disconnected");
+        return;
+    }
+
+    if (eStateConnecting == m_state)
+    {
+        if (!net_isCompleted_Connect())
+            return;
+        net_Syncronize();
+        m_state = eStateHandshake;
+    }
+
+    StartProcessQueue();
+    while (NET_Packet* P = net_msg_Retreive())
+    {
+        ++m_stats.messages_received;
+        m_stats.bytes_received += P->B.count;
+        process_message(*P);
+        net_msg_Release();
+        if (eStateFailed == m_state)
+            break;
+    }
+    EndProcessQueue();
+
+    if (eStateFailed == m_state)
+        return;
+
+    u32 time = TimeGlobal(device_timer);
+    if (time - m_last_statistic_time >= 1000)
+    {
+        m_last_statistic_time = time;
+        UpdateStatistic();
+        m_stats.max_ping = _max(m_stats.max_ping, GetStatistic().getPing());
+    }
+
+    switch (m_state)
+    {
+    case eStateSpectator:
+    {
+        if ((u16(-1) != m_control_id) && (time - m_last_ready_time >= bot_ready_interval))
+        {
+            m_last_ready_time = time;
+            send_ready();
+        }
+    }
+    break;
+    case eStateAlive:
+    {
+        u32 update_interval = 1000 / _max(psNET_ClientUpdate, 1);
+        if (time - m_last_update_time >= update_interval)
+        {
+            send_update();
+            m_last_update_time = time;
+        }
+        if ((m_behaviour & eBotFire) && !m_targets.empty() &&
+            (time - m_last_fire_time >= bot_fire_interval + u32(m_random.randI(s32(bot_fire_interval)))))
+        {
+            m_last_fire_time = time;
+            send_hit();
+        }
+        if ((m_behaviour & eBotInventory) && !m_items.empty() &&
+            (time - m_last_inventory_time >= bot_inventory_interval))
+        {
+            m_last_inventory_time = time;
+            send_inventory_event();
+        }
+    }
+    break;
+    }
+
+    Flush_Send_Buffer();
+}
+
+void CBotClient::process_message(NET_Packet& P)
+{
+    u16 type;
+    P.r_begin(type);
+    switch (type)
+    {
+    case M_SECURE_KEY_SYNC:
+    {
+        s32 seed = P.r_s32();
+        secure_messaging::generate_key(seed, m_secret_key);
+
+        NET_Packet ack_key;
+        ack_key.w_begin(M_SECURE_KEY_SYNC);
+        ack_key.w_s32(seed);
+        Send(ack_key, net_flags(TRUE, TRUE, TRUE));
+    }
+    break;
+    case M_SECURE_MESSAGE: { process_secure_message(P);
+    }
+    break;
+    case M_AUTH_CHALLENGE:
+    {
+        NET_Packet S;
+        S.w_begin(M_CREATE_PLAYER_STATE);
+        write_player_state(S);
+        secure_send(S, net_flags(TRUE, TRUE, TRUE, TRUE));
+
+        S.w_begin(M_CL_AUTH);
+#ifdef USE_DEBUG_AUTH
+        S.w_u64(MP_DEBUG_AUTH);
+#else
+        S.w_u64(FS.auth_get());
+#endif // #ifdef USE_DEBUG_AUTH
+        secure_send(S, net_flags(TRUE, TRUE, TRUE, TRUE));
+    }
+    break;
+    case M_SV_DIGEST:
+    {
+        // the digest stands for the cd key, the server pools the states of the disconnected players by it
+        string128 digest;
+        xr_sprintf(digest, "load_test_%s", m_name);
+        NET_Packet S;
+        S.w_begin(M_SV_DIGEST);
+        S.w_stringZ(digest);
+        secure_send(S, net_flags(TRUE, TRUE, TRUE, TRUE));
+    }
+    break;
+    case M_CLIENT_CONNECT_RESULT:
+    {
+        u8 result = P.r_u8();
+        P.r_u8();
+        string512 result_str;
+        P.r_stringZ_s(result_str);
+        ClientID client_id;
+        P.r_clientID(client_id);
+        SetClientID(client_id);
+        if (!result)
+        {
+            fail(xr_strlen(result_str) ? result_str : "connection rejected");
+            break;
+        }
+        if (eStateHandshake != m_state)
+            break;
+
+        NET_Packet S;
+        S.w_begin(M_CLIENT_REQUEST_CONNECTION_DATA);
+        Send(S, net_flags(TRUE, TRUE, TRUE, TRUE));
+        m_state = eStateConfiguring;
+    }
+    break;
+    case M_SV_CONFIG_FINISHED:
+    {
+        if (eStateConfiguring != m_state)
+            break;
+
+        NET_Packet S;
+        S.w_begin(M_CLIENTREADY);
+        write_player_state(S);
+        Send(S, net_flags(TRUE, TRUE));
+
+        m_stats.connect_time = m_connect_timer.GetElapsed_ms();
+        m_state = (u16(-1) != m_actor_id) ? eStateAlive : eStateSpectator;
+    }
+    break;
+    case M_SPAWN: { process_spawn(P);
+    }
+    break;
+    case M_EVENT: { process_event(P);
+    }
+    break;
+    case M_EVENT_PACK:
+    {
+        NET_Packet tmpP;
+        while (!P.r_eof())
+        {
+            tmpP.B.count = P.r_u8();
+            P.r(tmpP.B.data, tmpP.B.count);
+            process_message(tmpP);
+        }
+    }
+    break;
+    case M_DELTA_UPDATE_OBJECTS: { process_delta_update(P);
+    }
+    break;
+    }
+}
+
+void CBotClient::process_secure_message(NET_Packet& P)
+{
+    NET_Packet dec_packet;
+    dec_packet.B.count = P.B.count - sizeof(u16) - sizeof(u32);
+    P.r(dec_packet.B.data, dec_packet.B.count);
+    u32 checksum = secure_messaging::decrypt(dec_packet.B.data, dec_packet.B.count, m_secret_key);
+    u32 real_checksum = P.r_u32();
+    if (checksum != real_checksum)
+    {
+        fail("secure message checksum mismatch");
+        return;
+    }
+    process_message(dec_packet);
+}
+
+void CBotClient::process_spawn(NET_Packet& P)
+{
+    shared_str s_name;
+    P.r_stringZ(s_name);
+    CSE_Abstract* E = F_entity_Create(*s_name);
+    if (!E)
+        return;
+
+    E->Spawn_Read(P);
+    ++m_stats.spawns;
+
+    bool local = E->s_flags.is(M_SPAWN_OBJECT_LOCAL);
+    CSE_ALifeCreatureActor* actor = smart_cast<CSE_ALifeCreatureActor*>(E);
+    if (E->s_flags.is(M_SPAWN_OBJECT_ASPLAYER))
+    {
+        if (local)
+        {
+            m_control_id = E->ID;
+            if (actor)
+            {
+                m_actor_id = E->ID;
+                m_team = actor->g_team();
+                m_home = E->o_Position;
+                m_position = E->o_Position;
+                m_yaw = E->o_Angle.y;
+                m_items.clear();
+                m_ruck_item = u16(-1);
+                m_active_slot = NO_ACTIVE_SLOT;
+                if (eStateSpectator == m_state)
+                    m_state = eStateAlive;
+            }
+            else
+            {
+                m_actor_id = u16(-1);
+                m_items.clear();
+                if (eStateAlive == m_state)
+                    m_state = eStateSpectator;
+            }
+        }
+        else if (actor)
+            m_targets.push_back(E->ID);
+    }
+    else if (local && (u16(-1) != m_actor_id) && (E->ID_Parent == m_actor_id))
+    {
+        // only the items an inventory slot can hold, as CInventoryItem reads it
+        if (pSettings->line_exist(s_name.c_str(), "slot"))
+        {
+            u32 slot = pSettings->r_u32(s_name.c_str(), "slot");
+            if (u32(-1) != slot)
+                m_items.push_back(std::make_pair(E->ID, u16(slot + 1)));
+        }
+    }
+
+    F_entity_Destroy(E);
+}
+
+void CBotClient::remove_object(u16 id)
+{
+    if (id == m_control_id)
+        m_control_id = u16(-1);
+
+    if (id == m_actor_id)
+    {
+        m_actor_id = u16(-1);
+        m_items.clear();
+        if (eStateAlive == m_state)
+            m_state = eStateSpectator;
+    }
+
+    xr_vector<u16>::iterator I = std::find(m_targets.begin(), m_targets.end(), id);
+    if (I != m_targets.end())
+        m_targets.erase(I);
+
+    for (xr_vector<std::pair<u16, u16>>::iterator J = m_items.begin(); J != m_items.end(); ++J)
+    {
+        if (J->first == id)
+        {
+            m_items.erase(J);
+            break;
+        }
+    }
+    if (id == m_ruck_item)
+        m_ruck_item = u16(-1);
+}
+
+void CBotClient::process_event(NET_Packet& P)
+{
+    u32 timestamp;
+    u16 type, dest;
+    P.r_u32(timestamp);
+    P.r_u16(type);
+    P.r_u16(dest);
+
+    switch (type)
+    {
+    case GE_DESTROY: { remove_object(dest);
+    }
+    break;
+    case GE_DIE:
+    {
+        if (dest != m_actor_id)
+        {
+            xr_vector<u16>::iterator I = std::find(m_targets.begin(), m_targets.end(), dest);
+            if (I != m_targets.end())
+                m_targets.erase(I);
+            break;
+        }
+        // the corpse stays, the next actor is spawned on the ready request
+        ++m_stats.deaths;
+        m_items.clear();
+        m_last_ready_time = TimeGlobal(device_timer);
+        if (eStateAlive == m_state)
+            m_state = eStateSpectator;
+    }
+    break;
+    case GE_OWNERSHIP_REJECT:
+    case GE_TRADE_SELL:
+    {
+        if (dest == m_actor_id)
+            remove_object(P.r_u16());
+    }
+    break;
+    }
+}
+
+void CBotClient::process_delta_update(NET_Packet& P)
+{
+    // the states are not imported, the snapshot is acknowledged as soon as all its parts are here for the server
+    // to make the next deltas against it, as it does for a real client
+    u32 snapshot_id = P.r_u32();
+    P.r_u32();
+    P.r_u8();
+    u8 parts = P.r_u8();
+    if (snapshot_id != m_delta_snapshot)
+    {
+        m_delta_snapshot = snapshot_id;
+        m_delta_parts_left = parts;
+    }
+    if (!m_delta_parts_left || --m_delta_parts_left)
+        return;
+
+    NET_Packet ack;
+    ack.w_begin(M_DELTA_UPDATE_ACK);
+    ack.w_u32(snapshot_id);
+    Send(ack, net_flags(FALSE, TRUE));
+}
+
+void CBotClient::send_ready()
+{
+    NET_Packet P;
+    event_begin(P, GE_GAME_EVENT, m_control_id);
+    P.w_u16(GAME_EVENT_PLAYER_READY);
+    Send(P);
+}
+
+// CActor::net_Export with one synchronized physics item, as an alive actor of a multiplayer game sends it
+void CBotClient::send_update()
+{
+    Fvector velocity;
+    velocity.set(0.f, 0.f, 0.f);
+    u16 move_state = 0;
+    if (m_behaviour & eBotMove)
+    {
+        float dt = _min(float(TimeGlobal(device_timer) - m_last_update_time) / 1000.f, 0.1f);
+        m_phase = angle_normalize(m_phase + dt * bot_move_speed / bot_move_radius);
+
+        Fvector position;
+        position.set(m_home.x + bot_move_radius * _cos(m_phase), m_home.y, m_home.z + bot_move_radius * _sin(m_phase));
+        if (dt > EPS)
+            velocity.sub(position, m_position).div(dt);
+        m_position = position;
+        m_yaw = angle_normalize(PI_DIV_2 - m_phase + PI);
+        move_state = u16(ACTOR_DEFS::mcFwd);
+    }
+
+    NET_Packet P;
+    P.w_begin(M_CL_UPDATE);
+    P.w_u16(m_actor_id);
+    P.w_u32(0); // reserved place for client's ping
+
+    P.w_float(1.f);
+    P.w_u32(timeServer());
+    P.w_u8(0);
+    P.w_vec3(m_position);
+    P.w_float(m_yaw);
+    P.w_float(m_yaw);
+    P.w_float(0.f);
+    P.w_float(0.f);
+    P.w_u8(m_team);
+    P.w_u8(0);
+    P.w_u8(0);
+
+    P.w_u16(move_state);
+    P.w_sdir(Fvector().set(0.f, 0.f, 0.f));
+    P.w_sdir(velocity);
+    P.w_float(0.f);
+    P.w_u8(m_active_slot);
+
+    P.w_u16(1);
+    P.w_u8(1);
+    P.w_vec3(Fvector().set(0.f, 0.f, 0.f));
+    P.w_vec3(velocity);
+    P.w_vec3(Fvector().set(0.f, 0.f, 0.f));
+    P.w_vec3(Fvector().set(0.f, 0.f, 0.f));
+    P.w_vec3(m_position);
+    P.w_float(0.f);
+    P.w_float(0.f);
+    P.w_float(0.f);
+    P.w_float(1.f);
+
+    Send(P, net_flags(FALSE));
+    ++m_stats.updates_sent;
+}
+
+// SHit::Write_Packet of a multiplayer game: a weak bullet hit, so the load test is not over by the first kills
+void CBotClient::send_hit()
+{
+    u16 target = m_targets[m_random.randI(s32(m_targets.size()))];
+    u16 weapon = m_actor_id;
+    for (xr_vector<std::pair<u16, u16>>::const_iterator I = m_items.begin(); I != m_items.end(); ++I)
+    {
+        if ((I->second == m_active_slot) && (I->first != m_ruck_item))
+        {
+            weapon = I->first;
+            break;
+        }
+    }
+
+    Fvector dir;
+    dir.setHP(m_yaw, 0.f);
+
+    NET_Packet P;
+    event_begin(P, GE_HIT, target);
+    P.w_u16(m_actor_id);
+    P.w_u16(weapon);
+    P.w_dir(dir);
+    P.w_float(bot_hit_power);
+    P.w_u16(0);
+    P.w_vec3(Fvector().set(0.f, 0.f, 0.f));
+    P.w_float(0.f);
+    P.w_u16(u16(ALife::eHitTypeFireWound));
+    P.w_float(0.f);
+    Send(P);
+    ++m_stats.hits_sent;
+}
+
+// the item put to the ruck last time goes back to its slot, otherwise a random one goes to the ruck, then a slot of
+// the items left is activated
+void CBotClient::send_inventory_event()
+{
+    NET_Packet P;
+    if (u16(-1) != m_ruck_item)
+    {
+        for (xr_vector<std::pair<u16, u16>>::const_iterator I = m_items.begin(); I != m_items.end(); ++I)
+        {
+            if (I->first != m_ruck_item)
+                continue;
+            event_begin(P, GEG_PLAYER_ITEM2SLOT, m_actor_id);
+            P.w_u16(I->first);
+            P.w_u16(I->second);
+            Send(P);
+            ++m_stats.inventory_events_sent;
+            break;
+        }
+        m_ruck_item = u16(-1);
+    }
+    else
+    {
+        m_ruck_item = m_items[m_random.randI(s32(m_items.size()))].first;
+        event_begin(P, GEG_PLAYER_ITEM2RUCK, m_actor_id);
+        P.w_u16(m_ruck_item);
+        Send(P);
+        ++m_stats.inventory_events_sent;
+    }
+
+    const std::pair<u16, u16>& item = m_items[m_random.randI(s32(m_items.size()))];
+    if ((item.first == m_ruck_item) || (item.second == m_active_slot))
+        return;
+
+    m_active_slot = u8(item.second);
+    event_begin(P, GEG_PLAYER_ACTIVATE_SLOT, m_actor_id);
+    P.w_u16(item.second);
+    Send(P);
+    ++m_stats.inventory_events_sent;
+}
@@ -0,0 +1,111 @@
+#pragma once
+
+#include "xrNetServer/NET_Client.h"
+#include "secure_messaging.h"
+
+// Headless player of a multiplayer game, for the server load tests. It goes through the same connection
+// handshake as CLevel, but keeps no objects: only the ids it needs to send the actor updates, the hits and
+// the inventory events a real player would
+class CBotClient : public IPureClient
+{
+public:
+    enum EBehaviour
+    {
+        eBotMove = (1 << 0),
+        eBotFire = (1 << 1),
+        eBotInventory = (1 << 2),
+    };
+
+    enum EState
+    {
+        eStateConnecting = 0,
+        eStateHandshake, // auth, digest and the connect result
+        eStateConfiguring, // receiving the game and the spawns
+        eStateSpectator, // waiting for the actor, spectating or dead
+        eStateAlive,
+        eStateFailed,
+    };
+
+    struct SStats
+    {
+        u32 connect_time; // ms from Start to M_SV_CONFIG_FINISHED
+        u32 messages_sent;
+        u32 bytes_sent;
+        u32 messages_received;
+        u32 bytes_received;
+        u32 updates_sent;
+        u32 hits_sent;
+        u32 inventory_events_sent;
+        u32 spawns;
+        u32 deaths;
+        u32 max_ping;
+
+        SStats() { ZeroMemory(this, sizeof(*this)); }
+    };
+
+private:
+    string64 m_name;
+    u32 m_behaviour;
+    EState m_state;
+    shared_str m_fail_reason;
+    SStats m_stats;
+    CRandom m_random;
+    CTimer m_connect_timer;
+    secure_messaging::key_t m_secret_key;
+
+    u16 m_control_id; // spectator or actor
+    u16 m_actor_id;
+    u8 m_team;
+    Fvector m_home; // the actor spawn point, the movement circles around it
+    Fvector m_position;
+    float m_yaw;
+    float m_phase;
+    u8 m_active_slot;
+    xr_vector<u16> m_targets; // actors of the other players
+    xr_vector<std::pair<u16, u16>> m_items; // item, slot, of our actor
+
+    u32 m_last_update_time;
+    u32 m_last_ready_time;
+    u32 m_last_fire_time;
+    u32 m_last_inventory_time;
+    u32 m_last_statistic_time;
+    u16 m_ruck_item; // put to the ruck by the inventory pattern, goes back to its slot next time
+
+    u32 m_delta_snapshot;
+    u32 m_delta_parts_left;
+
+    void fail(LPCSTR reason);
+    void process_message(NET_Packet& P);
+    void process_secure_message(NET_Packet& P);
+    void process_spawn(NET_Packet& P);
+    void process_event(NET_Packet& P);
+    void process_delta_update(NET_Packet& P);
+
+    void secure_send(NET_Packet& P, u32 flags);
+    void event_begin(NET_Packet& P, u16 type, u16 dest);
+    void write_player_state(NET_Packet& P);
+    void remove_object(u16 id);
+
+    void send_ready();
+    void send_update();
+    void send_hit();
+    void send_inventory_event();
+
+public:
+    CBotClient(u32 index, CTimer* timer);
+    virtual ~CBotClient();
+
+    // address is "host[/port=...][/psw=...]", the name is added by the bot
+    bool Start(LPCSTR address, u32 behaviour);
+    void Stop();
+    // processes the received messages and runs the behaviour, once a frame
+    void Update();
+
+    virtual void Send(NET_Packet& P, u32 dwFlags = DPNSEND_GUARANTEED, u32 dwTimeout = 0);
+    virtual void OnSessionTerminate(LPCSTR reason);
+
+    LPCSTR name() const { return m_name; }
+    EState state() const { return m_state; }
+    LPCSTR fail_reason() const { return m_fail_reason.c_str(); }
+    const SStats& stats() const { return m_stats; }
+};
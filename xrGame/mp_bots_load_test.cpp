@@ -0,0 +1,179 @@
+#include "stdafx.h"
+#include "mp_bots_load_test.h"
+#include "mp_bot_client.h"
+#include "Level.h"
+#include "xrServer.h"
+#include "Common/object_broker.h"
+
+XRNETSERVER_API extern BOOL g_net_compressor_enabled;
+XRNETSERVER_API extern BOOL g_net_compressor_gather_stats;
+void XRNETSERVER_API GetNetCompressorTotals(NET_CompressorTotals& totals);
+void XRNETSERVER_API DumpNetCompressorStats(bool brief);
+
+Flags32 g_mp_bots_behaviour = {CBotClient::eBotMove | CBotClient::eBotFire | CBotClient::eBotInventory};
+CBotLoadTest* g_bot_load_test = NULL;
+
+static xrServer* local_server() { return g_pGameLevel ? Level().Server : NULL; }
+static LPCSTR bot_state_name(CBotClient::EState state)
+{
+    switch (state)
+    {
+    case CBotClient::eStateConnecting: return "connecting";
+    case CBotClient::eStateHandshake: return "handshake";
+    case CBotClient::eStateConfiguring: return "configuring";
+    case CBotClient::eStateSpectator: return "spectator";
+    case CBotClient::eStateAlive: return "alive";
+    case CBotClient::eStateFailed: return "failed";
+    }
+    return "unknown";
+}
+
+CBotLoadTest::CBotLoadTest(u32 count, LPCSTR address, u32 behaviour)
+    : m_started(0), m_address(address), m_behaviour(behaviour)
+{
+    m_bots.reserve(count);
+    for (u32 i = 0; i < count; ++i)
+        m_bots.push_back(new CBotClient(i, Device.GetTimerGlobal()));
+
+    m_gather_stats = g_net_compressor_gather_stats;
+    g_net_compressor_gather_stats = TRUE;
+    GetNetCompressorTotals(m_compressor_start);
+
+    // the updates done before the start are not the ones of the test
+    if (xrServer* server = local_server())
+    {
+        server->TakeUpdateTimes(m_update_times);
+        m_update_times.clear();
+    }
+
+    m_timer.Start();
+    Device.seqFrame.Add(this, REG_PRIORITY_LOW);
+}
+
+CBotLoadTest::~CBotLoadTest()
+{
+    Device.seqFrame.Remove(this);
+    delete_data(m_bots);
+    g_net_compressor_gather_stats = m_gather_stats;
+}
+
+void CBotLoadTest::OnFrame()
+{
+    if (m_started < m_bots.size())
+        m_bots[m_started++]->Start(m_address.c_str(), m_behaviour);
+
+    for (xr_vector<CBotClient*>::iterator I = m_bots.begin(), E = m_bots.end(); I != E; ++I)
+        (*I)->Update();
+
+    if (xrServer* server = local_server())
+        server->TakeUpdateTimes(m_update_times);
+}
+
+void CBotLoadTest::Report()
+{
+    string64 t_stamp;
+    timestamp(t_stamp);
+
+    string_path fn;
+    FS.update_path(fn, "$logs$", "mp_stats\\");
+    xr_strcat(fn, "bots_");
+    xr_strcat(fn, t_stamp);
+    xr_strcat(fn, ".ltx");
+
+    write_report(fn);
+    Msg("- bots load test report is written to %s", fn);
+    DumpNetCompressorStats(true);
+}
+
+void CBotLoadTest::write_report(LPCSTR file_name)
+{
+    CInifile ini(file_name, FALSE, FALSE, TRUE);
+    float duration = _max(m_timer.GetElapsed_sec(), EPS_S);
+
+    u32 connected = 0, alive = 0, failed = 0;
+    u64 bytes_sent = 0, bytes_received = 0;
+    for (u32 i = 0; i < u32(m_bots.size()); ++i)
+    {
+        const CBotClient& bot = *m_bots[i];
+        const CBotClient::SStats& stats = bot.stats();
+        connected += stats.connect_time ? 1 : 0;
+        alive += (CBotClient::eStateAlive == bot.state()) ? 1 : 0;
+        failed += (CBotClient::eStateFailed == bot.state()) ? 1 : 0;
+        bytes_sent += stats.bytes_sent;
+        bytes_received += stats.bytes_received;
+
+        string32 section;
+        xr_sprintf(section, "bot_%u", i);
+        ini.w_string(section, "name", bot.name());
+        ini.w_string(section, "state", bot_state_name(bot.state()));
+        if (CBotClient::eStateFailed == bot.state())
+            ini.w_string(section, "fail_reason", bot.fail_reason());
+        ini.w_u32(section, "connect_time_ms", stats.connect_time);
+        ini.w_u32(section, "messages_sent", stats.messages_sent);
+        ini.w_u32(section, "bytes_sent", stats.bytes_sent);
+        ini.w_u32(section, "messages_received", stats.messages_received);
+        ini.w_u32(section, "bytes_received", stats.bytes_received);
+        ini.w_float(section, "bytes_sent_per_sec", float(stats.bytes_sent) / duration);
+        ini.w_float(section, "bytes_received_per_sec", float(stats.bytes_received) / duration);
+        ini.w_u32(section, "updates_sent", stats.updates_sent);
+        ini.w_u32(section, "hits_sent", stats.hits_sent);
+        ini.w_u32(section, "inventory_events_sent", stats.inventory_events_sent);
+        ini.w_u32(section, "spawns_received", stats.spawns);
+        ini.w_u32(section, "deaths", stats.deaths);
+        ini.w_u32(section, "max_ping", stats.max_ping);
+    }
+
+    string64 t_stamp;
+    timestamp(t_stamp);
+    ini.w_string("global", "dump_time", t_stamp);
+    ini.w_string("global", "address", m_address.c_str());
+    ini.w_float("global", "duration_sec", duration);
+    ini.w_u32("global", "behaviour", m_behaviour);
+    ini.w_u32("global", "client_update_rate", psNET_ClientUpdate);
+    ini.w_u32("global", "bots", u32(m_bots.size()));
+    ini.w_u32("global", "bots_connected", connected);
+    ini.w_u32("global", "bots_alive", alive);
+    ini.w_u32("global", "bots_failed", failed);
+    if (!m_bots.empty())
+    {
+        ini.w_float("global", "bytes_sent_per_bot_per_sec", float(bytes_sent) / m_bots.size() / duration);
+        ini.w_float("global", "bytes_received_per_bot_per_sec", float(bytes_received) / m_bots.size() / duration);
+    }
+
+    xrServer* server = local_server();
+    ini.w_u32("server", "in_process", server ? 1 : 0);
+    if (server)
+    {
+        ini.w_u32("server", "clients", server->GetClientsCount());
+        ini.w_u32("server", "updates", u32(m_update_times.size()));
+        if (!m_update_times.empty())
+        {
+            xr_vector<float> sorted = m_update_times;
+            std::sort(sorted.begin(), sorted.end());
+            float total = 0.f;
+            for (xr_vector<float>::const_iterator I = sorted.begin(); I != sorted.end(); ++I)
+                total += *I;
+            u32 last = u32(sorted.size()) - 1;
+            ini.w_float("server", "update_avg_ms", total / float(sorted.size()));
+            ini.w_float("server", "update_p50_ms", sorted[iFloor(0.50f * last)]);
+            ini.w_float("server", "update_p95_ms", sorted[iFloor(0.95f * last)]);
+            ini.w_float("server", "update_p99_ms", sorted[iFloor(0.99f * last)]);
+            ini.w_float("server", "update_worst_ms", sorted.back());
+        }
+    }
+
+    // the compressor is shared by all the clients and the server of the process
+    NET_CompressorTotals totals;
+    GetNetCompressorTotals(totals);
+    totals.uncompressed_bytes -= m_compressor_start.uncompressed_bytes;
+    totals.compressed_bytes -= m_compressor_start.compressed_bytes;
+    totals.packets -= m_compressor_start.packets;
+    totals.unlucky -= m_compressor_start.unlucky;
+    ini.w_u32("compressor", "enabled", g_net_compressor_enabled ? 1 : 0);
+    ini.w_u32("compressor", "uncompressed_bytes", totals.uncompressed_bytes);
+    ini.w_u32("compressor", "compressed_bytes", totals.compressed_bytes);
+    ini.w_u32("compressor", "packets", totals.packets);
+    ini.w_u32("compressor", "unlucky", totals.unlucky);
+    if (totals.uncompressed_bytes)
+        ini.w_float("compressor", "ratio", float(totals.compressed_bytes) / float(totals.uncompressed_bytes));
+}
@@ -0,0 +1,36 @@
+#pragma once
+
+#include "xrNetServer/NET_Shared.h"
+
+class CBotClient;
+
+// Connects bot clients to a multiplayer server and writes what the server capacity is judged by to
+// $logs$/mp_stats/bots_<time>.ltx: the server update times, the traffic of every bot and the net compressor
+// totals. The update times are known only when the server runs in this process, so the test may also be run
+// with no bots on the server itself, while the bots of another process load it
+class CBotLoadTest : public pureFrame
+{
+    xr_vector<CBotClient*> m_bots;
+    u32 m_started; // connecting blocks, so one bot is started a frame
+    shared_str m_address;
+    u32 m_behaviour;
+    CTimer m_timer;
+    BOOL m_gather_stats; // of the compressor, restored on stop
+    NET_CompressorTotals m_compressor_start;
+
+    xr_vector<float> m_update_times; // ms, one per server update
+
+    void write_report(LPCSTR file_name);
+
+public:
+    CBotLoadTest(u32 count, LPCSTR address, u32 behaviour);
+    virtual ~CBotLoadTest();
+
+    virtual void OnFrame();
+    void Report();
+};
+
+// the CBotClient::EBehaviour flags of the bots started
+extern Flags32 g_mp_bots_behaviour;
+// deleted by mp_bots_stop, on the level destroy and on the application end
+extern CBotLoadTest* g_bot_load_test;
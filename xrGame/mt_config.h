@@ -20,3 +20,6 @@ extern Flags32 g_mt_config;
 #define mtLevelSounds (1 << 7)
 #define mtALife (1 << 8)
 #define mtMap (1 << 9)
+#define mtLevelPathConcurrent (1 << 10)
+#define mtALifeConcurrent (1 << 11)
+#define mtAiVisionBatch (1 << 12)
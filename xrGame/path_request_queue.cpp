@@ -0,0 +1,111 @@
+////////////////////////////////////////////////////////////////////////////
+//	Module 		: path_request_queue.cpp
+//	Description : Level path requests processed in the parallel frame stage
+////////////////////////////////////////////////////////////////////////////
+
+#include "stdafx.h"
+#include "path_request_queue.h"
+#include "level_path_builder.h"
+#include "space_restriction_manager.h"
+#include "Level.h"
+#include "ai_space.h"
+#include "mt_config.h"
+#include "xrAICore/Navigation/graph_engine_pool.h"
+#include "xrCore/Threading/TaskManager.hpp"
+#include "xrEngine/profiler.h"
+
+CPathRequestQueue::CPathRequestQueue() : m_registered(false) {}
+CPathRequestQueue::~CPathRequestQueue()
+{
+    if (m_registered)
+        Device.remove_from_seq_parallel(fastdelegate::FastDelegate0<>(this, &CPathRequestQueue::process));
+}
+
+void CPathRequestQueue::add(CLevelPathBuilder* builder)
+{
+    if (std::find(m_builders.begin(), m_builders.end(), builder) != m_builders.end())
+        return;
+
+    m_builders.push_back(builder);
+    if (m_registered)
+        return;
+
+    m_registered = true;
+    Device.seqParallel.push_back(fastdelegate::FastDelegate0<>(this, &CPathRequestQueue::process));
+}
+
+void CPathRequestQueue::remove(CLevelPathBuilder* builder)
+{
+    BUILDERS::iterator I = std::find(m_builders.begin(), m_builders.end(), builder);
+    if (I == m_builders.end())
+        return;
+
+    m_builders.erase(I);
+    if (!m_builders.empty() || !m_registered)
+        return;
+
+    m_registered = false;
+    Device.remove_from_seq_parallel(fastdelegate::FastDelegate0<>(this, &CPathRequestQueue::process));
+}
+
+void CPathRequestQueue::prepare()
+{
+    m_requests.clear();
+    CSpaceRestrictionManager& restrictions = Level().space_restriction_manager();
+    for (CLevelPathBuilder* builder : m_processing)
+    {
+        if (!builder->can_prepare())
+            continue;
+
+        // Restrictions are initialized here, so the workers only read the shared restrictors
+        const CSpaceRestriction* restriction;
+        if (!restrictions.prepare_restriction(builder->object_id(), restriction))
+            continue;
+
+        SRequest request = {restriction ? (const void*)restriction : (const void*)builder, builder};
+        m_requests.push_back(request);
+    }
+
+    std::sort(m_requests.begin(), m_requests.end());
+    m_groups.clear();
+    for (u32 i = 0, n = m_requests.size(); i < n; ++i)
+    {
+        if (m_groups.empty() || m_requests[i].key != m_requests[m_groups.back().first].key)
+            m_groups.push_back(std::make_pair(i, i));
+        m_groups.back().second = i + 1;
+    }
+
+    if (m_groups.size() < 2)
+        return;
+
+    CGraphEnginePool& pool = *ai().graph_engine_pool();
+    const CLevelGraph* level_graph = &ai().level_graph();
+    TaskScheduler.ParallelFor(0, m_groups.size(), 1, [&](u32 from, u32 to) {
+        CGraphEngineScope scope(pool, level_graph);
+        for (u32 i = from; i < to; ++i)
+        {
+            for (u32 j = m_groups[i].first; j < m_groups[i].second; ++j)
+                m_requests[j].builder->prepare();
+        }
+    });
+}
+
+void __stdcall CPathRequestQueue::process()
+{
+    START_PROFILE("Build Path/Level Path Requests");
+
+    m_registered = false;
+    VERIFY(m_processing.empty());
+    m_processing.swap(m_builders);
+
+    if ((m_processing.size() > 1) && g_mt_config.test(mtLevelPathConcurrent) && ai().graph_engine_pool())
+        prepare();
+
+    // Sync point: paths are handed over to the movement managers in the order of the requests
+    for (CLevelPathBuilder* builder : m_processing)
+        builder->process();
+
+    m_processing.clear();
+
+    STOP_PROFILE;
+}
@@ -0,0 +1,46 @@
+////////////////////////////////////////////////////////////////////////////
+//	Module 		: path_request_queue.h
+//	Description : Level path requests processed in the parallel frame stage
+////////////////////////////////////////////////////////////////////////////
+
+#pragma once
+
+class CLevelPathBuilder;
+
+// Level path builders registered during the frame are processed by the secondary thread.
+// The graph searches are prepared first: requests of objects with different restrictions
+// run concurrently on the task scheduler, each worker with a pooled graph engine
+// (CGraphEnginePool). Then every builder is processed in the order of registration,
+// it picks up the prepared path and builds the detail path as before
+class CPathRequestQueue
+{
+private:
+    struct SRequest
+    {
+        const void* key; // objects sharing a restriction apply its borders in turn
+        CLevelPathBuilder* builder;
+
+        bool operator<(const SRequest& other) const { return key < other.key; }
+    };
+
+    typedef xr_vector<CLevelPathBuilder*> BUILDERS;
+    typedef xr_vector<SRequest> REQUESTS;
+    typedef xr_vector<std::pair<u32, u32>> GROUPS;
+
+private:
+    BUILDERS m_builders;
+    BUILDERS m_processing;
+    REQUESTS m_requests;
+    GROUPS m_groups;
+    bool m_registered;
+
+private:
+    void prepare();
+
+public:
+    CPathRequestQueue();
+    ~CPathRequestQueue();
+    void add(CLevelPathBuilder* builder);
+    void remove(CLevelPathBuilder* builder);
+    void __stdcall process();
+};
@@ -193,6 +193,13 @@ void CRestrictedObject::add_border(u32 start_vertex_id, u32 dest_vertex_id) cons
     STOP_PROFILE;
 }
 
+bool CRestrictedObject::static_border(const CSpaceRestriction*& restriction) const
+{
+    bool result;
+    restriction = Level().space_restriction_manager().initialized_restriction(object().ID(), result);
+    return (result);
+}
+
 void CRestrictedObject::remove_border() const
 {
     START_PROFILE("Restricted Object/Remove Border");
@@ -13,6 +13,7 @@
 class CSE_Abstract;
 class CCustomMonster;
 class CGameObject;
+class CSpaceRestriction;
 
 namespace RestrictionSpace
 {
@@ -52,6 +53,9 @@ public:
     virtual void add_border(const Fvector& start_position, const Fvector& dest_position) const;
     virtual void add_border(u32 start_vertex_id, u32 dest_vertex_id) const;
     virtual void remove_border() const;
+    // The border applied for a level path depends only on the restriction and the path vertices,
+    // so the path may be cached (CLevelPathCache) with the restriction as a part of the key
+    virtual bool static_border(const CSpaceRestriction*& restriction) const;
 
 public:
     u32 accessible_nearest(const Fvector& position, Fvector& result) const;
@@ -101,3 +101,11 @@ void CRestrictedObjectObstacle::remove_border() const
     ai().level_graph().clear_mask_no_check(m_static_query.area());
     ai().level_graph().clear_mask_no_check(m_dynamic_query.area());
 }
+
+bool CRestrictedObjectObstacle::static_border(const CSpaceRestriction*& restriction) const
+{
+    if (!m_static_query.area().empty() || !m_dynamic_query.area().empty())
+        return (false);
+
+    return (inherited::static_border(restriction));
+}
@@ -34,6 +34,7 @@ public:
     virtual void add_border(const Fvector& start_position, const Fvector& dest_position) const;
     virtual void add_border(u32 start_vertex_id, u32 dest_vertex_id) const;
     virtual void remove_border() const;
+    virtual bool static_border(const CSpaceRestriction*& restriction) const;
 
     IC const obstacles_query& static_query() const
     {
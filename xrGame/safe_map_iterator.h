@@ -9,11 +9,12 @@
 #pragma once
 
 template <typename _key_type, typename _data_type, typename _predicate = std::less<_key_type>,
-    bool use_time_limit = true, typename _cycle_type = u64, bool use_first_update = true>
+    bool use_time_limit = true, typename _cycle_type = u64, bool use_first_update = true,
+    typename _registry = xr_map<_key_type, _data_type*, _predicate>>
 class CSafeMapIterator
 {
 public:
-    typedef xr_map<_key_type, _data_type*, _predicate> _REGISTRY;
+    typedef _registry _REGISTRY;
     typedef typename _REGISTRY::iterator _iterator;
     typedef typename _REGISTRY::const_iterator _const_iterator;
 
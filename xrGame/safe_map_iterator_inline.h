@@ -10,10 +10,10 @@
 
 #define TEMPLATE_SPEZIALIZATION                                                                                        \
     template <typename _key_type, typename _data_type, typename _predicate, bool use_time_limit, typename _cycle_type, \
-        bool use_first_update>
+        bool use_first_update, typename _registry>
 
 #define CSSafeMapIterator \
-    CSafeMapIterator<_key_type, _data_type, _predicate, use_time_limit, _cycle_type, use_first_update>
+    CSafeMapIterator<_key_type, _data_type, _predicate, use_time_limit, _cycle_type, use_first_update, _registry>
 
 TEMPLATE_SPEZIALIZATION
 IC CSSafeMapIterator::CSafeMapIterator()
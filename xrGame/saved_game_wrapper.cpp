@@ -16,6 +16,7 @@
 #include "alife_simulator_header.h"
 #include "alife_simulator.h"
 #include "alife_spawn_registry.h"
+#include "alife_save_stream.h"
 
 extern LPCSTR alife_section;
 
@@ -38,7 +39,8 @@ bool CSavedGameWrapper::valid_saved_game(IReader& stream)
     if (stream.length() < 8)
         return (false);
 
-    if (stream.r_u32() != u32(-1))
+    u32 format = stream.r_u32();
+    if ((format != u32(-1)) && (format != ALIFE_SAVE_SECTIONS))
         return (false);
 
     if (stream.r_u32() < ALIFE_VERSION)
@@ -77,50 +79,53 @@ CSavedGameWrapper::CSavedGameWrapper(LPCSTR saved_game_name)
         return;
     }
 
-    u32 source_count = stream->r_u32();
-    void* source_data = xr_malloc(source_count);
-    rtc_decompress(source_data, source_count, stream->pointer(), stream->length() - 3 * sizeof(u32));
-    FS.r_close(stream);
-
-    IReader reader(source_data, source_count);
-
+    // only the time, the actor and the spawn name are needed, so only their blocks are decompressed
+    CSE_ALifeDynamicObject* object = 0;
+    string_path spawn_file_name = "";
     {
-        CALifeTimeManager time_manager(alife_section);
-        time_manager.load(reader);
-        m_game_time = time_manager.game_time();
+        CALifeSaveReader source(*stream);
+        source.load(GAME_TIME_CHUNK_DATA, [this](IReader& reader) {
+            CALifeTimeManager time_manager(alife_section);
+            time_manager.load(reader);
+            m_game_time = time_manager.game_time();
+        });
+
+        source.load(OBJECT_CHUNK_DATA, 0, [&object](IReader& reader) {
+            R_ASSERT2(reader.find_chunk(OBJECT_CHUNK_DATA), "Can't find chunk OBJECT_CHUNK_DATA!");
+            u32 count = reader.r_u32();
+            VERIFY(count > 0);
+            object = CALifeObjectRegistry::get_object(reader);
+        });
+
+        source.load(SPAWN_CHUNK_DATA, [&spawn_file_name](IReader& reader) {
+            IReader* chunk = reader.open_chunk(SPAWN_CHUNK_DATA);
+            R_ASSERT2(chunk, "Spawn version mismatch - REBUILD SPAWN!");
+            IReader* sub_chunk = chunk->open_chunk(0);
+            if (sub_chunk)
+            {
+                sub_chunk->r_stringZ(spawn_file_name, sizeof(spawn_file_name));
+                sub_chunk->close();
+            }
+            chunk->close();
+        });
     }
+    FS.r_close(stream);
 
     {
-        R_ASSERT2(reader.find_chunk(OBJECT_CHUNK_DATA), "Can't find chunk OBJECT_CHUNK_DATA!");
-        u32 count = reader.r_u32();
-        VERIFY(count > 0);
-        CSE_ALifeDynamicObject* object = CALifeObjectRegistry::get_object(reader);
         VERIFY(object->ID == 0);
         CSE_ALifeCreatureActor* actor = smart_cast<CSE_ALifeCreatureActor*>(object);
         VERIFY(actor);
 
         m_actor_health = actor->get_health();
 
-        IReader* chunk = reader.open_chunk(SPAWN_CHUNK_DATA);
-        R_ASSERT2(chunk, "Spawn version mismatch - REBUILD SPAWN!");
-
-        string_path spawn_file_name;
+        if (!xr_strlen(spawn_file_name))
         {
-            IReader* sub_chunk = chunk->open_chunk(0);
-            if (!sub_chunk)
-            {
-                chunk->close();
-                F_entity_Destroy(object);
-                m_level_id = _LEVEL_ID(-1);
-                m_level_name = "";
-                return;
-            }
-            sub_chunk->r_stringZ(spawn_file_name, sizeof(spawn_file_name));
-            sub_chunk->close();
+            F_entity_Destroy(object);
+            m_level_id = _LEVEL_ID(-1);
+            m_level_name = "";
+            return;
         }
 
-        chunk->close();
-
         if (!FS.exist(file_name, "$game_spawn$", spawn_file_name, ".spawn"))
         {
             F_entity_Destroy(object);
@@ -147,7 +152,7 @@ CSavedGameWrapper::CSavedGameWrapper(LPCSTR saved_game_name)
             return;
         }
 
-        chunk = spawn->open_chunk(4);
+        IReader* chunk = spawn->open_chunk(4);
         if (!chunk)
         {
             F_entity_Destroy(object);
@@ -169,6 +174,4 @@ CSavedGameWrapper::CSavedGameWrapper(LPCSTR saved_game_name)
             FS.r_close(spawn);
         F_entity_Destroy(object);
     }
-
-    xr_free(source_data);
 }
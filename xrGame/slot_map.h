@@ -0,0 +1,156 @@
+////////////////////////////////////////////////////////////////////////////
+//	Module 		: slot_map.h
+//	Description : Map of objects indexed directly by their IDs
+////////////////////////////////////////////////////////////////////////////
+
+#pragma once
+
+// Subset of the xr_map<_key_type, _data_type*> interface over a vector of slots indexed
+// by the key itself, it suits the dense u16 object IDs. Lookups are a single index, the
+// iteration goes in the ascending key order as the map did.
+// Iterators keep a slot index rather than a node, so they stay valid while the objects
+// are added or removed: an iterator to a removed object can still be incremented.
+// Dereferencing yields a proxy whose second refers to the slot itself, so that
+// (*I).second = 0 or xr_delete((*I).second) update the map as they did with xr_map
+template <typename _key_type, typename _data_type>
+class CSlotMap
+{
+public:
+    typedef _key_type key_type;
+    typedef _data_type* mapped_type;
+    typedef std::pair<_key_type, _data_type*> value_type;
+
+private:
+    typedef xr_vector<_data_type*> SLOTS;
+
+public:
+    struct reference
+    {
+        _key_type first;
+        _data_type*& second;
+
+        IC operator value_type() const { return (value_type(first, second)); }
+    };
+
+    struct pointer
+    {
+        reference m_reference;
+
+        IC reference* operator->() { return (&m_reference); }
+    };
+
+    class iterator
+    {
+        friend class CSlotMap<_key_type, _data_type>;
+
+    public:
+        typedef std::forward_iterator_tag iterator_category;
+        typedef std::pair<_key_type, _data_type*> value_type;
+        typedef ptrdiff_t difference_type;
+        typedef typename CSlotMap<_key_type, _data_type>::pointer pointer;
+        typedef typename CSlotMap<_key_type, _data_type>::reference reference;
+
+    private:
+        SLOTS* m_slots;
+        u32 m_index;
+
+    private:
+        IC iterator(const SLOTS* slots, u32 index) : m_slots(const_cast<SLOTS*>(slots)), m_index(index) { skip(); }
+        IC void skip()
+        {
+            while ((m_index < m_slots->size()) && !(*m_slots)[m_index])
+                ++m_index;
+        }
+
+        // every index past the last slot is the end, the slots may grow after the iterator is taken
+        IC u32 index() const { return (_min(m_index, u32(m_slots->size()))); }
+
+    public:
+        IC iterator() : m_slots(0), m_index(0) {}
+        IC reference operator*() const
+        {
+            VERIFY(m_index < m_slots->size());
+            reference result = {_key_type(m_index), (*m_slots)[m_index]};
+            return (result);
+        }
+
+        IC pointer operator->() const
+        {
+            pointer result = {**this};
+            return (result);
+        }
+        IC iterator& operator++()
+        {
+            ++m_index;
+            skip();
+            return (*this);
+        }
+
+        IC iterator operator++(int)
+        {
+            iterator result = *this;
+            ++*this;
+            return (result);
+        }
+
+        IC bool operator==(const iterator& other) const { return (index() == other.index()); }
+        IC bool operator!=(const iterator& other) const { return (index() != other.index()); }
+    };
+
+    typedef iterator const_iterator;
+
+private:
+    SLOTS m_slots;
+    u32 m_count;
+
+public:
+    IC CSlotMap() : m_count(0) {}
+    IC iterator begin() const { return (iterator(&m_slots, 0)); }
+    IC iterator end() const { return (iterator(&m_slots, m_slots.size())); }
+    IC iterator find(const _key_type& key) const
+    {
+        if ((u32(key) < m_slots.size()) && m_slots[key])
+            return (iterator(&m_slots, key));
+        return (end());
+    }
+
+    IC std::pair<iterator, bool> insert(const value_type& value)
+    {
+        VERIFY(value.second);
+        if (u32(value.first) >= m_slots.size())
+            m_slots.resize(u32(value.first) + 1, 0);
+
+        _data_type*& slot = m_slots[value.first];
+        if (slot)
+            return (std::make_pair(iterator(&m_slots, value.first), false));
+
+        slot = value.second;
+        ++m_count;
+        return (std::make_pair(iterator(&m_slots, value.first), true));
+    }
+
+    IC void erase(const iterator& I)
+    {
+        VERIFY(I.m_index < m_slots.size() && m_slots[I.m_index]);
+        m_slots[I.m_index] = 0;
+        --m_count;
+    }
+
+    IC u32 erase(const _key_type& key)
+    {
+        iterator I = find(key);
+        if (I == end())
+            return (0);
+        erase(I);
+        return (1);
+    }
+
+    IC void clear()
+    {
+        m_slots.clear();
+        m_count = 0;
+    }
+
+    IC u32 size() const { return (m_count); }
+    IC bool empty() const { return (!m_count); }
+};
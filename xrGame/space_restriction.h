@@ -24,6 +24,7 @@ private:
 
     friend struct CRemoveMergedFreeInRestrictions;
     friend class LevelGraphDebugRender;
+    friend class CSpaceRestrictionManager;
 
 private:
     typedef SpaceRestrictionHolder::CBaseRestrictionPtr CBaseRestrictionPtr;
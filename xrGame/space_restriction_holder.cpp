@@ -14,6 +14,8 @@
 #include "space_restriction_shape.h"
 #include "space_restriction_composition.h"
 #include "restriction_space.h"
+#include "ai_space.h"
+#include "level_path_cache.h"
 
 #pragma warning(push)
 #pragma warning(disable : 4995)
@@ -30,6 +32,12 @@ void CSpaceRestrictionHolder::clear()
     m_default_in_restrictions = "";
 }
 
+void CSpaceRestrictionHolder::invalidate_paths()
+{
+    if (g_ai_space && g_ai_space->get_level_path_cache())
+        g_ai_space->get_level_path_cache()->clear();
+}
+
 shared_str CSpaceRestrictionHolder::normalize_string(shared_str space_restrictors)
 {
     u32 n = xr_strlen(space_restrictors);
@@ -146,6 +154,7 @@ void CSpaceRestrictionHolder::register_restrictor(
     }
 
     (*I).second->change_implementation(shape);
+    invalidate_paths();
 }
 
 bool try_remove_string(shared_str& search_string, const shared_str& string_to_search)
@@ -195,6 +204,7 @@ void CSpaceRestrictionHolder::unregister_restrictor(CSpaceRestrictor* space_rest
     CSpaceRestrictionBase* composition = new CSpaceRestrictionComposition(this, restrictor_id);
     bridge->change_implementation(composition);
     m_restrictions.insert(std::make_pair(restrictor_id, bridge));
+    invalidate_paths();
 
     collect_garbage();
 }
@@ -47,6 +47,8 @@ protected:
     IC void collect_garbage();
     virtual void on_default_restrictions_changed() = 0;
     void clear();
+    // borders the cached level paths were built with are no longer valid
+    void invalidate_paths();
 
 public:
     IC CSpaceRestrictionHolder();
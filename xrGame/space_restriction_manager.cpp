@@ -49,6 +49,7 @@ void CSpaceRestrictionManager::clear()
 {
     m_clients->clear();
     delete_data(m_space_restrictions);
+    invalidate_paths();
 
     CSpaceRestrictionHolder::clear();
 }
@@ -60,6 +61,37 @@ void CSpaceRestrictionManager::remove_border(ALife::_OBJECT_ID id)
         client_restriction->remove_border();
 }
 
+bool CSpaceRestrictionManager::prepare_restriction(ALife::_OBJECT_ID id, const CSpaceRestriction*& result)
+{
+    result = 0;
+    CLIENT_RESTRICTIONS::iterator I = m_clients->find(id);
+    if (m_clients->end() == I || !(*I).second.m_restriction)
+        return (true);
+
+    CSpaceRestriction* client_restriction = &*(*I).second.m_restriction;
+    if (!client_restriction->initialized())
+    {
+        client_restriction->initialize();
+        if (!client_restriction->initialized())
+            return (false);
+    }
+
+    result = client_restriction;
+    return (true);
+}
+
+const CSpaceRestriction* CSpaceRestrictionManager::initialized_restriction(ALife::_OBJECT_ID id, bool& result) const
+{
+    result = true;
+    CLIENT_RESTRICTIONS::const_iterator I = m_clients->find(id);
+    if (m_clients->end() == I || !(*I).second.m_restriction)
+        return (0);
+
+    const CSpaceRestriction* client_restriction = (*I).second.m_restriction.get();
+    result = client_restriction->initialized();
+    return (client_restriction);
+}
+
 shared_str CSpaceRestrictionManager::in_restrictions(ALife::_OBJECT_ID id)
 {
     CRestrictionPtr client_restriction = restriction(id);
@@ -109,6 +141,7 @@ void CSpaceRestrictionManager::collect_garbage()
             ++I;
             xr_delete((*J).second);
             m_space_restrictions.erase(J);
+            invalidate_paths();
         }
         else
             ++I;
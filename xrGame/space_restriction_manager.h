@@ -61,6 +61,11 @@ public:
     template <typename T1, typename T2>
     IC void add_border(ALife::_OBJECT_ID id, T1 p1, T2 p2);
     void remove_border(ALife::_OBJECT_ID id);
+    // Initializes the restriction of the object ahead of concurrent path searches, objects
+    // sharing the result apply the same borders; false if it can't be initialized yet
+    bool prepare_restriction(ALife::_OBJECT_ID id, const CSpaceRestriction*& result);
+    // Restriction of the object without initializing it, result is false if its border can't be applied yet
+    const CSpaceRestriction* initialized_restriction(ALife::_OBJECT_ID id, bool& result) const;
 
     shared_str in_restrictions(ALife::_OBJECT_ID id);
     shared_str out_restrictions(ALife::_OBJECT_ID id);
@@ -69,6 +69,7 @@ private:
 
 public:
     virtual void build_level_path();
+    virtual bool can_prepare_level_path() const;
     virtual const float& prediction_speed() const;
 #ifdef DEBUG
     inline doors::actor const& get_doors_actor() const { return *m_doors_actor; }
@@ -106,6 +106,17 @@ IC void stalker_movement_manager_obstacles::remove_query_objects(const Fvector&
     m_static_obstacles.active_query().remove_objects(position, radius);
 }
 
+// Obstacles become borders of the search, so the path is prepared ahead only while there are none of them
+bool stalker_movement_manager_obstacles::can_prepare_level_path() const
+{
+#ifndef MASTER_GOLD
+    if (!psAI_Flags.test(aiObstaclesAvoiding))
+        return (true);
+#endif // MASTER_GOLD
+
+    return (m_static_obstacles.active_query().area().empty() && m_dynamic_obstacles.active_query().area().empty());
+}
+
 void stalker_movement_manager_obstacles::build_level_path()
 {
 #ifndef MASTER_GOLD
@@ -140,6 +151,10 @@ void stalker_movement_manager_obstacles::build_level_path()
         m_dynamic_obstacles.inactive_query().copy(m_dynamic_obstacles.active_query());
 #endif // MASTER_GOLD
 
+    // the obstacles found after the path was prepared without them
+    if (!can_prepare_level_path())
+        level_path().discard_prepared_path();
+
     bool pure_search_tried = false;
     bool pure_search_result = false;
 
@@ -44,6 +44,7 @@ public:
     IC void construct(stalker_movement_manager_obstacles* movement_manager, const bool& failed_to_build_path);
     IC const bool& need_path_to_rebuild() const;
     IC obstacles_query& active_query();
+    IC const obstacles_query& active_query() const;
     IC obstacles_query& inactive_query();
     IC obstacles_query& current_iteration();
     IC void clear();
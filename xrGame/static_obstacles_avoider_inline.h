@@ -31,6 +31,7 @@ IC const stalker_movement_manager_obstacles& static_obstacles_avoider::movement_
 
 IC const bool& static_obstacles_avoider::need_path_to_rebuild() const { return (m_need_path_to_rebuild); }
 IC obstacles_query& static_obstacles_avoider::active_query() { return (m_active_query); }
+IC const obstacles_query& static_obstacles_avoider::active_query() const { return (m_active_query); }
 IC obstacles_query& static_obstacles_avoider::inactive_query() { return (m_inactive_query); }
 IC obstacles_query& static_obstacles_avoider::current_iteration() { return (m_current_iteration); }
 IC void static_obstacles_avoider::clear()
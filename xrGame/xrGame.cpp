@@ -45,10 +45,6 @@ BOOL APIENTRY DllMain(HANDLE hModule, u32 ul_reason_for_call, LPVOID lpReserved)
         CCC_RegisterCommands();
         // keyboard binding
         CCC_RegisterInput();
-#ifdef DEBUG
-// XXX nitrocaster PROFILER: temporarily disabled due to linkage issues
-// g_profiler			= new CProfiler();
-#endif
         break;
     }
 
@@ -46,6 +46,7 @@ void xrClientData::Clear()
     m_ping_warn.m_maxPingWarnings = 0;
     m_ping_warn.m_dwLastMaxPingWarningTime = 0;
     m_admin_rights.m_has_admin_rights = FALSE;
+    m_acked_snapshot = 0;
 };
 
 xrClientData::~xrClientData() { xr_delete(ps); }
@@ -57,6 +58,7 @@ xrServer::xrServer() : IPureServer(Device.GetTimerGlobal(), g_dedicated_server)
     m_server_rules = NULL;
     m_last_updates_size = 0;
     m_last_update_time = 0;
+    m_delta_updates = false;
 }
 
 xrServer::~xrServer()
@@ -199,6 +201,7 @@ void xrServer::Update()
     if (Level().IsDemoPlayStarted() || Level().IsDemoPlayFinished())
         return; // diabling server when demo is playing
     stats.Update.Begin();
+    stats.UpdateTimer.Start();
     NET_Packet Packet;
 
     VERIFY(verify_entities());
@@ -236,13 +239,23 @@ void xrServer::Update()
     //-----------------------------------------------------
 
     PerformCheckClientsForMaxPing();
-    Flush_Clients_Buffers();
+    Flush_Clients_Buffers_Parallel();
 
     if (0 == (Device.dwFrame % 100)) // once per 100 frames
     {
         UpdateBannedList();
     }
     stats.Update.End();
+
+    if (stats.UpdateTimes.size() == 1024)
+        stats.UpdateTimes.clear();
+    stats.UpdateTimes.push_back(stats.UpdateTimer.GetElapsed_sec() * 1000.f);
+}
+
+void xrServer::TakeUpdateTimes(xr_vector<float>& times)
+{
+    times.insert(times.end(), stats.UpdateTimes.begin(), stats.UpdateTimes.end());
+    stats.UpdateTimes.clear();
 }
 
 void _stdcall xrServer::SendGameUpdateTo(IClient* client)
@@ -275,7 +288,12 @@ void xrServer::MakeUpdatePackets()
     NET_Packet tmpPacket;
     u32 position;
 
-    m_updator.begin_updates();
+    // every client gets the changes since the snapshot it has acknowledged, the demo needs the whole stream
+    m_delta_updates = (g_sv_traffic_optimization_level & eto_snapshot_delta) && !Level().IsDemoSave();
+    if (m_delta_updates)
+        m_snapshots.begin_snapshot();
+    else
+        m_updator.begin_updates();
 
     xrS_entities::iterator I = entities.begin();
     xrS_entities::iterator E = entities.end();
@@ -307,29 +325,83 @@ void xrServer::MakeUpdatePackets()
             if (g_Dump_Update_Write)
                 Msg("* %s : %d", Test.name(), ObjectSize);
 #endif
-            m_updator.write_update_for(Test.ID, tmpPacket);
+            if (m_delta_updates)
+                m_snapshots.write_update_for(Test.ID, tmpPacket);
+            else
+                m_updator.write_update_for(Test.ID, tmpPacket);
         }
     } // all entities
 
-    m_updator.end_updates(m_update_begin, m_update_end);
+    if (m_delta_updates)
+        m_snapshots.end_snapshot();
+    else
+        m_updator.end_updates(m_update_begin, m_update_end);
+}
+
+void _stdcall xrServer::SendUpdatePacketsTo(IClient* client)
+{
+    xrClientData* xr_client = static_cast<xrClientData*>(client);
+    VERIFY(xr_client);
+    if (!xr_client->flags.bConnected || !xr_client->net_Accepted || (client == GetServerClient()))
+        return;
+
+    for (update_iterator_t i = m_update_begin; i != m_update_end; ++i)
+    {
+        NET_Packet& to_send = **i;
+        if (to_send.B.count > 2)
+            client->SendPacket(to_send.B.data, to_send.B.count, net_flags(FALSE, TRUE), 0);
+    }
+}
+
+void _stdcall xrServer::SendDeltaUpdateTo(IClient* client)
+{
+    xrClientData* xr_client = static_cast<xrClientData*>(client);
+    VERIFY(xr_client);
+    if (!xr_client->flags.bConnected || !xr_client->net_Ready || (client == GetServerClient()))
+        return;
+
+    delta_update_packets& delta = xr_client->m_delta_packets;
+    m_snapshots.make_delta(xr_client->m_acked_snapshot, delta);
+    u32 delta_size = 0;
+    for (update_iterator_t i = delta.begin(); i != delta.end(); ++i)
+    {
+        delta_size += (*i)->B.count;
+        client->SendPacket((*i)->B.data, (*i)->B.count, net_flags(FALSE, TRUE), 0);
+    }
+    m_last_updates_size += delta_size;
 }
 
 void xrServer::SendUpdatePacketsToAll()
 {
+    // the workers put the updates straight to the client buffers, past xrServer::SendTo_LL: it only differs for
+    // the local client, which gets no updates
     m_last_updates_size = 0;
+    fastdelegate::FastDelegate1<IClient*, void> sendtofd;
+    if (m_delta_updates)
+    {
+        sendtofd.bind(this, &xrServer::SendDeltaUpdateTo);
+        m_snapshots.DeltaStats.Begin();
+        ForEachClientDoSenderParallel(sendtofd);
+        m_snapshots.DeltaStats.End();
+        return;
+    }
+
+    u32 updates_size = 0;
     for (update_iterator_t i = m_update_begin; i != m_update_end; ++i)
     {
         NET_Packet& to_send = **i;
         if (to_send.B.count > 2)
         {
-            m_last_updates_size += to_send.B.count;
-            SendBroadcast(GetServerClient()->ID, to_send, net_flags(FALSE, TRUE));
+            updates_size += to_send.B.count;
             if (Level().IsDemoSave())
             {
                 Level().SavePacket(to_send);
             }
         }
     }
+    m_last_updates_size = updates_size;
+    sendtofd.bind(this, &xrServer::SendUpdatePacketsTo);
+    ForEachClientDoSenderParallel(sendtofd);
 }
 
 void xrServer::SendUpdatesToAll()
@@ -499,6 +571,16 @@ u32 xrServer::OnMessage(NET_Packet& P, ClientID sender) // Non-Zero means broadc
         VERIFY(verify_entities());
     }
     break;
+    case M_DELTA_UPDATE_ACK:
+    {
+        if (!CL)
+            break;
+        // 0 is asked for by a client which has lost the baseline
+        u32 snapshot_id = P.r_u32();
+        if (!snapshot_id || (snapshot_id > CL->m_acked_snapshot))
+            CL->m_acked_snapshot = snapshot_id;
+    }
+    break;
     case M_MOVE_PLAYERS_RESPOND:
     {
         xrClientData* CL = ID_to_client(sender);
@@ -966,6 +1048,12 @@ void xrServer::DumpStatistics(IGameFont& font, IPerformanceAlert* alert)
     m_updator.CompressStats.FrameEnd();
     font.OutNext("- compress:   %2.2fms", m_updator.CompressStats.result);
     m_updator.CompressStats.FrameStart();
+    m_snapshots.DeltaStats.FrameEnd();
+    font.OutNext("- delta:      %2.2fms, %d bytes", m_snapshots.DeltaStats.result, m_last_updates_size.load());
+    m_snapshots.DeltaStats.FrameStart();
+    u32 buffer_count, free_count, memory;
+    NET_PooledPacket::pool_stats(buffer_count, free_count, memory);
+    font.OutNext("- packets:    %d buffers, %d free, %dKb", buffer_count, free_count, memory / 1024);
     stats.FrameStart();
 }
 
@@ -991,7 +1079,9 @@ void xrServer::ProceedDelayedPackets()
     while (!m_aDelayedPackets.empty())
     {
         DelayedPacket& DPacket = *m_aDelayedPackets.begin();
-        OnDelayedMessage(DPacket.Packet, DPacket.SenderID);
+        NET_Packet Packet;
+        DPacket.Packet.unpack(Packet);
+        OnDelayedMessage(Packet, DPacket.SenderID);
         //		OnMessage(DPacket.Packet, DPacket.SenderID);
         m_aDelayedPackets.pop_front();
     }
@@ -1005,7 +1095,7 @@ void xrServer::AddDelayedPacket(NET_Packet& Packet, ClientID Sender)
     m_aDelayedPackets.push_back(DelayedPacket());
     DelayedPacket* NewPacket = &(m_aDelayedPackets.back());
     NewPacket->SenderID = Sender;
-    CopyMemory(&(NewPacket->Packet), &Packet, sizeof(NET_Packet));
+    NewPacket->Packet.assign(Packet);
 
     DelayedPackestCS.Leave();
 }
@@ -13,6 +13,7 @@
 #include "xrEngine/mp_logging.h"
 #include "secure_messaging.h"
 #include "xrServer_updates_compressor.h"
+#include "xrServer_updates_snapshots.h"
 #include "xrClientsPool.h"
 
 #ifdef DEBUG
@@ -52,6 +53,9 @@ public:
     secure_messaging::key_t m_secret_key;
     s32 m_last_key_sync_request_seed;
 
+    u32 m_acked_snapshot; // the last update snapshot the client has got, deltas are made against it
+    delta_update_packets m_delta_packets;
+
     xrClientData();
     virtual ~xrClientData();
     virtual void Clear();
@@ -96,10 +100,15 @@ private:
     update_iterator_t m_update_begin;
     update_iterator_t m_update_end;
     server_updates_compressor m_updator;
+    server_updates_snapshots m_snapshots;
+    bool m_delta_updates;
 
     void MakeUpdatePackets();
     void SendUpdatePacketsToAll();
-    u32 m_last_updates_size;
+    // these run on the workers of ForEachClientDoSenderParallel, every one only fills the buffers of its client
+    void _stdcall SendUpdatePacketsTo(IClient* client);
+    void _stdcall SendDeltaUpdateTo(IClient* client);
+    std::atomic<u32> m_last_updates_size;
     u32 m_last_update_time;
 
     void SendServerInfoToClient(ClientID const& new_client);
@@ -116,7 +125,7 @@ private:
     struct DelayedPacket
     {
         ClientID SenderID;
-        NET_Packet Packet;
+        NET_PooledPacket Packet;
         bool operator==(const DelayedPacket& other) { return SenderID == other.SenderID; }
     };
 
@@ -148,6 +157,10 @@ private:
     struct ServerStatistics
     {
         CStatTimer Update;
+        // the update times in ms for the load tests, gathered whether g_bEnableStatGather is set or not,
+        // the ones nobody takes are dropped now and then
+        CTimer UpdateTimer;
+        xr_vector<float> UpdateTimes;
 
         ServerStatistics() { FrameStart(); }
         void FrameStart() { Update.FrameStart(); }
@@ -163,6 +176,8 @@ protected:
 
 public:
     virtual IServerGameState* GetGameState() override { return game; }
+    // appends the update times in ms since the previous call
+    void TakeUpdateTimes(xr_vector<float>& times);
     void Export_game_type(IClient* CL);
     void Perform_game_export();
     BOOL PerformRP(CSE_Abstract* E);
@@ -94,11 +94,8 @@ last_updates_cache::last_update_t* last_updates_cache::search_most_expired(
 
 server_updates_compressor::server_updates_compressor()
 {
-    u32 const need_to_reserve = (start_compress_buffer_size / sizeof(m_acc_buff.B.data)) + 1;
-    for (u32 i = 0; i < need_to_reserve; ++i)
-    {
-        m_ready_for_send.push_back(new NET_Packet());
-    }
+    // the destination packets are added on demand by goto_next_dest
+    m_ready_for_send.push_back(new NET_Packet());
 
     m_trained_stream = NULL;
     m_lzo_working_memory = NULL;
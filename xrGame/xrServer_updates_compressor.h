@@ -45,10 +45,7 @@ public:
     void end_updates(send_ready_updates_t::const_iterator& b, send_ready_updates_t::const_iterator& e);
 
 private:
-    // actor update size ~ 150 bytes..
     static u16 const max_eq_packets = 3;
-    static u32 const entities_count = 32;
-    static u32 const start_compress_buffer_size = 1024 * 150 * entities_count;
 
     enum_traffic_optimization m_traffic_optimization;
 
@@ -0,0 +1,395 @@
+#include "stdafx.h"
+#include "xrServer_updates_snapshots.h"
+#include "xrEngine/xr_object_list.h"
+#include "Common/object_broker.h"
+#include "xrMessages.h"
+#include "xrNetServer/NET_Transport.h"
+
+// offset of the parts count in a delta update packet : w_begin + snapshot id + baseline id + part
+static u32 const parts_count_offset = sizeof(u16) + 2 * sizeof(u32) + sizeof(u8);
+
+// IClient::SendPacket puts a part after its u16 size to the multipacket buffer, which has to stay below
+// NET_PacketSizeLimit, and the multipacket goes out with a 3 byte header and a compression tag, which the
+// net transport message has to hold as well
+static u32 const multipacket_buffer_overhead = sizeof(u16) + 1;
+static u32 const multipacket_message_overhead = sizeof(u16) + 3 + 1;
+static u32 const max_part_size = _min(
+    NET_PacketSizeLimit - multipacket_buffer_overhead, NET_TransportMessageSizeLimit - multipacket_message_overhead);
+
+// returns the size of the runs, 0 if they are not shorter than the state itself
+static u32 encode_delta(u8 const* baseline, u8 const* state, u8 const size, u8* dest)
+{
+    u32 result = 0;
+    u32 i = 0;
+    while (i < size)
+    {
+        u32 equal = 0;
+        while ((i + equal < size) && (equal < 255) && (baseline[i + equal] == state[i + equal]))
+            ++equal;
+        i += equal;
+        if (i == size)
+            break;
+
+        u32 changed = 0;
+        while ((i + changed < size) && (changed < 255) && (baseline[i + changed] != state[i + changed]))
+            ++changed;
+        if (result + 2 * sizeof(u8) + changed >= size)
+            return 0;
+
+        dest[result++] = static_cast<u8>(equal);
+        dest[result++] = static_cast<u8>(changed);
+        for (u32 j = 0; j < changed; ++j, ++i)
+            dest[result++] = baseline[i] ^ state[i];
+    }
+    return result;
+}
+
+static void decode_delta(NET_Packet& P, u32 const runs_size, u8 const* baseline, u8 const size, u8* state)
+{
+    CopyMemory(state, baseline, size);
+    u32 const runs_end = P.r_tell() + runs_size;
+    u32 i = 0;
+    while (P.r_tell() < runs_end)
+    {
+        i += P.r_u8();
+        u32 changed = P.r_u8();
+        R_ASSERT2(i + changed <= size, "corrupted delta update");
+        for (; changed; --changed, ++i)
+            state[i] ^= P.r_u8();
+    }
+}
+
+struct entity_state_predicate
+{
+    IC bool operator()(updates_snapshot::entity_state const& first, updates_snapshot::entity_state const& second) const
+    {
+        return (first.m_object_id < second.m_object_id);
+    }
+    IC bool operator()(updates_snapshot::entity_state const& first, u16 const entity_id) const
+    {
+        return (first.m_object_id < entity_id);
+    }
+};
+
+updates_snapshot::updates_snapshot() : m_id(0) {}
+void updates_snapshot::clear(u32 const id)
+{
+    m_id = id;
+    m_states.clear();
+    m_data.clear();
+}
+
+void updates_snapshot::add_state(u16 const entity_id, u8 const* data, u8 const size)
+{
+    VERIFY(size);
+    entity_state state;
+    state.m_object_id = entity_id;
+    state.m_size = size;
+    state.m_offset = m_data.size();
+    m_states.push_back(state);
+    m_data.insert(m_data.end(), data, data + size);
+}
+
+void updates_snapshot::sort_states() { std::sort(m_states.begin(), m_states.end(), entity_state_predicate()); }
+updates_snapshot::entity_state const* updates_snapshot::search_state(u16 const entity_id) const
+{
+    states_t::const_iterator I = std::lower_bound(m_states.begin(), m_states.end(), entity_id, entity_state_predicate());
+    if ((I == m_states.end()) || ((*I).m_object_id != entity_id))
+        return NULL;
+    return &*I;
+}
+
+delta_update_packets::delta_update_packets() : m_count(0) { m_packets.push_back(new NET_Packet()); }
+delta_update_packets::~delta_update_packets() { delete_data(m_packets); }
+server_updates_snapshots::server_updates_snapshots() : m_last_id(0) {}
+updates_snapshot const* server_updates_snapshots::search_snapshot(u32 const id) const
+{
+    if (!id)
+        return NULL;
+    updates_snapshot const& result = m_snapshots[id % snapshots_count];
+    return (result.id() == id) ? &result : NULL;
+}
+
+void server_updates_snapshots::begin_snapshot()
+{
+    if (!++m_last_id)
+        ++m_last_id;
+    m_snapshots[m_last_id % snapshots_count].clear(m_last_id);
+}
+
+void server_updates_snapshots::write_update_for(u16 const entity, NET_Packet const& update)
+{
+    // update ::= u16 entity id + u8 state size + state
+    u32 const header_size = sizeof(u16) + sizeof(u8);
+    VERIFY(update.B.count > header_size);
+    VERIFY(update.B.data[sizeof(u16)] == update.B.count - header_size);
+    m_snapshots[m_last_id % snapshots_count].add_state(
+        entity, update.B.data + header_size, static_cast<u8>(update.B.count - header_size));
+}
+
+void server_updates_snapshots::end_snapshot() { m_snapshots[m_last_id % snapshots_count].sort_states(); }
+void server_updates_snapshots::write_header(NET_Packet& dest, u32 const baseline_id, u32 const part) const
+{
+    VERIFY(part < 255);
+    dest.w_begin(M_DELTA_UPDATE_OBJECTS);
+    dest.w_u32(m_last_id);
+    dest.w_u32(baseline_id);
+    dest.w_u8(static_cast<u8>(part));
+    dest.w_u8(0);
+}
+
+NET_Packet* server_updates_snapshots::goto_next_dest(delta_update_packets& dest, u32 const baseline_id) const
+{
+    u32 const part = dest.m_count++;
+    VERIFY(dest.m_packets.size() >= part);
+    if (dest.m_packets.size() == part)
+        dest.m_packets.push_back(new NET_Packet());
+
+    NET_Packet* new_dest = dest.m_packets[part];
+    write_header(*new_dest, baseline_id, part);
+    return new_dest;
+}
+
+void server_updates_snapshots::write_record(
+    delta_update_packets& dest, u8 const* record, u32 const size, u32 const baseline_id) const
+{
+    NET_Packet* packet = dest.m_packets[dest.m_count - 1];
+    if (packet->w_tell() + size > max_part_size)
+        packet = goto_next_dest(dest, baseline_id);
+    packet->w(record, size);
+}
+
+void server_updates_snapshots::make_delta(u32 const baseline_id, delta_update_packets& dest) const
+{
+    updates_snapshot const& current = m_snapshots[m_last_id % snapshots_count];
+    updates_snapshot const* baseline = search_snapshot(baseline_id);
+    u32 const base_id = baseline ? baseline_id : 0;
+
+    dest.m_count = 0;
+    goto_next_dest(dest, base_id);
+
+    updates_snapshot::states_t const empty;
+    updates_snapshot::states_t const& base_states = baseline ? baseline->states() : empty;
+    updates_snapshot::states_t::const_iterator I = current.states().begin();
+    updates_snapshot::states_t::const_iterator E = current.states().end();
+    updates_snapshot::states_t::const_iterator i = base_states.begin();
+    updates_snapshot::states_t::const_iterator e = base_states.end();
+
+    u8 record[max_record_size];
+    u32 const header_size = sizeof(u16) + sizeof(u8);
+    while ((I != E) || (i != e))
+    {
+        if ((i != e) && ((I == E) || ((*i).m_object_id < (*I).m_object_id)))
+        {
+            *reinterpret_cast<u16*>(record) = (*i).m_object_id;
+            record[sizeof(u16)] = ds_removed;
+            write_record(dest, record, header_size, base_id);
+            ++i;
+            continue;
+        }
+
+        u8 const* state = current.state_data(*I);
+        *reinterpret_cast<u16*>(record) = (*I).m_object_id;
+        record[header_size] = (*I).m_size;
+
+        if ((i != e) && ((*i).m_object_id == (*I).m_object_id))
+        {
+            u8 const* base_state = baseline->state_data(*i);
+            bool const same_size = (*i).m_size == (*I).m_size;
+            ++i;
+            if (same_size)
+            {
+                if (!memcmp(base_state, state, (*I).m_size))
+                {
+                    ++I;
+                    continue;
+                }
+
+                u32 const runs_size = encode_delta(base_state, state, (*I).m_size, record + header_size + 2);
+                if (runs_size)
+                {
+                    record[sizeof(u16)] = ds_delta;
+                    record[header_size + 1] = static_cast<u8>(runs_size);
+                    write_record(dest, record, header_size + 2 + runs_size, base_id);
+                    ++I;
+                    continue;
+                }
+            }
+        }
+
+        record[sizeof(u16)] = ds_full;
+        CopyMemory(record + header_size + 1, state, (*I).m_size);
+        write_record(dest, record, header_size + 1 + (*I).m_size, base_id);
+        ++I;
+    }
+
+    u8 const parts_count = static_cast<u8>(dest.m_count);
+    for (delta_update_packets::send_ready_updates_t::const_iterator j = dest.begin(); j != dest.end(); ++j)
+        (*j)->w_seek(parts_count_offset, &parts_count, sizeof(parts_count));
+}
+
+client_updates_snapshots::client_updates_snapshots()
+    : m_build_id(0), m_build_baseline(0), m_build_parts_left(0), m_acknowledge(false), m_acknowledge_id(0)
+{
+    m_import.write_start();
+}
+
+updates_snapshot const* client_updates_snapshots::search_snapshot(u32 const id) const
+{
+    if (!id)
+        return NULL;
+    updates_snapshot const& result = m_snapshots[id % server_updates_snapshots::snapshots_count];
+    return (result.id() == id) ? &result : NULL;
+}
+
+bool client_updates_snapshots::acknowledge(u32& snapshot_id)
+{
+    if (!m_acknowledge)
+        return false;
+    snapshot_id = m_acknowledge_id;
+    m_acknowledge = false;
+    return true;
+}
+
+void client_updates_snapshots::flush_import(CObjectList& objects)
+{
+    if (!m_import.w_tell())
+        return;
+    m_import.r_seek(0);
+    objects.net_Import(&m_import);
+    m_import.write_start();
+}
+
+void client_updates_snapshots::process_part(NET_Packet& P, CObjectList& objects)
+{
+    u32 const snapshot_id = P.r_u32();
+    u32 const baseline_id = P.r_u32();
+    u8 const part = P.r_u8();
+    u8 const parts_count = P.r_u8();
+
+    // a late part of an older snapshot, the newer one is being built already
+    if (snapshot_id < m_build_id)
+        return;
+
+    updates_snapshot const* baseline = search_snapshot(baseline_id);
+    if (baseline_id && !baseline)
+    {
+        m_acknowledge = true;
+        m_acknowledge_id = 0;
+        return;
+    }
+
+    if (snapshot_id != m_build_id)
+    {
+        m_build_id = snapshot_id;
+        m_build_baseline = baseline_id;
+        m_build_parts.assign(parts_count, false);
+        m_build_parts_left = parts_count;
+        m_build_changes.clear(snapshot_id);
+        m_build_removed.clear();
+    }
+
+    if ((part >= m_build_parts.size()) || m_build_parts[part] || (baseline_id != m_build_baseline))
+        return;
+
+    u8 state[255];
+    while (!P.r_eof())
+    {
+        u16 const entity_id = P.r_u16();
+        u8 const type = P.r_u8();
+        if (ds_removed == type)
+        {
+            m_build_removed.push_back(entity_id);
+            continue;
+        }
+
+        u8 const size = P.r_u8();
+        if (ds_full == type)
+            P.r(state, size);
+        else
+        {
+            R_ASSERT2(ds_delta == type, "corrupted delta update");
+            u8 const runs_size = P.r_u8();
+            updates_snapshot::entity_state const* base_state = baseline ? baseline->search_state(entity_id) : NULL;
+            R_ASSERT2(base_state && (base_state->m_size == size), "delta update against an unknown state");
+            decode_delta(P, runs_size, baseline->state_data(*base_state), size, state);
+        }
+
+        m_build_changes.add_state(entity_id, state, size);
+    }
+
+    m_build_parts[part] = true;
+    if (!--m_build_parts_left)
+        complete_snapshot(objects);
+}
+
+void client_updates_snapshots::import_states(updates_snapshot const& states, CObjectList& objects)
+{
+    updates_snapshot::states_t::const_iterator I = states.states().begin();
+    updates_snapshot::states_t::const_iterator E = states.states().end();
+    for (; I != E; ++I)
+    {
+        u8 const* state = states.state_data(*I);
+        u8 const size = (*I).m_size;
+        updates_snapshot::entity_state const* imported = m_imported.search_state((*I).m_object_id);
+        if (imported && (imported->m_size == size) && !memcmp(m_imported.state_data(*imported), state, size))
+            continue;
+
+        // NET_Packet::w keeps the packet below NET_PacketSizeLimit
+        if (m_import.w_tell() + sizeof(u16) + sizeof(u8) + size >= sizeof(m_import.B.data))
+            flush_import(objects);
+        m_import.w_u16((*I).m_object_id);
+        m_import.w_u8(size);
+        m_import.w(state, size);
+    }
+    flush_import(objects);
+}
+
+void client_updates_snapshots::complete_snapshot(CObjectList& objects)
+{
+    updates_snapshot const* baseline = search_snapshot(m_build_baseline);
+    m_acknowledge = true;
+    m_build_changes.sort_states();
+    if (m_build_baseline && !baseline)
+    {
+        // the states can't be rebuilt, so the imported ones are not known anymore till the full states come
+        import_states(m_build_changes, objects);
+        m_imported.clear(0);
+        m_acknowledge_id = 0;
+        return;
+    }
+
+    updates_snapshot& snapshot = m_snapshots[m_build_id % server_updates_snapshots::snapshots_count];
+    VERIFY(&snapshot != baseline);
+    std::sort(m_build_removed.begin(), m_build_removed.end());
+
+    snapshot.clear(m_build_id);
+    updates_snapshot::states_t::const_iterator I = m_build_changes.states().begin();
+    updates_snapshot::states_t::const_iterator E = m_build_changes.states().end();
+    for (; I != E; ++I)
+        snapshot.add_state((*I).m_object_id, m_build_changes.state_data(*I), (*I).m_size);
+
+    if (baseline)
+    {
+        I = baseline->states().begin();
+        E = baseline->states().end();
+        for (; I != E; ++I)
+        {
+            if (m_build_changes.search_state((*I).m_object_id))
+                continue;
+            if (std::binary_search(m_build_removed.begin(), m_build_removed.end(), (*I).m_object_id))
+                continue;
+            snapshot.add_state((*I).m_object_id, baseline->state_data(*I), (*I).m_size);
+        }
+    }
+
+    snapshot.sort_states();
+    m_acknowledge_id = m_build_id;
+
+    import_states(snapshot, objects);
+    m_imported.clear(m_build_id);
+    I = snapshot.states().begin();
+    E = snapshot.states().end();
+    for (; I != E; ++I)
+        m_imported.add_state((*I).m_object_id, snapshot.state_data(*I), (*I).m_size);
+}
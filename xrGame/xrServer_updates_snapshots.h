@@ -0,0 +1,137 @@
+#ifndef XRSERVER_UPDATES_SNAPSHOTS_INCLUDED
+#define XRSERVER_UPDATES_SNAPSHOTS_INCLUDED
+
+class CObjectList;
+
+// States of the net relevant entities as they were written by UPDATE_Write during one server update.
+// Snapshots are identified by an increasing id, 0 stands for no snapshot at all
+class updates_snapshot : private Noncopyable
+{
+public:
+    struct entity_state
+    {
+        u16 m_object_id;
+        u8 m_size;
+        u32 m_offset;
+    };
+    typedef xr_vector<entity_state> states_t;
+
+    updates_snapshot();
+    ~updates_snapshot(){};
+
+    void clear(u32 const id);
+    void add_state(u16 const entity_id, u8 const* data, u8 const size);
+    void sort_states();
+
+    entity_state const* search_state(u16 const entity_id) const;
+    u8 const* state_data(entity_state const& state) const { return &m_data[state.m_offset]; }
+    states_t const& states() const { return m_states; }
+    u32 id() const { return m_id; }
+
+private:
+    u32 m_id;
+    states_t m_states; // sorted by the entity id after sort_states
+    xr_vector<u8> m_data;
+}; // class updates_snapshot
+
+// Every delta update packet is:
+//   M_DELTA_UPDATE_OBJECTS, u32 snapshot id, u32 baseline id, u8 part, u8 parts count, records...
+// and every record is u16 entity id, u8 record type, then:
+//   ds_full    : u8 size, the state
+//   ds_delta   : u8 size, u8 runs size, runs of {u8 equal bytes, u8 changed bytes, changed bytes XOR baseline}
+//   ds_removed : nothing, the entity is not in the snapshot anymore
+// Entities the state of which is the same as in the baseline are not written at all
+enum enum_delta_state
+{
+    ds_full = 0,
+    ds_delta,
+    ds_removed,
+}; // enum enum_delta_state
+
+// Packets of the last delta made for a client. Every client has its own, so the deltas of the clients are made
+// and sent in parallel
+class delta_update_packets : private Noncopyable
+{
+public:
+    typedef xr_vector<NET_Packet*> send_ready_updates_t;
+
+    delta_update_packets();
+    ~delta_update_packets();
+
+    send_ready_updates_t::const_iterator begin() const { return m_packets.begin(); }
+    send_ready_updates_t::const_iterator end() const { return m_packets.begin() + m_count; }
+
+private:
+    friend class server_updates_snapshots;
+
+    send_ready_updates_t m_packets; // kept between the updates, only the first m_count are the delta
+    u32 m_count;
+}; // class delta_update_packets
+
+class server_updates_snapshots : private Noncopyable
+{
+public:
+    static u32 const snapshots_count = 32;
+
+    CStatTimer DeltaStats;
+
+    server_updates_snapshots();
+    ~server_updates_snapshots(){};
+
+    void begin_snapshot();
+    void write_update_for(u16 const entity, NET_Packet const& update);
+    void end_snapshot();
+
+    // packets taking a client from the acknowledged baseline to the current snapshot, all the states
+    // are sent in full if the baseline is not kept anymore. Snapshots are not changed, so the deltas of
+    // different clients may be made at the same time
+    void make_delta(u32 const baseline_id, delta_update_packets& dest) const;
+
+private:
+    static u32 const max_record_size = sizeof(u16) + 3 * sizeof(u8) + 255;
+
+    updates_snapshot m_snapshots[snapshots_count];
+    u32 m_last_id;
+
+    updates_snapshot const* search_snapshot(u32 const id) const;
+    void write_header(NET_Packet& dest, u32 const baseline_id, u32 const part) const;
+    NET_Packet* goto_next_dest(delta_update_packets& dest, u32 const baseline_id) const;
+    void write_record(delta_update_packets& dest, u8 const* record, u32 const size, u32 const baseline_id) const;
+}; // class server_updates_snapshots
+
+class client_updates_snapshots : private Noncopyable
+{
+public:
+    client_updates_snapshots();
+    ~client_updates_snapshots(){};
+
+    // collects the states of a delta update packet, P is read after the message type. The states are imported
+    // to the objects only when the snapshot is complete, and only the ones which differ from the imported before:
+    // an entity the server takes as unchanged since the baseline may have been imported from a newer snapshot
+    void process_part(NET_Packet& P, CObjectList& objects);
+    // snapshot the server should make the next deltas against, 0 requests the full states
+    bool acknowledge(u32& snapshot_id);
+
+private:
+    updates_snapshot m_snapshots[server_updates_snapshots::snapshots_count];
+
+    u32 m_build_id;
+    u32 m_build_baseline;
+    xr_vector<bool> m_build_parts;
+    u32 m_build_parts_left;
+    updates_snapshot m_build_changes;
+    xr_vector<u16> m_build_removed;
+
+    NET_Packet m_import;
+    updates_snapshot m_imported; // the states the objects have, sorted
+
+    bool m_acknowledge;
+    u32 m_acknowledge_id;
+
+    updates_snapshot const* search_snapshot(u32 const id) const;
+    void complete_snapshot(CObjectList& objects);
+    void import_states(updates_snapshot const& states, CObjectList& objects);
+    void flush_import(CObjectList& objects);
+}; // class client_updates_snapshots
+
+#endif //#ifndef XRSERVER_UPDATES_SNAPSHOTS_INCLUDED
@@ -22,6 +22,7 @@
 #include "character_reputation.h"
 
 #include "xrEngine/profiler.h"
+#include "mp_bots_load_test.h"
 
 #include "sound_collection_storage.h"
 #include "relation_registry.h"
@@ -69,6 +70,7 @@ extern void destroy_lua_wpn_params();
 
 void clean_game_globals()
 {
+    xr_delete(g_bot_load_test);
     destroy_lua_wpn_params();
     // destroy ai space
     xr_delete(g_ai_space);
@@ -117,8 +119,6 @@ void clean_game_globals()
     xr_delete(g_sound_collection_storage);
 
 #ifdef DEBUG
-    // XXX nitrocaster PROFILER: temporarily disabled due to linkage issues
-    // xr_delete										(g_profiler);
     release_smart_cast_stats();
 #endif
 
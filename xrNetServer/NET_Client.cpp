@@ -84,8 +84,6 @@ const GUID CLSID_DirectPlay8Address = {0x934a9523, 0xa3ca, 0x4bc5, {0xad, 0xa0,
 
 const GUID IID_IDirectPlay8Address = {0x83783300, 0x4063, 0x4c8a, {0x9d, 0xb3, 0x82, 0x83, 0x0a, 0x7f, 0xeb, 0x31}};
 
-static INetLog* pClNetLog = NULL;
-
 void dump_URL(LPCSTR p, IDirectPlay8Address* A)
 {
     string256 aaaa;
@@ -100,150 +98,57 @@ INetQueue::INetQueue()
     : cs(MUTEX_PROFILE_ID(INetQueue))
 #endif // CONFIG_PROFILE_LOCKS
 {
-    unused.reserve(128);
-    for (int i = 0; i < 16; i++)
-        unused.push_back(new NET_Packet());
+    current_valid = false;
 }
 
 INetQueue::~INetQueue()
 {
     cs.Enter();
-    u32 it;
-    for (it = 0; it < unused.size(); it++)
-        xr_delete(unused[it]);
-    for (it = 0; it < ready.size(); it++)
-        xr_delete(ready[it]);
+    ready.clear();
     cs.Leave();
 }
 
-static u32 LastTimeCreate = 0;
-NET_Packet* INetQueue::Create()
+void INetQueue::Push(const void* data, u32 size, u32 time_receive)
 {
-    NET_Packet* P = 0;
     // cs.Enter		();
-    //#ifdef _DEBUG
-    //		Msg ("- INetQueue::Create - ready %d, unused %d", ready.size(), unused.size());
-    //#endif
-    if (unused.empty())
-    {
-        ready.push_back(new NET_Packet());
-        P = ready.back();
-        //---------------------------------------------
-        LastTimeCreate = GetTickCount();
-        //---------------------------------------------
-    }
-    else
-    {
-        ready.push_back(unused.back());
-        unused.pop_back();
-        P = ready.back();
-    }
+    ready.push_back(NET_PooledPacket());
+    ready.back().assign(data, size, time_receive);
     // cs.Leave		();
-    return P;
-}
-NET_Packet* INetQueue::Create(const NET_Packet& _other)
-{
-    NET_Packet* P = 0;
-    cs.Enter();
-    //#ifdef _DEBUG
-    //		Msg ("- INetQueue::Create - ready %d, unused %d", ready.size(), unused.size());
-    //#endif
-    if (unused.empty())
-    {
-        ready.push_back(new NET_Packet());
-        P = ready.back();
-        //---------------------------------------------
-        LastTimeCreate = GetTickCount();
-        //---------------------------------------------
-    }
-    else
-    {
-        ready.push_back(unused.back());
-        unused.pop_back();
-        P = ready.back();
-    }
-    CopyMemory(P, &_other, sizeof(NET_Packet));
-    cs.Leave();
-    return P;
 }
+
 NET_Packet* INetQueue::Retreive()
 {
-    NET_Packet* P = 0;
     // cs.Enter		();
-    //#ifdef _DEBUG
-    //			Msg ("INetQueue::Retreive - ready %d, unused %d", ready.size(), unused.size());
-    //#endif
-    if (!ready.empty())
-        P = ready.front();
-    //---------------------------------------------
-    else
+    if (ready.empty())
+        return 0;
+
+    // the same message is returned till it is released
+    if (!current_valid)
     {
-        u32 tmp_time = GetTickCount() - 60000;
-        u32 size = unused.size();
-        if ((LastTimeCreate < tmp_time) && (size > 32))
-        {
-            xr_delete(unused.back());
-            unused.pop_back();
-        }
+        ready.front().unpack(current);
+        current_valid = true;
     }
-    //---------------------------------------------
     // cs.Leave		();
-    return P;
+    return &current;
 }
+
 void INetQueue::Release()
 {
     // cs.Enter		();
-    //#ifdef _DEBUG
-    //		Msg ("INetQueue::Release - ready %d, unused %d", ready.size(), unused.size());
-    //#endif
     VERIFY(!ready.empty());
-    //---------------------------------------------
-    u32 tmp_time = GetTickCount() - 60000;
-    u32 size = unused.size();
-    ready.front()->B.count = 0;
-    if ((LastTimeCreate < tmp_time) && (size > 32))
-    {
-        xr_delete(ready.front());
-    }
-    else
-        unused.push_back(ready.front());
-    //---------------------------------------------
     ready.pop_front();
+    current_valid = false;
     // cs.Leave		();
 }
 
 //
-const u32 syncQueueSize = 512;
 const int syncSamples = 256;
-class XRNETSERVER_API syncQueue
-{
-    u32 table[syncQueueSize];
-    u32 write;
-    u32 count;
-
-public:
-    syncQueue() { clear(); }
-    IC void push(u32 value)
-    {
-        table[write++] = value;
-        if (write == syncQueueSize)
-            write = 0;
-
-        if (count <= syncQueueSize)
-            count++;
-    }
-    IC u32* begin() { return table; }
-    IC u32* end() { return table + count; }
-    IC u32 size() { return count; }
-    IC void clear()
-    {
-        write = 0;
-        count = 0;
-    }
-} net_DeltaArray;
+// the reply of the server over the net transport
+static const u32 transport_reply_waiting = u32(-1);
+static const u32 transport_connect_timeout = 10000;
 
 //-------
-XRNETSERVER_API Flags32 psNET_Flags = {0};
+XRNETSERVER_API Flags32 psNET_Flags = {NETFLAG_PARALLEL_SEND};
 XRNETSERVER_API int psNET_ClientUpdate = 30; // FPS
 XRNETSERVER_API int psNET_ClientPending = 2;
 XRNETSERVER_API char psNET_Name[32] = "Player";
@@ -327,6 +232,9 @@ IPureClient::IPureClient(CTimer* timer)
     NET = NULL;
     net_Address_server = NULL;
     net_Address_device = NULL;
+    m_transport = NULL;
+    m_transport_server = 0;
+    m_transport_reply = transport_reply_waiting;
     device_timer = timer;
     net_TimeDelta_User = 0;
     net_Time_LastUpdate = 0;
@@ -418,6 +326,12 @@ BOOL IPureClient::Connect(LPCSTR options)
         net_Syncronised = FALSE;
         net_Disconnected = FALSE;
 
+        if (net_transport_enabled())
+        {
+            net_TimeDelta = 0;
+            return transport_Connect(server_name, psSV_Port, password_str, user_name_str, user_pass);
+        }
+
         //---------------------------
         string1024 tmp = "";
         //	HRESULT CoInitializeExRes = CoInitializeEx(NULL, 0);
@@ -725,8 +639,93 @@ BOOL IPureClient::Connect(LPCSTR options)
     return TRUE;
 }
 
+BOOL IPureClient::transport_Connect(
+    LPCSTR server_name, u32 port, LPCSTR password, LPCSTR user_name, LPCSTR user_pass)
+{
+    NET_Address address;
+    if (!net_resolve_address(server_name, u16(port), address))
+    {
+        OnInvalidHost();
+        return FALSE;
+    }
+
+    m_transport_address = address;
+    m_transport_reply = transport_reply_waiting;
+    m_transport = new CNetTransportThread(net_create_udp_socket(), *this);
+    m_transport_server = m_transport->Connect(address);
+    if (!m_transport_server)
+    {
+        xr_delete(m_transport);
+        return FALSE;
+    }
+
+    SClientTransportConnect connect;
+    connect.data.process_id = GetCurrentProcessId();
+    xr_strcpy(connect.data.name, user_name);
+    xr_strcpy(connect.data.pass, user_pass);
+    xr_strcpy(connect.session_password, password);
+    // waits for the connection to be accepted
+    m_transport->Send(
+        m_transport_server, &connect, sizeof(connect), NET_TRANSPORT_RELIABLE | NET_TRANSPORT_SEQUENCED);
+    m_transport->Start();
+
+    CTimer timer;
+    timer.Start();
+    while ((m_transport_reply == transport_reply_waiting) && !net_Disconnected &&
+        (timer.GetElapsed_ms() < transport_connect_timeout))
+        Sleep(1);
+
+    switch (m_transport_reply)
+    {
+    case SServerTransportReply::Accepted:
+        Msg("- IPureClient : connected to %s:%d over the net transport!", server_name, port);
+        return TRUE;
+    case SServerTransportReply::InvalidPassword: OnInvalidPassword(); break;
+    case SServerTransportReply::SessionFull: OnSessionFull(); break;
+    case SServerTransportReply::Rejected: OnConnectRejected(); break;
+    default: OnInvalidHost(); break;
+    }
+
+    xr_delete(m_transport);
+    return FALSE;
+}
+
+void IPureClient::OnPeerConnected(u32 peer) {}
+void IPureClient::OnPeerDisconnected(u32 peer) { net_Disconnected = TRUE; }
+void IPureClient::OnPeerMessage(u32 peer, const void* data, u32 size)
+{
+    if (m_transport_reply != transport_reply_waiting)
+    {
+        MultipacketReciever::RecievePacket(data, size);
+        return;
+    }
+
+    // the reply is the first reliable message, the unreliable ones may outrun it
+    if (size != sizeof(SServerTransportReply))
+        return;
+
+    SServerTransportReply reply;
+    CopyMemory(&reply, data, size);
+    if (reply.result == SServerTransportReply::Accepted)
+    {
+        reply.session_name[sizeof(reply.session_name) - 1] = 0;
+        m_game_description = reply.game_descr;
+
+        HOST_NODE NODE;
+        ZeroMemory(&NODE, sizeof(HOST_NODE));
+        NODE.dpSessionName = reply.session_name;
+        net_csEnumeration.Enter();
+        net_Hosts.push_back(NODE);
+        net_csEnumeration.Leave();
+    }
+    m_transport_reply = reply.result;
+}
+
 void IPureClient::Disconnect()
 {
+    // the transport thread is stopped before the client is gone
+    xr_delete(m_transport);
+
     if (NET)
         NET->Close(0);
 
@@ -909,13 +908,7 @@ void IPureClient::OnMessage(void* data, u32 size)
 {
     // One of the messages - decompress it
     net_Queue.Lock();
-    NET_Packet* P = net_Queue.Create();
-
-    P->construct(data, size);
-    P->timeReceive = timeServer_Async(); // TimerAsync				(device_timer);
-
-    u16 m_type;
-    P->r_begin(m_type);
+    net_Queue.Push(data, size, timeServer_Async()); // TimerAsync				(device_timer);
     net_Queue.Unlock();
 }
 
@@ -946,6 +939,17 @@ void IPureClient::SendTo_LL(void* data, u32 size, u32 dwFlags, u32 dwTimeout)
 
     net_Statistic.dwBytesSended += size;
 
+    if (m_transport)
+    {
+        if (size > NET_TransportMessageSizeLimit)
+        {
+            Msg("! too large packet size[%d] for the net transport", size);
+            return;
+        }
+        m_transport->Send(m_transport_server, data, size, net_transport_flags(dwFlags));
+        return;
+    }
+
     // verify
     VERIFY(desc.dwBufferSize);
     VERIFY(desc.pBufferData);
@@ -996,13 +1000,18 @@ BOOL IPureClient::net_HasBandwidth()
     }
     else if (0 != psNET_ClientUpdate && (dwTime - net_Time_LastUpdate) > dwInterval)
     {
-        HRESULT hr;
-        R_ASSERT(NET);
         // check queue for "empty" state
         DWORD dwPending = 0;
-        hr = NET->GetSendQueueInfo(&dwPending, 0, 0);
-        if (FAILED(hr))
-            return FALSE;
+        if (m_transport)
+            dwPending = m_transport->GetQueueSize(m_transport_server);
+        else
+        {
+            HRESULT hr;
+            R_ASSERT(NET);
+            hr = NET->GetSendQueueInfo(&dwPending, 0, 0);
+            if (FAILED(hr))
+                return FALSE;
+        }
 
         if (dwPending > u32(psNET_ClientPending))
         {
@@ -1025,9 +1034,14 @@ void IPureClient::UpdateStatistic()
     DPN_CONNECTION_INFO CI;
     ZeroMemory(&CI, sizeof(CI));
     CI.dwSize = sizeof(CI);
-    HRESULT hr = NET->GetConnectionInfo(&CI, 0);
-    if (FAILED(hr))
-        return;
+    if (m_transport)
+        CI.dwRoundTripLatencyMS = m_transport->GetPing(m_transport_server);
+    else
+    {
+        HRESULT hr = NET->GetConnectionInfo(&CI, 0);
+        if (FAILED(hr))
+            return;
+    }
 
     net_Statistic.Update(CI);
 }
@@ -1038,8 +1052,8 @@ void IPureClient::Sync_Thread()
 
     //***** Ping server
     net_DeltaArray.clear();
-    R_ASSERT(NET);
-    for (; NET && !net_Disconnected;)
+    R_ASSERT(NET || m_transport);
+    for (; (NET || m_transport) && !net_Disconnected;)
     {
         // Waiting for queue empty state
         if (net_Syncronised)
@@ -1049,7 +1063,10 @@ void IPureClient::Sync_Thread()
             DWORD dwPending = 0;
             do
             {
-                R_CHK(NET->GetSendQueueInfo(&dwPending, 0, 0));
+                if (m_transport)
+                    dwPending = m_transport->GetQueueSize(m_transport_server);
+                else
+                    R_CHK(NET->GetSendQueueInfo(&dwPending, 0, 0));
                 Sleep(1);
             } while (dwPending);
         }
@@ -1066,10 +1083,13 @@ void IPureClient::Sync_Thread()
             DPNHANDLE hAsync = 0;
             desc.dwBufferSize = sizeof(clPing);
             desc.pBufferData = LPBYTE(&clPing);
-            if (0 == NET || net_Disconnected)
+            if ((0 == NET && 0 == m_transport) || net_Disconnected)
                 break;
 
-            if (FAILED(NET->Send(&desc, 1, 0, 0, &hAsync, net_flags(FALSE, FALSE, TRUE))))
+            if (m_transport)
+                m_transport->Send(m_transport_server, &clPing, sizeof(clPing),
+                    net_transport_flags(net_flags(FALSE, FALSE, TRUE)));
+            else if (FAILED(NET->Send(&desc, 1, 0, 0, &hAsync, net_flags(FALSE, FALSE, TRUE))))
             {
                 Msg("* CLIENT: SyncThread: EXIT. (failed to send - disconnected?)");
                 break;
@@ -1140,6 +1160,16 @@ BOOL IPureClient::net_IsSyncronised() { return net_Syncronised; }
 bool IPureClient::GetServerAddress(ip_address& pAddress, DWORD* pPort)
 {
     *pPort = 0;
+    if (m_transport)
+    {
+        pAddress.m_data.a1 = u8(m_transport_address.ip >> 24);
+        pAddress.m_data.a2 = u8(m_transport_address.ip >> 16);
+        pAddress.m_data.a3 = u8(m_transport_address.ip >> 8);
+        pAddress.m_data.a4 = u8(m_transport_address.ip);
+        *pPort = m_transport_address.port;
+        return true;
+    }
+
     if (!net_Address_server)
         return false;
 
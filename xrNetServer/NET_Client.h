@@ -2,30 +2,61 @@
 
 #include "net_shared.h"
 #include "NET_Common.h"
+#include "NET_Transport.h"
 
 struct ip_address;
+class INetLog;
 
+// Received messages are queued in pooled buffers of their size, the one being processed is unpacked to current
 class XRNETSERVER_API INetQueue
 {
     Lock cs;
-    xr_deque<NET_Packet*> ready;
-    xr_vector<NET_Packet*> unused;
+    xr_deque<NET_PooledPacket> ready;
+    NET_Packet current;
+    bool current_valid;
 
 public:
     INetQueue();
     ~INetQueue();
 
-    NET_Packet* Create();
-    NET_Packet* Create(const NET_Packet& _other);
+    void Push(const void* data, u32 size, u32 time_receive);
     NET_Packet* Retreive();
     void Release();
     inline void Lock() { cs.Enter(); };
     inline void Unlock() { cs.Leave(); };
 };
 
+const u32 syncQueueSize = 512;
+class XRNETSERVER_API syncQueue
+{
+    u32 table[syncQueueSize];
+    u32 write;
+    u32 count;
+
+public:
+    syncQueue() { clear(); }
+    IC void push(u32 value)
+    {
+        table[write++] = value;
+        if (write == syncQueueSize)
+            write = 0;
+
+        if (count <= syncQueueSize)
+            count++;
+    }
+    IC u32* begin() { return table; }
+    IC u32* end() { return table + count; }
+    IC u32 size() { return count; }
+    IC void clear()
+    {
+        write = 0;
+        count = 0;
+    }
+};
+
 //==============================================================================
 
-class XRNETSERVER_API IPureClient : private MultipacketReciever, private MultipacketSender
+class XRNETSERVER_API IPureClient : private MultipacketReciever, private MultipacketSender, private INetTransportHandler
 {
     enum ConnectionState
     {
@@ -49,6 +80,11 @@ protected:
     IDirectPlay8Client* NET;
     IDirectPlay8Address* net_Address_device;
     IDirectPlay8Address* net_Address_server;
+    // instead of NET, see net_transport_enabled
+    CNetTransportThread* m_transport;
+    u32 m_transport_server;
+    NET_Address m_transport_address;
+    std::atomic<u32> m_transport_reply; // SServerTransportReply::EResult once it arrives
 
     Lock net_csEnumeration;
     xr_vector<HOST_NODE> net_Hosts;
@@ -62,6 +98,10 @@ protected:
     INetQueue net_Queue;
     IClientStatistic net_Statistic;
 
+    // per client, several of them may be connected from the same process
+    syncQueue net_DeltaArray;
+    INetLog* pClNetLog;
+
     u32 net_Time_LastUpdate;
     s32 net_TimeDelta;
     s32 net_TimeDelta_Calculated;
@@ -126,4 +166,9 @@ private:
 
     virtual void _Recieve(const void* data, u32 data_size, u32 param);
     virtual void _SendTo_LL(const void* data, u32 size, u32 flags, u32 timeout);
+
+    BOOL transport_Connect(LPCSTR server_name, u32 port, LPCSTR password, LPCSTR user_name, LPCSTR user_pass);
+    virtual void OnPeerConnected(u32 peer);
+    virtual void OnPeerDisconnected(u32 peer);
+    virtual void OnPeerMessage(u32 peer, const void* data, u32 size);
 };
@@ -53,6 +53,12 @@ struct MultipacketHeader
 
 static NET_Compressor Compressor;
 static const unsigned MaxMultipacketSize = 32768;
+// the server flushes its clients in parallel, their packets are dumped one at a time
+static Lock DumpTrafficCS
+#ifdef CONFIG_PROFILE_LOCKS
+    (MUTEX_PROFILE_ID(DumpTrafficCS))
+#endif // CONFIG_PROFILE_LOCKS
+    ;
 
 XRNETSERVER_API int psNET_GuaranteedPacketMode = NET_GUARANTEEDPACKET_DEFAULT;
 
@@ -143,6 +149,7 @@ void MultipacketSender::_FlushSendBuffer(u32 timeout, Buffer* buf)
 
         if (strstr(Core.Params, "-dump_traffic"))
         {
+            DumpTrafficCS.Enter();
             static bool first_time = true;
             FILE* dump = fopen("raw-out-traffic.bins", (first_time) ? "wb" : "ab");
 
@@ -157,6 +164,7 @@ void MultipacketSender::_FlushSendBuffer(u32 timeout, Buffer* buf)
             fwrite(&sz, sizeof(u16), 1, dump);
             fwrite(buf->buffer.B.data, buf->buffer.B.count, 1, dump);
             fclose(dump);
+            DumpTrafficCS.Leave();
         }
 
         // do send
@@ -226,3 +234,4 @@ void MultipacketReciever::RecievePacket(const void* packet_data, u32 packet_sz,
 }
 
 void XRNETSERVER_API DumpNetCompressorStats(bool brief) { Compressor.DumpStats(brief); }
+void XRNETSERVER_API GetNetCompressorTotals(NET_CompressorTotals& totals) { Compressor.GetTotals(totals); }
@@ -255,6 +255,7 @@ NET_Compressor::NET_Compressor()
     : CS(MUTEX_PROFILE_ID(NET_Compressor))
 #endif // CONFIG_PROFILE_LOCKS
 {
+    m_coder_ready.store(false);
 }
 
 NET_Compressor::~NET_Compressor()
@@ -294,6 +295,23 @@ void NET_Compressor::Initialize	()
     CS.Leave		();
 }*/
 
+void NET_Compressor::prepare_coder()
+{
+#if NET_USE_COMPRESSION && NET_USE_LZO_COMPRESSION
+    // the dictionary is loaded by the first packet, the other threads must not code before it is
+    if (m_coder_ready.load(std::memory_order_acquire))
+        return;
+
+    CS.Enter();
+    if (!m_coder_ready.load(std::memory_order_relaxed))
+    {
+        rtc9_initialize();
+        m_coder_ready.store(true, std::memory_order_release);
+    }
+    CS.Leave();
+#endif // NET_USE_COMPRESSION && NET_USE_LZO_COMPRESSION
+}
+
 u16 NET_Compressor::compressed_size(const u32& count)
 {
 #if NET_USE_COMPRESSION
@@ -320,14 +338,7 @@ XRNETSERVER_API BOOL g_net_compressor_gather_stats = FALSE;
 
 u16 NET_Compressor::Compress(BYTE* dest, const u32& dest_size, BYTE* src, const u32& count)
 {
-    SCompressorStats::SStatPacket* _p = NULL;
     bool b_compress_packet = (count > 36);
-    if (g_net_compressor_gather_stats && b_compress_packet)
-    {
-        _p = m_stats.get(count);
-        _p->hit_count += 1;
-        m_stats.total_uncompressed_bytes += count;
-    }
 
     VERIFY(dest);
     VERIFY(src);
@@ -357,15 +368,18 @@ u16 NET_Compressor::Compress(BYTE* dest, const u32& dest_size, BYTE* src, const
     offset += sizeof(u32);
 #endif // NET_USE_COMPRESSION_CRC
 
+    u32 encoded_size = 0;
     if (!psNET_direct_connect && g_net_compressor_enabled && b_compress_packet)
     {
+#if NET_USE_LZO_COMPRESSION
+        prepare_coder();
+        encoded_size = offset + ENCODE(dest + offset, dest_size - offset, src, count);
+#else // NET_USE_LZO_COMPRESSION
         CS.Enter();
-        compressed_size = offset + ENCODE(dest + offset, dest_size - offset, src, count);
-
-        if (g_net_compressor_gather_stats)
-            m_stats.total_compressed_bytes += compressed_size;
-
+        encoded_size = offset + ENCODE(dest + offset, dest_size - offset, src, count);
         CS.Leave();
+#endif // NET_USE_LZO_COMPRESSION
+        compressed_size = encoded_size;
     }
 
     if (compressed_size < count)
@@ -396,9 +410,6 @@ u16 NET_Compressor::Compress(BYTE* dest, const u32& dest_size, BYTE* src, const
     }
     else
     {
-        if (g_net_compressor_gather_stats && b_compress_packet)
-            _p->unlucky_attempts += 1;
-
         *dest = NET_TAG_NONCOMPRESSED;
 
         compressed_size = count + 1;
@@ -409,7 +420,17 @@ u16 NET_Compressor::Compress(BYTE* dest, const u32& dest_size, BYTE* src, const
 #endif
     }
     if (g_net_compressor_gather_stats && b_compress_packet)
+    {
+        CS.Enter();
+        SCompressorStats::SStatPacket* _p = m_stats.get(count);
+        _p->hit_count += 1;
         _p->compressed_size += compressed_size;
+        if (compressed_size > count)
+            _p->unlucky_attempts += 1;
+        m_stats.total_uncompressed_bytes += count;
+        m_stats.total_compressed_bytes += encoded_size;
+        CS.Leave();
+    }
 
 #if 1 // def DEBUG
 //	if( strstr(Core.Params,"-dump_traffic"))
@@ -490,9 +511,14 @@ u16 NET_Compressor::Decompress(BYTE* dest, const u32& dest_size, BYTE* src, cons
     R_ASSERT2(crc == *((u32*)(src + 1)), make_string("crc is different! (0x%08x != 0x%08x)", crc, *((u32*)(src + 1))));
 #endif // NET_USE_COMPRESSION_CRC
 
+#if NET_USE_LZO_COMPRESSION
+    prepare_coder();
+    u32 uncompressed_size = DECODE(dest, dest_size, src + offset, count - offset);
+#else // NET_USE_LZO_COMPRESSION
     CS.Enter();
     u32 uncompressed_size = DECODE(dest, dest_size, src + offset, count - offset);
     CS.Leave();
+#endif // NET_USE_LZO_COMPRESSION
 
     return (u16(uncompressed_size));
 
@@ -501,6 +527,7 @@ u16 NET_Compressor::Decompress(BYTE* dest, const u32& dest_size, BYTE* src, cons
 
 void NET_Compressor::DumpStats(bool brief)
 {
+    CS.Enter();
     xr_map<u32, SCompressorStats::SStatPacket>::const_iterator it = m_stats.m_packets.begin();
     xr_map<u32, SCompressorStats::SStatPacket>::const_iterator it_e = m_stats.m_packets.end();
 
@@ -526,4 +553,22 @@ void NET_Compressor::DumpStats(bool brief)
     }
     Msg("total   [%d]", total_hits);
     Msg("unlucky [%d]", unlucky_hits);
+    CS.Leave();
+}
+
+void NET_Compressor::GetTotals(NET_CompressorTotals& totals)
+{
+    CS.Enter();
+    totals.uncompressed_bytes = m_stats.total_uncompressed_bytes;
+    totals.compressed_bytes = m_stats.total_compressed_bytes;
+    totals.packets = 0;
+    totals.unlucky = 0;
+    xr_map<u32, SCompressorStats::SStatPacket>::const_iterator it = m_stats.m_packets.begin();
+    xr_map<u32, SCompressorStats::SStatPacket>::const_iterator it_e = m_stats.m_packets.end();
+    for (; it != it_e; ++it)
+    {
+        totals.packets += it->second.hit_count;
+        totals.unlucky += it->second.unlucky_attempts;
+    }
+    CS.Leave();
 }
@@ -4,9 +4,24 @@
 
 #include "xrCore/Threading/Lock.hpp"
 
+struct NET_CompressorTotals
+{
+    u32 uncompressed_bytes;
+    u32 compressed_bytes;
+    u32 packets; // the ones big enough to try compressing
+    u32 unlucky; // the ones compressing did not make smaller
+
+    NET_CompressorTotals() : uncompressed_bytes(0), compressed_bytes(0), packets(0), unlucky(0) {}
+};
+
 class XRNETSERVER_API NET_Compressor
 {
+    // guards the stats and the PPMd model, LZO keeps its work memory per thread and codes without it,
+    // so the server compresses the packets of different clients in parallel
     Lock CS;
+    std::atomic_bool m_coder_ready;
+
+    void prepare_coder();
 
     struct SCompressorStats
     {
@@ -34,6 +49,7 @@ public:
     u16 Compress(BYTE* dest, const u32& dest_size, BYTE* src, const u32& count); // return size of compressed
     u16 Decompress(BYTE* dest, const u32& dest_size, BYTE* src, const u32& count); // return size of compressed
     void DumpStats(bool brief);
+    void GetTotals(NET_CompressorTotals& totals);
 };
 
 #endif // !defined(AFX_NET_COMPRESSOR_H__21E1ED1C_BF92_4BF0_94A8_18A27486EBFD__INCLUDED_)
@@ -4,6 +4,7 @@
 #include "net_shared.h"
 #include "NET_Common.h"
 #include "xrCore/fastdelegate.h"
+#include "xrCore/Threading/TaskManager.hpp"
 
 class IClient;
 
@@ -80,6 +81,27 @@ public:
         // Msg("-S- Leaving from csPlayers [%d]", GetCurrentThreadId());
         csPlayers.Leave();
     }
+    // Calls the functor for every client on the task scheduler workers, one client per task. The clients stay
+    // locked by this thread meanwhile, so the functor must not look up or iterate the clients itself
+    template <typename ActionFunctor>
+    void ForEachClientDoParallel(ActionFunctor const& functor)
+    {
+        csPlayers.Enter();
+        now_iterating_in_net_players = true;
+#ifdef DEBUG
+        iterator_thread_id = GetCurrentThreadId();
+#endif
+        players_collection_t const& players = net_Players;
+        TaskScheduler.ParallelFor(0, u32(players.size()), 1, [&players, &functor](u32 from, u32 to) {
+            for (u32 i = from; i != to; ++i)
+            {
+                VERIFY2(players[i] != NULL, "IClient ptr is NULL");
+                functor(players[i]);
+            }
+        });
+        now_iterating_in_net_players = false;
+        csPlayers.Leave();
+    }
     template <typename SearchPredicate, typename ActionFunctor>
     u32 ForFoundClientsDo(SearchPredicate const& predicate, ActionFunctor& functor)
     {
@@ -198,6 +198,7 @@ IPureServer::IPureServer(CTimer* timer, BOOL Dedicated)
     SV_Client = NULL;
     NET = NULL;
     net_Address_device = NULL;
+    m_transport = NULL;
     pSvNetLog = NULL; // new INetLog("logs\\net_sv_log.log", TimeGlobal(device_timer));
 #ifdef DEBUG
     sender_functor_invoked = false;
@@ -279,7 +280,12 @@ IPureServer::EConnect IPureServer::Connect(LPCSTR options, GameDescriptionData&
     }
     //-------------------------------------------------------------------
 
-    if (!psNET_direct_connect)
+    if (!psNET_direct_connect && net_transport_enabled())
+    {
+        if (!transport_Host(session_name, password_str, dwMaxPlayers, game_descr, dwServerPort, !!bPortWasSet))
+            return ErrConnect;
+    }
+    else if (!psNET_direct_connect)
     {
 //---------------------------
 #ifdef DEBUG
@@ -427,6 +433,9 @@ void IPureServer::Disconnect()
         IpList_Unload();
     }
 
+    // the transport thread is stopped before the players are gone
+    xr_delete(m_transport);
+
     if (NET)
         NET->Close(0);
 
@@ -435,6 +444,118 @@ void IPureServer::Disconnect()
     _RELEASE(NET);
 }
 
+bool IPureServer::transport_Host(LPCSTR session_name, LPCSTR password, u32 max_players,
+    const GameDescriptionData& game_descr, u32 port, bool port_set)
+{
+    ZeroMemory(&m_transport_reply, sizeof(m_transport_reply));
+    m_transport_reply.result = SServerTransportReply::Accepted;
+    strncpy_s(m_transport_reply.session_name, session_name, sizeof(m_transport_reply.session_name) - 1);
+    m_transport_reply.game_descr = game_descr;
+    xr_strcpy(m_transport_password, password);
+    // DirectPlay counts the host as a player, the transport has no such
+    m_transport_max_players = m_bDedicated ? (max_players + 1) : max_players;
+
+    psNET_Port = port;
+    for (;;)
+    {
+        m_transport = new CNetTransportThread(net_create_udp_socket(), *this);
+        if (m_transport->Listen(u16(psNET_Port)))
+            break;
+
+        xr_delete(m_transport);
+        Msg("! IPureServer : port %d is BUSY!", psNET_Port);
+        if (port_set || (++psNET_Port > END_PORT_LAN))
+            return false;
+    }
+
+    m_transport->Start();
+    Msg("- IPureServer : created on port %d over the net transport!", psNET_Port);
+    return true;
+}
+
+void IPureServer::transport_ConnectClient(u32 peer, const void* data, u32 size)
+{
+    SServerTransportReply reply = m_transport_reply;
+    SClientTransportConnect connect;
+    ip_address HAddr;
+    GetClientAddress(ClientID(peer), HAddr);
+
+    if (size != sizeof(connect))
+        reply.result = SServerTransportReply::Rejected;
+    else
+    {
+        CopyMemory(&connect, data, size);
+        connect.data.name[sizeof(connect.data.name) - 1] = 0;
+        connect.data.pass[sizeof(connect.data.pass) - 1] = 0;
+        connect.session_password[sizeof(connect.session_password) - 1] = 0;
+
+        // first connected client is SV_Client, the same as for DPN_MSGID_INDICATE_CONNECT
+        if (GetBannedClient(HAddr) || (SV_Client && !m_ip_filter.is_ip_present(HAddr.m_data.data)))
+            reply.result = SServerTransportReply::Rejected;
+        else if (xr_strlen(m_transport_password) && xr_strcmp(connect.session_password, m_transport_password))
+            reply.result = SServerTransportReply::InvalidPassword;
+        else if (net_players.ClientsCount() >= m_transport_max_players)
+            reply.result = SServerTransportReply::SessionFull;
+    }
+
+    m_transport->Send(peer, &reply, sizeof(reply), NET_TRANSPORT_RELIABLE | NET_TRANSPORT_SEQUENCED);
+    if (reply.result != SServerTransportReply::Accepted)
+    {
+        Msg("! IPureServer : connection of %s is rejected", HAddr.to_string().c_str());
+        m_transport->Disconnect(peer);
+        return;
+    }
+
+    connect.data.clientID.set(peer);
+    new_client(&connect.data);
+}
+
+void IPureServer::OnPeerConnected(u32 peer) {}
+void IPureServer::OnPeerDisconnected(u32 peer) { client_destroyed(ClientID(peer)); }
+void IPureServer::OnPeerMessage(u32 peer, const void* data, u32 size)
+{
+    if (ID_to_client(ClientID(peer)))
+        net_Receive(data, size, peer);
+    else
+        transport_ConnectClient(peer, data, size);
+}
+
+void IPureServer::net_Receive(const void* data, u32 size, u32 sender)
+{
+    const MSYS_PING* m_ping = (const MSYS_PING*)data;
+
+    if ((size > 2 * sizeof(u32)) && (m_ping->sign1 == 0x12071980) && (m_ping->sign2 == 0x26111975))
+    {
+        // this is system message
+        if (size == sizeof(MSYS_PING))
+        {
+            // ping - save server time and reply
+            MSYS_PING reply = *m_ping;
+            reply.dwTime_Server = TimerAsync(device_timer);
+            ClientID ID;
+            ID.set(sender);
+            IPureServer::SendTo_Buf(ID, &reply, sizeof(reply), net_flags(FALSE, FALSE, TRUE, TRUE));
+        }
+    }
+    else
+    {
+        MultipacketReciever::RecievePacket(data, size, sender);
+    }
+}
+
+void IPureServer::client_destroyed(ClientID ID)
+{
+    IClient* tmp_client = net_players.GetFoundClient(ClientIdSearchPredicate(ID));
+    if (tmp_client)
+    {
+        tmp_client->flags.bConnected = FALSE;
+        tmp_client->flags.bReconnect = FALSE;
+        OnCL_Disconnected(tmp_client);
+        // real destroy
+        client_Destroy(tmp_client);
+    }
+}
+
 HRESULT IPureServer::net_Handler(u32 dwMessageType, PVOID pMessage)
 {
     // HRESULT     hr = S_OK;
@@ -494,44 +615,13 @@ HRESULT IPureServer::net_Handler(u32 dwMessageType, PVOID pMessage)
     case DPN_MSGID_DESTROY_PLAYER:
     {
         PDPNMSG_DESTROY_PLAYER msg = PDPNMSG_DESTROY_PLAYER(pMessage);
-        IClient* tmp_client =
-            net_players.GetFoundClient(ClientIdSearchPredicate(static_cast<ClientID>(msg->dpnidPlayer)));
-        if (tmp_client)
-        {
-            tmp_client->flags.bConnected = FALSE;
-            tmp_client->flags.bReconnect = FALSE;
-            OnCL_Disconnected(tmp_client);
-            // real destroy
-            client_Destroy(tmp_client);
-        }
+        client_destroyed(static_cast<ClientID>(msg->dpnidPlayer));
     }
     break;
     case DPN_MSGID_RECEIVE:
     {
         PDPNMSG_RECEIVE pMsg = PDPNMSG_RECEIVE(pMessage);
-        void* m_data = pMsg->pReceiveData;
-        u32 m_size = pMsg->dwReceiveDataSize;
-        DPNID m_sender = pMsg->dpnidSender;
-
-        MSYS_PING* m_ping = (MSYS_PING*)m_data;
-
-        if ((m_size > 2 * sizeof(u32)) && (m_ping->sign1 == 0x12071980) && (m_ping->sign2 == 0x26111975))
-        {
-            // this is system message
-            if (m_size == sizeof(MSYS_PING))
-            {
-                // ping - save server time and reply
-                m_ping->dwTime_Server = TimerAsync(device_timer);
-                ClientID ID;
-                ID.set(m_sender);
-                //						IPureServer::SendTo_LL	(ID,m_data,m_size,net_flags(FALSE,FALSE,TRUE));
-                IPureServer::SendTo_Buf(ID, m_data, m_size, net_flags(FALSE, FALSE, TRUE, TRUE));
-            }
-        }
-        else
-        {
-            MultipacketReciever::RecievePacket(pMsg->pReceiveData, pMsg->dwReceiveDataSize, m_sender);
-        }
+        net_Receive(pMsg->pReceiveData, pMsg->dwReceiveDataSize, pMsg->dpnidSender);
     }
     break;
 
@@ -575,6 +665,55 @@ void IPureServer::Flush_Clients_Buffers()
     net_players.ForEachClientDo(LocalSenderFunctor::FlushBuffer);
 }
 
+// the workers sending to the clients in parallel only write to the log, it is made before them
+static void PrepareParallelSendLog(CTimer* timer)
+{
+    if (psNET_Flags.test(NETFLAG_LOG_SV_PACKETS) && !pSvNetLog)
+        pSvNetLog = new INetLog("logs\\net_sv_log.log", TimeGlobal(timer));
+}
+
+void IPureServer::Flush_Clients_Buffers_Parallel()
+{
+    if (!psNET_Flags.test(NETFLAG_PARALLEL_SEND))
+    {
+        Flush_Clients_Buffers();
+        return;
+    }
+
+#if NET_LOG_PACKETS
+    Msg("#flush server send-buf in parallel");
+#endif
+
+    struct LocalSenderFunctor
+    {
+        static void FlushBuffer(IClient* client) { client->FlushSendBuffer(0); }
+    };
+
+    // every client compresses and sends its buffers on its own worker
+    PrepareParallelSendLog(device_timer);
+    net_players.ForEachClientDoParallel(&LocalSenderFunctor::FlushBuffer);
+}
+
+void IPureServer::ForEachClientDoSenderParallel(fastdelegate::FastDelegate1<IClient*, void>& action)
+{
+    if (!psNET_Flags.test(NETFLAG_PARALLEL_SEND))
+    {
+        ForEachClientDoSender(action);
+        return;
+    }
+
+    PrepareParallelSendLog(device_timer);
+    csMessage.Enter();
+#ifdef DEBUG
+    sender_functor_invoked = true;
+#endif //#ifdef DEBUG
+    net_players.ForEachClientDoParallel(action);
+#ifdef DEBUG
+    sender_functor_invoked = false;
+#endif //#ifdef DEBUG
+    csMessage.Leave();
+}
+
 void IPureServer::SendTo_Buf(ClientID id, void* data, u32 size, u32 dwFlags, u32 dwTimeout)
 {
     IClient* tmp_client = net_players.GetFoundClient(ClientIdSearchPredicate(id));
@@ -600,16 +739,25 @@ void IPureServer::SendTo_LL(ClientID ID /*DPNID ID*/, void* data, u32 size, u32
 
 #ifdef _DEBUG
     u32 time_global = TimeGlobal(device_timer);
-    if (time_global - stats.dwSendTime >= 999)
-    {
-        stats.dwBytesPerSec = (stats.dwBytesPerSec * 9 + stats.dwBytesSended) / 10;
-        stats.dwBytesSended = 0;
-        stats.dwSendTime = time_global;
-    };
+    u32 send_time = stats.dwSendTime.load();
+    // only the sender which moves the send time on averages the bytes of the last second
+    if ((time_global - send_time >= 999) && stats.dwSendTime.compare_exchange_strong(send_time, time_global))
+        stats.dwBytesPerSec = (stats.dwBytesPerSec.load() * 9 + stats.dwBytesSended.exchange(0)) / 10;
     if (ID.value())
         stats.dwBytesSended += size;
 #endif
 
+    if (m_transport)
+    {
+        if (size > NET_TransportMessageSizeLimit)
+        {
+            Msg("! too large packet size[%d] for the net transport", size);
+            return;
+        }
+        m_transport->Send(ID.value(), data, size, net_transport_flags(dwFlags));
+        return;
+    }
+
     // verify
     VERIFY(desc.dwBufferSize);
     VERIFY(desc.pBufferData);
@@ -712,9 +860,14 @@ BOOL IPureServer::HasBandwidth(IClient* C)
     {
         // check queue for "empty" state
         DWORD dwPending;
-        hr = NET->GetSendQueueInfo(C->ID.value(), &dwPending, 0, 0);
-        if (FAILED(hr))
-            return FALSE;
+        if (m_transport)
+            dwPending = m_transport->GetQueueSize(C->ID.value());
+        else
+        {
+            hr = NET->GetSendQueueInfo(C->ID.value(), &dwPending, 0, 0);
+            if (FAILED(hr))
+                return FALSE;
+        }
 
         if (dwPending > u32(psNET_ServerPending))
         {
@@ -736,7 +889,9 @@ void IPureServer::UpdateClientStatistic(IClient* C)
     DPN_CONNECTION_INFO CI;
     ZeroMemory(&CI, sizeof(CI));
     CI.dwSize = sizeof(CI);
-    if (!psNET_direct_connect)
+    if (m_transport)
+        CI.dwRoundTripLatencyMS = m_transport->GetPing(C->ID.value());
+    else if (!psNET_direct_connect)
     {
         HRESULT hr = NET->GetConnectionInfo(C->ID.value(), &CI, 0);
         if (FAILED(hr))
@@ -770,6 +925,13 @@ bool IPureServer::DisconnectClient(IClient* C, LPCSTR Reason)
     if (!C)
         return false;
 
+    // the transport has no reason to pass, the client just loses the connection
+    if (m_transport)
+    {
+        m_transport->Disconnect(C->ID.value());
+        return true;
+    }
+
     HRESULT res = NET->DestroyClient(C->ID.value(), Reason, xr_strlen(Reason) + 1, 0);
     CHK_DX(res);
     return true;
@@ -838,6 +1000,18 @@ bool IPureServer::GetClientAddress(IDirectPlay8Address* pClientAddress, ip_addre
 
 bool IPureServer::GetClientAddress(ClientID ID, ip_address& Address, DWORD* pPort)
 {
+    if (m_transport)
+    {
+        NET_Address address = m_transport->GetAddress(ID.value());
+        Address.m_data.a1 = u8(address.ip >> 24);
+        Address.m_data.a2 = u8(address.ip >> 16);
+        Address.m_data.a3 = u8(address.ip >> 8);
+        Address.m_data.a4 = u8(address.ip);
+        if (pPort != NULL)
+            *pPort = address.port;
+        return true;
+    }
+
     IDirectPlay8Address* pClAddr = NULL;
     CHK_DX(NET->GetClientAddress(ID.value(), &pClAddr, 0));
 
@@ -4,6 +4,7 @@
 #include "ip_filter.h"
 #include "NET_Common.h"
 #include "NET_PlayersMonitor.h"
+#include "NET_Transport.h"
 
 struct SClientConnectData
 {
@@ -19,6 +20,29 @@ struct SClientConnectData
     }
 };
 
+// Over CNetTransport, which has no sessions of its own, the client sends the connect data as its first message and
+// the server replies to it before any other message
+struct SClientTransportConnect
+{
+    SClientConnectData data;
+    string64 session_password;
+};
+
+struct SServerTransportReply
+{
+    enum EResult
+    {
+        Accepted,
+        Rejected,
+        InvalidPassword,
+        SessionFull,
+    };
+
+    u32 result;
+    string256 session_name;
+    GameDescriptionData game_descr;
+};
+
 // -----------------------------------------------------
 
 class IPureServer;
@@ -102,9 +126,10 @@ public:
     u32 bytes_out, bytes_out_real;
     u32 bytes_in, bytes_in_real;
 
-    u32 dwBytesSended;
-    u32 dwSendTime;
-    u32 dwBytesPerSec;
+    // SendTo_LL updates them from the workers of Flush_Clients_Buffers_Parallel
+    std::atomic<u32> dwBytesSended;
+    std::atomic<u32> dwSendTime;
+    std::atomic<u32> dwBytesPerSec;
 };
 
 class XRNETSERVER_API IBannedClient
@@ -137,7 +162,7 @@ class CSE_Abstract;
 class CServerInfo;
 class IServerGameState;
 
-class XRNETSERVER_API IPureServer : private MultipacketReciever
+class XRNETSERVER_API IPureServer : private MultipacketReciever, private INetTransportHandler
 {
 public:
     enum EConnect
@@ -151,6 +176,11 @@ protected:
     shared_str connect_options;
     IDirectPlay8Server* NET;
     IDirectPlay8Address* net_Address_device;
+    // instead of NET, see net_transport_enabled
+    CNetTransportThread* m_transport;
+    SServerTransportReply m_transport_reply;
+    string64 m_transport_password;
+    u32 m_transport_max_players;
 
     NET_Compressor net_Compressor;
 
@@ -202,6 +232,8 @@ public:
     virtual void SendTo_LL(ClientID ID, void* data, u32 size, u32 dwFlags = DPNSEND_GUARANTEED, u32 dwTimeout = 0);
     virtual void SendTo_Buf(ClientID ID, void* data, u32 size, u32 dwFlags = DPNSEND_GUARANTEED, u32 dwTimeout = 0);
     virtual void Flush_Clients_Buffers();
+    // the same on the task scheduler workers, for the thread the server is updated on
+    void Flush_Clients_Buffers_Parallel();
 
     void SendTo(ClientID ID, NET_Packet& P, u32 dwFlags = DPNSEND_GUARANTEED, u32 dwTimeout = 0);
     void SendBroadcast_LL(ClientID exclude, void* data, u32 size, u32 dwFlags = DPNSEND_GUARANTEED);
@@ -268,6 +300,9 @@ public:
 #endif //#ifdef DEBUG
         csMessage.Leave();
     }
+    // for the senders of the server update that only fill the buffers of the client they are given: they run on
+    // the task scheduler workers, one client per task, see PlayersMonitor::ForEachClientDoParallel
+    void ForEachClientDoSenderParallel(fastdelegate::FastDelegate1<IClient*, void>& action);
 // template<typename ActionFunctor>
 // void					ForEachDisconnectedClientDo(ActionFunctor & action) {
 // net_players.ForEachDisconnectedClientDo(action);
@@ -304,4 +339,14 @@ private:
 #endif
 
     virtual void _Recieve(const void* data, u32 data_size, u32 param);
+
+    void net_Receive(const void* data, u32 size, u32 sender);
+    void client_destroyed(ClientID ID);
+
+    bool transport_Host(LPCSTR session_name, LPCSTR password, u32 max_players, const GameDescriptionData& game_descr,
+        u32 port, bool port_set);
+    void transport_ConnectClient(u32 peer, const void* data, u32 size);
+    virtual void OnPeerConnected(u32 peer);
+    virtual void OnPeerDisconnected(u32 peer);
+    virtual void OnPeerMessage(u32 peer, const void* data, u32 size);
 };
@@ -37,6 +37,7 @@ enum
     NETFLAG_DBG_DUMPSIZE = (1 << 1),
     NETFLAG_LOG_SV_PACKETS = (1 << 2),
     NETFLAG_LOG_CL_PACKETS = (1 << 3),
+    NETFLAG_PARALLEL_SEND = (1 << 4), // server sends to the clients on the task scheduler workers
 };
 
 IC u32 TimeGlobal(CTimer* timer) { return timer->GetElapsed_ms(); }
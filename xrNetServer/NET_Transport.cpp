@@ -0,0 +1,1080 @@
+#include "stdafx.h"
+#include "NET_Transport.h"
+#include "xrCore/Threading/Lock.hpp"
+
+#if defined(WINDOWS)
+// windows.h is included lean, without the sockets
+#include <winsock2.h>
+#elif defined(LINUX)
+#include <sys/socket.h>
+#include <netinet/in.h>
+#include <arpa/inet.h>
+#include <fcntl.h>
+#include <netdb.h>
+#include <unistd.h>
+#endif
+
+u32 net_transport_flags(u32 dpn_flags)
+{
+    u32 result = 0;
+    if (dpn_flags & DPNSEND_GUARANTEED)
+        result |= NET_TRANSPORT_RELIABLE;
+    if (!(dpn_flags & DPNSEND_NONSEQUENTIAL))
+        result |= NET_TRANSPORT_SEQUENCED;
+    return result;
+}
+
+bool net_transport_enabled() { return !!strstr(Core.Params, "-net_transport"); }
+
+static const u32 net_loopback_ip = 0x7F000001;
+
+// ---UDP socket
+#if defined(WINDOWS)
+typedef SOCKET net_socket_t;
+typedef int net_socklen_t;
+static const net_socket_t net_invalid_socket = INVALID_SOCKET;
+IC void net_close_socket(net_socket_t s) { closesocket(s); }
+IC bool net_set_nonblocking(net_socket_t s)
+{
+    u_long on = 1;
+    return ioctlsocket(s, FIONBIO, &on) == 0;
+}
+#else
+typedef int net_socket_t;
+typedef socklen_t net_socklen_t;
+static const net_socket_t net_invalid_socket = -1;
+IC void net_close_socket(net_socket_t s) { close(s); }
+IC bool net_set_nonblocking(net_socket_t s) { return fcntl(s, F_SETFL, fcntl(s, F_GETFL, 0) | O_NONBLOCK) != -1; }
+#endif
+
+// datagrams passed to the system in one call
+static const u32 udp_batch = 64;
+static const int udp_buffer_size = 1024 * 1024;
+
+static void to_sockaddr(const NET_Address& address, sockaddr_in& dest)
+{
+    ZeroMemory(&dest, sizeof(dest));
+    dest.sin_family = AF_INET;
+    dest.sin_addr.s_addr = htonl(address.ip);
+    dest.sin_port = htons(address.port);
+}
+
+static NET_Address from_sockaddr(const sockaddr_in& source)
+{
+    return NET_Address(ntohl(source.sin_addr.s_addr), ntohs(source.sin_port));
+}
+
+class CNetUdpSocket : public INetDatagramSocket
+{
+    net_socket_t m_socket;
+    NET_Address m_address;
+#if defined(WINDOWS)
+    bool m_startup;
+#endif
+
+public:
+#if defined(WINDOWS)
+    CNetUdpSocket() : m_socket(net_invalid_socket), m_startup(false) {}
+#else
+    CNetUdpSocket() : m_socket(net_invalid_socket) {}
+#endif
+    virtual ~CNetUdpSocket() { Close(); }
+    virtual bool Open(u16 port)
+    {
+        VERIFY(m_socket == net_invalid_socket);
+#if defined(WINDOWS)
+        WSADATA wsa_data;
+        if (WSAStartup(MAKEWORD(2, 2), &wsa_data))
+        {
+            Msg("! NET: can't initialize the sockets");
+            return false;
+        }
+        m_startup = true;
+#endif
+        m_socket = socket(AF_INET, SOCK_DGRAM, IPPROTO_UDP);
+        if (m_socket == net_invalid_socket)
+        {
+            Msg("! NET: can't create an UDP socket");
+            Close();
+            return false;
+        }
+
+        setsockopt(m_socket, SOL_SOCKET, SO_RCVBUF, (const char*)&udp_buffer_size, sizeof(udp_buffer_size));
+        setsockopt(m_socket, SOL_SOCKET, SO_SNDBUF, (const char*)&udp_buffer_size, sizeof(udp_buffer_size));
+
+        sockaddr_in address;
+        to_sockaddr(NET_Address(0, port), address);
+        net_socklen_t address_size = sizeof(address);
+        if (bind(m_socket, (sockaddr*)&address, sizeof(address)) ||
+            getsockname(m_socket, (sockaddr*)&address, &address_size) || !net_set_nonblocking(m_socket))
+        {
+            Msg("! NET: can't bind the UDP port %d", port);
+            Close();
+            return false;
+        }
+
+        m_address = NET_Address(net_loopback_ip, ntohs(address.sin_port));
+        return true;
+    }
+
+    virtual void Close()
+    {
+        if (m_socket != net_invalid_socket)
+            net_close_socket(m_socket);
+#if defined(WINDOWS)
+        if (m_startup)
+            WSACleanup();
+        m_startup = false;
+#endif
+        m_socket = net_invalid_socket;
+        m_address = NET_Address();
+    }
+
+    virtual NET_Address Address() const { return m_address; }
+#if defined(LINUX)
+    virtual void Send(const NET_Datagram* datagrams, u32 count)
+    {
+        mmsghdr messages[udp_batch];
+        iovec vectors[udp_batch];
+        sockaddr_in addresses[udp_batch];
+        for (u32 i = 0; i < count; i += udp_batch)
+        {
+            u32 batch = _min(count - i, udp_batch);
+            for (u32 j = 0; j < batch; ++j)
+            {
+                to_sockaddr(datagrams[i + j].address, addresses[j]);
+                vectors[j].iov_base = datagrams[i + j].data;
+                vectors[j].iov_len = datagrams[i + j].size;
+                ZeroMemory(&messages[j], sizeof(messages[j]));
+                messages[j].msg_hdr.msg_name = &addresses[j];
+                messages[j].msg_hdr.msg_namelen = sizeof(addresses[j]);
+                messages[j].msg_hdr.msg_iov = &vectors[j];
+                messages[j].msg_hdr.msg_iovlen = 1;
+            }
+
+            // the datagrams the system has no room for are lost, as any other ones
+            for (u32 sent = 0; sent < batch;)
+            {
+                int result = sendmmsg(m_socket, messages + sent, batch - sent, 0);
+                if (result <= 0)
+                    break;
+                sent += result;
+            }
+        }
+    }
+
+    virtual u32 Receive(NET_Datagram* datagrams, u32 count)
+    {
+        mmsghdr messages[udp_batch];
+        iovec vectors[udp_batch];
+        sockaddr_in addresses[udp_batch];
+        u32 batch = _min(count, udp_batch);
+        for (u32 j = 0; j < batch; ++j)
+        {
+            vectors[j].iov_base = datagrams[j].data;
+            vectors[j].iov_len = NET_DatagramSizeLimit;
+            ZeroMemory(&messages[j], sizeof(messages[j]));
+            messages[j].msg_hdr.msg_name = &addresses[j];
+            messages[j].msg_hdr.msg_namelen = sizeof(addresses[j]);
+            messages[j].msg_hdr.msg_iov = &vectors[j];
+            messages[j].msg_hdr.msg_iovlen = 1;
+        }
+
+        int result = recvmmsg(m_socket, messages, batch, MSG_DONTWAIT, nullptr);
+        if (result <= 0)
+            return 0;
+
+        for (int j = 0; j < result; ++j)
+        {
+            datagrams[j].address = from_sockaddr(addresses[j]);
+            // a datagram over the buffer is truncated, it is dropped as an empty one
+            datagrams[j].size = (messages[j].msg_hdr.msg_flags & MSG_TRUNC) ? 0 : messages[j].msg_len;
+        }
+        return u32(result);
+    }
+#else
+    virtual void Send(const NET_Datagram* datagrams, u32 count)
+    {
+        sockaddr_in address;
+        for (u32 i = 0; i < count; ++i)
+        {
+            to_sockaddr(datagrams[i].address, address);
+            sendto(m_socket, (const char*)datagrams[i].data, datagrams[i].size, 0, (sockaddr*)&address,
+                sizeof(address));
+        }
+    }
+
+    virtual u32 Receive(NET_Datagram* datagrams, u32 count)
+    {
+        u32 result = 0;
+        while (result < count)
+        {
+            sockaddr_in address;
+            net_socklen_t address_size = sizeof(address);
+            int size = recvfrom(m_socket, (char*)datagrams[result].data, NET_DatagramSizeLimit, 0,
+                (sockaddr*)&address, &address_size);
+            if (size < 0)
+            {
+                // an unreachable peer is reported by the next receive, there may be more datagrams still
+                // the datagram over the buffer is dropped as well
+                int error = WSAGetLastError();
+                if ((error == WSAECONNRESET) || (error == WSAEMSGSIZE))
+                    continue;
+                break;
+            }
+
+            datagrams[result].address = from_sockaddr(address);
+            datagrams[result].size = u32(size);
+            ++result;
+        }
+        return result;
+    }
+#endif
+};
+
+INetDatagramSocket* net_create_udp_socket() { return new CNetUdpSocket(); }
+
+bool net_resolve_address(LPCSTR host, u16 port, NET_Address& result)
+{
+#if defined(WINDOWS)
+    WSADATA wsa_data;
+    if (WSAStartup(MAKEWORD(2, 2), &wsa_data))
+        return false;
+#endif
+    hostent* host_entry = gethostbyname(host);
+    bool resolved = host_entry && (host_entry->h_addrtype == AF_INET) && host_entry->h_addr_list[0];
+    if (resolved)
+    {
+        in_addr address;
+        CopyMemory(&address, host_entry->h_addr_list[0], sizeof(address));
+        result = NET_Address(ntohl(address.s_addr), port);
+    }
+#if defined(WINDOWS)
+    WSACleanup();
+#endif
+    return resolved;
+}
+// ---loopback socket
+// datagrams over the limit are dropped as by a full socket buffer
+static const u32 loopback_queue_limit = 4096;
+static const u16 loopback_first_port = 49152;
+
+class CNetLoopbackSocket;
+
+struct CNetLoopbackRegistry
+{
+    Lock cs;
+    xr_map<u16, CNetLoopbackSocket*> sockets;
+};
+
+static CNetLoopbackRegistry loopback_registry;
+
+class CNetLoopbackSocket : public INetDatagramSocket
+{
+    struct SQueued
+    {
+        NET_Address from;
+        NET_PooledPacket datagram;
+    };
+
+    Lock m_cs;
+    xr_deque<SQueued> m_queue;
+    NET_Address m_address;
+
+    void push(const NET_Address& from, const NET_Datagram& datagram)
+    {
+        m_cs.Enter();
+        if (m_queue.size() < loopback_queue_limit)
+        {
+            m_queue.push_back(SQueued());
+            m_queue.back().from = from;
+            m_queue.back().datagram.assign(datagram.data, datagram.size, 0);
+        }
+        m_cs.Leave();
+    }
+
+public:
+    virtual ~CNetLoopbackSocket() { Close(); }
+    virtual bool Open(u16 port)
+    {
+        VERIFY(!m_address.port);
+        loopback_registry.cs.Enter();
+        if (!port)
+        {
+            for (port = loopback_first_port; port && loopback_registry.sockets.count(port); ++port)
+                ;
+        }
+
+        if (!port || loopback_registry.sockets.count(port))
+        {
+            loopback_registry.cs.Leave();
+            Msg("! NET: loopback port %d is taken", port);
+            return false;
+        }
+
+        loopback_registry.sockets[port] = this;
+        loopback_registry.cs.Leave();
+        m_address = NET_Address(net_loopback_ip, port);
+        return true;
+    }
+
+    virtual void Close()
+    {
+        if (!m_address.port)
+            return;
+
+        loopback_registry.cs.Enter();
+        loopback_registry.sockets.erase(m_address.port);
+        loopback_registry.cs.Leave();
+
+        m_cs.Enter();
+        m_queue.clear();
+        m_cs.Leave();
+        m_address = NET_Address();
+    }
+
+    virtual NET_Address Address() const { return m_address; }
+    virtual void Send(const NET_Datagram* datagrams, u32 count)
+    {
+        // the registry stays locked, so that no socket is closed while a datagram is pushed to it
+        loopback_registry.cs.Enter();
+        for (u32 i = 0; i < count; ++i)
+        {
+            auto I = loopback_registry.sockets.find(datagrams[i].address.port);
+            if (I != loopback_registry.sockets.end())
+                I->second->push(m_address, datagrams[i]);
+        }
+        loopback_registry.cs.Leave();
+    }
+
+    virtual u32 Receive(NET_Datagram* datagrams, u32 count)
+    {
+        u32 result = 0;
+        m_cs.Enter();
+        for (; (result < count) && !m_queue.empty(); ++result)
+        {
+            SQueued& queued = m_queue.front();
+            datagrams[result].address = queued.from;
+            datagrams[result].size = queued.datagram.size();
+            CopyMemory(datagrams[result].data, queued.datagram.data(), queued.datagram.size());
+            m_queue.pop_front();
+        }
+        m_cs.Leave();
+        return result;
+    }
+};
+
+INetDatagramSocket* net_create_loopback_socket() { return new CNetLoopbackSocket(); }
+// ---CNetTransport
+enum
+{
+    dt_connect = 0,
+    dt_accept,
+    dt_disconnect,
+    dt_reliable,
+    dt_unreliable,
+    dt_ack, // acknowledges and keeps the connection alive when there is nothing else to send
+};
+
+#pragma pack(push, 1)
+struct SDatagramHeader
+{
+    u16 magic;
+    u8 type;
+    u8 flags;
+    u32 sequence;
+    u32 ack; // all the reliable messages before are received
+    u32 ack_bits; // bit i is set if the reliable message ack + 1 + i is received out of order
+};
+#pragma pack(pop)
+
+static const u16 transport_magic = 0x5258;
+static const u32 receive_batch = 64;
+// reliable messages sent and not acknowledged yet, the next ones wait
+static const u32 reliable_window = 256;
+static const u32 min_resend_time = 30;
+static const u32 max_resend_time = 1000;
+static const u32 max_resend_count = 30;
+static const u32 connect_retry_time = 250;
+static const u32 keep_alive_time = 1000;
+static const u32 peer_timeout = 10000;
+
+void CNetTransport::SPeer::reset()
+{
+    used = false;
+    connected = false;
+    ack_needed = false;
+    last_receive_time = 0;
+    last_send_time = 0;
+    connect_time = 0;
+    rtt = 100;
+    send_sequence = 0;
+    pending.clear();
+    waiting.clear();
+    receive_sequence = 0;
+    out_of_order.clear();
+    unreliable_send_sequence = 0;
+    unreliable_receive_sequence = 0;
+}
+
+CNetTransport::CNetTransport(INetDatagramSocket* socket) : m_socket(socket), m_open(false), m_listen(false)
+{
+    m_timer.Start();
+    m_send_buffer.resize(NET_DatagramSizeLimit);
+    m_receive_buffer.resize(receive_batch * NET_DatagramSizeLimit);
+}
+
+CNetTransport::~CNetTransport()
+{
+    for (u32 i = 0; i < m_peers.size(); ++i)
+    {
+        if (m_peers[i]->used)
+            Disconnect(peer_id(i));
+        xr_delete(m_peers[i]);
+    }
+    flush();
+    m_socket->Close();
+    xr_delete(m_socket);
+}
+
+u32 CNetTransport::peer_id(u32 index) const { return (u32(m_peers[index]->generation) << 16) | (index + 1); }
+CNetTransport::SPeer* CNetTransport::peer(u32 id) const
+{
+    u32 index = (id & 0xffff) - 1;
+    if (!(id & 0xffff) || (index >= m_peers.size()) || !m_peers[index]->used)
+        return nullptr;
+    SPeer* result = m_peers[index];
+    return (result->generation == (id >> 16)) ? result : nullptr;
+}
+
+u32 CNetTransport::create_peer(const NET_Address& address)
+{
+    u32 index = 0;
+    for (; (index < m_peers.size()) && m_peers[index]->used; ++index)
+        ;
+    if (index == m_peers.size())
+    {
+        R_ASSERT2(index < 0xfffe, "Too many net transport peers");
+        m_peers.push_back(new SPeer());
+        m_peers.back()->generation = 0;
+    }
+
+    SPeer& result = *m_peers[index];
+    result.reset();
+    ++result.generation;
+    result.used = true;
+    result.address = address;
+    result.connect_time = result.last_receive_time = m_timer.GetElapsed_ms();
+    u32 id = peer_id(index);
+    m_peer_ids[address] = id;
+    return id;
+}
+
+void CNetTransport::remove_peer(u32 id)
+{
+    SPeer* p = peer(id);
+    VERIFY(p);
+    m_peer_ids.erase(p->address);
+    p->reset();
+}
+
+bool CNetTransport::Listen(u16 port)
+{
+    VERIFY(!m_open);
+    m_open = m_socket->Open(port);
+    m_listen = m_open;
+    return m_open;
+}
+
+u32 CNetTransport::Connect(const NET_Address& address)
+{
+    if (!m_open)
+        m_open = m_socket->Open(0);
+    if (!m_open)
+        return 0;
+
+    u32 id = create_peer(address);
+    send_datagram(*peer(id), dt_connect, 0, 0, nullptr, 0);
+    return id;
+}
+
+void CNetTransport::Disconnect(u32 id)
+{
+    SPeer* p = peer(id);
+    if (!p)
+        return;
+    send_datagram(*p, dt_disconnect, 0, 0, nullptr, 0);
+    remove_peer(id);
+}
+
+NET_Address CNetTransport::GetAddress(u32 id) const
+{
+    SPeer* p = peer(id);
+    return p ? p->address : NET_Address();
+}
+
+u32 CNetTransport::GetPing(u32 id) const
+{
+    SPeer* p = peer(id);
+    return p ? p->rtt : 0;
+}
+
+u32 CNetTransport::GetQueueSize(u32 id) const
+{
+    SPeer* p = peer(id);
+    return p ? u32(p->pending.size() + p->waiting.size()) : 0;
+}
+
+u32 CNetTransport::ack_bits(const SPeer& p) const
+{
+    u32 result = 0;
+    auto I = p.out_of_order.upper_bound(p.receive_sequence);
+    for (auto E = p.out_of_order.end(); I != E; ++I)
+    {
+        u32 distance = I->first - p.receive_sequence;
+        if (distance > 32)
+            break;
+        result |= u32(1) << (distance - 1);
+    }
+    return result;
+}
+
+void CNetTransport::send_datagram(SPeer& p, u8 type, u8 flags, u32 sequence, const void* data, u32 size)
+{
+    STATIC_CHECK(sizeof(SDatagramHeader) == NET_DatagramHeaderSize, Datagram_header_size_mismatch);
+    R_ASSERT(size <= NET_TransportMessageSizeLimit);
+
+    SDatagramHeader header;
+    header.magic = transport_magic;
+    header.type = type;
+    header.flags = flags;
+    header.sequence = sequence;
+    header.ack = p.receive_sequence;
+    header.ack_bits = ack_bits(p);
+    CopyMemory(&m_send_buffer.front(), &header, sizeof(header));
+    if (size)
+        CopyMemory(&m_send_buffer.front() + sizeof(header), data, size);
+
+    m_outgoing.push_back(SOutgoing());
+    m_outgoing.back().address = p.address;
+    m_outgoing.back().datagram.assign(&m_send_buffer.front(), sizeof(header) + size, 0);
+
+    p.ack_needed = false;
+    p.last_send_time = m_timer.GetElapsed_ms();
+}
+
+void CNetTransport::send_reliable(SPeer& p, const void* data, u32 size)
+{
+    p.pending.push_back(SPending());
+    SPending& pending = p.pending.back();
+    pending.sequence = p.send_sequence++;
+    pending.send_time = m_timer.GetElapsed_ms();
+    pending.resend_count = 0;
+    pending.message.assign(data, size, 0);
+    send_datagram(p, dt_reliable, 0, pending.sequence, data, size);
+}
+
+void CNetTransport::Send(u32 id, const void* data, u32 size, u32 flags)
+{
+    R_ASSERT2(size <= NET_TransportMessageSizeLimit, "message exceeds the datagram size limit");
+    SPeer* p = peer(id);
+    if (!p)
+        return;
+
+    if (flags & NET_TRANSPORT_RELIABLE)
+    {
+        if (!p->connected || !p->waiting.empty() || (p->pending.size() >= reliable_window))
+        {
+            p->waiting.push_back(NET_PooledPacket());
+            p->waiting.back().assign(data, size, 0);
+            return;
+        }
+        send_reliable(*p, data, size);
+        return;
+    }
+
+    if (!p->connected)
+        return;
+    send_datagram(*p, dt_unreliable, u8(flags & NET_TRANSPORT_SEQUENCED), p->unreliable_send_sequence++, data, size);
+}
+
+void CNetTransport::receive_ack(SPeer& p, u32 ack, u32 bits)
+{
+    u32 time = m_timer.GetElapsed_ms();
+    auto I = p.pending.begin();
+    while (I != p.pending.end())
+    {
+        s32 distance = s32(I->sequence - ack);
+        if (distance > 32)
+            break;
+
+        if (!distance || ((distance > 0) && !(bits & (u32(1) << (distance - 1)))))
+        {
+            ++I;
+            continue;
+        }
+
+        // the round trip of a resent message is ambiguous
+        if (!I->resend_count)
+            p.rtt = (7 * p.rtt + (time - I->send_time)) / 8;
+        I = p.pending.erase(I);
+    }
+}
+
+void CNetTransport::deliver_reliable(INetTransportHandler& handler, u32 id, u32 sequence, const u8* data, u32 size)
+{
+    SPeer* p = peer(id);
+    p->ack_needed = true;
+
+    s32 distance = s32(sequence - p->receive_sequence);
+    if ((distance < 0) || p->out_of_order.count(sequence))
+    {
+        ++m_stats.dropped;
+        return;
+    }
+
+    if (distance > 0)
+    {
+        if (u32(distance) < reliable_window)
+            p->out_of_order[sequence].assign(data, size, 0);
+        return;
+    }
+
+    ++p->receive_sequence;
+    handler.OnPeerMessage(id, data, size);
+
+    // the handler may disconnect the peer
+    while (p->used && !p->out_of_order.empty())
+    {
+        auto I = p->out_of_order.find(p->receive_sequence);
+        if (I == p->out_of_order.end())
+            break;
+
+        NET_PooledPacket message(std::move(I->second));
+        p->out_of_order.erase(I);
+        ++p->receive_sequence;
+        handler.OnPeerMessage(id, message.data(), message.size());
+    }
+}
+
+void CNetTransport::receive_datagram(
+    INetTransportHandler& handler, const NET_Address& address, const u8* data, u32 size)
+{
+    if ((size < sizeof(SDatagramHeader)) || (size > NET_DatagramSizeLimit))
+        return;
+
+    SDatagramHeader header;
+    CopyMemory(&header, data, sizeof(header));
+    if (header.magic != transport_magic)
+        return;
+
+    ++m_stats.datagrams_received;
+    m_stats.bytes_received += size;
+    data += sizeof(header);
+    size -= sizeof(header);
+
+    auto I = m_peer_ids.find(address);
+    if (I == m_peer_ids.end())
+    {
+        if (!m_listen || (header.type != dt_connect))
+            return;
+
+        u32 id = create_peer(address);
+        SPeer& p = *peer(id);
+        p.connected = true;
+        send_datagram(p, dt_accept, 0, 0, nullptr, 0);
+        handler.OnPeerConnected(id);
+        return;
+    }
+
+    u32 id = I->second;
+    SPeer& p = *peer(id);
+    p.last_receive_time = m_timer.GetElapsed_ms();
+
+    if (header.type == dt_disconnect)
+    {
+        remove_peer(id);
+        handler.OnPeerDisconnected(id);
+        return;
+    }
+
+    // anything the other side sends means the connection is accepted, even if the accept itself is lost
+    if (!p.connected && (header.type != dt_connect))
+    {
+        p.connected = true;
+        handler.OnPeerConnected(id);
+        if (!p.used)
+            return;
+    }
+
+    receive_ack(p, header.ack, header.ack_bits);
+
+    switch (header.type)
+    {
+    case dt_connect: send_datagram(p, dt_accept, 0, 0, nullptr, 0); break;
+    case dt_reliable: deliver_reliable(handler, id, header.sequence, data, size); break;
+    case dt_unreliable:
+    {
+        s32 distance = s32(header.sequence - p.unreliable_receive_sequence);
+        if ((header.flags & NET_TRANSPORT_SEQUENCED) && (distance < 0))
+        {
+            ++m_stats.dropped;
+            break;
+        }
+
+        if (distance >= 0)
+            p.unreliable_receive_sequence = header.sequence + 1;
+        handler.OnPeerMessage(id, data, size);
+        break;
+    }
+    }
+}
+
+void CNetTransport::update_peers(INetTransportHandler& handler)
+{
+    u32 time = m_timer.GetElapsed_ms();
+    for (u32 i = 0; i < m_peers.size(); ++i)
+    {
+        SPeer& p = *m_peers[i];
+        if (!p.used)
+            continue;
+
+        u32 id = peer_id(i);
+        if (!p.connected)
+        {
+            if (time - p.connect_time > peer_timeout)
+            {
+                remove_peer(id);
+                handler.OnPeerDisconnected(id);
+            }
+            else if (time - p.last_send_time >= connect_retry_time)
+                send_datagram(p, dt_connect, 0, 0, nullptr, 0);
+            continue;
+        }
+
+        if (time - p.last_receive_time > peer_timeout)
+        {
+            remove_peer(id);
+            handler.OnPeerDisconnected(id);
+            continue;
+        }
+
+        u32 resend_time = _max(min_resend_time, _min(2 * p.rtt, max_resend_time));
+        bool lost = false;
+        for (SPending& pending : p.pending)
+        {
+            if (time - pending.send_time < resend_time)
+                continue;
+
+            if (pending.resend_count == max_resend_count)
+            {
+                lost = true;
+                break;
+            }
+
+            ++pending.resend_count;
+            ++m_stats.resent;
+            pending.send_time = time;
+            send_datagram(p, dt_reliable, 0, pending.sequence, pending.message.data(), pending.message.size());
+        }
+
+        if (lost)
+        {
+            Disconnect(id);
+            handler.OnPeerDisconnected(id);
+            continue;
+        }
+
+        while (!p.waiting.empty() && (p.pending.size() < reliable_window))
+        {
+            NET_PooledPacket message(std::move(p.waiting.front()));
+            p.waiting.pop_front();
+            send_reliable(p, message.data(), message.size());
+        }
+
+        if (p.ack_needed || (time - p.last_send_time >= keep_alive_time))
+            send_datagram(p, dt_ack, 0, 0, nullptr, 0);
+    }
+}
+
+void CNetTransport::flush()
+{
+    NET_Datagram datagrams[receive_batch];
+    for (u32 i = 0; i < m_outgoing.size(); i += receive_batch)
+    {
+        u32 count = _min(u32(m_outgoing.size()) - i, receive_batch);
+        for (u32 j = 0; j < count; ++j)
+        {
+            SOutgoing& outgoing = m_outgoing[i + j];
+            datagrams[j].address = outgoing.address;
+            datagrams[j].data = const_cast<u8*>(outgoing.datagram.data());
+            datagrams[j].size = outgoing.datagram.size();
+            m_stats.bytes_sent += datagrams[j].size;
+        }
+        m_socket->Send(datagrams, count);
+        m_stats.datagrams_sent += count;
+    }
+    m_outgoing.clear();
+}
+
+void CNetTransport::Update(INetTransportHandler& handler)
+{
+    if (!m_open)
+        return;
+
+    NET_Datagram datagrams[receive_batch];
+    for (u32 i = 0; i < receive_batch; ++i)
+        datagrams[i].data = &m_receive_buffer.front() + i * NET_DatagramSizeLimit;
+
+    for (;;)
+    {
+        u32 count = m_socket->Receive(datagrams, receive_batch);
+        for (u32 i = 0; i < count; ++i)
+            receive_datagram(handler, datagrams[i].address, datagrams[i].data, datagrams[i].size);
+        if (count < receive_batch)
+            break;
+    }
+
+    update_peers(handler);
+    flush();
+}
+
+// ---transport thread
+static const u32 transport_thread_period = 1;
+
+CNetTransportThread::CNetTransportThread(INetDatagramSocket* socket, INetTransportHandler& handler)
+    : m_transport(socket), m_handler(handler),
+#ifdef CONFIG_PROFILE_LOCKS
+      m_cs(MUTEX_PROFILE_ID(CNetTransportThread::m_cs)),
+#endif // CONFIG_PROFILE_LOCKS
+      m_started(false), m_quit(false)
+{
+}
+
+CNetTransportThread::~CNetTransportThread()
+{
+    if (m_started)
+    {
+        m_quit = true;
+        m_finished.Wait();
+    }
+}
+
+bool CNetTransportThread::Listen(u16 port)
+{
+    m_cs.Enter();
+    bool result = m_transport.Listen(port);
+    m_cs.Leave();
+    return result;
+}
+
+u32 CNetTransportThread::Connect(const NET_Address& address)
+{
+    m_cs.Enter();
+    u32 result = m_transport.Connect(address);
+    m_cs.Leave();
+    return result;
+}
+
+void CNetTransportThread::Start()
+{
+    VERIFY(!m_started);
+    m_started = true;
+    thread_spawn(thread_entry, "network-transport", 0, this);
+}
+
+void CNetTransportThread::Disconnect(u32 peer)
+{
+    m_cs.Enter();
+    // the peer may be gone already, it is reported once
+    if (!(m_transport.GetAddress(peer) == NET_Address()))
+    {
+        m_transport.Disconnect(peer);
+        push_event(ev_disconnected, peer);
+    }
+    m_cs.Leave();
+}
+
+void CNetTransportThread::Send(u32 peer, const void* data, u32 size, u32 flags)
+{
+    m_cs.Enter();
+    m_transport.Send(peer, data, size, flags);
+    m_cs.Leave();
+}
+
+NET_Address CNetTransportThread::GetAddress(u32 peer)
+{
+    m_cs.Enter();
+    NET_Address result = m_transport.GetAddress(peer);
+    m_cs.Leave();
+    return result;
+}
+
+u32 CNetTransportThread::GetPing(u32 peer)
+{
+    m_cs.Enter();
+    u32 result = m_transport.GetPing(peer);
+    m_cs.Leave();
+    return result;
+}
+
+u32 CNetTransportThread::GetQueueSize(u32 peer)
+{
+    m_cs.Enter();
+    u32 result = m_transport.GetQueueSize(peer);
+    m_cs.Leave();
+    return result;
+}
+
+void CNetTransportThread::push_event(EEvent type, u32 peer)
+{
+    m_events.push_back(SEvent());
+    m_events.back().type = type;
+    m_events.back().peer = peer;
+}
+
+void CNetTransportThread::OnPeerConnected(u32 peer) { push_event(ev_connected, peer); }
+void CNetTransportThread::OnPeerDisconnected(u32 peer) { push_event(ev_disconnected, peer); }
+void CNetTransportThread::OnPeerMessage(u32 peer, const void* data, u32 size)
+{
+    // the data is in the receive buffer of the transport
+    push_event(ev_message, peer);
+    m_events.back().message.assign(data, size, 0);
+}
+
+void CNetTransportThread::thread_entry(void* self) { ((CNetTransportThread*)self)->execute(); }
+void CNetTransportThread::execute()
+{
+    while (!m_quit)
+    {
+        m_cs.Enter();
+        m_transport.Update(*this);
+        m_dispatched.swap(m_events);
+        m_cs.Leave();
+
+        for (SEvent& event : m_dispatched)
+        {
+            switch (event.type)
+            {
+            case ev_connected: m_handler.OnPeerConnected(event.peer); break;
+            case ev_disconnected: m_handler.OnPeerDisconnected(event.peer); break;
+            case ev_message: m_handler.OnPeerMessage(event.peer, event.message.data(), event.message.size()); break;
+            }
+        }
+        m_dispatched.clear();
+        Sleep(transport_thread_period);
+    }
+
+    // the disconnects of the peers are sent by the destructor of the transport
+    m_finished.Set();
+}
+
+// ---bench
+static const u32 bench_connect_timeout = 2000;
+// unreliable messages may be lost, the bench ends when nothing arrives for a while
+static const u32 bench_idle_timeout = 1000;
+static const u32 bench_burst = 64;
+
+namespace
+{
+class CBenchServer : public INetTransportHandler
+{
+    CNetTransport& m_transport;
+    u32 m_flags;
+
+public:
+    CBenchServer(CNetTransport& transport, u32 flags) : m_transport(transport), m_flags(flags) {}
+    virtual void OnPeerConnected(u32 peer) {}
+    virtual void OnPeerDisconnected(u32 peer) {}
+    virtual void OnPeerMessage(u32 peer, const void* data, u32 size) { m_transport.Send(peer, data, size, m_flags); }
+};
+
+class CBenchClient : public INetTransportHandler
+{
+    const CTimer& m_timer;
+
+public:
+    bool connected;
+    u32 received;
+    float latency_sum;
+    float latency_max;
+
+    CBenchClient(const CTimer& timer)
+        : m_timer(timer), connected(false), received(0), latency_sum(0.f), latency_max(0.f)
+    {
+    }
+
+    virtual void OnPeerConnected(u32 peer) { connected = true; }
+    virtual void OnPeerDisconnected(u32 peer) { connected = false; }
+    virtual void OnPeerMessage(u32 peer, const void* data, u32 size)
+    {
+        float send_time;
+        CopyMemory(&send_time, data, sizeof(send_time));
+        float latency = 1000.f * m_timer.GetElapsed_sec() - send_time;
+        latency_sum += latency;
+        latency_max = _max(latency_max, latency);
+        ++received;
+    }
+};
+}
+
+bool net_transport_bench(SNetTransportBench& bench)
+{
+    R_ASSERT((bench.size >= sizeof(float)) && (bench.size <= NET_TransportMessageSizeLimit));
+
+    CNetTransport server(bench.udp ? net_create_udp_socket() : net_create_loopback_socket());
+    CNetTransport client(bench.udp ? net_create_udp_socket() : net_create_loopback_socket());
+    if (!server.Listen(0))
+        return false;
+
+    CTimer timer;
+    timer.Start();
+    CBenchServer server_handler(server, bench.flags);
+    CBenchClient client_handler(timer);
+    u32 peer = client.Connect(server.Address());
+    if (!peer)
+        return false;
+
+    while (!client_handler.connected && (timer.GetElapsed_ms() < bench_connect_timeout))
+    {
+        client.Update(client_handler);
+        server.Update(server_handler);
+    }
+
+    if (!client_handler.connected)
+        return false;
+
+    xr_vector<u8> message(bench.size, 0);
+    timer.Start();
+    u32 sent = 0;
+    u32 last_received = 0;
+    u32 last_receive_time = 0;
+    while (client_handler.connected && (client_handler.received < bench.messages))
+    {
+        for (u32 i = 0; (i < bench_burst) && (sent < bench.messages); ++i, ++sent)
+        {
+            float send_time = 1000.f * timer.GetElapsed_sec();
+            CopyMemory(&message.front(), &send_time, sizeof(send_time));
+            client.Send(peer, &message.front(), bench.size, bench.flags);
+        }
+
+        client.Update(client_handler);
+        server.Update(server_handler);
+
+        u32 time = timer.GetElapsed_ms();
+        if (client_handler.received != last_received)
+        {
+            last_received = client_handler.received;
+            last_receive_time = time;
+        }
+        else if ((sent == bench.messages) && (time - last_receive_time > bench_idle_timeout))
+            break;
+    }
+
+    bench.seconds = timer.GetElapsed_sec();
+    bench.delivered = client_handler.received;
+    bench.average_latency = bench.delivered ? client_handler.latency_sum / bench.delivered : 0.f;
+    bench.max_latency = client_handler.latency_max;
+    bench.resent = client.GetStats().resent + server.GetStats().resent;
+    return true;
+}
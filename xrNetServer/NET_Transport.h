@@ -0,0 +1,254 @@
+#pragma once
+
+#include "xrCore/Threading/Event.hpp"
+#include "xrCore/Threading/Lock.hpp"
+
+// Transport of the net messages over plain datagram sockets, without DirectPlay. Every peer has a reliable
+// ordered channel and an unreliable one, the unreliable messages may be sequenced, i.e. the ones older than
+// the last received are dropped. The transport has no threads of its own, the owner polls it by Update
+
+enum
+{
+    NET_TRANSPORT_RELIABLE = (1 << 0),
+    NET_TRANSPORT_SEQUENCED = (1 << 1),
+};
+
+// DPNSEND_* flags of IPureServer::SendTo and IPureClient::Send to the transport ones
+XRNETSERVER_API u32 net_transport_flags(u32 dpn_flags);
+// IPureServer and IPureClient use the transport instead of DirectPlay, -net_transport on the command line
+XRNETSERVER_API bool net_transport_enabled();
+
+// A message is a NET_Packet sent as is or a multipacket of NET_PacketSizeLimit with its header and compression
+// tag, which are a few bytes over. A message is never fragmented by the transport, so the datagrams of 16 KB rely
+// on the IP fragmentation, and a lost fragment loses the whole datagram
+const u32 NET_TransportMessageSizeLimit = NET_PacketSizeLimit + 16;
+const u32 NET_DatagramHeaderSize = 16;
+// the datagrams are kept in the pooled packets
+const u32 NET_DatagramSizeLimit = NET_TransportMessageSizeLimit + NET_DatagramHeaderSize;
+static_assert(NET_DatagramSizeLimit <= NET_PooledPacketSizeLimit, "Datagram does not fit a pooled packet");
+
+struct XRNETSERVER_API NET_Address
+{
+    u32 ip; // host byte order
+    u16 port;
+
+    NET_Address() : ip(0), port(0) {}
+    NET_Address(u32 ip, u16 port) : ip(ip), port(port) {}
+    bool operator==(const NET_Address& other) const { return (ip == other.ip) && (port == other.port); }
+    bool operator<(const NET_Address& other) const
+    {
+        return (ip < other.ip) || ((ip == other.ip) && (port < other.port));
+    }
+};
+
+struct NET_Datagram
+{
+    NET_Address address;
+    u8* data;
+    u32 size;
+};
+
+class XRNETSERVER_API INetDatagramSocket
+{
+public:
+    virtual ~INetDatagramSocket() {}
+    // port 0 binds any free one
+    virtual bool Open(u16 port) = 0;
+    virtual void Close() = 0;
+    // address the socket is reached at from this host
+    virtual NET_Address Address() const = 0;
+    // neither blocks, the received datagrams are copied to the given data buffers of NET_DatagramSizeLimit bytes
+    virtual void Send(const NET_Datagram* datagrams, u32 count) = 0;
+    virtual u32 Receive(NET_Datagram* datagrams, u32 count) = 0;
+};
+
+XRNETSERVER_API INetDatagramSocket* net_create_udp_socket();
+// host name or the dotted address
+XRNETSERVER_API bool net_resolve_address(LPCSTR host, u16 port, NET_Address& result);
+// sockets of the same process, addressed by the port only
+XRNETSERVER_API INetDatagramSocket* net_create_loopback_socket();
+
+class XRNETSERVER_API INetTransportHandler
+{
+public:
+    virtual ~INetTransportHandler() {}
+    virtual void OnPeerConnected(u32 peer) = 0;
+    virtual void OnPeerDisconnected(u32 peer) = 0;
+    virtual void OnPeerMessage(u32 peer, const void* data, u32 size) = 0;
+};
+
+class XRNETSERVER_API CNetTransport
+{
+public:
+    struct SStats
+    {
+        u32 datagrams_sent;
+        u32 datagrams_received;
+        u32 bytes_sent;
+        u32 bytes_received;
+        u32 resent;
+        u32 dropped; // the late sequenced messages and the duplicates
+
+        SStats() { ZeroMemory(this, sizeof(*this)); }
+    };
+
+private:
+    struct SPending
+    {
+        u32 sequence;
+        u32 send_time;
+        u32 resend_count;
+        NET_PooledPacket message;
+    };
+
+    struct SPeer
+    {
+        NET_Address address;
+        u16 generation; // the slot reuse count, in the high bits of the peer id
+        bool used;
+        bool connected;
+        bool ack_needed;
+        u32 last_receive_time;
+        u32 last_send_time;
+        u32 connect_time;
+        u32 rtt;
+
+        u32 send_sequence;
+        xr_deque<SPending> pending; // sent and not acknowledged yet, by the sequence
+        xr_deque<NET_PooledPacket> waiting; // reliable messages over the window of the pending ones
+        u32 receive_sequence;
+        xr_map<u32, NET_PooledPacket> out_of_order;
+
+        u32 unreliable_send_sequence;
+        u32 unreliable_receive_sequence;
+
+        void reset();
+    };
+
+    struct SOutgoing
+    {
+        NET_Address address;
+        NET_PooledPacket datagram;
+    };
+
+    INetDatagramSocket* m_socket;
+    bool m_open;
+    bool m_listen;
+    CTimer m_timer;
+    // peer id is the index + 1 in the low 16 bits and the slot generation in the high ones, so a peer id is not
+    // given to another peer as soon as the slot is reused, as DirectPlay ids are unique within a session
+    xr_vector<SPeer*> m_peers;
+    xr_map<NET_Address, u32> m_peer_ids;
+    xr_vector<SOutgoing> m_outgoing;
+    xr_vector<u8> m_send_buffer;
+    xr_vector<u8> m_receive_buffer;
+    SStats m_stats;
+
+    u32 peer_id(u32 index) const;
+    SPeer* peer(u32 id) const;
+    u32 create_peer(const NET_Address& address);
+    void remove_peer(u32 id);
+    u32 ack_bits(const SPeer& peer) const;
+    void send_datagram(SPeer& peer, u8 type, u8 flags, u32 sequence, const void* data, u32 size);
+    void send_reliable(SPeer& peer, const void* data, u32 size);
+    void receive_datagram(INetTransportHandler& handler, const NET_Address& address, const u8* data, u32 size);
+    void receive_ack(SPeer& peer, u32 ack, u32 bits);
+    void deliver_reliable(INetTransportHandler& handler, u32 id, u32 sequence, const u8* data, u32 size);
+    void update_peers(INetTransportHandler& handler);
+    void flush();
+
+public:
+    // takes the ownership of the socket
+    CNetTransport(INetDatagramSocket* socket);
+    ~CNetTransport();
+
+    bool Listen(u16 port);
+    // the peer is connected as soon as OnPeerConnected is called, 0 is never a valid peer
+    u32 Connect(const NET_Address& address);
+    void Disconnect(u32 peer);
+
+    void Send(u32 peer, const void* data, u32 size, u32 flags);
+    // receives and dispatches the datagrams, resends the lost reliable messages and sends everything queued
+    void Update(INetTransportHandler& handler);
+
+    NET_Address Address() const { return m_socket->Address(); }
+    NET_Address GetAddress(u32 peer) const;
+    u32 GetPing(u32 peer) const;
+    // reliable messages sent and not acknowledged yet or waiting to be sent
+    u32 GetQueueSize(u32 peer) const;
+    const SStats& GetStats() const { return m_stats; }
+};
+
+// Transport polled on a thread of its own, the way DirectPlay calls the handler of IPureServer and IPureClient.
+// The events are dispatched outside of the transport lock, so the handler may send, and the rest may be called
+// from any thread. A peer disconnected by Disconnect is reported to the handler as well
+class XRNETSERVER_API CNetTransportThread : private INetTransportHandler
+{
+    enum EEvent
+    {
+        ev_connected,
+        ev_disconnected,
+        ev_message,
+    };
+
+    struct SEvent
+    {
+        EEvent type;
+        u32 peer;
+        NET_PooledPacket message;
+    };
+
+    CNetTransport m_transport;
+    INetTransportHandler& m_handler;
+    Lock m_cs;
+    xr_vector<SEvent> m_events;
+    xr_vector<SEvent> m_dispatched;
+    bool m_started;
+    std::atomic_bool m_quit;
+    Event m_finished;
+
+    void push_event(EEvent type, u32 peer);
+    virtual void OnPeerConnected(u32 peer);
+    virtual void OnPeerDisconnected(u32 peer);
+    virtual void OnPeerMessage(u32 peer, const void* data, u32 size);
+
+    static void thread_entry(void* self);
+    void execute();
+
+public:
+    // takes the ownership of the socket
+    CNetTransportThread(INetDatagramSocket* socket, INetTransportHandler& handler);
+    ~CNetTransportThread();
+
+    bool Listen(u16 port);
+    u32 Connect(const NET_Address& address);
+    // after Listen or Connect
+    void Start();
+    void Disconnect(u32 peer);
+
+    void Send(u32 peer, const void* data, u32 size, u32 flags);
+
+    NET_Address GetAddress(u32 peer);
+    u32 GetPing(u32 peer);
+    u32 GetQueueSize(u32 peer);
+};
+
+// Echo of messages between a client and a server transport of the same process, to measure the throughput
+// and the round trip latency of the transport without the network
+struct XRNETSERVER_API SNetTransportBench
+{
+    bool udp;
+    u32 messages;
+    u32 size;
+    u32 flags;
+
+    u32 delivered;
+    float seconds;
+    float average_latency; // ms
+    float max_latency;
+    u32 resent;
+
+    SNetTransportBench() { ZeroMemory(this, sizeof(*this)); }
+};
+
+XRNETSERVER_API bool net_transport_bench(SNetTransportBench& bench);
@@ -1622,7 +1622,7 @@ extern void noise3Init();
 #ifndef _EDITOR
 
 #include <xmmintrin.h>
-#include "xrCore/Threading/ttapi.h"
+#include "xrCore/Threading/TaskManager.hpp"
 
 __forceinline __m128 _mm_load_fvector(const Fvector& v)
 {
@@ -1758,39 +1758,23 @@ void PATurbulence::Execute(ParticleEffect* effect, const float dt, float& tm_max
     if (!p_cnt)
         return;
 
-    u32 nWorkers = ttapi_GetWorkerCount();
-
-    if (p_cnt < nWorkers * 64)
-        nWorkers = 1;
-
-    TES_PARAMS* tesParams = (TES_PARAMS*)_alloca(sizeof(TES_PARAMS) * nWorkers);
-
-    // Give ~1% more for the last worker
-    // to minimize wait in final spin
-    u32 nSlice = p_cnt / 128;
-
-    u32 nStep = ((p_cnt - nSlice) / nWorkers);
-    // u32 nStep = ( p_cnt / nWorkers );
-
-    // Msg( "Trb: %u" , nStep );
-
-    for (u32 i = 0; i < nWorkers; ++i)
+    TES_PARAMS tesParams;
+    tesParams.effect = effect;
+    tesParams.offset = offset;
+    tesParams.age = age;
+    tesParams.epsilon = epsilon;
+    tesParams.frequency = frequency;
+    tesParams.octaves = octaves;
+    tesParams.magnitude = magnitude;
+
+    // Small chunks let idle workers steal the tail instead of waiting for the slowest stride
+    TaskScheduler.ParallelFor(0, p_cnt, TaskScheduler.CalcGrainSize(p_cnt, 64), [&tesParams](u32 from, u32 to)
     {
-        tesParams[i].p_from = i * nStep;
-        tesParams[i].p_to = (i == (nWorkers - 1)) ? p_cnt : (tesParams[i].p_from + nStep);
-
-        tesParams[i].effect = effect;
-        tesParams[i].offset = offset;
-        tesParams[i].age = age;
-        tesParams[i].epsilon = epsilon;
-        tesParams[i].frequency = frequency;
-        tesParams[i].octaves = octaves;
-        tesParams[i].magnitude = magnitude;
-
-        ttapi_AddWorker(PATurbulenceExecuteStream, (LPVOID)&tesParams[i]);
-    }
-
-    ttapi_Run();
+        TES_PARAMS chunk = tesParams;
+        chunk.p_from = from;
+        chunk.p_to = to;
+        PATurbulenceExecuteStream(&chunk);
+    });
 }
 
 #else
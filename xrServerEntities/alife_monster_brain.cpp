@@ -158,6 +158,12 @@ void CALifeMonsterBrain::update()
     movement().update();
 }
 
+void CALifeMonsterBrain::prepare_update()
+{
+    if (movement().path_type() != MovementManager::ePathTypeNoPath)
+        movement().detail().prepare();
+}
+
 void CALifeMonsterBrain::default_behaviour() { movement().path_type(MovementManager::ePathTypeNoPath); }
 void CALifeMonsterBrain::on_switch_online() { movement().on_switch_online(); }
 void CALifeMonsterBrain::on_switch_offline() { movement().on_switch_offline(); }
@@ -57,6 +57,8 @@ public:
 
 public:
     void update();
+    // Read-only part of the next update (the game path search), may run on a worker thread
+    void prepare_update();
     bool perform_attack();
     ALife::EMeetActionType action_type(
         CSE_ALifeSchedulable* tpALifeSchedulable, const int& iGroupIndex, const bool& bMutualDetection);
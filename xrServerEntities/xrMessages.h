@@ -78,6 +78,8 @@ enum
     M_SECURE_MESSAGE,
     M_CREATE_PLAYER_STATE,
     M_COMPRESSED_UPDATE_OBJECTS,
+    M_DELTA_UPDATE_OBJECTS,
+    M_DELTA_UPDATE_ACK,
 
     MSG_FORCEDWORD = u32(-1)
 };
@@ -84,6 +84,9 @@ public:
         CSE_ALifeSchedulable* tpALifeSchedulable, int iGroupIndex, bool bMutualDetection) = 0;
     virtual bool bfActive() = 0;
     virtual CSE_ALifeDynamicObject* tpfGetBestDetector() = 0;
+    // Part of update() that doesn't touch the ALife registries, CALifeScheduleRegistry
+    // runs it for a batch of objects on the task scheduler before their updates
+    virtual void prepare_update() {}
 #endif
 };
 
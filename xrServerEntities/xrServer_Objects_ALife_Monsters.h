@@ -350,6 +350,7 @@ public:
     virtual void update(){};
 #else
     virtual void update();
+    virtual void prepare_update();
     virtual CSE_ALifeItemWeapon* tpfGetBestWeapon(ALife::EHitType& tHitType, float& fHitPower);
     virtual ALife::EMeetActionType tfGetActionType(
         CSE_ALifeSchedulable* tpALifeSchedulable, int iGroupIndex, bool bMutualDetection);